@@ -1,7 +1,5 @@
 #include "detectorrecords.hpp"
 
-#include <Components/Encryption/Encoding.h>
-
 namespace Database
 {
 
@@ -138,34 +136,32 @@ DetectorInfoRecord::DetectorInfoRecord() :
 record_t DetectorInfoRecord::toRecord() const
 {
     auto res = RecordBase::toRecord();
-    auto hexIfExist = [](auto& iv) -> recordValue_t {
+    auto valueIfExist = [](auto& iv) -> recordValue_t {
         if (iv.has_value()) {
-            return std::string("HEX-") + Encryption::encodeHex(iv.value());
+            return iv.value();
         }
         else
             return recordValue_t{};
     };
-    res["display_name"] = hexIfExist(m_displayName);
-    res["description"]  = hexIfExist(m_description);
-    res["location"]     = hexIfExist(m_location);
+    res["display_name"] = valueIfExist(m_displayName);
+    res["description"]  = valueIfExist(m_description);
+    res["location"]     = valueIfExist(m_location);
     return res;
 }
 
 void DetectorInfoRecord::initFromRecord(const record_t &iRecord)
 {
     RecordBase::initFromRecord(iRecord);
-    auto dehexIfExist = [](auto& iv) -> ExtraClasses::JOptional<std::string> {
+    auto valueIfExist = [](auto& iv) -> ExtraClasses::JOptional<std::string> {
         if (iv.has_value() && !std::holds_alternative<std::monostate>(iv.value())) {
-            auto vstr = std::get<std::string>(iv.value());
-            vstr.erase(vstr.begin(), vstr.begin() + 4); // HEX-
-            return Encryption::decodeHex(vstr);
+            return std::get<std::string>(iv.value()); // HEX values of previous versions are decoded by migration
         }
         else
             return std::nullopt;
     };
-    m_displayName   = dehexIfExist(iRecord.at("display_name"));
-    m_description   = dehexIfExist(iRecord.at("description"));
-    m_location      = dehexIfExist(iRecord.at("location"));
+    m_displayName   = valueIfExist(iRecord.at("display_name"));
+    m_description   = valueIfExist(iRecord.at("description"));
+    m_location      = valueIfExist(iRecord.at("location"));
 }
 
 void DetectorInfoRecord::setDisplayName(const std::string &name)
@@ -80,7 +80,7 @@ private:
 
 /**
  * @brief The DetectorInfoRecord class detector.info table record
- * @note All string values converts to/from HEX for database
+ * @note Values stored in HEX with "HEX-" prefix by previous versions are decoded on read
  */
 class DetectorInfoRecord : public RecordBase
 {
@@ -4,73 +4,214 @@
 
 #include <Components/Logger/Logger.h>
 
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+
 namespace Database {
 
-// TODO: Move to common?
-static std::vector<record_t> resultToRecords(const drogon::orm::Result& execResult) {
+namespace {
+// Type OIDs of pg_type (catalog/pg_type_d.h of PostgreSQL)
+constexpr uint32_t OID_BOOL     = 16;
+constexpr uint32_t OID_INT8     = 20;
+constexpr uint32_t OID_INT2     = 21;
+constexpr uint32_t OID_INT4     = 23;
+constexpr uint32_t OID_OID      = 26;
+constexpr uint32_t OID_FLOAT4   = 700;
+constexpr uint32_t OID_FLOAT8   = 701;
+constexpr uint32_t OID_NUMERIC  = 1700;
+
+enum class ColumnType
+{
+    Integer,
+    Boolean,
+    Double,
+    String
+};
+
+ColumnType toColumnType(uint32_t oid)
+{
+    switch (oid) {
+    case OID_INT8:
+    case OID_INT2:
+    case OID_INT4:
+    case OID_OID:
+        return ColumnType::Integer;
+
+    case OID_BOOL:
+        return ColumnType::Boolean;
+
+    case OID_FLOAT4:
+    case OID_FLOAT8:
+    case OID_NUMERIC:
+        return ColumnType::Double;
+
+    default:
+        return ColumnType::String;
+    }
+}
+
+/**
+ * @brief decodeValue   Value from text form of result field (zero terminated), NULL if integer text is invalid
+ */
+recordValue_t decodeValue(ColumnType type, const char* text, std::size_t length)
+{
+    switch (type) {
+    case ColumnType::Integer: {
+        int64_t value {};
+        auto res = std::from_chars(text, text + length, value);
+        return (res.ec == std::errc() && res.ptr == text + length) ? recordValue_t(value) : recordValue_t();
+    }
 
-    std::map<int, int> columnTypes; // For cast easier
+    case ColumnType::Boolean:
+        return int64_t(length > 0 && text[0] == 't');
+
+    case ColumnType::Double:
+        return std::strtod(text, nullptr);
+
+    case ColumnType::String:
+        break;
+    }
+    return std::string(text, length);
+}
+}
+
+/**
+ * @brief resultToTable Decode result by types of columns, column types are resolved once per result
+ * @param columnOids    Type OIDs by column name, unknown columns are read as strings
+ */
+static RecordTable resultToTable(const drogon::orm::Result& execResult, const std::map<std::string, uint32_t>& columnOids)
+{
+    RecordTable table;
+    const std::size_t columnCount = execResult.columns();
+    std::vector<ColumnType> columnTypes;
+    table.columns.reserve(columnCount);
+    columnTypes.reserve(columnCount);
+    for (std::size_t column = 0; column < columnCount; ++column) {
+        table.columns.emplace_back(execResult.columnName(column));
+        auto oidIt = columnOids.find(table.columns.back());
+        columnTypes.push_back(oidIt != columnOids.end() ? toColumnType(oidIt->second) : ColumnType::String);
+    }
 
-    std::vector<record_t> res;
+    table.values.reserve(execResult.size() * columnCount);
     for (auto& row : execResult) {
-        record_t record;
-        for (size_t i = 0; i < row.size(); ++i) {
-            auto colname = execResult.columnName(i);
-
-            // Use deduced type
-            if (columnTypes[i] != 0) {
-                switch (columnTypes[i])
-                {
-                case 1:
-                    row[i].isNull() ? record[colname] = std::nullopt : record[colname] = row[i].as<int64_t>();
-                    break; // Integer
-
-                case 3:
-                    row[i].isNull() ? record[colname] = std::nullopt : record[colname] = row[i].as<double>();
-                    break; // Double
-
-                case 4:
-                    row[i].isNull() ? record[colname] = std::nullopt : record[colname] = row[i].as<std::string>();
-                    break; // String
-                }
-                continue;
-            }
+        for (std::size_t column = 0; column < columnCount; ++column) {
+            auto field = row[column];
+            table.values.push_back(field.isNull() ? recordValue_t() : decodeValue(columnTypes[column], field.c_str(), field.length()));
+        }
+    }
+    return table;
+}
 
-            if (row[i].isNull()) {
-                record[colname] = {};
-                continue;
-            }
+static bool isNullValue(const recordValue_t& val)
+{
+    return !val.has_value() || std::holds_alternative<std::monostate>(val.value());
+}
 
-            // Deduce type
-            auto strVal = row[i].as<std::string>();
-            try {
-                std::size_t convEndPos {0};
-                auto convRes = std::stol(strVal, &convEndPos);
-                if (convEndPos != strVal.length()) {
-                    throw std::invalid_argument("len end not reached");
-                }
-                record[colname] = convRes;
-                columnTypes[i] = 1;
-
-            } catch (const std::invalid_argument& ex) {
-                try {
-                    std::size_t convEndPos {0};
-                    auto doubleV = std::stod(strVal, &convEndPos);
-                    if (convEndPos != strVal.length()) {
-                        throw std::invalid_argument("len end not reached");
-                    }
-                    record[colname] = doubleV;
-                    columnTypes[i] = 2;
+/**
+ * @brief toId  Id from integer value, NULL_ID for NULL or value of other type
+ */
+static DataObjects::id_t toId(const recordValue_t& val)
+{
+    if (!val.has_value() || !std::holds_alternative<int64_t>(val.value())) {
+        return DataObjects::NULL_ID;
+    }
+    return DataObjects::id_t(std::get<int64_t>(val.value()));
+}
+
+static recordValue_t toRecordValue(const DataObjects::id_t& id)
+{
+    return id.has_value() ? recordValue_t(int64_t(id.value())) : recordValue_t();
+}
 
-                } catch (const std::invalid_argument& ex) {
-                    record[colname] = strVal;
-                    columnTypes[i] = 3;
+static std::string doubleToString(double val)
+{
+    // Shortest text keeping exact value, std::to_string drops digits
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", val);
+    return buf;
+}
+
+/**
+ * @brief bindValue Bind value as typed parameter: integers in binary form, strings as is (no quoting or encoding)
+ * @note Doubles are bound as text, server converts them to type of column
+ */
+static void bindValue(drogon::orm::internal::SqlBinder& binder, const recordValue_t& val)
+{
+    if (isNullValue(val)) {
+        binder << nullptr;
+        return;
+    }
+    std::visit([&binder](auto& v) {
+        using valueType_t = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<valueType_t, std::string>) {
+            binder << v;
+        } else if constexpr (std::is_same_v<valueType_t, int64_t>) {
+            binder << v;
+        } else if constexpr (std::is_same_v<valueType_t, double>) {
+            binder << doubleToString(v);
+        }
+    }, val.value());
+}
+
+/**
+ * @brief getArrayType  SQL array type of column of records, deduced by first non-NULL value
+ */
+static std::string getArrayType(const std::vector<record_t>& records, const std::string& colName)
+{
+    for (auto& record : records) {
+        auto valIt = record.find(colName);
+        if (valIt == record.end() || isNullValue(valIt->second)) {
+            continue;
+        }
+        if (std::holds_alternative<int64_t>(valIt->second.value())) {
+            return "bigint[]";
+        }
+        if (std::holds_alternative<double>(valIt->second.value())) {
+            return "float8[]";
+        }
+        return "text[]";
+    }
+    return "text[]";
+}
+
+/**
+ * @brief toArrayLiteral    Column of records as text of SQL array ({1,NULL,"text"}), bound as one parameter
+ */
+static std::string toArrayLiteral(const std::vector<record_t>& records, const std::string& colName)
+{
+    std::string literal("{");
+    for (auto& record : records) {
+        auto valIt = record.find(colName);
+        if (valIt == record.end() || isNullValue(valIt->second)) {
+            literal += "NULL,";
+            continue;
+        }
+        std::visit([&literal](auto& v) {
+            using valueType_t = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<valueType_t, std::string>) {
+                literal += '"';
+                for (auto ch : v) {
+                    if (ch == '"' || ch == '\\') {
+                        literal += '\\';
+                    }
+                    literal += ch;
                 }
+                literal += '"';
+            } else if constexpr (std::is_same_v<valueType_t, int64_t>) {
+                literal += std::to_string(v);
+            } else if constexpr (std::is_same_v<valueType_t, double>) {
+                literal += doubleToString(v);
             }
-        }
-        res.push_back(record);
+        }, valIt->second.value());
+        literal += ",";
     }
-    return res;
+    if (literal.back() == ',') {
+        literal.back() = '}';
+    } else {
+        literal += "}";
+    }
+    return literal;
 }
 
 RecordManager::RecordManager(const std::string &connectionName) :
@@ -108,96 +249,160 @@ void RecordManager::setUser(const std::string &username, const std::string &pass
 
 std::vector<DataObjects::id_t> RecordManager::getAvailableRecords(const std::string_view& tableName, const std::string_view &recordIdColumn) const
 {
-    std::vector<DataObjects::id_t> res;
-    try {
-        auto execRes = m_pClient->execSqlSync(std::string("SELECT ") + recordIdColumn.data() + " FROM " + tableName.data());
-        auto rows = resultToRecords(execRes);
-        for (auto& r : rows) {
-            auto& idVal = r.at(recordIdColumn.data());
-            res.push_back(idVal.has_value() ? DataObjects::id_t(std::get<int64_t>(idVal.value())) : DataObjects::NULL_ID);
-        }
-    } catch (const drogon::orm::DrogonDbException& ex) {
-        COMPLOG_ERROR("[RecordManager] Record get exist exec error:", ex.base().what());
+    const auto statement = getStatement("SELECT-IDS " + std::string(tableName) + " " + std::string(recordIdColumn), [&]() {
+        return "SELECT " + std::string(recordIdColumn) + " FROM " + std::string(tableName);
+    });
+    const auto pColumnOids = getColumnTypes(tableName);
+    if (pColumnOids == nullptr) {
         return {};
     }
+
+    std::vector<DataObjects::id_t> res;
+    execStatement(true, statement, {}, [&res, &pColumnOids](const drogon::orm::Result& execRes) {
+        const auto table = resultToTable(execRes, *pColumnOids);
+        res.reserve(table.getRowCount());
+        for (std::size_t row = 0; row < table.getRowCount(); ++row) {
+            res.push_back(toId(table.getValue(row, 0)));
+        }
+    }, "Record get exist");
     return res;
 }
 
 DataObjects::id_t RecordManager::addRecord(bool isSync, const std::string_view &tableName, const std::map<std::string, recordValue_t> &valueMap, const std::string_view &idColumnName) const
 {
-    if (isSync) {
-        try {
-            auto execRes = m_pClient->execSqlSync(createInsertQuery(tableName, valueMap, idColumnName));
-            if (execRes.empty()) {
-                return DataObjects::NULL_ID;
-            }
-            auto recordInfo = resultToRecords(execRes);
-            auto& idVal = recordInfo[0].at(idColumnName.data());
-            return idVal.has_value() ? DataObjects::id_t(std::get<int64_t>(idVal.value())) : DataObjects::NULL_ID;
-        } catch (const drogon::orm::DrogonDbException& ex) {
-            COMPLOG_ERROR("[RecordManager] Record add exec error:", ex.base().what());
-            return DataObjects::NULL_ID;
-        }
-    } else {
-        m_pClient->execSqlAsync(createInsertQuery(tableName, valueMap, idColumnName), [](const drogon::orm::Result& res){
-            // TODO: Process?
-        }, [](const drogon::orm::DrogonDbException& ex){
-                                    COMPLOG_ERROR("[RecordManager] ASYNC Record add exec error:", ex.base().what());
-                                });
+    std::string key = "INSERT " + std::string(tableName) + " " + std::string(idColumnName);
+    std::vector<recordValue_t> params;
+    params.reserve(valueMap.size());
+    for (auto& [colName, colValue] : valueMap) {
+        key += " " + colName;
+        params.push_back(colValue);
+    }
+    const auto statement = getStatement(key, [&]() {
+        return createInsertQuery(tableName, valueMap, idColumnName);
+    });
+
+    if (!isSync) {
+        execStatement(false, statement, params, nullptr, "Record add");
+        return DataObjects::NULL_ID;
+    }
+    const auto pColumnOids = getColumnTypes(tableName);
+    if (pColumnOids == nullptr) {
         return DataObjects::NULL_ID;
     }
-    return DataObjects::NULL_ID;
+    DataObjects::id_t createdId = DataObjects::NULL_ID;
+    execStatement(true, statement, params, [&createdId, &pColumnOids](const drogon::orm::Result& res) {
+        const auto table = resultToTable(res, *pColumnOids);
+        if (table.getRowCount() > 0) {
+            createdId = toId(table.getValue(0, 0));
+        }
+    }, "Record add");
+    return createdId;
 }
 
-bool RecordManager::updateRecord(bool isSync, const std::string_view& tableName, const std::string& whereCondition, const std::map<std::string, recordValue_t>& valueMap)
+bool RecordManager::updateRecord(bool isSync, const std::string_view& tableName, const std::string_view& idColumnName, DataObjects::id_t recordId,
+                                 const std::map<std::string, recordValue_t>& valueMap)
 {
-    if (isSync) {
-        try {
-            auto res = m_pClient->execSqlSync(createUpdateQuery(tableName, whereCondition, valueMap));
-            return (res.affectedRows() == 1);
-        } catch (const drogon::orm::DrogonDbException& ex) {
-            COMPLOG_ERROR("[RecordManager] Record update exec error:", ex.base().what());
-            return false;
-        }
-    } else {
-        m_pClient->execSqlAsync(createUpdateQuery(tableName, whereCondition, valueMap), [](const drogon::orm::Result& res){
-            // TODO: Process?
-        }, [](const drogon::orm::DrogonDbException& ex){
-                                    COMPLOG_ERROR("[RecordManager] ASYNC Record update exec error:", ex.base().what());
-                                });
-        return true;
+    std::string key = "UPDATE " + std::string(tableName) + " " + std::string(idColumnName);
+    std::vector<recordValue_t> params;
+    params.reserve(valueMap.size() + 1);
+    for (auto& [colName, colValue] : valueMap) {
+        key += " " + colName;
+        params.push_back(colValue);
+    }
+    params.push_back(toRecordValue(recordId));
+    const auto statement = getStatement(key, [&]() {
+        return createUpdateQuery(tableName, idColumnName, valueMap);
+    });
+
+    if (!isSync) {
+        return execStatement(false, statement, params, nullptr, "Record update");
     }
-    return false;
+    bool isUpdated {false};
+    const bool isExecuted = execStatement(true, statement, params, [&isUpdated](const drogon::orm::Result& res) {
+        isUpdated = (res.affectedRows() == 1);
+    }, "Record update");
+    return isExecuted && isUpdated;
 }
 
-bool RecordManager::removeRecord(bool isSync, const std::string_view &tableName, const std::string &whereCondition)
+bool RecordManager::updateRecords(bool isSync, const std::string_view &tableName, const std::string_view &idColumnName,
+                                  const std::vector<record_t> &records, const std::set<std::string> &accumulatedColumns)
 {
-    std::string query = std::string("DELETE FROM ") + tableName.data() + " WHERE " + whereCondition;
-    try {
-        auto res = m_pClient->execSqlSync(query);
-        return (res.affectedRows() > 0);
-    } catch (const drogon::orm::DrogonDbException& ex) {
-        COMPLOG_ERROR("[RecordManager] Record remove exec error:", ex.base().what());
-        return {};
+    // Every column is bound as one array parameter, so statement does not depend on count of records
+    std::map<std::string, std::string> arrayTypes;
+    std::vector<recordValue_t> params;
+    std::string key = "UPDATE-BATCH " + std::string(tableName) + " " + std::string(idColumnName);
+    for (auto& [colName, colValue] : records.front()) {
+        auto& arrayType = arrayTypes[colName] = getArrayType(records, colName);
+        key += " " + colName + ":" + arrayType + (accumulatedColumns.count(colName) ? "+" : "");
+        params.push_back(toArrayLiteral(records, colName));
     }
-    return {};
+    const auto statement = getStatement(key, [&]() {
+        return createBatchUpdateQuery(tableName, idColumnName, arrayTypes, accumulatedColumns);
+    });
+
+    if (!isSync) {
+        return execStatement(false, statement, params, nullptr, "Records update");
+    }
+    bool isUpdated {false};
+    const bool isExecuted = execStatement(true, statement, params, [&isUpdated, &records](const drogon::orm::Result& res) {
+        isUpdated = (res.affectedRows() == records.size());
+    }, "Records update");
+    return isExecuted && isUpdated;
+}
+
+bool RecordManager::removeRecord(bool isSync, const std::string_view &tableName, const std::string_view &idColumnName, DataObjects::id_t recordId)
+{
+    const auto statement = getStatement("DELETE " + std::string(tableName) + " " + std::string(idColumnName), [&]() {
+        return "DELETE FROM " + std::string(tableName) + " WHERE " + std::string(idColumnName) + " = $1";
+    });
+
+    if (!isSync) {
+        return execStatement(false, statement, {toRecordValue(recordId)}, nullptr, "Record remove");
+    }
+    bool isRemoved {false};
+    const bool isExecuted = execStatement(true, statement, {toRecordValue(recordId)}, [&isRemoved](const drogon::orm::Result& res) {
+        isRemoved = (res.affectedRows() > 0);
+    }, "Record remove");
+    return isExecuted && isRemoved;
 }
 
 std::map<std::string, recordValue_t> RecordManager::getRecord(bool isSync, const std::string_view &tableName, const std::string_view &idColumnName, DataObjects::id_t recordId) const
 {
-    std::string query = std::string("SELECT * FROM ") + tableName.data() + " WHERE " + idColumnName.data() + " = " + (recordId.has_value() ? std::to_string(recordId.value()) : "NULL");
-    try {
-        auto res = m_pClient->execSqlSync(query);
-        auto records = resultToRecords(res);
+    const auto statement = getStatement("SELECT " + std::string(tableName) + " " + std::string(idColumnName), [&]() {
+        return "SELECT * FROM " + std::string(tableName) + " WHERE " + std::string(idColumnName) + " = $1";
+    });
 
-        if (!records.empty()) {
-            return records.front();
+    const auto pColumnOids = getColumnTypes(tableName);
+    if (pColumnOids == nullptr) {
+        return {};
+    }
+
+    // Record is returned, so it is always read in sync mode
+    std::map<std::string, recordValue_t> record;
+    execStatement(true, statement, {toRecordValue(recordId)}, [&record, &pColumnOids](const drogon::orm::Result& res) {
+        const auto table = resultToTable(res, *pColumnOids);
+        if (table.getRowCount() > 0) {
+            table.readRow(0, record);
         }
-    } catch (const drogon::orm::DrogonDbException& ex) {
-        COMPLOG_ERROR("[RecordManager] Record get exec error:", ex.base().what());
+    }, "Record get");
+    return record;
+}
+
+RecordTable RecordManager::readTable(const std::string_view &tableName) const
+{
+    const auto statement = getStatement("SELECT-ALL " + std::string(tableName), [&]() {
+        return "SELECT * FROM " + std::string(tableName);
+    });
+    const auto pColumnOids = getColumnTypes(tableName);
+    if (pColumnOids == nullptr) {
         return {};
     }
-    return {};
+
+    RecordTable table;
+    execStatement(true, statement, {}, [&table, &pColumnOids](const drogon::orm::Result& res) {
+        table = resultToTable(res, *pColumnOids);
+    }, "Records get");
+    return table;
 }
 
 std::string RecordManager::createConnectionString() const
@@ -211,56 +416,141 @@ std::string RecordManager::createConnectionString() const
     return connString;
 }
 
-std::string RecordManager::cellDataToString(const recordValue_t &val) const
+std::string RecordManager::getStatement(const std::string &key, const std::function<std::string ()> &createStatement) const
 {
-    if (!val.has_value() || std::holds_alternative<std::monostate>(val.value())) {
-        return "NULL";
+    std::lock_guard<std::mutex> lock(m_statementsMx);
+    auto statementIt = m_statements.find(key);
+    if (statementIt == m_statements.end()) {
+        statementIt = m_statements.emplace(key, createStatement()).first;
     }
-    return std::visit([](auto& v) -> std::string {
-        using valueType_t = std::decay_t<decltype(v)>;
-        if constexpr (std::is_same_v<valueType_t, std::string>) {
-            return std::string("'") + v + "'";
-        } else if constexpr (std::is_same_v<valueType_t, int64_t>) {
-                if (v == DataObjects::NULL_ID) {
-                    return "NULL";
+    return statementIt->second;
+}
+
+RecordManager::ColumnTypesPtr RecordManager::getColumnTypes(const std::string_view &tableName) const
+{
+    const std::string table(tableName);
+    {
+        std::lock_guard<std::mutex> lock(m_columnTypesMx);
+        auto typesIt = m_columnTypes.find(table);
+        if (typesIt != m_columnTypes.end()) {
+            return typesIt->second;
+        }
+    }
+
+    // Schema does not change while server runs, so types are read once per table.
+    // Failed read is not cached: values would be decoded as strings
+    auto pColumnOids = std::make_shared<std::map<std::string, uint32_t> >();
+    const bool isRead = execStatement(true, "SELECT attname::text, atttypid::bigint FROM pg_attribute WHERE attrelid = $1::regclass AND attnum > 0 AND NOT attisdropped",
+                                      {table}, [&pColumnOids](const drogon::orm::Result& res) {
+        for (auto& row : res) {
+            (*pColumnOids)[row[0].as<std::string>()] = static_cast<uint32_t>(row[1].as<int64_t>());
+        }
+    }, "Column types get");
+    if (!isRead || pColumnOids->empty()) {
+        COMPLOG_ERROR("Query to", table, "failed: column types are unknown");
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_columnTypesMx);
+    return m_columnTypes.emplace(table, std::move(pColumnOids)).first->second;
+}
+
+bool RecordManager::execStatement(bool isSync, const std::string &statement, const std::vector<recordValue_t> &params,
+                                  std::function<void (const drogon::orm::Result &)> onResult, const std::string_view &errorContext) const
+{
+    bool isSucceed {true};
+    try {
+        auto binder = *m_pClient << statement;
+        for (auto& param : params) {
+            bindValue(binder, param);
+        }
+        if (isSync) {
+            binder << drogon::orm::Mode::Blocking;
+            binder >> [&onResult](const drogon::orm::Result& res) {
+                if (onResult) {
+                    onResult(res);
                 }
-                return std::to_string(v);
-        } else if constexpr (std::is_same_v<valueType_t, double>) {
-                    return std::to_string(v);
+            };
+            binder >> [&isSucceed, &errorContext](const drogon::orm::DrogonDbException& ex) {
+                COMPLOG_ERROR("[RecordManager]", errorContext, "exec error:", ex.base().what());
+                isSucceed = false;
+            };
+        } else {
+            binder >> [onResult = std::move(onResult)](const drogon::orm::Result& res) {
+                if (onResult) {
+                    onResult(res);
                 }
-        return {};
-    }, val.value());
+            };
+            binder >> [context = std::string(errorContext)](const drogon::orm::DrogonDbException& ex) {
+                COMPLOG_ERROR("[RecordManager] ASYNC", context, "exec error:", ex.base().what());
+            };
+        }
+        binder.exec();
+    } catch (const drogon::orm::DrogonDbException& ex) {
+        COMPLOG_ERROR("[RecordManager]", errorContext, "exec error:", ex.base().what());
+        return false;
+    }
+    return isSucceed;
 }
 
 std::string RecordManager::createInsertQuery(const std::string_view &tableName, const std::map<std::string, recordValue_t> &valueMap, const std::string_view& idColumnName) const
 {
     std::string colsQuery;
     std::string valuesQuery;
+    std::size_t paramNo {0};
     for (auto& [colName, colValue] : valueMap) {
         colsQuery += colName + ",";
-        valuesQuery += cellDataToString(colValue) + ",";
+        valuesQuery += "$" + std::to_string(++paramNo) + ",";
     }
     colsQuery.pop_back();
     valuesQuery.pop_back();
 
-    return std::string("INSERT INTO ") + tableName.data() + " (" + colsQuery + ") VALUES (" + valuesQuery + ") RETURNING " + idColumnName.data();
+    return "INSERT INTO " + std::string(tableName) + " (" + colsQuery + ") VALUES (" + valuesQuery + ") RETURNING " + std::string(idColumnName);
 }
 
-std::string RecordManager::createUpdateQuery(const std::string_view &tableName, const std::string_view &whereCondition, const std::map<std::string, recordValue_t> &valueMap) const
+std::string RecordManager::createUpdateQuery(const std::string_view &tableName, const std::string_view &idColumnName, const std::map<std::string, recordValue_t> &valueMap) const
 {
     std::string query("UPDATE ");
-    query += tableName.data();
+    query += tableName;
     query += " SET ";
 
+    std::size_t paramNo {0};
     for (auto& [colName, colValue] : valueMap) {
-        query += colName + "=" + cellDataToString(colValue) + ",";
+        query += colName + "=$" + std::to_string(++paramNo) + ",";
     }
     query.pop_back();
-    query += (whereCondition.empty() ? "" : std::string(" WHERE ") + whereCondition.data());
+    query += " WHERE " + std::string(idColumnName) + " = $" + std::to_string(++paramNo);
 
     return query;
 }
 
+std::string RecordManager::createBatchUpdateQuery(const std::string_view &tableName, const std::string_view &idColumnName,
+                                                  const std::map<std::string, std::string> &arrayTypes, const std::set<std::string> &accumulatedColumns) const
+{
+    // UPDATE table AS t SET col = v.col, sum = t.sum + v.sum FROM unnest($1::bigint[], ...) AS v(id, col, sum) WHERE t.id = v.id
+    std::string query("UPDATE ");
+    query += tableName;
+    query += " AS t SET ";
 
+    std::string colsQuery;
+    std::string arraysQuery;
+    std::size_t paramNo {0};
+    for (auto& [colName, arrayType] : arrayTypes) {
+        colsQuery += colName + ",";
+        arraysQuery += "$" + std::to_string(++paramNo) + "::" + arrayType + ",";
+        if (colName == idColumnName) {
+            continue;
+        }
+        query += colName + "=" + (accumulatedColumns.count(colName) ? "t." + colName + "+" : std::string()) + "v." + colName + ",";
+    }
+    colsQuery.pop_back();
+    arraysQuery.pop_back();
+    query.pop_back();
+
+    const std::string idColumn(idColumnName);
+    query += " FROM unnest(" + arraysQuery + ") AS v(" + colsQuery + ") WHERE t." + idColumn + " = v." + idColumn;
+
+    return query;
+}
 
 } // namespace Database
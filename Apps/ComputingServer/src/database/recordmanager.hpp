@@ -1,14 +1,18 @@
 #pragma once
 
 #include <string>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <vector>
 
 #include "recordobjects.hpp"
 
 namespace drogon::orm {
 class DbClient;
+class Result;
 using DbClientPtr = std::shared_ptr<DbClient>;
 }
 
@@ -43,16 +47,32 @@ public:
     template <bool isSync = true, typename T>
     std::enable_if_t<std::is_base_of_v<RecordBase, std::decay_t<T> >, bool>
     updateRecord(const T& iValue) {
-        return updateRecord(isSync, iValue.getTable(),
-                            std::string(iValue.getIdColumn().data()) + " = " + (iValue.getId().has_value() ? std::to_string(iValue.getId().value()) : "NULL"),
-                            iValue.toRecord());
+        return updateRecord(isSync, iValue.getTable(), iValue.getIdColumn(), iValue.getId(), iValue.toRecord());
     }
 
+    /**
+     * @brief updateRecords         Update many records of one table by single query (one round trip per batch)
+     * @param accumulatedColumns    Values of these columns are added to stored ones, other columns are replaced
+     * @return                      In sync mode false if any record is not updated. Always true in non-sync mode
+     */
+    template <bool isSync = true, typename T>
+    std::enable_if_t<std::is_base_of_v<RecordBase, std::decay_t<T> >, bool>
+    updateRecords(const std::vector<T>& iValues, const std::set<std::string>& accumulatedColumns = {}) {
+        if (iValues.empty()) {
+            return true;
+        }
+        std::vector<record_t> records;
+        records.reserve(iValues.size());
+        for (auto& value : iValues) {
+            records.push_back(value.toRecord());
+        }
+        return updateRecords(isSync, iValues.front().getTable(), iValues.front().getIdColumn(), records, accumulatedColumns);
+    }
 
     template <typename T>
     bool removeRecord(DataObjects::id_t recId, bool isSync = true) {
         T infoRec; // TODO: set table name as static data?
-        return removeRecord(isSync, infoRec.getTable(), std::string(infoRec.getIdColumn()) + " = " + (recId.has_value() ? std::to_string(recId.value()) : "NULL"));
+        return removeRecord(isSync, infoRec.getTable(), infoRec.getIdColumn(), recId);
     }
 
     template <bool isSync = true, typename T>
@@ -63,13 +83,35 @@ public:
         return res;
     }
 
+    /**
+     * @brief getRecords    Read all records of table by single query
+     */
+    template <typename T>
+    std::enable_if_t<std::is_base_of_v<RecordBase, T>, std::vector<T> >
+    getRecords() const {
+        T tableRecord;
+        const auto table = readTable(tableRecord.getTable());
+
+        std::vector<T> res(table.getRowCount());
+        record_t record;
+        for (std::size_t row = 0; row < res.size(); ++row) {
+            table.readRow(row, record);
+            res[row].initFromRecord(record);
+        }
+        return res;
+    }
+
     std::vector<DataObjects::id_t> getAvailableRecords(const std::string_view &tableName, const std::string_view &recordIdColumn) const;
 
 private:
     DataObjects::id_t addRecord(bool isSync, const std::string_view& tableName, const std::map<std::string, recordValue_t>& valueMap, const std::string_view &idColumnName) const;
-    bool updateRecord(bool isSync, const std::string_view& tableName, const std::string& whereCondition, const std::map<std::string, recordValue_t>& valueMap);
-    bool removeRecord(bool isSync, const std::string_view& tableName, const std::string& whereCondition);
+    bool updateRecord(bool isSync, const std::string_view& tableName, const std::string_view& idColumnName, DataObjects::id_t recordId,
+                      const std::map<std::string, recordValue_t>& valueMap);
+    bool updateRecords(bool isSync, const std::string_view& tableName, const std::string_view& idColumnName,
+                       const std::vector<record_t>& records, const std::set<std::string>& accumulatedColumns);
+    bool removeRecord(bool isSync, const std::string_view& tableName, const std::string_view& idColumnName, DataObjects::id_t recordId);
     std::map<std::string, recordValue_t> getRecord(bool isSync, const std::string_view& tableName, const std::string_view& idColumnName, DataObjects::id_t recordId) const;
+    RecordTable readTable(const std::string_view& tableName) const;
 
     drogon::orm::DbClientPtr m_pClient;
 
@@ -81,11 +123,42 @@ private:
     std::string m_username;
     std::string m_password;
 
+    // Statement texts by operation, table and column set. Values are bound as parameters ($1..$n),
+    // so every connection of client prepares statement once and reuses it
+    mutable std::mutex                         m_statementsMx;
+    mutable std::map<std::string, std::string> m_statements;
+
+    // Type OIDs of columns by table, results are decoded by them
+    using ColumnTypesPtr = std::shared_ptr<const std::map<std::string, uint32_t> >;
+    mutable std::mutex                              m_columnTypesMx;
+    mutable std::map<std::string, ColumnTypesPtr>   m_columnTypes;
+
     std::string createConnectionString() const;
-    std::string cellDataToString(const recordValue_t& val) const;
+
+    /**
+     * @brief getStatement      Cached statement text of key, created on first use
+     */
+    std::string getStatement(const std::string& key, const std::function<std::string()>& createStatement) const;
+
+    /**
+     * @brief getColumnTypes    Type OIDs of table columns by name (pg_attribute), read from DB once per table
+     * @return                  nullptr if types were not read (error is logged), query must fail then
+     */
+    ColumnTypesPtr getColumnTypes(const std::string_view& tableName) const;
+
+    /**
+     * @brief execStatement     Execute statement with values bound as typed parameters (NULL for empty value)
+     * @param onResult          Result handler, called before return in sync mode
+     * @param errorContext      Operation name for error log
+     * @return                  false on error in sync mode. Always true in non-sync mode, errors are logged
+     */
+    bool execStatement(bool isSync, const std::string& statement, const std::vector<recordValue_t>& params,
+                       std::function<void(const drogon::orm::Result&)> onResult, const std::string_view& errorContext) const;
 
     std::string createInsertQuery(const std::string_view &tableName, const std::map<std::string, recordValue_t>& valueMap, const std::string_view &idColumnName) const;
-    std::string createUpdateQuery(const std::string_view &tableName, const std::string_view& whereCondition, const std::map<std::string, recordValue_t>& valueMap) const;
+    std::string createUpdateQuery(const std::string_view &tableName, const std::string_view& idColumnName, const std::map<std::string, recordValue_t>& valueMap) const;
+    std::string createBatchUpdateQuery(const std::string_view &tableName, const std::string_view &idColumnName,
+                                       const std::map<std::string, std::string>& arrayTypes, const std::set<std::string>& accumulatedColumns) const;
 };
 
 } // namespace Database
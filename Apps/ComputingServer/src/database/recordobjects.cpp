@@ -2,6 +2,34 @@
 
 namespace Database {
 
+std::size_t RecordTable::getRowCount() const
+{
+    return columns.empty() ? 0 : values.size() / columns.size();
+}
+
+std::size_t RecordTable::findColumn(const std::string_view &columnName) const
+{
+    for (std::size_t column = 0; column < columns.size(); ++column) {
+        if (columns[column] == columnName) {
+            return column;
+        }
+    }
+    return columns.size();
+}
+
+const recordValue_t &RecordTable::getValue(std::size_t row, std::size_t column) const
+{
+    return values.at(row * columns.size() + column);
+}
+
+void RecordTable::readRow(std::size_t row, record_t &ioRecord) const
+{
+    for (std::size_t column = 0; column < columns.size(); ++column) {
+        ioRecord[columns[column]] = getValue(row, column);
+    }
+}
+
+
 RecordBase::RecordBase(const std::string &tableName, const std::string &idColumn) :
     m_table {tableName},
     m_idColumnName {idColumn}
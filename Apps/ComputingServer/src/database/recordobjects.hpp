@@ -3,6 +3,7 @@
 #include <string>
 #include <variant>
 #include <map>
+#include <vector>
 
 #include <ROD/Types.h>
 
@@ -12,6 +13,29 @@ namespace Database {
 using recordValue_t = std::optional<std::variant<std::monostate, std::string, int64_t, double> >;
 using record_t = std::map<std::string, recordValue_t>;
 
+/**
+ * @brief The RecordTable struct Rows of query result, values of all rows are kept in one vector row by row
+ * @note Column index is resolved once by findColumn and used for every row
+ */
+struct RecordTable
+{
+    std::vector<std::string>    columns;
+    std::vector<recordValue_t>  values;
+
+    std::size_t getRowCount() const;
+
+    /**
+     * @brief findColumn    Index of column, columns.size() if there is no such column
+     */
+    std::size_t findColumn(const std::string_view& columnName) const;
+    const recordValue_t& getValue(std::size_t row, std::size_t column) const;
+
+    /**
+     * @brief readRow       Fill record with values of row. Nodes of record are reused when it is filled by rows of the same table
+     */
+    void readRow(std::size_t row, record_t& ioRecord) const;
+};
+
 /**
  * @brief The RecordBase class Basic class for converting from/to DB records
  */
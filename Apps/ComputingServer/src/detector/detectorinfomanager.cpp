@@ -11,19 +11,60 @@ void DetectorInfoManager::setRecordManager(const Database::RecordManagerPtr &pMa
     m_pRecordManager = pManager;
 }
 
+void DetectorInfoManager::setDeviceRegistry(const std::shared_ptr<Protocol::DeviceRegistry> &pRegistry)
+{
+    m_pDeviceRegistry = pRegistry;
+}
+
 void DetectorInfoManager::updateDetectorsInfo()
 {
+    // Every table is read by one query, records are joined by id of detector
+    auto indexById = [](auto&& records) {
+        std::unordered_map<DataObjects::id_t::type, std::decay_t<decltype(records.front())> > res;
+        res.reserve(records.size());
+        for (auto& record : records) {
+            if (record.getId().has_value()) {
+                res.emplace(record.getId().value(), std::move(record));
+            }
+        }
+        return res;
+    };
+    auto onlineRecords   = indexById(m_pRecordManager->getRecords<Database::DetectorOnlineRecord>());
+    auto softwareRecords = indexById(m_pRecordManager->getRecords<Database::DetectorSoftwareRecord>());
+    auto infoRecords     = indexById(m_pRecordManager->getRecords<Database::DetectorInfoRecord>());
+    auto getOrDefault = [](auto& records, DataObjects::id_t::type id) {
+        auto recordIt = records.find(id);
+        return recordIt != records.end() ? recordIt->second : typename std::decay_t<decltype(records)>::mapped_type();
+    };
+
     m_detectors.clear();
-    Database::DetectorSystemRecord tmpr;
-    auto idVect = m_pRecordManager->getAvailableRecords(tmpr.getTable(), tmpr.getIdColumn());
-    m_detectors.reserve(idVect.size());
-    for (auto id : idVect) {
-        if (!id.has_value()) {
+    auto systemRecords = m_pRecordManager->getRecords<Database::DetectorSystemRecord>();
+    m_detectors.reserve(systemRecords.size());
+    for (auto& systemRecord : systemRecords) {
+        if (!systemRecord.getId().has_value()) {
             continue;
         }
-        m_detectors.emplace(id.value(), getRecord(id));
+        const auto id = systemRecord.getId().value();
+        m_detectors.emplace(id, Database::fromRecords(std::make_tuple(
+            systemRecord,
+            getOrDefault(onlineRecords, id),
+            getOrDefault(softwareRecords, id),
+            getOrDefault(infoRecords, id)
+            )));
     }
     COMPLOG_INFO("Loaded info about", m_detectors.size(), "detectors");
+
+    // Registry could miss detectors, if it was loaded when database was not available. Empty result could be failed query
+    if (m_pDeviceRegistry && !m_detectors.empty()) {
+        std::vector<uint64_t> detectorIds;
+        detectorIds.reserve(m_detectors.size());
+        for (auto& [id, info] : m_detectors) {
+            if (id > 0) {
+                detectorIds.push_back(static_cast<uint64_t>(id));
+            }
+        }
+        m_pDeviceRegistry->reset(detectorIds);
+    }
 }
 
 std::vector<DataObjects::id_t> DetectorInfoManager::getDetectorList() const
@@ -59,6 +100,9 @@ DataObjects::id_t DetectorInfoManager::addDetector(const DataObjects::DetectorCo
     }
     detInfoCopy.system.id = createdId.value();
     m_detectors[createdId.value()] = detInfoCopy;
+    if (m_pDeviceRegistry) {
+        m_pDeviceRegistry->add(createdId.value());
+    }
 
     // Update inserted values (they are inserted by triggers)
     return (updateDetectorData(detInfoCopy) ? createdId : std::nullopt);
@@ -98,6 +142,9 @@ bool DetectorInfoManager::removeDetectorData(DataObjects::id_t id)
     auto remRes = m_pRecordManager->removeRecord<Database::DetectorSystemRecord>(id);
     if (remRes) {
         m_detectors.erase(id.value());
+        if (m_pDeviceRegistry) {
+            m_pDeviceRegistry->remove(id.value());
+        }
     }
     return remRes;
 }
@@ -3,6 +3,7 @@
 #include <Components/Database/SQlite.h>
 
 #include <ROD/DetectorConfiguration.h>
+#include <ROD/Protocol.h>
 
 #include "database/recordmanager.hpp"
 
@@ -11,6 +12,11 @@ class DetectorInfoManager
 public:
     void setRecordManager(const Database::RecordManagerPtr& pManager);
 
+    /**
+     * @brief setDeviceRegistry Registry of devices allowed to connect, updated on detector adding and removing
+     */
+    void setDeviceRegistry(const std::shared_ptr<Protocol::DeviceRegistry>& pRegistry);
+
     void updateDetectorsInfo();
 
     std::vector<DataObjects::id_t> getDetectorList() const;
@@ -22,6 +28,7 @@ public:
 
 private:
     Database::RecordManagerPtr m_pRecordManager;
+    std::shared_ptr<Protocol::DeviceRegistry> m_pDeviceRegistry;
     std::unordered_map<DataObjects::id_t::type, DataObjects::DetectorConfiguration> m_detectors;
 
     DataObjects::DetectorConfiguration getRecord(DataObjects::id_t id) const;
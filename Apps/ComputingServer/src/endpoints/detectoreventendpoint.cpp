@@ -4,10 +4,11 @@
 
 #include <ROD/Protocol.h>
 
-#include <regex>
+#include <algorithm>
 
 DetectorEventEndpoint::DetectorEventEndpoint() :
-    AbstractEndpoint()
+    AbstractEndpoint(),
+    m_presenceTimer(m_ioService)
 {
     m_deviceEventServer.init_asio(&m_ioService);
 
@@ -22,17 +23,23 @@ DetectorEventEndpoint::DetectorEventEndpoint() :
 
     // Message processing
     m_deviceEventServer.set_message_handler([this](ConnectionHdl hdl, MessagePtr msg) {
-        if (msg->get_opcode() != websocketpp::frame::opcode::text) {
-            COMPLOG_WARNING("[WS] Received binary data (skipped)");
+        // Frame opcode defines encoding, so device may send both. Frame is single event or batch
+        const bool isBinary = (msg->get_opcode() == websocketpp::frame::opcode::binary);
+        std::vector<Protocol::Event> events;
+        if (!Protocol::readEvents(msg->get_payload(), isBinary ? Protocol::EventEncoding::Binary : Protocol::EventEncoding::Json, events)) {
+            COMPLOG_ERROR("[WS] Invalid event, size:", msg->get_payload().size(), "binary:", isBinary);
             return;
         }
-        Protocol::Event ev;
-        if (!ev.readRaw(msg->get_payload())) {
-            COMPLOG_ERROR(Protocol::toString(ev.getType()), msg->get_payload());
-            return;
+
+        // Device is known by connection, not trusted from event. Handler runs in strand of connection
+        auto con = m_deviceEventServer.get_con_from_hdl(hdl);
+        heartbeat(*con);
+        const auto& deviceId = con->deviceId;
+        for (auto& ev : events) {
+            COMPLOG_DEBUG(Protocol::toString(ev.getType()), "from device", deviceId);
+            ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, deviceId);
+            m_pEventProcessor->addEvent(std::move(ev));
         }
-        COMPLOG_DEBUG(Protocol::toString(ev.getType()), msg->get_payload());
-        m_pEventProcessor->addEvent(std::move(ev));
     });
 }
 
@@ -41,6 +48,23 @@ DetectorEventEndpoint::~DetectorEventEndpoint()
     DetectorEventEndpoint::stop();
 }
 
+void DetectorEventEndpoint::setIoThreadCount(std::size_t threadCount)
+{
+    m_ioThreadCount = threadCount;
+}
+
+void DetectorEventEndpoint::setDeviceRegistry(const std::shared_ptr<Protocol::DeviceRegistry> &pRegistry)
+{
+    m_pDeviceRegistry = pRegistry;
+}
+
+void DetectorEventEndpoint::setPresence(const Protocol::PresenceConfig &config, std::chrono::seconds flushInterval, OnlineTimeCallback callback)
+{
+    m_presenceConfig = config;
+    m_onlineFlushInterval = flushInterval;
+    m_onlineTimeCallback = std::move(callback);
+}
+
 void DetectorEventEndpoint::start(uint16_t port)
 {
     websocketpp::lib::asio::ip::tcp::endpoint endpoint(
@@ -61,14 +85,29 @@ void DetectorEventEndpoint::start(uint16_t port)
         return;
     }
 
-    if (!m_ioThread) {
-        m_ioThread = std::make_unique<std::thread>([this]() {
-            m_deviceEventServer.run();
-        });
+    {
+        std::lock_guard<std::mutex> lock(m_presenceMx);
+        const auto now = std::chrono::steady_clock::now();
+        m_pPresenceTracker = std::make_unique<Protocol::PresenceTracker>(m_presenceConfig, now);
+        m_nextPing = now + m_presenceConfig.timeout / 3;
+        m_nextOnlineFlush = now + m_onlineFlushInterval;
+    }
+    schedulePresenceTick();
+
+    if (m_ioThreads.empty()) {
+        auto threadCount = m_ioThreadCount;
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (std::size_t i = 0; i < threadCount; ++i) {
+            m_ioThreads.emplace_back([this]() {
+                m_deviceEventServer.run();
+            });
+        }
     }
     m_isListening = true;
 
-    COMPLOG_OK("[WS] Started event server on port", std::to_string(port));
+    COMPLOG_OK("[WS] Started event server on port", std::to_string(port), "io threads:", m_ioThreads.size());
 
 }
 
@@ -89,69 +128,150 @@ void DetectorEventEndpoint::stop()
         COMPLOG_ERROR("[WS] Error stopping server:", ec.message());
     }
 
-    m_connectionMx.lock();
-    for (auto& hdl : m_connections) {
+    // Close handlers lock shards too, so connections are closed out of lock
+    std::vector<ConnectionHdl> connections;
+    for (auto& shard : m_connectionShards) {
+        std::lock_guard<std::mutex> lock(shard.mx);
+        for (auto& [deviceId, hdl] : shard.connections) {
+            connections.push_back(hdl);
+        }
+        shard.connections.clear();
+    }
+    for (auto& hdl : connections) {
         try {
-            m_deviceEventServer.close(hdl.first, websocketpp::close::status::going_away, "Server shutdown");
+            m_deviceEventServer.close(hdl, websocketpp::close::status::going_away, "Server shutdown");
         } catch (const std::exception& ex) {
             COMPLOG_WARNING("Close exception:", ex.what());
         } catch (...) {
             COMPLOG_WARNING("Unknown close exception");
         }
     }
-    m_connections.clear();
-    m_connectionMx.unlock();
 
-    if (m_ioThread && m_ioThread->joinable()) {
-        m_ioService.stop();
-        m_ioThread->join();
-        m_ioThread.reset();
+    // Sessions of connected devices end now, close handlers may not run after io service stop
+    {
+        websocketpp::lib::asio::error_code timerEc;
+        m_presenceTimer.cancel(timerEc);
+        std::vector<Protocol::OnlineTime> onlineTimes;
+        {
+            std::lock_guard<std::mutex> lock(m_presenceMx);
+            const auto now = std::chrono::steady_clock::now();
+            for (auto& hdl : connections) {
+                auto con = m_deviceEventServer.get_con_from_hdl(hdl, ec);
+                if (!ec) {
+                    m_pPresenceTracker->disconnect(con->numericId, now);
+                }
+            }
+            onlineTimes = m_pPresenceTracker->takeOnlineTimes(now);
+        }
+        if (m_onlineTimeCallback && !onlineTimes.empty()) {
+            m_onlineTimeCallback(std::move(onlineTimes));
+        }
     }
 
+    m_ioService.stop();
+    for (auto& ioThread : m_ioThreads) {
+        if (ioThread.joinable()) {
+            ioThread.join();
+        }
+    }
+    m_ioThreads.clear();
+
     m_isListening.store(false, std::memory_order_release);
 }
 
+bool DetectorEventEndpoint::sendEvent(const std::string &deviceId, const Protocol::Event &ev)
+{
+    ConnectionHdl targetHdl;
+    {
+        auto& shard = getConnectionShard(deviceId);
+        std::lock_guard<std::mutex> lock(shard.mx);
+        auto connectionIt = shard.connections.find(deviceId);
+        if (connectionIt != shard.connections.end()) {
+            targetHdl = connectionIt->second;
+        }
+    }
+    websocketpp::lib::error_code ec;
+    auto con = m_deviceEventServer.get_con_from_hdl(targetHdl, ec);
+    if (ec) {
+        COMPLOG_WARNING("[WS] Event to not connected device skipped:", deviceId);
+        return false;
+    }
+
+    const auto opcode = (con->encoding == Protocol::EventEncoding::Binary) ? websocketpp::frame::opcode::binary : websocketpp::frame::opcode::text;
+    ec = con->send(ev.encode(con->encoding), opcode);
+    if (ec) {
+        COMPLOG_ERROR("[WS] Failed to send event to device", deviceId, ":", ec.message());
+        return false;
+    }
+    return true;
+}
+
 void DetectorEventEndpoint::initConnectionCallbacks()
 {
     m_deviceEventServer.set_validate_handler([this](ConnectionHdl hdl) -> bool {
         auto con = m_deviceEventServer.get_con_from_hdl(hdl);
         auto remote = con->get_remote_endpoint();
 
-        auto parameters = con->get_resource();
-        std::regex devnameRegexp("\\/\\?dev=([1-9][0-9]{0,})");
-        std::smatch devnameMatch;
-        if (!std::regex_match(parameters, devnameMatch, devnameRegexp)) {
+        // All devices reconnect at once after restart, so no regex and no database here
+        Protocol::EventChannelTarget target;
+        if (!Protocol::parseEventChannelTarget(con->get_resource(), target)) {
             COMPLOG_WARNING("[INVALID PROTOCOL] Rejected connection from:", remote);
             return false;
         }
-
-        auto deviceId = devnameMatch[1].str();
-        if (!isDevValid(deviceId)) {
-            COMPLOG_WARNING("[INVALID DEVNAME] Rejected connection from:", remote);
+        if (!isDevValid(target.deviceId)) {
+            COMPLOG_WARNING("[INVALID DEVNAME] Rejected connection from:", remote, "device:", target.deviceId);
             return false;
         }
-        m_connectionMx.lock();
-        m_connections.emplace(hdl, deviceId);
-        m_connectionMx.unlock();
+        con->deviceId = std::to_string(target.deviceId);
+        con->numericId = target.deviceId;
+        con->encoding = target.encoding;
+        return true;
+    });
+
+    // Device is registered when handshake is done, failed connection is not seen by sendEvent
+    m_deviceEventServer.set_open_handler([this](ConnectionHdl hdl) {
+        auto con = m_deviceEventServer.get_con_from_hdl(hdl);
+        {
+            auto& shard = getConnectionShard(con->deviceId);
+            std::lock_guard<std::mutex> lock(shard.mx);
+            auto& storedHdl = shard.connections[con->deviceId];
+            if (!storedHdl.expired()) {
+                COMPLOG_WARNING("[WS] Device reconnected, previous connection is not used:", con->deviceId);
+            }
+            storedHdl = hdl;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_presenceMx);
+            m_pPresenceTracker->connect(con->numericId, std::chrono::steady_clock::now());
+        }
 
-        COMPLOG_OK("[WS] Client connected:", remote);
+        COMPLOG_OK("[WS] Client connected:", con->get_remote_endpoint(), "encoding:", Protocol::toString(con->encoding));
 
         Protocol::Event ev;
         ev.setType(Protocol::EventType::DetectorConnected);
-        ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, m_connections[hdl]);
+        ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, con->deviceId);
         m_pEventProcessor->addEvent(std::move(ev));
-        return true;
     });
 
     m_deviceEventServer.set_close_handler([this](ConnectionHdl hdl) {
-        m_connectionMx.lock();
-        auto it = m_connections.find(hdl);
-        if (it != m_connections.end()) {
-            m_connections.erase(it);
+        auto con = m_deviceEventServer.get_con_from_hdl(hdl);
+        const auto deviceId = con->deviceId;
+        bool isRegisteredConnection {false};
+        {
+            // Newer connection of the same device is kept
+            auto& shard = getConnectionShard(deviceId);
+            std::lock_guard<std::mutex> lock(shard.mx);
+            auto connectionIt = shard.connections.find(deviceId);
+            if (connectionIt != shard.connections.end() &&
+                !connectionIt->second.owner_before(hdl) && !hdl.owner_before(connectionIt->second)) {
+                shard.connections.erase(connectionIt);
+                isRegisteredConnection = true;
+
+                std::lock_guard<std::mutex> presenceLock(m_presenceMx);
+                m_pPresenceTracker->disconnect(con->numericId, std::chrono::steady_clock::now());
+            }
         }
-        m_connectionMx.unlock();
 
-        auto con = m_deviceEventServer.get_con_from_hdl(hdl);
         auto code = con->get_remote_close_code();
         auto reasonStr = con->get_remote_close_reason();
 
@@ -173,13 +293,22 @@ void DetectorEventEndpoint::initConnectionCallbacks()
             COMPLOG_WARNING("[WS] Client disconnected:", reasonStr, "code:", code);
         };
 
+        // Replaced connection closes after newer one of device is connected, device is still online
+        if (!isRegisteredConnection) {
+            return;
+        }
         Protocol::Event ev;
         ev.setType(Protocol::EventType::DetectorDisconnected);
-        ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, m_connections[hdl]);
+        ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, deviceId);
         ev.setPayload(reasonStr);
         m_pEventProcessor->addEvent(std::move(ev));
     });
 
+    // Devices answer pings of presence check. No pong timeout is set, so there is no timer per connection
+    m_deviceEventServer.set_pong_handler([this](ConnectionHdl hdl, std::string) {
+        heartbeat(*m_deviceEventServer.get_con_from_hdl(hdl));
+    });
+
     m_deviceEventServer.set_fail_handler([this](ConnectionHdl hdl) {
         auto con = m_deviceEventServer.get_con_from_hdl(hdl);
         auto ec = con->get_ec();
@@ -187,20 +316,102 @@ void DetectorEventEndpoint::initConnectionCallbacks()
     });
 }
 
-bool DetectorEventEndpoint::isDevValid(const std::string &devname) const
+void DetectorEventEndpoint::schedulePresenceTick()
 {
-    if (devname.empty() && (devname != "MANAGER")) {
-        return false;
+    m_presenceTimer.expires_after(m_presenceConfig.tick);
+    m_presenceTimer.async_wait([this](const websocketpp::lib::asio::error_code& ec) {
+        if (!ec) {
+            onPresenceTick();
+        }
+    });
+}
+
+void DetectorEventEndpoint::onPresenceTick()
+{
+    std::vector<ConnectionHdl> connections;
+    for (auto& shard : m_connectionShards) {
+        std::lock_guard<std::mutex> lock(shard.mx);
+        for (auto& [deviceId, hdl] : shard.connections) {
+            connections.push_back(hdl);
+        }
     }
 
-    if (devname == "MANAGER") {
-        std::lock_guard<std::mutex> lock(m_connectionMx);
-        if (m_isManagerAuthorized) {
-            return false;
+    // Heartbeats since previous tick
+    std::vector<std::pair<uint64_t, std::chrono::steady_clock::time_point>> heartbeats;
+    for (auto& hdl : connections) {
+        websocketpp::lib::error_code ec;
+        auto con = m_deviceEventServer.get_con_from_hdl(hdl, ec);
+        if (ec) {
+            continue;
+        }
+        const auto lastSeenNs = con->lastSeenNs.exchange(0, std::memory_order_relaxed);
+        if (lastSeenNs != 0) {
+            heartbeats.emplace_back(con->numericId, std::chrono::steady_clock::time_point(std::chrono::nanoseconds(lastSeenNs)));
         }
-    } else {
-        // TODO: Check devices id DB
-        COMPLOG_WARNING("DEVICE ID CHECK IGNORED");
     }
-    return true;
+
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<uint64_t> timedOut;
+    std::vector<Protocol::OnlineTime> onlineTimes;
+    bool isPingTime {false};
+    {
+        std::lock_guard<std::mutex> lock(m_presenceMx);
+        for (auto& [numericId, lastSeen] : heartbeats) {
+            m_pPresenceTracker->heartbeat(numericId, lastSeen);
+        }
+        timedOut = m_pPresenceTracker->advance(now);
+        if (now >= m_nextOnlineFlush) {
+            onlineTimes = m_pPresenceTracker->takeOnlineTimes(now);
+            m_nextOnlineFlush = now + m_onlineFlushInterval;
+        }
+        if (now >= m_nextPing) {
+            isPingTime = true;
+            m_nextPing = now + m_presenceConfig.timeout / 3; // Three pings may be lost before timeout
+        }
+    }
+
+    for (auto numericId : timedOut) {
+        const auto deviceId = std::to_string(numericId);
+        ConnectionHdl hdl;
+        {
+            auto& shard = getConnectionShard(deviceId);
+            std::lock_guard<std::mutex> lock(shard.mx);
+            auto connectionIt = shard.connections.find(deviceId);
+            if (connectionIt == shard.connections.end()) {
+                continue;
+            }
+            hdl = connectionIt->second;
+        }
+        COMPLOG_WARNING("[WS] Device heartbeat timeout:", deviceId);
+        websocketpp::lib::error_code ec;
+        m_deviceEventServer.close(hdl, websocketpp::close::status::policy_violation, "Heartbeat timeout", ec);
+    }
+
+    if (isPingTime) {
+        for (auto& hdl : connections) {
+            websocketpp::lib::error_code ec;
+            m_deviceEventServer.ping(hdl, std::string(), ec); // Closed connection is skipped
+        }
+    }
+
+    if (m_onlineTimeCallback && !onlineTimes.empty()) {
+        m_onlineTimeCallback(std::move(onlineTimes));
+    }
+    schedulePresenceTick();
+}
+
+void DetectorEventEndpoint::heartbeat(ConnectionInfo &connection)
+{
+    const auto nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    connection.lastSeenNs.store(nowNs, std::memory_order_relaxed);
+}
+
+DetectorEventEndpoint::ConnectionShard &DetectorEventEndpoint::getConnectionShard(const std::string &deviceId)
+{
+    return m_connectionShards[std::hash<std::string>{}(deviceId) % CONNECTION_SHARD_COUNT];
+}
+
+bool DetectorEventEndpoint::isDevValid(uint64_t deviceId) const
+{
+    return !m_pDeviceRegistry || m_pDeviceRegistry->contains(deviceId);
 }
@@ -6,11 +6,20 @@
 #include <websocketpp/server.hpp>
 #include <websocketpp/config/asio_no_tls.hpp>
 #include <nlohmann/json.hpp>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <thread>
 #include <map>
+#include <mutex>
+#include <vector>
 
 /**
  * @brief The DetectorEventEndpoint class Detector event management instance
+ * @note io_service is run by pool of threads. Every connection has own strand (websocketpp asio transport
+ *       with multithreading config), so events of one device are read in order, while devices are served in parallel.
+ *       Presence of devices is checked by one tracker timer: server pings all devices, any frame or pong is a heartbeat.
+ *       Heartbeat is stored in connection without lock, tracker timer passes it to presence tracker
  */
 class DetectorEventEndpoint : public AbstractEndpoint
 {
@@ -18,27 +27,96 @@ public:
     DetectorEventEndpoint();
     ~DetectorEventEndpoint();
 
+    /**
+     * @brief setIoThreadCount  Threads serving connections, applied on start. 0 is count of CPU cores
+     */
+    void setIoThreadCount(std::size_t threadCount);
+
+    /**
+     * @brief setDeviceRegistry Only registered devices may connect. Any device is accepted, if it is not set
+     */
+    void setDeviceRegistry(const std::shared_ptr<Protocol::DeviceRegistry>& pRegistry);
+
+    using OnlineTimeCallback = std::function<void(std::vector<Protocol::OnlineTime>&&)>;
+    /**
+     * @brief setPresence   Presence check settings, applied on start. Devices silent for timeout are disconnected
+     * @param flushInterval Period of callback with online time of devices, it is called from io thread and on stop
+     */
+    void setPresence(const Protocol::PresenceConfig& config, std::chrono::seconds flushInterval, OnlineTimeCallback callback);
+
     // AbstractEndpoint interface
     void start(uint16_t port) override;
     bool isWorking() const override;
     void stop() override;
 
+    /**
+     * @brief sendEvent Send event to connected device
+     * @param deviceId  Id of device, as it was connected
+     * @return          false if device is not connected or sending failed
+     * @note Thread-safe. Event is encoded as device requested on connection ("/?dev=N&enc=bin|json", JSON by default)
+     */
+    bool sendEvent(const std::string& deviceId, const Protocol::Event& ev);
+
 private:
-    using Server = websocketpp::server<websocketpp::config::asio>;
+    /**
+     * @brief The ConnectionInfo struct Connected device, stored in its connection object
+     */
+    struct ConnectionInfo
+    {
+        std::string             deviceId;
+        uint64_t                numericId {};   // Key of presence tracker
+        Protocol::EventEncoding encoding {Protocol::EventEncoding::Json};
+        std::atomic<int64_t>    lastSeenNs {};  // Steady clock time of last heartbeat, 0 if it is passed to tracker
+    };
+
+    /**
+     * @brief The ServerConfig struct Default asio config with device info in every connection (no lookup on message)
+     */
+    struct ServerConfig : public websocketpp::config::asio
+    {
+        typedef ServerConfig type;
+        typedef websocketpp::config::asio base;
+        typedef ConnectionInfo connection_base;
+    };
+
+    using Server = websocketpp::server<ServerConfig>;
     using ConnectionHdl = websocketpp::connection_hdl;
-    using MessagePtr = websocketpp::config::asio::message_type::ptr;
+    using MessagePtr = ServerConfig::message_type::ptr;
+
+    /**
+     * @brief The ConnectionShard struct Part of connected devices, device id hash selects shard
+     */
+    struct ConnectionShard
+    {
+        std::map<std::string, ConnectionHdl>    connections; // By device id
+        std::mutex                              mx;
+    };
+    static constexpr std::size_t CONNECTION_SHARD_COUNT {16};
 
     websocketpp::lib::asio::io_service m_ioService;
-    std::unique_ptr<std::thread> m_ioThread;
+    std::vector<std::thread> m_ioThreads;
+    std::size_t m_ioThreadCount {0};
 
     Server m_deviceEventServer;
-    std::map<ConnectionHdl, std::string, std::owner_less<ConnectionHdl>> m_connections;
-    mutable std::mutex m_connectionMx;
+    std::array<ConnectionShard, CONNECTION_SHARD_COUNT> m_connectionShards;
 
     std::atomic<bool> m_isListening {false};
 
+    Protocol::PresenceConfig m_presenceConfig;
+    std::chrono::seconds m_onlineFlushInterval {10};
+    OnlineTimeCallback m_onlineTimeCallback;
+    std::unique_ptr<Protocol::PresenceTracker> m_pPresenceTracker;
+    std::mutex m_presenceMx;
+    websocketpp::lib::asio::steady_timer m_presenceTimer;
+    std::chrono::steady_clock::time_point m_nextPing;
+    std::chrono::steady_clock::time_point m_nextOnlineFlush;
+
     void initConnectionCallbacks();
+    void schedulePresenceTick();
+    void onPresenceTick();
+    void heartbeat(ConnectionInfo& connection);
+    ConnectionShard& getConnectionShard(const std::string& deviceId);
 
-    mutable bool m_isManagerAuthorized {false};
-    bool isDevValid(const std::string& devname) const;
+    std::shared_ptr<Protocol::DeviceRegistry> m_pDeviceRegistry;
+    bool isDevValid(uint64_t deviceId) const;
 };
@@ -2,42 +2,35 @@
 
 #include <Components/Logger/Logger.h>
 
-#include <thread>
+#include <ROD/ImageProcessing/Utility.h>
+
+#include <algorithm>
 
 DetectorStreamEndpoint::DetectorStreamEndpoint() :
     AbstractEndpoint()
 {
-    m_streamingServer.setRequestProcessor([this](std::vector<uint8_t>&& udpRecData){
+    m_frameAssembler.setFrameCallback([this](Protocol::SendableImage&& img) {
+        const bool isTileFrame = ImageProcessing::TileDecoder::isTileFrame(img.getImage());
+        m_mailbox.push(std::move(img), isTileFrame);
+    });
+
+    m_streamingServer.setBatchProcessor([this](const Protocol::ImagePacketView* pViews, std::size_t viewCount){
         if (!m_receivedCallback) {
-            COMPLOG_WARNING("Image packet ignored (no processor set)");
+            COMPLOG_WARNING("Image packets ignored (no processor set), count:", viewCount);
             return;
         }
+        m_frameAssembler.addPackets(pViews, viewCount);
 
-        std::thread([this, receivedData = std::move(udpRecData)](){
-            Protocol::ImagePacket pkt;
-            if (!pkt.initFromPacketPart(receivedData)) {
-                return;
-            }
-            auto senderId = pkt.getSenderId();
-
-            m_imageMx.lock();
-            auto& imgData = m_imageParts[senderId];
-            m_imageMx.unlock();
-
-            std::lock_guard<std::mutex> lock(imgData.addMx);
-            if (imgData.id != pkt.getId()) {
-                imgData.parts.clear();
-            }
-            imgData.id = pkt.getId();
-            imgData.parts.emplace(std::move(pkt));
-            Protocol::SendableImage img;
-            if (!img.canInitFrom(imgData.parts)) {
-                return;
-            }
-            img.initFromPackets(std::move(imgData.parts));
-            imgData.id = 0;
-            m_receivedCallback(std::move(img));
-        }).detach();
+        std::lock_guard<std::mutex> lock(m_assemblerStatsMx);
+        m_assemblerStats = m_frameAssembler.getStats();
+    });
+
+    m_sharedServer.setImageCallback([this](Protocol::SendableImage&& img) {
+        if (!m_receivedCallback) {
+            return;
+        }
+        const bool isTileFrame = ImageProcessing::TileDecoder::isTileFrame(img.getImage());
+        m_mailbox.push(std::move(img), isTileFrame);
     });
 }
 
@@ -48,7 +41,29 @@ DetectorStreamEndpoint::~DetectorStreamEndpoint()
 
 void DetectorStreamEndpoint::start(uint16_t port)
 {
-    m_streamingServer.start(port);
+    m_mailbox.setPolicy(m_deliveryPolicy, m_deliveryCapacity);
+    m_mailbox.open();
+    m_isWorkersRunning.store(true, std::memory_order_release);
+    for (std::size_t i = 0; i < m_workerCount; ++i) {
+        m_workers.emplace_back([this]() {
+            workerLoop();
+        });
+    }
+
+    if (!m_streamingServer.start(port)) {
+        COMPLOG_ERROR("[UDP] Can't start streaming server:", m_streamingServer.getLastErrorText());
+        stop();
+        return;
+    }
+    COMPLOG_OK("[UDP] Started streaming server on port", std::to_string(port));
+
+    if (!m_sharedSocketPath.empty()) {
+        if (!m_sharedServer.start(m_sharedSocketPath)) {
+            COMPLOG_ERROR("[SHM] Can't start shared memory server:", m_sharedServer.getLastErrorText());
+            return; // UDP streaming still works
+        }
+        COMPLOG_OK("[SHM] Started shared memory server on", m_sharedSocketPath);
+    }
 }
 
 bool DetectorStreamEndpoint::isWorking() const
@@ -58,10 +73,176 @@ bool DetectorStreamEndpoint::isWorking() const
 
 void DetectorStreamEndpoint::stop()
 {
+    if (!m_isWorkersRunning.load(std::memory_order_acquire)) {
+        return;
+    }
     m_streamingServer.stop();
+    m_sharedServer.stop();
+
+    // Receive threads stopped, workers could finish
+    m_isWorkersRunning.store(false, std::memory_order_release);
+    m_mailbox.close();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+
+    auto stats = m_streamingServer.getStats();
+    auto& assemblerStats = m_frameAssembler.getStats();
+    COMPLOG_INFO("[UDP] Streaming stopped. Datagrams:", stats.datagrams,
+                 "per call:", stats.getDatagramsPerCall(),
+                 "invalid:", stats.invalidDatagrams,
+                 "kernel drops:", stats.kernelDrops);
+    COMPLOG_INFO("[UDP] Images completed:", assemblerStats.completedFrames,
+                 "incomplete:", assemblerStats.droppedFrames,
+                 "corrupted:", assemblerStats.corruptedFrames,
+                 "rejected packets:", assemblerStats.rejectedPackets,
+                 "FEC recovered fragments:", assemblerStats.recoveredFragments,
+                 "tile frames without reference:", m_skippedTileFrames.load());
+    COMPLOG_INFO("[UDP] Retransmission requests:", assemblerStats.nackRequests,
+                 "frames requested:", assemblerStats.nackedFrames,
+                 "recovered:", assemblerStats.nackRecoveredFrames,
+                 "ratio:", assemblerStats.getNackRecoveryRatio());
+    auto deliveryStats = m_mailbox.getStats();
+    COMPLOG_INFO("[UDP] Images delivered to workers:", deliveryStats.delivered,
+                 "superseded by newer:", deliveryStats.superseded,
+                 "dropped:", deliveryStats.dropped,
+                 "receiving blocked:", deliveryStats.blockedPushes,
+                 "idle streams evicted:", deliveryStats.evictedStreams);
+    if (!m_sharedSocketPath.empty()) {
+        auto sharedStats = m_sharedServer.getStats();
+        COMPLOG_INFO("[SHM] Shared memory streaming stopped. Connections:", sharedStats.connections,
+                     "rejected:", sharedStats.rejectedConnections,
+                     "images:", sharedStats.frames,
+                     "bytes:", sharedStats.bytes,
+                     "of unknown senders:", sharedStats.rejectedFrames);
+    }
+}
+
+Protocol::ReceiveStats DetectorStreamEndpoint::getReceiveStats() const
+{
+    return m_streamingServer.getStats();
+}
+
+Protocol::AssemblerStats DetectorStreamEndpoint::getAssemblerStats() const
+{
+    std::lock_guard<std::mutex> lock(m_assemblerStatsMx);
+    return m_assemblerStats;
 }
 
 void DetectorStreamEndpoint::setImageReceivedCallback(std::function<void (Protocol::SendableImage &&)> &&imgCallback)
 {
     m_receivedCallback = std::move(imgCallback);
 }
+
+void DetectorStreamEndpoint::setWorkerCount(std::size_t workerCount)
+{
+    m_workerCount = std::max<std::size_t>(workerCount, 1);
+}
+
+void DetectorStreamEndpoint::setDeliveryPolicy(Protocol::MailboxPolicy policy, std::size_t streamCapacity)
+{
+    m_deliveryPolicy = policy;
+    m_deliveryCapacity = std::max<std::size_t>(streamCapacity, 1);
+}
+
+Protocol::MailboxStats DetectorStreamEndpoint::getDeliveryStats() const
+{
+    return m_mailbox.getStats();
+}
+
+void DetectorStreamEndpoint::setNackCallback(Protocol::FrameAssembler::NackCallback &&nackCallback)
+{
+    m_frameAssembler.setPendingFrameCount(NACK_PENDING_FRAMES);
+    m_frameAssembler.setNackCallback(std::move(nackCallback));
+}
+
+void DetectorStreamEndpoint::setKeyframeRequestCallback(std::function<void (uint64_t, uint8_t)> &&keyframeCallback)
+{
+    m_keyframeRequestCallback = std::move(keyframeCallback);
+}
+
+void DetectorStreamEndpoint::setDeviceRegistry(const std::shared_ptr<Protocol::DeviceRegistry> &pRegistry)
+{
+    // UDP headers and shared memory slots are not authenticated, unknown senders must not take memory or workers
+    if (!pRegistry) {
+        m_frameAssembler.setSenderFilter(nullptr);
+        m_sharedServer.setSenderFilter(nullptr);
+        return;
+    }
+    m_frameAssembler.setSenderFilter([pRegistry](uint64_t senderId) {
+        return pRegistry->contains(senderId);
+    });
+    m_sharedServer.setSenderFilter([pRegistry](uint64_t senderId) {
+        return pRegistry->contains(senderId);
+    });
+}
+
+void DetectorStreamEndpoint::setSharedMemorySocket(const std::string &socketPath)
+{
+    m_sharedSocketPath = socketPath;
+}
+
+void DetectorStreamEndpoint::workerLoop()
+{
+    Protocol::SendableImage img;
+    while (m_mailbox.pop(img)) {
+        const auto senderId = img.getSenderId();
+        const auto streamId = img.getStreamId();
+        if (!ImageProcessing::TileDecoder::isTileFrame(img.getImage()) || composeTileFrame(img)) {
+            m_receivedCallback(std::move(img));
+        }
+        m_mailbox.finish(senderId, streamId); // Next image of stream could be processed
+    }
+}
+
+bool DetectorStreamEndpoint::composeTileFrame(Protocol::SendableImage &img)
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_tileDecodersMx);
+
+    // Detectors come and go, canvases of their streams must not stay forever
+    if (now - m_lastTileEvictionTime >= TILE_DECODER_IDLE_TIMEOUT) {
+        m_lastTileEvictionTime = now;
+        for (auto streamIt = m_tileDecoders.begin(); streamIt != m_tileDecoders.end();) {
+            streamIt = (now - streamIt->second.lastFrameTime >= TILE_DECODER_IDLE_TIMEOUT) ? m_tileDecoders.erase(streamIt) : std::next(streamIt);
+        }
+    }
+    auto& tileStream = m_tileDecoders[{img.getSenderId(), img.getStreamId()}];
+    if (!tileStream.pDecoder) {
+        tileStream.pDecoder = std::make_shared<ImageProcessing::TileDecoder>();
+    }
+    tileStream.lastFrameTime = now;
+    auto pDecoder = tileStream.pDecoder;
+    lock.unlock();
+
+    if (!pDecoder->apply(img.getId(), img.getImage())) {
+        m_skippedTileFrames.fetch_add(1, std::memory_order_relaxed);
+        COMPLOG_DEBUG("[UDP] Tile frame skipped:", pDecoder->getLastErrorText());
+        requestKeyframe(img.getSenderId(), img.getStreamId(), now);
+        return false;
+    }
+
+    // Consumers get whole frame from persistent canvas of stream
+    img.setImage(img.getId(), ImageProcessing::Utility::serializeMat(pDecoder->getCanvas()));
+    return true;
+}
+
+void DetectorStreamEndpoint::requestKeyframe(uint64_t senderId, uint8_t streamId, std::chrono::steady_clock::time_point now)
+{
+    // Without request decoder waits for periodic keyframe, stream is dark until then
+    if (!m_keyframeRequestCallback) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_tileDecodersMx);
+        auto streamIt = m_tileDecoders.find({senderId, streamId});
+        if (streamIt == m_tileDecoders.end() || now - streamIt->second.lastKeyframeRequestTime < KEYFRAME_REQUEST_INTERVAL) {
+            return;
+        }
+        streamIt->second.lastKeyframeRequestTime = now;
+    }
+    m_keyframeRequestCallback(senderId, streamId);
+}
@@ -2,13 +2,17 @@
 
 #include "abstractendpoint.hpp"
 
-#include <Components/Network/ServerUDP.h>
 #include <Components/Network/ClientUDP.h>
 
 #include <ROD/ImageProcessing/ImageProcessor.h>
+#include <ROD/ImageProcessing/TileCodec.h>
 
+#include <atomic>
+#include <chrono>
 #include <map>
-#include <set>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 /**
  * @brief The DetectorStreamEndpoint class  Server instance, processing video streaming and retranslation
@@ -25,27 +29,114 @@ public:
     void stop() override;
 
     /**
-     * @brief setImageReceivedCallback When image received, this callback will be called once in some thread
+     * @brief setImageReceivedCallback When image received, this callback will be called once in some worker thread
      * @param imgCallback
      */
     void setImageReceivedCallback(std::function<void(Protocol::SendableImage&&)>&& imgCallback);
 
     /**
-     * @brief The ImageInfo class Detector sent image parts
+     * @brief setWorkerCount    Set count of threads, processing completed images. Applied on start
+     * @param workerCount       Count of threads, at least 1. Images of one stream are never processed in parallel
      */
-    struct ImageInfo
-    {
-        std::mutex addMx;
-        uint64_t id {};
-        std::set<Protocol::ImagePacket> parts;
-    };
+    void setWorkerCount(std::size_t workerCount);
+
+    /**
+     * @brief setDeliveryPolicy What to do with images of stream when workers are late. Applied on start
+     * @param policy            LatestOnly by default: live detection needs the freshest image, not a backlog
+     * @param streamCapacity    Max count of queued images of every stream. LatestOnly uses it only for tile frames:
+     *                          superseded delta would cost keyframe request, so they are queued like with DropOldest
+     */
+    void setDeliveryPolicy(Protocol::MailboxPolicy policy, std::size_t streamCapacity = MAX_QUEUED_IMAGES);
+
+    /**
+     * @brief getDeliveryStats  Statistics of images between receiving and workers (superseded, dropped, etc.)
+     */
+    Protocol::MailboxStats getDeliveryStats() const;
+
+    /**
+     * @brief setNackCallback   Enable requests of lost fragments, callback must deliver request to sender. Applied on start
+     * @param nackCallback      Called in receive thread
+     */
+    void setNackCallback(Protocol::FrameAssembler::NackCallback&& nackCallback);
+
+    /**
+     * @brief setKeyframeRequestCallback    Enable requests of keyframe when tile stream lost its reference (gap, dropped or superseded frame)
+     * @param keyframeCallback              Must deliver request to sender. Called in worker thread,
+     *                                      not more often than KEYFRAME_REQUEST_INTERVAL per stream
+     */
+    void setKeyframeRequestCallback(std::function<void(uint64_t senderId, uint8_t streamId)>&& keyframeCallback);
+
+    /**
+     * @brief setDeviceRegistry Images are assembled (UDP) or delivered (shared memory) only of registered devices,
+     *                          any sender is accepted if it is not set. Call before start
+     */
+    void setDeviceRegistry(const std::shared_ptr<Protocol::DeviceRegistry>& pRegistry);
+
+    /**
+     * @brief setSharedMemorySocket Also receive images of detectors on the same host through shared memory. Applied on start
+     * @param socketPath            Path of Unix domain socket, empty to disable (default)
+     */
+    void setSharedMemorySocket(const std::string& socketPath);
+
+    /**
+     * @brief getReceiveStats   Statistics of UDP receiving (batches, kernel drops, etc.)
+     */
+    Protocol::ReceiveStats getReceiveStats() const;
+
+    /**
+     * @brief getAssemblerStats Statistics of frame assembling (completed, incomplete, recovered, etc.), thread-safe
+     */
+    Protocol::AssemblerStats getAssemblerStats() const;
+
+    // Default max count of completed images of stream waiting for workers
+    static constexpr std::size_t MAX_QUEUED_IMAGES {4};
+
+    // Frames of detector waiting for retransmission while newer ones arrive
+    static constexpr std::size_t NACK_PENDING_FRAMES {4};
+
+    // Canvas of stream without tile frames for this time is released
+    static constexpr std::chrono::seconds TILE_DECODER_IDLE_TIMEOUT {10};
+
+    // Min time between keyframe requests of stream, requested keyframe is on the way meanwhile
+    static constexpr std::chrono::milliseconds KEYFRAME_REQUEST_INTERVAL {500};
 
 private:
-    UDP::Server m_streamingServer;      // Receiver inserting images into processor to proceed
-    UDP::Client m_streamingDataSender;  // Retranslator
+    Protocol::ImageStreamReceiver   m_streamingServer;      // Receiver inserting images into processor to proceed
+    Protocol::SharedImageReceiver   m_sharedServer;         // Receiver of co-located detectors, images are already whole
+    std::string                     m_sharedSocketPath;
+    UDP::Client                     m_streamingDataSender;  // Retranslator
+    Protocol::FrameAssembler        m_frameAssembler;       // Used only in receive thread
+    Protocol::AssemblerStats        m_assemblerStats;       // Copy of assembler stats for other threads, updated per batch
+    mutable std::mutex              m_assemblerStatsMx;
 
-    std::mutex m_imageMx;
-    std::map<uint64_t, ImageInfo>                   m_imageParts;
     std::function<void(Protocol::SendableImage&&)>  m_receivedCallback;
-};
 
+    /**
+     * @brief The TileStream struct Decoder is shared with worker, so it could be evicted while frame is composed
+     */
+    struct TileStream
+    {
+        std::shared_ptr<ImageProcessing::TileDecoder>   pDecoder;
+        std::chrono::steady_clock::time_point           lastFrameTime;
+        std::chrono::steady_clock::time_point           lastKeyframeRequestTime;
+    };
+    using TileDecoders = std::map<std::pair<uint64_t, uint8_t>, TileStream>; // By sender and stream
+
+    // Workers for completed images
+    std::size_t                 m_workerCount {2};
+    std::vector<std::thread>    m_workers;
+    Protocol::FrameMailbox      m_mailbox;              // Stream is processed by one worker at once
+    Protocol::MailboxPolicy     m_deliveryPolicy {Protocol::MailboxPolicy::LatestOnly};
+    std::size_t                 m_deliveryCapacity {MAX_QUEUED_IMAGES};
+    std::atomic<bool>           m_isWorkersRunning {false};
+
+    TileDecoders                m_tileDecoders;         // Decoder is used by worker owning its stream
+    std::mutex                  m_tileDecodersMx;       // Guards map only
+    std::chrono::steady_clock::time_point m_lastTileEvictionTime;
+    std::function<void(uint64_t senderId, uint8_t streamId)> m_keyframeRequestCallback;
+    std::atomic<uint64_t>       m_skippedTileFrames {};
+
+    void workerLoop();
+    bool composeTileFrame(Protocol::SendableImage& img);
+    void requestKeyframe(uint64_t senderId, uint8_t streamId, std::chrono::steady_clock::time_point now);
+};
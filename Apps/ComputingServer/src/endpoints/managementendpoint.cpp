@@ -7,12 +7,15 @@
 #include "httpcontrollers/detectorinfocontroller.hpp"
 #include "httpcontrollers/servercontroller.hpp"
 #include "httpcontrollers/detectorsoftwarecontroller.hpp"
+#include "httpcontrollers/eventsubscriptioncontroller.hpp"
+#include "httpcontrollers/eventhistorycontroller.hpp"
 
 namespace Management
 {
 
 Endpoint::Endpoint() :
-    AbstractEndpoint()
+    AbstractEndpoint(),
+    m_pSubscriptionController {std::make_shared<EventSubscriptionController>()}
 {
 
 }
@@ -27,6 +30,31 @@ void Endpoint::setRecordManager(const Database::RecordManagerPtr &pManager)
     m_pRecordManager = pManager;
 }
 
+void Endpoint::setDeviceRegistry(const std::shared_ptr<Protocol::DeviceRegistry> &pRegistry)
+{
+    m_pDeviceRegistry = pRegistry;
+}
+
+void Endpoint::setEventLog(const std::shared_ptr<const Protocol::EventLog> &pEventLog)
+{
+    m_pEventLog = pEventLog;
+}
+
+void Endpoint::setSubscriberQueue(std::size_t capacity)
+{
+    m_pSubscriptionController->setQueueCapacity(capacity);
+}
+
+void Endpoint::publishEvent(const Protocol::Event &ev)
+{
+    m_pSubscriptionController->publish(ev);
+}
+
+void Endpoint::setStreamingStatusProvider(std::function<DataObjects::StreamingStatus ()> provider)
+{
+    m_streamingStatusProvider = std::move(provider);
+}
+
 void Endpoint::start(uint16_t port)
 {
     // 1 thread for status, 1 for management panel requests
@@ -35,13 +63,23 @@ void Endpoint::start(uint16_t port)
     auto pDetectorCommandProcessor = std::dynamic_pointer_cast<DetectorCommandProcessor>(m_pEventProcessor);
 
     // Настройка контроллеров
-    drogon::app().registerController(std::make_shared<ServerController>());
+    auto pServerController = std::make_shared<ServerController>();
+    pServerController->setStreamingStatusProvider(m_streamingStatusProvider);
+    drogon::app().registerController(pServerController);
     drogon::app().registerController(std::make_shared<DetectorSoftwareController>());
 
     auto pDetectorInfoController = std::make_shared<DetectorInfoController>();
+    pDetectorInfoController->setDeviceRegistry(m_pDeviceRegistry);
     pDetectorInfoController->setRecordManager(m_pRecordManager);
     drogon::app().registerController(pDetectorInfoController);
 
+    // Events are pushed to panels instead of polling
+    drogon::app().registerController(m_pSubscriptionController);
+
+    auto pEventHistoryController = std::make_shared<EventHistoryController>();
+    pEventHistoryController->setEventLog(m_pEventLog);
+    drogon::app().registerController(pEventHistoryController);
+
     // Server info
     drogon::app().setServerHeaderField("Management server");
 
@@ -5,6 +5,12 @@
 #include "abstractendpoint.hpp"
 #include "database/recordmanager.hpp"
 
+#include <ROD/StreamingStatus.h>
+
+#include <functional>
+
+class EventSubscriptionController;
+
 #include <Components/SystemProcessing/StatusManager.h>
 
 namespace Management
@@ -20,6 +26,27 @@ public:
     ~Endpoint();
 
     void setRecordManager(const Database::RecordManagerPtr& pManager);
+    void setDeviceRegistry(const std::shared_ptr<Protocol::DeviceRegistry>& pRegistry);
+
+    /**
+     * @brief setEventLog   History of events for API, set before start
+     */
+    void setEventLog(const std::shared_ptr<const Protocol::EventLog>& pEventLog);
+
+    /**
+     * @brief setSubscriberQueue    Max events waiting for sending to every subscribed management client
+     */
+    void setSubscriberQueue(std::size_t capacity);
+
+    /**
+     * @brief publishEvent  Push event to subscribed management clients, thread-safe
+     */
+    void publishEvent(const Protocol::Event& ev);
+
+    /**
+     * @brief setStreamingStatusProvider    Source of image streaming counters for API, set before start
+     */
+    void setStreamingStatusProvider(std::function<DataObjects::StreamingStatus()> provider);
 
     // AbstractEndpoint interface
     void start(uint16_t port) override;
@@ -28,6 +55,10 @@ public:
 
 private:
     Database::RecordManagerPtr m_pRecordManager;
+    std::shared_ptr<Protocol::DeviceRegistry> m_pDeviceRegistry;
+    std::shared_ptr<const Protocol::EventLog> m_pEventLog;
+    std::shared_ptr<EventSubscriptionController> m_pSubscriptionController;
+    std::function<DataObjects::StreamingStatus()> m_streamingStatusProvider;
 };
 
 }
@@ -1,5 +1,9 @@
 #include "serverendpoint.hpp"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include <ROD/Protocol.h>
 #include <ROD/ImageProcessing/Utility.h>
 
@@ -16,12 +20,23 @@
 #include "eventprocessors/detectoreventprocessor.hpp"
 
 #include "database/recordmanager.hpp"
+#include "database/detectorrecords.hpp"
 
 struct ServerEndpoint::Impl
 {
     // Common
+    std::shared_ptr<Protocol::DeviceRegistry> deviceRegistry { std::make_shared<Protocol::DeviceRegistry>() };
     Database::RecordManagerPtr recordManager { std::make_shared<Database::RecordManager>("main_server_" + Common::createRandomString(32)) };
 
+    // Registry is reloaded in background until database gives detectors
+    std::thread             registryReloader;
+    std::mutex              registryReloaderMx;
+    std::condition_variable registryReloaderCv;
+    bool                    isRegistryReloaderStopped {false};
+
+    // History of server and detector events
+    std::shared_ptr<Protocol::EventLog> eventLog { std::make_shared<Protocol::EventLog>() };
+
     // Processors for events
     std::shared_ptr<ServerEventProcessor>       serverEventProcessor    { std::make_shared<ServerEventProcessor>() };
     std::shared_ptr<DetectorEventProcessor>     detectorEventProcessor  { std::make_shared<DetectorEventProcessor>() };
@@ -53,6 +68,45 @@ ServerEndpoint::~ServerEndpoint()
     d->serverEventProcessor->addServerEvent(Protocol::EventType::ServerStopped);
 }
 
+void ServerEndpoint::setSharedMemorySocket(const std::string &socketPath)
+{
+    m_sharedMemorySocket = socketPath;
+}
+
+void ServerEndpoint::setDeliveryPolicy(Protocol::MailboxPolicy policy, std::size_t streamCapacity)
+{
+    m_deliveryPolicy = policy;
+    m_deliveryCapacity = streamCapacity;
+}
+
+void ServerEndpoint::setEventWorkers(std::size_t workerCount, Protocol::EventOverflowPolicy policy, std::size_t queueCapacity)
+{
+    m_eventWorkerCount = workerCount;
+    m_eventOverflowPolicy = policy;
+    m_eventQueueCapacity = queueCapacity;
+}
+
+void ServerEndpoint::setEventIoThreads(std::size_t threadCount)
+{
+    m_eventIoThreadCount = threadCount;
+}
+
+void ServerEndpoint::setEventRetention(std::chrono::hours retention)
+{
+    m_eventRetention = retention;
+}
+
+void ServerEndpoint::setSubscriberQueue(std::size_t capacity)
+{
+    m_subscriberQueueCapacity = capacity;
+}
+
+void ServerEndpoint::setPresence(std::chrono::seconds timeout, std::chrono::seconds flushInterval)
+{
+    m_presenceTimeout = timeout;
+    m_onlineFlushInterval = flushInterval;
+}
+
 void ServerEndpoint::start(uint16_t wsEventPort, uint16_t httpAPIPort, uint16_t udpStreamingPort)
 {
     COMPLOG_INFO("Starting RemoteObjectDetector server. Port configuration:");
@@ -62,9 +116,21 @@ void ServerEndpoint::start(uint16_t wsEventPort, uint16_t httpAPIPort, uint16_t
 
     d = std::make_unique<Impl>();
 
+    Protocol::EventLogConfig eventLogConfig;
+    eventLogConfig.retention = m_eventRetention;
+    auto eventLogDir = Common::DirectoryManager::getDirectoryStatic(Common::DirectoryManager::DirectoryType::Data) / "events";
+    if (!d->eventLog->open(eventLogDir, eventLogConfig)) {
+        COMPLOG_ERROR("Failed to open event log (history is not saved):", d->eventLog->getLastErrorText());
+    } else if (m_eventRetention.count() > 0) {
+        const auto retentionUs = std::chrono::duration_cast<std::chrono::microseconds>(m_eventRetention).count();
+        d->eventLog->removeOlderThan(Protocol::EventLog::getCurrentTimestampUs() - retentionUs);
+    }
+
     auto addEmptyLog = [this](Protocol::EventType evt){
         d->serverEventProcessor->setEventProcessor(evt, [this, eventTypeString = Protocol::toString(evt)](auto&& ev) {
             COMPLOG_INFO("SERVER EVENT:", eventTypeString, ev.getPayload());
+            d->eventLog->append(ev);
+            d->managementEndpoint.publishEvent(ev);
         });
     };
     addEmptyLog(Protocol::EventType::ServerStarted);
@@ -78,23 +144,104 @@ void ServerEndpoint::start(uint16_t wsEventPort, uint16_t httpAPIPort, uint16_t
     d->recordManager->setUser("server", "serv_auth_password");
     d->recordManager->init();
 
+    // Devices allowed to connect, loaded by one request. Management API keeps registry in sync then
+    if (!loadDeviceRegistry()) {
+        COMPLOG_WARNING("No registered detectors loaded, reloading every", REGISTRY_RELOAD_INTERVAL.count(), "s");
+        d->registryReloader = std::thread([this]() {
+            std::unique_lock<std::mutex> lock(d->registryReloaderMx);
+            while (!d->registryReloaderCv.wait_for(lock, REGISTRY_RELOAD_INTERVAL, [this]() { return d->isRegistryReloaderStopped; })) {
+                if (loadDeviceRegistry()) {
+                    break;
+                }
+            }
+        });
+    }
+
+    // Detector events are saved in history and pushed to management clients
+    d->managementEndpoint.setSubscriberQueue(m_subscriberQueueCapacity);
+    for (auto evt : {Protocol::EventType::DetectorConnected, Protocol::EventType::DetectorDisconnected, Protocol::EventType::DetectorAlert,
+                     Protocol::EventType::DetectedObject, Protocol::EventType::FailedObjectDetection}) {
+        d->detectorEventProcessor->setEventProcessor(evt, [this](auto&& ev) {
+            if (!d->eventLog->append(ev)) {
+                COMPLOG_WARNING("Event is not saved:", Protocol::toString(ev.getType()));
+            }
+            d->managementEndpoint.publishEvent(ev);
+        });
+    }
+
     // In other threads
+    d->detectorEventProcessor->setQueue(m_eventOverflowPolicy, m_eventQueueCapacity);
+    d->detectorEventProcessor->start(m_eventWorkerCount);
     d->detectorEventEndpoint.setEventProcessor(d->detectorEventProcessor);
+    d->detectorEventEndpoint.setIoThreadCount(m_eventIoThreadCount);
+    d->detectorEventEndpoint.setDeviceRegistry(d->deviceRegistry);
+
+    // Online time of all detectors is saved by one query per flush. Online detector has last_utc 0
+    Protocol::PresenceConfig presenceConfig;
+    presenceConfig.timeout = m_presenceTimeout;
+    d->detectorEventEndpoint.setPresence(presenceConfig, m_onlineFlushInterval, [this](std::vector<Protocol::OnlineTime>&& onlineTimes) {
+        const auto steadyNow = std::chrono::steady_clock::now();
+        const auto utcNow = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+        std::vector<Database::DetectorOnlineRecord> records;
+        records.reserve(onlineTimes.size());
+        for (auto& onlineTime : onlineTimes) {
+            Database::DetectorOnlineRecord record;
+            record.setId(static_cast<int64_t>(onlineTime.deviceId));
+            record.setTotalOnline(onlineTime.online.count());
+            record.setLastOnline(onlineTime.isOnline ? 0 :
+                                 (utcNow - std::chrono::duration_cast<std::chrono::seconds>(steadyNow - onlineTime.lastSeen)).count());
+            records.push_back(std::move(record));
+        }
+        d->recordManager->updateRecords<false>(records, {"total"});
+    });
     d->detectorEventEndpoint.start(wsEventPort);
 
     // Image stream processor
     d->detectorStreamingEndpoint.setImageReceivedCallback([](auto&& receivedImage) -> void {
-        COMPLOG_DEBUG("Received image from:", receivedImage.getSenderId(), "with id:", receivedImage.getId());
+        COMPLOG_DEBUG("Received image from:", receivedImage.getSenderId(), "stream:", receivedImage.getStreamId(), "with id:", receivedImage.getId());
 
+        // Images are saved by parallel workers, so every camera has own names
         auto& dirManager = Common::DirectoryManager::getInstance();
         auto dataDir = dirManager.getDirectory(Common::DirectoryManager::Data);
-        auto saveFile = dataDir / (std::to_string(receivedImage.getId()) + ".png");
+        auto saveFile = dataDir / (std::to_string(receivedImage.getSenderId()) + "_" + std::to_string(receivedImage.getStreamId()) + "_" +
+                                   std::to_string(receivedImage.getId()) + ".png");
         ImageProcessing::Utility::saveImage(receivedImage.getImage(), saveFile);
     });
+    d->detectorStreamingEndpoint.setNackCallback([this](uint64_t senderId, const Protocol::FragmentNack& nack) {
+        Protocol::Event ev;
+        ev.setType(Protocol::EventType::FragmentsRequested);
+        ev.setPayload(nack.toRaw());
+        d->detectorEventEndpoint.sendEvent(std::to_string(senderId), ev);
+    });
+    d->detectorStreamingEndpoint.setKeyframeRequestCallback([this](uint64_t senderId, uint8_t streamId) {
+        Protocol::Event ev;
+        ev.setType(Protocol::EventType::KeyframeRequested);
+        ev.setPayload(std::to_string(streamId));
+        d->detectorEventEndpoint.sendEvent(std::to_string(senderId), ev);
+    });
+    d->detectorStreamingEndpoint.setDeviceRegistry(d->deviceRegistry);
+    d->detectorStreamingEndpoint.setSharedMemorySocket(m_sharedMemorySocket);
+    d->detectorStreamingEndpoint.setDeliveryPolicy(m_deliveryPolicy, m_deliveryCapacity);
     d->detectorStreamingEndpoint.start(udpStreamingPort);
 
     d->managementEndpoint.setRecordManager(d->recordManager);
+    d->managementEndpoint.setDeviceRegistry(d->deviceRegistry);
+    d->managementEndpoint.setEventLog(d->eventLog);
     d->managementEndpoint.setEventProcessor(d->serverEventProcessor);
+    d->managementEndpoint.setStreamingStatusProvider([this]() {
+        auto receiveStats = d->detectorStreamingEndpoint.getReceiveStats();
+        auto assemblerStats = d->detectorStreamingEndpoint.getAssemblerStats();
+        DataObjects::StreamingStatus status;
+        status.receive.datagrams    = receiveStats.datagrams;
+        status.receive.kernelDrops  = receiveStats.kernelDrops;
+        status.frames.completed     = assemblerStats.completedFrames;
+        status.frames.incomplete    = assemblerStats.droppedFrames;
+        status.frames.corrupted     = assemblerStats.corruptedFrames;
+        status.frames.fecRecoveredFragments = assemblerStats.recoveredFragments;
+        status.frames.nackRequests          = assemblerStats.nackRequests;
+        status.frames.nackRecoveredFrames   = assemblerStats.nackRecoveredFrames;
+        return status;
+    });
 
     d->serverEventProcessor->addServerEvent(Protocol::EventType::ServerStarted,
                                            std::string("[ API ") + std::to_string(httpAPIPort) +
@@ -117,9 +264,45 @@ bool ServerEndpoint::isWorking() const
 
 void ServerEndpoint::stop()
 {
+    stopRegistryReloading();
     if (!isWorking()) {
         return;
     }
     d->detectorEventEndpoint.stop();
     d->managementEndpoint.stop();
+
+    auto eventStats = d->detectorEventProcessor->getStats();
+    d->detectorEventProcessor->stop();
+    COMPLOG_INFO("Detector events processed:", eventStats.processed, "dropped:", eventStats.dropped,
+                 "max handler time (us):", eventStats.handlerTimeMaxUs);
+}
+
+bool ServerEndpoint::loadDeviceRegistry()
+{
+    Database::DetectorSystemRecord detectorRecord;
+    std::vector<uint64_t> detectorIds;
+    for (auto& id : d->recordManager->getAvailableRecords(detectorRecord.getTable(), detectorRecord.getIdColumn())) {
+        if (id.has_value() && id.value() > 0) {
+            detectorIds.push_back(static_cast<uint64_t>(id.value()));
+        }
+    }
+    if (detectorIds.empty()) {
+        return false; // Failed query is not distinguished from empty table, detectors added by API are kept
+    }
+    d->deviceRegistry->reset(detectorIds);
+    COMPLOG_INFO("Registered detectors:", d->deviceRegistry->size());
+    return true;
+}
+
+void ServerEndpoint::stopRegistryReloading()
+{
+    if (d == nullptr || !d->registryReloader.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(d->registryReloaderMx);
+        d->isRegistryReloaderStopped = true;
+    }
+    d->registryReloaderCv.notify_all();
+    d->registryReloader.join();
 }
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <stdint.h>
 #include <string>
 
+#include <ROD/Protocol.h>
+
 /**
  * @brief The ServerEndpoint class Главный объект сервера
  */
@@ -13,13 +16,65 @@ public:
     ServerEndpoint(const std::string& dbPath);
     ~ServerEndpoint();
 
+    /**
+     * @brief setSharedMemorySocket Enable shared memory streaming for detectors on the same host, applied on start
+     */
+    void setSharedMemorySocket(const std::string& socketPath);
+
+    /**
+     * @brief setDeliveryPolicy Policy of images waiting for processing, applied on start
+     */
+    void setDeliveryPolicy(Protocol::MailboxPolicy policy, std::size_t streamCapacity);
+
+    /**
+     * @brief setEventWorkers   Detector events are processed by workers, not in event channel thread. Applied on start
+     */
+    void setEventWorkers(std::size_t workerCount, Protocol::EventOverflowPolicy policy, std::size_t queueCapacity);
+
+    /**
+     * @brief setEventIoThreads Threads serving detector event connections, 0 is count of CPU cores. Applied on start
+     */
+    void setEventIoThreads(std::size_t threadCount);
+
+    /**
+     * @brief setEventRetention Keep history of events so long, 0 keeps all. Applied on start
+     */
+    void setEventRetention(std::chrono::hours retention);
+
+    /**
+     * @brief setSubscriberQueue    Max events waiting for sending to every management client subscribed to events. Applied on start
+     */
+    void setSubscriberQueue(std::size_t capacity);
+
+    /**
+     * @brief setPresence   Detector without heartbeat for timeout is disconnected, online time is saved to DB every flushInterval. Applied on start
+     */
+    void setPresence(std::chrono::seconds timeout, std::chrono::seconds flushInterval);
+
     void start(uint16_t wsEventPort, uint16_t httpAPIPort, uint16_t udpStreamingPort);
     bool isWorking() const;
     void stop();
 
+    // Interval of detector registry reloading, while database gives no detectors (failed query or database not ready)
+    static constexpr std::chrono::seconds REGISTRY_RELOAD_INTERVAL {10};
+
 private:
     std::string m_dbPath;
+    std::string m_sharedMemorySocket;
+    Protocol::MailboxPolicy m_deliveryPolicy {Protocol::MailboxPolicy::LatestOnly};
+    std::size_t             m_deliveryCapacity {4};
+    std::size_t                     m_eventWorkerCount {2};
+    Protocol::EventOverflowPolicy   m_eventOverflowPolicy {Protocol::EventOverflowPolicy::Block};
+    std::size_t                     m_eventQueueCapacity {1024};
+    std::size_t                     m_eventIoThreadCount {0};
+    std::chrono::hours              m_eventRetention {30 * 24};
+    std::size_t                     m_subscriberQueueCapacity {256};
+    std::chrono::seconds            m_presenceTimeout {30};
+    std::chrono::seconds            m_onlineFlushInterval {10};
     struct Impl;
     std::unique_ptr<Impl> d;
+
+    bool loadDeviceRegistry();
+    void stopRegistryReloading();
 };
 
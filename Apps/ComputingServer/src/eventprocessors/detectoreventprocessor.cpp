@@ -1,7 +1,7 @@
 #include "detectoreventprocessor.hpp"
 
 DetectorEventProcessor::DetectorEventProcessor() :
-    EventProcessor()
+    AsyncEventProcessor()
 {
     setProcessorName("Detector event processor");
 }
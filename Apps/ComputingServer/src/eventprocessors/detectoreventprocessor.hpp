@@ -2,7 +2,7 @@
 
 #include <ROD/Protocol.h>
 
-class DetectorEventProcessor : public Protocol::EventProcessor
+class DetectorEventProcessor : public Protocol::AsyncEventProcessor
 {
 public:
     DetectorEventProcessor();
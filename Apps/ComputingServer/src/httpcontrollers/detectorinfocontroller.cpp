@@ -10,6 +10,11 @@ void DetectorInfoController::setRecordManager(const Database::RecordManagerPtr &
     m_deviceInfoManager.updateDetectorsInfo();
 }
 
+void DetectorInfoController::setDeviceRegistry(const std::shared_ptr<Protocol::DeviceRegistry> &pRegistry)
+{
+    m_deviceInfoManager.setDeviceRegistry(pRegistry);
+}
+
 void DetectorInfoController::processGetList(const drogon::HttpRequestPtr &req, ResponseCallback_t &&callback)
 {
     nlohmann::json res;
@@ -22,6 +22,7 @@ public:
     METHOD_LIST_END
 
     void setRecordManager(const Database::RecordManagerPtr& pManager);
+    void setDeviceRegistry(const std::shared_ptr<Protocol::DeviceRegistry>& pRegistry);
 
     using ResponseCallback_t = std::function<void(const drogon::HttpResponsePtr&)>;
 
@@ -0,0 +1,64 @@
+#include "eventhistorycontroller.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <charconv>
+
+namespace {
+template<typename T>
+bool readNumberParameter(const drogon::HttpRequestPtr &req, const std::string& name, T& oValue)
+{
+    const auto& text = req->getParameter(name);
+    if (text.empty()) {
+        return true; // Default is kept
+    }
+    auto res = std::from_chars(text.data(), text.data() + text.size(), oValue);
+    return (res.ec == std::errc()) && (res.ptr == text.data() + text.size());
+}
+}
+
+void EventHistoryController::setEventLog(const std::shared_ptr<const Protocol::EventLog> &pEventLog)
+{
+    m_pEventLog = pEventLog;
+}
+
+void EventHistoryController::processGetHistory(const drogon::HttpRequestPtr &req, ResponseCallback_t &&callback)
+{
+    if (!m_pEventLog || !m_pEventLog->isOpen()) {
+        sendTextMessage(drogon::k503ServiceUnavailable, "Event history is not available", std::move(callback));
+        return;
+    }
+
+    Protocol::EventLogQuery query;
+    Protocol::EventFilter filter;
+    std::size_t limit {MAX_EVENTS};
+    if (!readNumberParameter(req, "from", query.fromUs) || !readNumberParameter(req, "to", query.toUs) ||
+        !readNumberParameter(req, "limit", limit) ||
+        !Protocol::EventFilter::parse(req->getParameter("dev"), req->getParameter("types"), filter) || filter.devices.size() > 1) {
+        sendTextMessage(drogon::k400BadRequest, "Invalid history query", std::move(callback));
+        return;
+    }
+    if (!filter.devices.empty()) {
+        query.deviceId = filter.devices.front();
+    }
+    query.types = std::move(filter.types);
+    limit = std::min(limit, MAX_EVENTS);
+
+    nlohmann::json events = nlohmann::json::array();
+    if (limit > 0) {
+        m_pEventLog->scan(query, [&events, limit](Protocol::EventLogRecord&& record) {
+            nlohmann::json item;
+            item["timestamp"] = record.timestampUs;
+            item["device"] = record.deviceId;
+            item["event"] = nlohmann::json::parse(record.event.encode(Protocol::EventEncoding::Json), nullptr, false);
+            events.push_back(std::move(item));
+            return events.size() < limit;
+        });
+    }
+
+    nlohmann::json res;
+    res["events"] = std::move(events);
+    res["complete"] = (res["events"].size() < limit); // Otherwise more events could match
+    sendJsonMessage(drogon::k200OK, res.dump(), std::move(callback));
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <drogon/drogon.h>
+
+#include <ROD/Protocol.h>
+
+#include <memory>
+
+#include "controllerbase.hpp"
+
+/**
+ * @brief The EventHistoryController class Reads saved server and detector events from event log
+ * @note Query: from, to (microseconds since epoch, inclusive), dev (one device id, 0 is server),
+ *       types (comma separated names) and limit. All are optional, events are returned in time order
+ */
+class EventHistoryController : public drogon::HttpController<EventHistoryController, false>,
+                               public ControllerBase
+{
+public:
+    METHOD_LIST_BEGIN
+        ADD_METHOD_TO(EventHistoryController::processGetHistory,    Protocol::API::DROGON::EVENTS_HISTORY,  drogon::Get);
+    METHOD_LIST_END
+
+    void setEventLog(const std::shared_ptr<const Protocol::EventLog>& pEventLog);
+
+    using ResponseCallback_t = std::function<void(const drogon::HttpResponsePtr&)>;
+
+    void processGetHistory(const drogon::HttpRequestPtr &req,
+                           ResponseCallback_t &&callback);
+
+    // Max count of events in one response, client continues from timestamp of the last one
+    static constexpr std::size_t MAX_EVENTS {1000};
+
+private:
+    std::shared_ptr<const Protocol::EventLog> m_pEventLog;
+};
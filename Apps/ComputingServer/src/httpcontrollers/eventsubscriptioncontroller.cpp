@@ -0,0 +1,121 @@
+#include "eventsubscriptioncontroller.hpp"
+
+#include <drogon/drogon.h>
+
+#include <Components/Logger/Logger.h>
+
+#include <algorithm>
+#include <charconv>
+
+EventSubscriptionController::Subscriber::Subscriber(const Protocol::EventFilter &filter, std::size_t capacity, Protocol::SubscriberOverflowPolicy policy) :
+    subscription {filter, capacity, policy}
+{
+
+}
+
+void EventSubscriptionController::setQueueCapacity(std::size_t capacity)
+{
+    if (capacity == 0) {
+        throw std::invalid_argument("Subscription queue capacity must be positive");
+    }
+    m_queueCapacity = capacity;
+}
+
+void EventSubscriptionController::publish(const Protocol::Event &ev)
+{
+    std::shared_lock<std::shared_mutex> lock(m_mx);
+    for (const auto& [pConnection, pSubscriber] : m_subscriptions) {
+        if (pSubscriber->subscription.push(ev)) {
+            scheduleFlush(pConnection, pSubscriber);
+        }
+    }
+}
+
+std::size_t EventSubscriptionController::getSubscriberCount() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mx);
+    return m_subscriptions.size();
+}
+
+void EventSubscriptionController::handleNewMessage(const drogon::WebSocketConnectionPtr &pConnection, std::string &&message, const drogon::WebSocketMessageType &type)
+{
+    // Subscription is read-only, filter is changed by reconnection. Pong acknowledges sent bytes
+    if (type != drogon::WebSocketMessageType::Pong) {
+        return;
+    }
+    uint64_t ackedBytes {};
+    const auto parseRes = std::from_chars(message.data(), message.data() + message.size(), ackedBytes);
+    if (parseRes.ec != std::errc() || parseRes.ptr != message.data() + message.size()) {
+        return; // Not our ping
+    }
+    std::shared_lock<std::shared_mutex> lock(m_mx);
+    auto subscriptionIt = m_subscriptions.find(pConnection);
+    if (subscriptionIt == m_subscriptions.end()) {
+        return;
+    }
+    auto& pSubscriber = subscriptionIt->second;
+    auto currentAcked = pSubscriber->ackedBytes.load();
+    while (currentAcked < ackedBytes && !pSubscriber->ackedBytes.compare_exchange_weak(currentAcked, ackedBytes)) {}
+}
+
+void EventSubscriptionController::handleNewConnection(const drogon::HttpRequestPtr &req, const drogon::WebSocketConnectionPtr &pConnection)
+{
+    Protocol::EventFilter filter;
+    if (!Protocol::EventFilter::parse(req->getParameter("dev"), req->getParameter("types"), filter)) {
+        COMPLOG_WARNING("Invalid event subscription filter from:", pConnection->peerAddr().toIpPort());
+        pConnection->shutdown(drogon::CloseCode::kViolation, "Invalid filter");
+        return;
+    }
+    auto policy = Protocol::SubscriberOverflowPolicy::Summarize;
+    const auto& policyName = req->getParameter("policy");
+    if (!policyName.empty() && !Protocol::toSubscriberOverflowPolicy(policyName, policy)) {
+        COMPLOG_WARNING("Invalid event subscription policy from:", pConnection->peerAddr().toIpPort());
+        pConnection->shutdown(drogon::CloseCode::kViolation, "Invalid policy");
+        return;
+    }
+
+    auto pSubscriber = std::make_shared<Subscriber>(filter, m_queueCapacity, policy);
+    std::unique_lock<std::shared_mutex> lock(m_mx);
+    m_subscriptions.emplace(pConnection, std::move(pSubscriber));
+    COMPLOG_INFO("Event subscriber connected:", pConnection->peerAddr().toIpPort(), "subscribers:", m_subscriptions.size());
+}
+
+void EventSubscriptionController::handleConnectionClosed(const drogon::WebSocketConnectionPtr &pConnection)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mx);
+    auto subscriptionIt = m_subscriptions.find(pConnection);
+    if (subscriptionIt == m_subscriptions.end()) {
+        return;
+    }
+    COMPLOG_INFO("Event subscriber disconnected:", pConnection->peerAddr().toIpPort(), "dropped events:", subscriptionIt->second->subscription.getDroppedCount());
+    m_subscriptions.erase(subscriptionIt);
+}
+
+void EventSubscriptionController::scheduleFlush(const std::weak_ptr<drogon::WebSocketConnection> &pConnection, const SubscriberPtr &pSubscriber)
+{
+    // Sending is paced: queue of slow subscriber overflows instead of socket buffer
+    drogon::app().getLoop()->runAfter(FLUSH_INTERVAL, [this, pConnection, pSubscriber]() {
+        auto pLockedConnection = pConnection.lock();
+        if (pLockedConnection == nullptr || pLockedConnection->disconnected()) {
+            return;
+        }
+        const auto sentBytes = pSubscriber->sentBytes.load();
+        if (sentBytes - std::min(sentBytes, pSubscriber->ackedBytes.load()) > MAX_UNACKED_BYTES) {
+            scheduleFlush(pConnection, pSubscriber); // Client is behind, events wait (or drop) in its queue
+            return;
+        }
+
+        bool isFlushPending {};
+        auto events = pSubscriber->subscription.take(BATCH_SIZE, isFlushPending);
+        if (!events.empty()) {
+            auto message = Protocol::writeEvents(events, Protocol::EventEncoding::Json);
+            const auto totalSentBytes = sentBytes + message.size();
+            pSubscriber->sentBytes.store(totalSentBytes);
+            pLockedConnection->send(message, drogon::WebSocketMessageType::Text);
+            pLockedConnection->send(std::to_string(totalSentBytes), drogon::WebSocketMessageType::Ping);
+        }
+        if (isFlushPending) {
+            scheduleFlush(pConnection, pSubscriber);
+        }
+    });
+}
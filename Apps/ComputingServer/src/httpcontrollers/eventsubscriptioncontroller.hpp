@@ -0,0 +1,69 @@
+#pragma once
+
+#include <drogon/WebSocketController.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+
+#include <ROD/Protocol.h>
+
+/**
+ * @brief The EventSubscriptionController class Pushes server and detector events to management clients over WebSocket
+ * @note Client sets filter in query (dev, types, policy - see Protocol::EventFilter::parse).
+ *       Every client has own bounded queue, sent in batches not more often than flush interval,
+ *       so a slow client loses its own events (dropped or summarized) and never slows down publisher or other clients.
+ *       Every batch is followed by ping with count of sent bytes, client pong acknowledges them. While client has not
+ *       acknowledged too much data, its events stay in its queue instead of piling up in send buffer
+ */
+class EventSubscriptionController : public drogon::WebSocketController<EventSubscriptionController, false>
+{
+public:
+    WS_PATH_LIST_BEGIN
+        WS_PATH_ADD(Protocol::API::DROGON::EVENTS_SUBSCRIBE, drogon::Get);
+    WS_PATH_LIST_END
+
+    /**
+     * @brief setQueueCapacity  Max count of events waiting for sending to every new subscriber
+     */
+    void setQueueCapacity(std::size_t capacity);
+
+    /**
+     * @brief publish   Queue event for matching subscribers, thread-safe
+     */
+    void publish(const Protocol::Event& ev);
+
+    std::size_t getSubscriberCount() const;
+
+    // WebSocketController interface
+    void handleNewMessage(const drogon::WebSocketConnectionPtr& pConnection, std::string&& message, const drogon::WebSocketMessageType& type) override;
+    void handleNewConnection(const drogon::HttpRequestPtr& req, const drogon::WebSocketConnectionPtr& pConnection) override;
+    void handleConnectionClosed(const drogon::WebSocketConnectionPtr& pConnection) override;
+
+private:
+    /**
+     * @brief The Subscriber struct Queue of client and its unacknowledged data
+     */
+    struct Subscriber
+    {
+        Subscriber(const Protocol::EventFilter& filter, std::size_t capacity, Protocol::SubscriberOverflowPolicy policy);
+
+        Protocol::EventSubscription subscription;
+        std::atomic<uint64_t>       sentBytes {};   // Written to connection
+        std::atomic<uint64_t>       ackedBytes {};  // Confirmed by pong of client
+    };
+    using SubscriberPtr = std::shared_ptr<Subscriber>;
+
+    static constexpr std::size_t                BATCH_SIZE {64};            // Max events sent per flush interval
+    static constexpr uint64_t                   MAX_UNACKED_BYTES {256 * 1024};
+    static constexpr std::chrono::milliseconds  FLUSH_INTERVAL {50};
+
+    std::size_t m_queueCapacity {256};
+
+    std::map<drogon::WebSocketConnectionPtr, SubscriberPtr> m_subscriptions;
+    mutable std::shared_mutex                               m_mx;
+
+    void scheduleFlush(const std::weak_ptr<drogon::WebSocketConnection>& pConnection, const SubscriberPtr& pSubscriber);
+};
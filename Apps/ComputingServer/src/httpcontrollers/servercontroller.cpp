@@ -14,6 +14,11 @@ void ServerController::setServerEventProcessor(const std::shared_ptr<ServerEvent
     m_serverEventProcessor = pProcessor;
 }
 
+void ServerController::setStreamingStatusProvider(StreamingStatusProvider provider)
+{
+    m_streamingStatusProvider = std::move(provider);
+}
+
 void ServerController::processGetStatus(const drogon::HttpRequestPtr &req, ResponseCallback_t &&callback)
 {
     // Get status
@@ -48,3 +53,12 @@ void ServerController::processPowerRequest(const drogon::HttpRequestPtr &req, Re
 
     sendTextMessage(drogon::k400BadRequest, "Invalid action type", std::move(callback));
 }
+
+void ServerController::processGetStreaming(const drogon::HttpRequestPtr &req, ResponseCallback_t &&callback)
+{
+    if (!m_streamingStatusProvider) {
+        sendTextMessage(drogon::k503ServiceUnavailable, "Streaming is not started", std::move(callback));
+        return;
+    }
+    sendJsonMessage(drogon::k200OK, m_streamingStatusProvider().toJson(), std::move(callback));
+}
@@ -5,6 +5,9 @@
 #include <Components/SystemProcessing/StatusManager.h>
 
 #include <ROD/Protocol.h>
+#include <ROD/StreamingStatus.h>
+
+#include <functional>
 
 #include "controllerbase.hpp"
 
@@ -16,9 +19,16 @@ class ServerController : public drogon::HttpController<ServerController, false>,
 public:
     void setServerEventProcessor(const std::shared_ptr<ServerEventProcessor>& pProcessor);
 
+    using StreamingStatusProvider = std::function<DataObjects::StreamingStatus()>;
+    /**
+     * @brief setStreamingStatusProvider    Source of streaming counters, called from request thread
+     */
+    void setStreamingStatusProvider(StreamingStatusProvider provider);
+
     METHOD_LIST_BEGIN
         ADD_METHOD_TO(ServerController::processGetStatus,       Protocol::API::DROGON::SERVER_STATUS,   drogon::Get);
         ADD_METHOD_TO(ServerController::processPowerRequest,    Protocol::API::DROGON::SERVER_POWER,    drogon::Put);
+        ADD_METHOD_TO(ServerController::processGetStreaming,    Protocol::API::DROGON::SERVER_STREAMING, drogon::Get);
     METHOD_LIST_END
 
     using ResponseCallback_t = std::function<void(const drogon::HttpResponsePtr&)>;
@@ -30,8 +40,12 @@ public:
                             ResponseCallback_t &&callback,
                             const std::string& action);
 
+    void processGetStreaming(const drogon::HttpRequestPtr &req,
+                             ResponseCallback_t &&callback);
+
 private:
     SystemProcessing::StatusManager         m_statusManager;
     std::shared_ptr<ServerEventProcessor>   m_serverEventProcessor;
+    StreamingStatusProvider                 m_streamingStatusProvider;
 };
 
@@ -3,6 +3,8 @@
 
 #include <boost/program_options.hpp>
 
+#include <ROD/Protocol.h>
+
 #include "endpoints/serverendpoint.hpp"
 #include "common/servercommon.hpp"
 
@@ -24,6 +26,17 @@ int main(int argc, char* argv[]) {
     uint16_t wsPort {9002};
     uint16_t streamingUDPPort {9003};
     std::string updatesDir {"."};
+    std::string sharedMemorySocket {};
+    std::string deliveryPolicy {"latest-only"};
+    std::size_t deliveryQueueSize {4};
+    std::size_t eventWorkerCount {2};
+    std::string eventOverflow {"block"};
+    std::size_t eventQueueSize {1024};
+    std::size_t eventIoThreadCount {0};
+    std::size_t eventRetentionDays {30};
+    std::size_t subscriberQueueSize {256};
+    std::size_t presenceTimeoutSec {30};
+    std::size_t onlineFlushSec {10};
 
     bpo::options_description desc;
     desc.add_options()
@@ -31,6 +44,17 @@ int main(int argc, char* argv[]) {
             ("api-port,-a",     bpo::value(&httpAPIPort),       "HTTP API port")
             ("stream-port,-s",  bpo::value(&streamingUDPPort),  "UDP streaming port")
             ("data,-d",         bpo::value(&updatesDir),        "Path to directory to use for saving server data (current dir by default)")
+            ("shm-socket,-m",   bpo::value(&sharedMemorySocket), "Unix socket for shared memory streaming of detectors on this host (disabled by default)")
+            ("delivery-policy", bpo::value(&deliveryPolicy),    "Images of stream waiting for processing: latest-only (default), drop-oldest or block")
+            ("delivery-queue",  bpo::value(&deliveryQueueSize), "Max images of stream waiting for processing (drop-oldest, block and tile frames of latest-only)")
+            ("event-workers",   bpo::value(&eventWorkerCount),  "Threads processing detector events, events of one detector are processed in order (2 by default)")
+            ("event-overflow",  bpo::value(&eventOverflow),     "Detector events when worker queue is full: block (default, slows down event channel) or drop")
+            ("event-queue",     bpo::value(&eventQueueSize),    "Max detector events waiting in queue of every worker")
+            ("event-io-threads", bpo::value(&eventIoThreadCount), "Threads serving detector event connections (count of CPU cores by default)")
+            ("event-retention", bpo::value(&eventRetentionDays), "Days of event history to keep, 0 keeps all (30 by default)")
+            ("subscriber-queue", bpo::value(&subscriberQueueSize), "Max events waiting for sending to every subscribed management panel (256 by default)")
+            ("presence-timeout", bpo::value(&presenceTimeoutSec), "Seconds without heartbeat after which detector is disconnected (30 by default)")
+            ("online-flush",    bpo::value(&onlineFlushSec),    "Period in seconds of saving detector online time (10 by default)")
             ;
 
     // Harvest settings
@@ -47,6 +71,40 @@ int main(int argc, char* argv[]) {
     }
 
     // Check-up
+    Protocol::MailboxPolicy mailboxPolicy;
+    if (deliveryPolicy == "latest-only") {
+        mailboxPolicy = Protocol::MailboxPolicy::LatestOnly;
+    } else if (deliveryPolicy == "drop-oldest") {
+        mailboxPolicy = Protocol::MailboxPolicy::DropOldest;
+    } else if (deliveryPolicy == "block") {
+        mailboxPolicy = Protocol::MailboxPolicy::Block;
+    } else {
+        std::cerr << "Invalid delivery policy: " << deliveryPolicy << std::endl;
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+    if (deliveryQueueSize == 0) {
+        std::cerr << "Delivery queue size must be at least 1" << std::endl;
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+
+    Protocol::EventOverflowPolicy eventOverflowPolicy;
+    if (eventOverflow == "block") {
+        eventOverflowPolicy = Protocol::EventOverflowPolicy::Block;
+    } else if (eventOverflow == "drop") {
+        eventOverflowPolicy = Protocol::EventOverflowPolicy::DropNewest;
+    } else {
+        std::cerr << "Invalid event overflow policy: " << eventOverflow << std::endl;
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+    if (eventWorkerCount == 0 || eventQueueSize == 0 || subscriberQueueSize == 0) {
+        std::cerr << "Event worker count and queue sizes must be at least 1" << std::endl;
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+    if (presenceTimeoutSec == 0 || onlineFlushSec == 0) {
+        std::cerr << "Presence timeout and online flush period must be at least 1 second" << std::endl;
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+
     if (!std::filesystem::exists(updatesDir)) {
         std::cerr << "Invalid updates directory path: " << updatesDir << std::endl;
         return APP_EXITCODE_CONFIGURATION_ERROR;
@@ -64,6 +122,13 @@ int main(int argc, char* argv[]) {
 
     // Start server
     ServerEndpoint server(dirManager.getDirectory(Common::DirectoryManager::DirectoryType::Data) / "local.db");
+    server.setSharedMemorySocket(sharedMemorySocket);
+    server.setDeliveryPolicy(mailboxPolicy, deliveryQueueSize);
+    server.setEventWorkers(eventWorkerCount, eventOverflowPolicy, eventQueueSize);
+    server.setEventIoThreads(eventIoThreadCount);
+    server.setEventRetention(std::chrono::hours(24 * eventRetentionDays));
+    server.setSubscriberQueue(subscriberQueueSize);
+    server.setPresence(std::chrono::seconds(presenceTimeoutSec), std::chrono::seconds(onlineFlushSec));
 #ifdef DEBUG_BUILD_MODE
     server.start(wsPort, httpAPIPort, streamingUDPPort); // For exception handling
 #else
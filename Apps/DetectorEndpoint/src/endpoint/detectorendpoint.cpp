@@ -4,15 +4,25 @@
 
 #include <ROD/ImageProcessing/CameraAdaptor.h>
 #include <ROD/ImageProcessing/ImageProcessor.h>
+#include <ROD/ImageProcessing/TileCodec.h>
+#include <ROD/ImageProcessing/Utility.h>
 #include <ROD/ImageProcessing/VideoReader.h>
 #include <ROD/Protocol.h>
 
 #include <Components/Logger/Logger.h>
 #include <Components/Common/DirectoryManager.h>
-#include <Components/Network/ClientUDP.h>
 
+#include <opencv2/core.hpp>
+
+#include <algorithm>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <set>
 
 using namespace ImageProcessing;
 
@@ -24,23 +34,89 @@ struct DetectorEndpoint::Impl
     EventEndpoint eventEndpoint;
 
     // Image processing
-    CameraAdaptor                   camera;
     std::unique_ptr<VideoReader>    debugVideoReader;
     std::atomic<uint64_t>           pictureSendIntervalUs {1'000'000}; // Something like FPS
 
+    /**
+     * @brief The CameraStream struct Camera, streamed with own stream id and shot ids
+     */
+    struct CameraStream
+    {
+        std::unique_ptr<CameraAdaptor>  camera;
+        TileEncoder                     tileEncoder;
+        ImageData_t                     currentShotData;
+        uint64_t                        currentImageId {1};
+    };
+    std::vector<CameraStream>   streams; // Index is stream id
+
+    // Keyframes requested by server in event thread, applied to encoders in send thread
+    std::mutex                  keyframeRequestMx;
+    std::set<uint8_t>           keyframeRequests;
+
     // Streaming
-    UDP::Client             streamingClient;
-    VideoReader::Iterator   currentDebugShotIt;
-    ImageData_t             currentShotData;
+    std::mutex                  sendMx; // Guards senders of frames, locked only by send thread during streaming
+    Protocol::ImageStreamSender streamingSender;
+    Protocol::PacingConfig      pacing;
+    unsigned                    frameSpreadPercent {};
+    Protocol::SharedImageSender sharedSender;   // Used instead of UDP when server is on the same host
+    std::string                 sharedSocketPath;
+    std::chrono::steady_clock::time_point   nextSharedConnectTime;  // UDP is used without connect attempts until then
+    std::chrono::milliseconds               sharedConnectBackoff {SHARED_RECONNECT_MIN_INTERVAL};
+    VideoReader::Iterator       currentDebugShotIt;
 
-    uint64_t currentImageId {1};
+    // Retransmission has own socket and thread, so requests neither wait behind paced frames nor block event thread
+    Protocol::ImageStreamSender retransmitSender;
+    std::thread                 retransmitThread;
+    std::mutex                  retransmitMx;   // Guards cache and queue
+    std::condition_variable     retransmitCv;
+    std::deque<std::shared_ptr<const Protocol::SendableImage> > retransmitCache; // Last sent images, newest at back
+    std::deque<Protocol::FragmentNack>  retransmitQueue;
+    bool                                isRetransmitting {false};
+
+    uint64_t deviceId {};
+    uint8_t  fecGroupCount {};
+    bool     isTileCoding {false};
+    TileCodecConfig tileCodecConfig;
+    std::size_t mtuSize {Protocol::ImagePacket::MTU_SIZE};
+
+    /**
+     * @brief applyPacing   Set pacing of senders, shot interval is shared by streams. Called under send lock
+     */
+    void applyPacing()
+    {
+        auto streamingPacing = pacing;
+        streamingPacing.frameInterval = std::chrono::microseconds(pictureSendIntervalUs * frameSpreadPercent / 100 / streams.size());
+        streamingSender.setPacing(streamingPacing);
+        auto retransmitPacing = pacing;
+        retransmitPacing.frameInterval = {};
+        retransmitSender.setPacing(retransmitPacing);
+    }
 };
 
 
 DetectorEndpoint::DetectorEndpoint() :
     d {new Impl}
 {
+    d->streams.resize(1);
+    d->streams.front().camera = std::make_unique<CameraAdaptor>();
 
+    d->eventEndpoint.getEventProcessor().setEventProcessor(Protocol::EventType::FragmentsRequested, [this](Protocol::Event&& ev) {
+        Protocol::FragmentNack nack;
+        if (!nack.readRaw(ev.getPayload())) {
+            COMPLOG_WARNING("Invalid fragments request:", ev.getPayload());
+            return;
+        }
+        queueRetransmission(std::move(nack));
+    });
+    d->eventEndpoint.getEventProcessor().setEventProcessor(Protocol::EventType::KeyframeRequested, [this](Protocol::Event&& ev) {
+        const auto streamId = std::strtoul(ev.getPayload().c_str(), nullptr, 10);
+        if (streamId > UINT8_MAX) {
+            COMPLOG_WARNING("Invalid keyframe request:", ev.getPayload());
+            return;
+        }
+        std::lock_guard<std::mutex> lock(d->keyframeRequestMx);
+        d->keyframeRequests.insert(static_cast<uint8_t>(streamId));
+    });
 }
 
 DetectorEndpoint::~DetectorEndpoint()
@@ -64,26 +140,143 @@ void DetectorEndpoint::setDebugMode(bool isDebug)
     d->debugVideoReader.reset();
 }
 
+void DetectorEndpoint::setCameraDevices(const std::vector<std::string> &cameraDevices)
+{
+    if (cameraDevices.empty() || cameraDevices.size() > UINT8_MAX + 1) {
+        throw std::invalid_argument("Camera count must be from 1 to 256");
+    }
+
+    d->streams.clear();
+    d->streams.resize(cameraDevices.size());
+    for (std::size_t streamId = 0; streamId < cameraDevices.size(); ++streamId) {
+        d->streams[streamId].camera = std::make_unique<CameraAdaptor>(cameraDevices[streamId]);
+    }
+}
+
+void DetectorEndpoint::setTileCoding(bool isEnabled, const TileCodecConfig &config)
+{
+    TileEncoder validatingEncoder(config); // Throws on invalid config
+    d->isTileCoding = isEnabled;
+    d->tileCodecConfig = config;
+}
+
+void DetectorEndpoint::setSharedMemorySocket(const std::string &socketPath)
+{
+    d->sharedSocketPath = socketPath;
+}
+
 void DetectorEndpoint::setDeviceId(long long deviceId)
 {
+    d->deviceId = deviceId;
     d->eventEndpoint.setDeviceId(deviceId);
 }
 
+void DetectorEndpoint::setEventEncoding(Protocol::EventEncoding encoding)
+{
+    d->eventEndpoint.setEncoding(encoding);
+}
+
+void DetectorEndpoint::setEventBatching(const Protocol::EventBatchConfig &config)
+{
+    d->eventEndpoint.setBatching(config);
+}
+
+bool DetectorEndpoint::sendEvent(Protocol::Event &&ev)
+{
+    ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, std::to_string(d->deviceId));
+    return d->eventEndpoint.sendEvent(std::move(ev));
+}
+
+void DetectorEndpoint::setFecGroupCount(uint8_t groupCount)
+{
+    d->fecGroupCount = groupCount;
+}
+
+void DetectorEndpoint::setMtuSize(std::size_t mtuSize)
+{
+    if (mtuSize < Protocol::ImagePacket::MIN_MTU_SIZE || mtuSize > Protocol::ImagePacket::MAX_MTU_SIZE) {
+        throw std::invalid_argument("MTU size out of range: " + std::to_string(mtuSize));
+    }
+    d->mtuSize = mtuSize;
+}
+
+void DetectorEndpoint::setPacing(const Protocol::PacingConfig &config, unsigned frameSpreadPercent)
+{
+    if (frameSpreadPercent > 100) {
+        throw std::invalid_argument("Shot spread must not exceed shot interval: " + std::to_string(frameSpreadPercent) + "%");
+    }
+    std::lock_guard<std::mutex> lock(d->sendMx);
+    d->pacing = config;
+    d->frameSpreadPercent = frameSpreadPercent;
+    d->applyPacing();
+}
+
 bool DetectorEndpoint::start(const std::string &host, uint16_t streamPort, uint16_t eventPort)
 {
     COMPLOG_INFO("Connecting to server...");
     d->eventEndpoint.setServer(host, eventPort);
     d->eventEndpoint.connect();
-    d->streamingClient.setHost(host, streamPort);
+    if (!d->streamingSender.setHost(host, streamPort) || !d->retransmitSender.setHost(host, streamPort)) {
+        COMPLOG_ERROR("Failed to setup streaming:", d->streamingSender.getLastErrorText(), d->retransmitSender.getLastErrorText());
+        return false;
+    }
+    for (auto& stream : d->streams) {
+        stream.tileEncoder.setConfig(d->tileCodecConfig);
+    }
+    {
+        std::lock_guard<std::mutex> lock(d->sendMx);
+        d->applyPacing(); // Count of streams is known now
+    }
     d->isWorking.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(d->retransmitMx);
+        d->isRetransmitting = true;
+    }
+    d->retransmitThread = std::thread([this]() {
+        retransmitLoop();
+    });
 
     COMPLOG_INFO("Starting endpoint...");
+
+    // Random phase, so detectors started together do not send shots at the same moments
+    std::random_device randomDev;
+    std::uniform_int_distribution<uint64_t> phaseDist(0, d->pictureSendIntervalUs - 1);
+    auto nextShotTime = std::chrono::steady_clock::now() + std::chrono::microseconds(phaseDist(randomDev));
     while (d->isWorking.load(std::memory_order_acquire)) {
-        std::this_thread::sleep_for(std::chrono::microseconds(d->pictureSendIntervalUs));
+        std::this_thread::sleep_until(nextShotTime);
+        nextShotTime = std::max(nextShotTime + std::chrono::microseconds(d->pictureSendIntervalUs), std::chrono::steady_clock::now());
         prepareShot();
         sendShot();
     }
-    COMPLOG_INFO("Endpoint stopped");
+
+    {
+        std::lock_guard<std::mutex> lock(d->retransmitMx);
+        d->isRetransmitting = false;
+        d->retransmitCv.notify_all();
+    }
+    d->retransmitThread.join();
+
+    std::lock_guard<std::mutex> lock(d->sendMx);
+    auto& sendStats = d->streamingSender.getStats();
+    COMPLOG_INFO("Endpoint stopped. Sent packets:", sendStats.packets,
+                 "bytes:", sendStats.bytes,
+                 "achieved bitrate:", sendStats.getAchievedBitrate(),
+                 "max queueing delay (us):", sendStats.maxQueueDelay.count());
+    if (!d->sharedSocketPath.empty()) {
+        auto& sharedStats = d->sharedSender.getStats();
+        COMPLOG_INFO("Shared memory images:", sharedStats.frames,
+                     "bytes:", sharedStats.bytes,
+                     "dropped on full ring:", sharedStats.ringFullDrops);
+    }
+    if (d->isTileCoding) {
+        for (std::size_t streamId = 0; streamId < d->streams.size(); ++streamId) {
+            auto& tileStats = d->streams[streamId].tileEncoder.getStats();
+            COMPLOG_INFO("Tile coding of stream", streamId, "keyframes:", tileStats.keyframes,
+                         "deltas:", tileStats.deltaFrames,
+                         "changed tiles:", tileStats.changedTiles, "of", tileStats.totalTiles,
+                         "bytes:", tileStats.encodedBytes);
+        }
+    }
     return true;
 }
 
@@ -98,14 +291,35 @@ void DetectorEndpoint::stop()
 
 void DetectorEndpoint::prepareShot()
 {
-    if (d->debugVideoReader) {
-        d->currentShotData = *d->currentDebugShotIt;
-        ++d->currentDebugShotIt;
-        if (d->currentDebugShotIt == d->debugVideoReader->end()) {
-            d->currentDebugShotIt = d->debugVideoReader->begin(); // Restart debug streaming
+    // Server lost reference of tile stream (dropped frame), next frame is keyframe then
+    std::set<uint8_t> keyframeRequests;
+    {
+        std::lock_guard<std::mutex> lock(d->keyframeRequestMx);
+        keyframeRequests.swap(d->keyframeRequests);
+    }
+    for (auto streamId : keyframeRequests) {
+        if (streamId < d->streams.size()) {
+            d->streams[streamId].tileEncoder.requestKeyframe();
+        }
+    }
+
+    for (std::size_t streamId = 0; streamId < d->streams.size(); ++streamId) {
+        auto& stream = d->streams[streamId];
+
+        // Debug video replaces the first camera
+        if (streamId == 0 && d->debugVideoReader) {
+            stream.currentShotData = d->isTileCoding ? stream.tileEncoder.encode(Utility::deserializeMat(*d->currentDebugShotIt))
+                                                     : *d->currentDebugShotIt;
+            ++d->currentDebugShotIt;
+            if (d->currentDebugShotIt == d->debugVideoReader->end()) {
+                d->currentDebugShotIt = d->debugVideoReader->begin(); // Restart debug streaming
+            }
+            continue;
         }
-    } else {
-        d->currentShotData = d->camera.shot();
+
+        // Tiles are encoded from raw frame, without JPEG of whole frame
+        stream.currentShotData = d->isTileCoding ? stream.tileEncoder.encode(stream.camera->shotFrame())
+                                                 : stream.camera->shot();
     }
 }
 
@@ -117,17 +331,43 @@ void DetectorEndpoint::sendShot()
     }
 
     if (d->eventEndpoint.isConnected()) {
-        COMPLOG_DEBUG("Sending image to server...");
+        COMPLOG_DEBUG("Sending images to server, streams:", d->streams.size());
 
-        Protocol::SendableImage img;
-        img.setImage(d->currentImageId, std::move(d->currentShotData));
-        d->currentImageId++;
+        // All streams go through one socket, server separates them by stream id
+        std::lock_guard<std::mutex> lock(d->sendMx);
+        for (std::size_t streamId = 0; streamId < d->streams.size(); ++streamId) {
+            auto& stream = d->streams[streamId];
+            if (stream.currentShotData.empty()) {
+                continue; // Camera failed
+            }
+
+            auto pImg = std::make_shared<Protocol::SendableImage>();
+            auto& img = *pImg;
+            img.setSenderId(d->deviceId);
+            img.setStreamId(static_cast<uint8_t>(streamId));
+            img.setFecGroupCount(d->fecGroupCount);
+            img.setMtuSize(d->mtuSize);
+            img.setImage(stream.currentImageId, std::move(stream.currentShotData));
+            stream.currentImageId++;
 
-        auto imagePackets = img.convertToPackets();
-        for (auto& pkt : imagePackets) {
-            if (!d->streamingClient.sendByteData(pkt)) {
-                return;
+            if (isSharedTransportReady(img)) {
+                // Same host, no fragments and no losses to retransmit
+                if (!d->sharedSender.sendImage(img)) {
+                    COMPLOG_WARNING("Failed to send image through shared memory:", d->sharedSender.getLastErrorText());
+                    stream.tileEncoder.requestKeyframe(); // Next tiles would reference lost frame
+                }
+                continue;
             }
+
+            if (!d->streamingSender.sendImage(img)) {
+                COMPLOG_WARNING("Failed to send image:", d->streamingSender.getLastErrorText());
+                stream.tileEncoder.requestKeyframe();
+            }
+            std::lock_guard<std::mutex> retransmitLock(d->retransmitMx);
+            if (d->retransmitCache.size() >= RETRANSMIT_CACHE_SIZE * d->streams.size()) {
+                d->retransmitCache.pop_front();
+            }
+            d->retransmitCache.push_back(std::move(pImg));
         }
         return;
     }
@@ -135,3 +375,80 @@ void DetectorEndpoint::sendShot()
     // TODO: Process by myself, save into cache and try to reconnect
     COMPLOG_WARNING("Server disconnected, image skipped");
 }
+
+bool DetectorEndpoint::isSharedTransportReady(const Protocol::SendableImage &img)
+{
+    if (d->sharedSocketPath.empty()) {
+        return false;
+    }
+    if (!d->sharedSender.isConnected()) {
+        // Connect may block for handshake timeout, so it is not tried for every frame
+        const auto now = std::chrono::steady_clock::now();
+        if (now < d->nextSharedConnectTime) {
+            return false;
+        }
+        if (!d->sharedSender.connect(d->sharedSocketPath)) {
+            // Server is on other host or has no shared memory streaming
+            COMPLOG_DEBUG("Shared memory is not available:", d->sharedSender.getLastErrorText(),
+                          "retry in (ms):", d->sharedConnectBackoff.count());
+            d->nextSharedConnectTime = now + d->sharedConnectBackoff;
+            d->sharedConnectBackoff = std::min(d->sharedConnectBackoff * 2, SHARED_RECONNECT_MAX_INTERVAL);
+            return false;
+        }
+        d->sharedConnectBackoff = SHARED_RECONNECT_MIN_INTERVAL;
+        COMPLOG_INFO("Streaming through shared memory:", d->sharedSocketPath);
+    }
+    return d->sharedSender.canSend(img);
+}
+
+void DetectorEndpoint::queueRetransmission(Protocol::FragmentNack &&nack)
+{
+    // Called in event thread, so it only queues request
+    std::lock_guard<std::mutex> lock(d->retransmitMx);
+    if (d->retransmitQueue.size() >= RETRANSMIT_QUEUE_SIZE) {
+        d->retransmitQueue.pop_front();
+    }
+    d->retransmitQueue.push_back(std::move(nack));
+    d->retransmitCv.notify_one();
+}
+
+void DetectorEndpoint::retransmitLoop()
+{
+    std::unique_lock<std::mutex> lock(d->retransmitMx);
+    while (true) {
+        d->retransmitCv.wait(lock, [this]() {
+            return !d->isRetransmitting || !d->retransmitQueue.empty();
+        });
+        if (!d->isRetransmitting) {
+            return;
+        }
+        auto nack = std::move(d->retransmitQueue.front());
+        d->retransmitQueue.pop_front();
+
+        lock.unlock();
+        resendFragments(nack);
+        lock.lock();
+    }
+}
+
+void DetectorEndpoint::resendFragments(const Protocol::FragmentNack &nack)
+{
+    std::shared_ptr<const Protocol::SendableImage> pCachedImg;
+    {
+        std::lock_guard<std::mutex> lock(d->retransmitMx);
+        auto cachedImg = std::find_if(d->retransmitCache.begin(), d->retransmitCache.end(), [&nack](auto& pImg) {
+            return (pImg->getId() == nack.shotId) && (pImg->getStreamId() == nack.streamId);
+        });
+        if (cachedImg == d->retransmitCache.end()) {
+            COMPLOG_DEBUG("Requested image is not cached anymore:", nack.shotId, "stream:", int(nack.streamId));
+            return;
+        }
+        pCachedImg = *cachedImg;
+    }
+
+    // Image is shared with cache, so it is sent without lock
+    COMPLOG_DEBUG("Resending fragments of image", nack.shotId, "count:", nack.fragmentNos.size());
+    if (!d->retransmitSender.sendFragments(*pCachedImg, nack.fragmentNos)) {
+        COMPLOG_WARNING("Failed to resend fragments:", d->retransmitSender.getLastErrorText());
+    }
+}
@@ -1,7 +1,23 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace Protocol {
+enum class EventEncoding : uint8_t;
+struct EventBatchConfig;
+class Event;
+struct FragmentNack;
+struct PacingConfig;
+class SendableImage;
+}
+
+namespace ImageProcessing {
+struct TileCodecConfig;
+}
 
 /**
  * @brief The DetectorEndpoint class    Main instance of detector
@@ -20,14 +36,85 @@ public:
 
     void setDeviceId(long long deviceId);
 
+    /**
+     * @brief setEventEncoding  Set encoding of event channel, binary by default. JSON is readable in debug logs
+     */
+    void setEventEncoding(Protocol::EventEncoding encoding);
+
+    /**
+     * @brief setEventBatching  Set how events to server are gathered into one frame
+     * @throws std::invalid_argument on invalid config
+     */
+    void setEventBatching(const Protocol::EventBatchConfig& config);
+
+    /**
+     * @brief sendEvent Send event to server (batched), device header is set by endpoint
+     * @return          false if event channel is not connected
+     */
+    bool sendEvent(Protocol::Event&& ev);
+
+    /**
+     * @brief setCameraDevices  Set cameras to stream, each one is sent as separate stream (id is index)
+     * @param cameraDevices     Paths of devices, for example /dev/video0. Only /dev/video0 is used by default
+     * @throws std::invalid_argument on empty list or more than 256 cameras
+     */
+    void setCameraDevices(const std::vector<std::string>& cameraDevices);
+
+    /**
+     * @brief setFecGroupCount  Set count of XOR parity fragments sent with every shot
+     * @param groupCount        0 disables FEC, otherwise any single lost fragment of a group is restored by server
+     */
+    void setFecGroupCount(uint8_t groupCount);
+
+    /**
+     * @brief setMtuSize    Set size of streaming datagrams, server takes it from packet headers
+     * @throws std::invalid_argument on size out of Protocol::ImagePacket MTU range
+     */
+    void setMtuSize(std::size_t mtuSize);
+
+    /**
+     * @brief setPacing             Spread fragments of shot in time instead of sending them at once
+     * @param frameSpreadPercent    Part of shot interval every shot is spread over (split between streams), rate follows
+     *                              shot size then. 0 sends at bitrate of config. Retransmissions go at bitrate of config
+     * @throws std::invalid_argument on invalid config or spread over 100%
+     */
+    void setPacing(const Protocol::PacingConfig& config, unsigned frameSpreadPercent = 0);
+
+    /**
+     * @brief setTileCoding Send only changed tiles of static scenes with periodic keyframes. Applied on start
+     * @param isEnabled     Send whole JPEG frames when disabled (default)
+     * @throws std::invalid_argument on invalid config
+     */
+    void setTileCoding(bool isEnabled, const ImageProcessing::TileCodecConfig& config);
+
+    /**
+     * @brief setSharedMemorySocket Send images through shared memory if server runs on the same host, UDP is used otherwise
+     * @param socketPath            Unix socket of server (its --shm-socket), empty to disable (default)
+     */
+    void setSharedMemorySocket(const std::string& socketPath);
+
     bool start(const std::string &host, uint16_t streamPort, uint16_t eventPort);
     void stop();
 
+    // Count of last sent images of every stream kept for retransmission of lost fragments
+    static constexpr std::size_t RETRANSMIT_CACHE_SIZE {8};
+
+    // Max count of fragment requests waiting for retransmission, the oldest ones are dropped
+    static constexpr std::size_t RETRANSMIT_QUEUE_SIZE {64};
+
+    // Interval of shared memory connection attempts, doubled after every failure. Frames go through UDP meanwhile
+    static constexpr std::chrono::milliseconds SHARED_RECONNECT_MIN_INTERVAL {1000};
+    static constexpr std::chrono::milliseconds SHARED_RECONNECT_MAX_INTERVAL {30000};
+
 private:
     struct Impl;
     std::unique_ptr<Impl> d;
 
     void prepareShot();
     void sendShot();
+    bool isSharedTransportReady(const Protocol::SendableImage& img);
+    void queueRetransmission(Protocol::FragmentNack&& nack);
+    void retransmitLoop();
+    void resendFragments(const Protocol::FragmentNack& nack);
 };
 
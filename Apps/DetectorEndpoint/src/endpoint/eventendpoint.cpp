@@ -3,6 +3,7 @@
 #include <websocketpp/client.hpp>
 #include <websocketpp/config/asio_client.hpp>
 #include <nlohmann/json.hpp>
+#include <future>
 #include <thread>
 
 #include <Components/Logger/Logger.h>
@@ -18,6 +19,17 @@ struct EventEndpoint::Impl
     websocketpp::lib::asio::io_service  ioService;
     ConnectionHdl                       eventConnection;
     std::atomic<bool>                   connected {false};
+    std::atomic<bool>                   connecting {false};
+    std::thread                         ioThread;   // Runs until connection is closed or failed
+
+    // Outgoing events, used only in event thread
+    Protocol::EventBatcher                  batcher;
+    websocketpp::lib::asio::steady_timer    flushTimer {ioService};
+
+    // Stats
+    std::atomic<uint64_t>   sentFrames {};
+    std::atomic<uint64_t>   sentEvents {};
+    std::atomic<uint64_t>   coalescedEvents {};
 
     std::string uri;
 };
@@ -31,20 +43,23 @@ EventEndpoint::EventEndpoint() :
     d->eventClient.set_open_handler([this](ConnectionHdl hdl) {
         d->eventConnection = hdl;
         d->connected.store(true, std::memory_order_release);
+        d->connecting.store(false, std::memory_order_release);
         COMPLOG_OK("[WS] Connected to server");
     });
     // d->eventClient.send(hdl, "hello", websocketpp::frame::opcode::text);
 
     d->eventClient.set_message_handler([this](ConnectionHdl hdl, MessagePtr msg) {
+        Protocol::Event ev;
         if (msg->get_opcode() == websocketpp::frame::opcode::text) {
-            std::string payload = msg->get_payload();
-            COMPLOG_DEBUG("[WS] Text got:", payload);
-            Protocol::Event ev(payload);
-            m_eventProcessor.addEvent(std::move(ev));
+            COMPLOG_DEBUG("[WS] Text got:", msg->get_payload());
+            if (!ev.readRaw(msg->get_payload())) {
+                return;
+            }
+        } else if (!ev.readBinary(msg->get_payload())) {
+            COMPLOG_WARNING("[WS] Invalid binary event, size:", msg->get_payload().size());
             return;
         }
-
-        COMPLOG_WARNING("[WS] Binary message received, size:", msg->get_payload().size());
+        m_eventProcessor.addEvent(std::move(ev));
     });
 
 
@@ -55,12 +70,14 @@ EventEndpoint::EventEndpoint() :
         code = pCon->get_remote_close_code();
         reasonStr = pCon->get_remote_close_reason();
         d->connected.store(false, std::memory_order_release);
+        d->connecting.store(false, std::memory_order_release);
         COMPLOG_WARNING("[WS] Disconnected:", reasonStr, "code:", code);
     });
 
 
     d->eventClient.set_fail_handler([this](ConnectionHdl hdl) {
         d->connected.store(false, std::memory_order_release);
+        d->connecting.store(false, std::memory_order_release);
         auto pCon = d->eventClient.get_con_from_hdl(hdl);
         auto ec = pCon->get_ec();
         COMPLOG_ERROR("[WS] Failed to connect:", ec.message());
@@ -82,9 +99,38 @@ void EventEndpoint::setServer(const std::string &serverHost, uint16_t eventPort)
     d->uri = "ws://" + serverHost + ":" + std::to_string(eventPort) + "/?dev=";
 }
 
+void EventEndpoint::setEncoding(Protocol::EventEncoding encoding)
+{
+    m_encoding = encoding;
+}
+
+void EventEndpoint::setBatching(const Protocol::EventBatchConfig &config)
+{
+    d->batcher.setConfig(config);
+}
+
+bool EventEndpoint::sendEvent(Protocol::Event &&ev)
+{
+    if (!isConnected()) {
+        COMPLOG_WARNING("[WS] Event skipped, not connected:", Protocol::toString(ev.getType()));
+        return false;
+    }
+    d->ioService.post([this, ev = std::move(ev)]() mutable {
+        queueEvent(std::move(ev));
+    });
+    return true;
+}
+
 void EventEndpoint::connect()
 {
-    auto url = d->uri + std::to_string(m_deviceId);
+    // Attempt in progress is not restarted, loop of previous connection is finished
+    if (isConnected() || d->connecting.load(std::memory_order_acquire)) {
+        return;
+    }
+    stopIoThread();
+    d->eventClient.reset();
+
+    auto url = d->uri + std::to_string(m_deviceId) + "&enc=" + Protocol::toString(m_encoding);
     COMPLOG_INFO("Connecting to:", url);
     websocketpp::lib::error_code ec;
     auto con = d->eventClient.get_connection(url, ec);
@@ -92,12 +138,13 @@ void EventEndpoint::connect()
         COMPLOG_ERROR("[WS] Connection:", ec.message());
         return;
     }
+    d->connecting.store(true, std::memory_order_release);
     d->eventClient.connect(con);
 
     // Event listen thread
-    std::thread([this](){
+    d->ioThread = std::thread([this](){
         d->eventClient.run();
-    }).detach();
+    });
 }
 
 bool EventEndpoint::isConnected() const
@@ -108,14 +155,81 @@ bool EventEndpoint::isConnected() const
 void EventEndpoint::disconnect()
 {
     if (!isConnected()) {
+        stopIoThread(); // Failed or closed connection
         return;
     }
-    d->eventClient.close(d->eventConnection, websocketpp::close::status::normal, "Disconnected by user");
+    // Batch is owned by event thread, queued events are sent before close
+    auto closed = std::make_shared<std::promise<void>>();
+    auto closedFuture = closed->get_future();
+    d->ioService.post([this, closed]() {
+        flushEvents();
+        websocketpp::lib::error_code ec;
+        d->eventClient.close(d->eventConnection, websocketpp::close::status::normal, "Disconnected by user", ec);
+        if (ec) {
+            COMPLOG_ERROR("[WS] Close:", ec.message());
+        }
+        closed->set_value();
+    });
+    if (closedFuture.wait_for(DISCONNECT_TIMEOUT) != std::future_status::ready) {
+        COMPLOG_WARNING("[WS] Event thread doesn't respond, queued events could be lost");
+        d->eventClient.stop();
+    }
+    if (d->ioThread.joinable()) {
+        d->ioThread.join(); // Loop exits after close handshake
+    }
     d->connected.store(false, std::memory_order_release);
+    COMPLOG_INFO("[WS] Sent events:", d->sentEvents.load(), "frames:", d->sentFrames.load(), "coalesced:", d->coalescedEvents.load());
     COMPLOG_INFO("Disconnected from event channel");
 }
 
+void EventEndpoint::stopIoThread()
+{
+    if (!d->ioThread.joinable()) {
+        return;
+    }
+    d->eventClient.stop();
+    d->ioThread.join();
+}
+
 ServerCommandProcessor &EventEndpoint::getEventProcessor()
 {
     return m_eventProcessor;
 }
+
+void EventEndpoint::queueEvent(Protocol::Event &&ev)
+{
+    // Delay of batch starts with its first event, coalesced events don't change size
+    const bool wasEmpty = d->batcher.isEmpty();
+    if (d->batcher.add(std::move(ev))) {
+        flushEvents();
+        return;
+    }
+    if (wasEmpty && !d->batcher.isEmpty()) {
+        d->flushTimer.expires_after(d->batcher.getConfig().maxDelay);
+        d->flushTimer.async_wait([this](const websocketpp::lib::error_code& ec) {
+            if (!ec) {
+                flushEvents();
+            }
+        });
+    }
+}
+
+void EventEndpoint::flushEvents()
+{
+    d->flushTimer.cancel();
+    if (d->batcher.isEmpty()) {
+        return;
+    }
+
+    auto batch = d->batcher.takeBatch();
+    const auto opcode = (m_encoding == Protocol::EventEncoding::Binary) ? websocketpp::frame::opcode::binary : websocketpp::frame::opcode::text;
+    websocketpp::lib::error_code ec;
+    d->eventClient.send(d->eventConnection, Protocol::writeEvents(batch, m_encoding), opcode, ec);
+    if (ec) {
+        COMPLOG_ERROR("[WS] Failed to send events:", ec.message(), "count:", batch.size());
+        return;
+    }
+    d->sentFrames.fetch_add(1, std::memory_order_relaxed);
+    d->sentEvents.fetch_add(batch.size(), std::memory_order_relaxed);
+    d->coalescedEvents.store(d->batcher.getCoalescedCount(), std::memory_order_relaxed);
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <stdint.h>
 #include "servercommandprocessor.hpp"
 
@@ -13,16 +14,51 @@ public:
 
     void setServer(const std::string& serverHost, uint16_t eventPort);
 
+    /**
+     * @brief setEncoding   Encoding of events requested from server on connect (binary by default, JSON for debugging)
+     */
+    void setEncoding(Protocol::EventEncoding encoding);
+
+    /**
+     * @brief setBatching   Set how outgoing events are gathered into one frame, must be called before connect
+     * @throws std::invalid_argument on invalid config
+     */
+    void setBatching(const Protocol::EventBatchConfig& config);
+
+    /**
+     * @brief sendEvent Queue event to server, it is sent in batch by count or delay of batching config
+     * @return          false if not connected (event is dropped)
+     * @note Thread-safe, events are batched and sent in event thread
+     */
+    bool sendEvent(Protocol::Event&& ev);
+
+    /**
+     * @brief connect   Start connection in event thread, does nothing while connected or connecting
+     */
     void connect();
     bool isConnected() const;
+
+    /**
+     * @brief disconnect    Send queued events, close connection and wait for event thread
+     */
     void disconnect();
 
+    // Max wait for event thread to send queued events on disconnect
+    static constexpr std::chrono::milliseconds DISCONNECT_TIMEOUT {1000};
+
     ServerCommandProcessor& getEventProcessor();
 
 private:
     long long m_deviceId {};
+    Protocol::EventEncoding m_encoding {Protocol::EventEncoding::Binary};
     ServerCommandProcessor m_eventProcessor;
 
     struct Impl;
     std::unique_ptr<Impl> d;
+
+    // In event thread
+    void queueEvent(Protocol::Event&& ev);
+    void flushEvents();
+
+    void stopIoThread();
 };
@@ -4,8 +4,13 @@
 
 #include "endpoint/detectorendpoint.hpp"
 
+#include <ROD/Protocol.h>
+#include <ROD/ImageProcessing/TileCodec.h>
+
 #include <boost/program_options.hpp>
 
+#include <sstream>
+
 namespace bpo = boost::program_options;
 
 #define APP_EXITCODE_OK                   0
@@ -68,6 +73,68 @@ int main(int argc, char* argv[]) {
     if (!pDevIdSetting) {
         pDevIdSetting = appSettings.addSetting(CONNECTION_CONFIG_SECTION_NAME, "device_id");
     }
+    auto pEventEncodingSetting = appSettings.getSetting(CONNECTION_CONFIG_SECTION_NAME, "event_encoding");
+    if (!pEventEncodingSetting) {
+        pEventEncodingSetting = appSettings.addSetting(CONNECTION_CONFIG_SECTION_NAME, "event_encoding");
+    }
+    auto pEventBatchSizeSetting = appSettings.getSetting(CONNECTION_CONFIG_SECTION_NAME, "event_batch_size");
+    if (!pEventBatchSizeSetting) {
+        pEventBatchSizeSetting = appSettings.addSetting(CONNECTION_CONFIG_SECTION_NAME, "event_batch_size");
+    }
+    auto pEventBatchDelaySetting = appSettings.getSetting(CONNECTION_CONFIG_SECTION_NAME, "event_batch_delay_us");
+    if (!pEventBatchDelaySetting) {
+        pEventBatchDelaySetting = appSettings.addSetting(CONNECTION_CONFIG_SECTION_NAME, "event_batch_delay_us");
+    }
+    auto pEventCoalescingSetting = appSettings.getSetting(CONNECTION_CONFIG_SECTION_NAME, "event_coalescing");
+    if (!pEventCoalescingSetting) {
+        pEventCoalescingSetting = appSettings.addSetting(CONNECTION_CONFIG_SECTION_NAME, "event_coalescing");
+    }
+
+    const auto STREAMING_CONFIG_SECTION_NAME = "STREAMING_CONFIG";
+    auto pFecGroupsSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "fec_groups");
+    if (!pFecGroupsSetting) {
+        pFecGroupsSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "fec_groups");
+    }
+    auto pMtuSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "mtu");
+    if (!pMtuSetting) {
+        pMtuSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "mtu");
+    }
+    auto pPacingBitrateSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "pacing_bitrate");
+    if (!pPacingBitrateSetting) {
+        pPacingBitrateSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "pacing_bitrate");
+    }
+    auto pPacingBurstSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "pacing_burst");
+    if (!pPacingBurstSetting) {
+        pPacingBurstSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "pacing_burst");
+    }
+    auto pPacingGapSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "pacing_gap_us");
+    if (!pPacingGapSetting) {
+        pPacingGapSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "pacing_gap_us");
+    }
+    auto pPacingSpreadSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "pacing_spread_percent");
+    if (!pPacingSpreadSetting) {
+        pPacingSpreadSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "pacing_spread_percent");
+    }
+    auto pCamerasSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "cameras");
+    if (!pCamerasSetting) {
+        pCamerasSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "cameras");
+    }
+    auto pSharedSocketSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "shm_socket");
+    if (!pSharedSocketSetting) {
+        pSharedSocketSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "shm_socket");
+    }
+    auto pTileCodingSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "tile_coding");
+    if (!pTileCodingSetting) {
+        pTileCodingSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "tile_coding");
+    }
+    auto pTileSizeSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "tile_size");
+    if (!pTileSizeSetting) {
+        pTileSizeSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "tile_size");
+    }
+    auto pKeyframeIntervalSetting = appSettings.getSetting(STREAMING_CONFIG_SECTION_NAME, "keyframe_interval");
+    if (!pKeyframeIntervalSetting) {
+        pKeyframeIntervalSetting = appSettings.addSetting(STREAMING_CONFIG_SECTION_NAME, "keyframe_interval");
+    }
     appSettings.saveSettings(); // For creating empty config file
 
     // Setup settings
@@ -95,9 +162,98 @@ int main(int argc, char* argv[]) {
         return APP_EXITCODE_CONFIGURATION_ERROR;
     }
 
+    // Get event encoding (json or bin), binary by default
+    auto eventEncoding {Protocol::EventEncoding::Binary};
+    if (pEventEncodingSetting->getValue().has_value() && !Protocol::toEventEncoding(pEventEncodingSetting->getValueString(), eventEncoding)) {
+        COMPLOG_ERROR("Invalid event encoding (must be json or bin):", pEventEncodingSetting->getValueString());
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+
+    // Get event batching, status events are coalesced by default
+    Protocol::EventBatchConfig eventBatchConfig;
+    long long eventBatchSizeLL  = pEventBatchSizeSetting->getValue().has_value() ? std::get<long long>(pEventBatchSizeSetting->getValue().value()) : eventBatchConfig.maxEvents;
+    long long eventBatchDelayLL = pEventBatchDelaySetting->getValue().has_value() ? std::get<long long>(pEventBatchDelaySetting->getValue().value()) : eventBatchConfig.maxDelay.count();
+    if (eventBatchSizeLL < 1 || eventBatchSizeLL > UINT16_MAX || eventBatchDelayLL < 0) {
+        COMPLOG_ERROR("Invalid event batching config (batch size must be in range 1-65535, delay >=0)");
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+    eventBatchConfig.maxEvents    = static_cast<std::size_t>(eventBatchSizeLL);
+    eventBatchConfig.maxDelay     = std::chrono::microseconds(eventBatchDelayLL);
+    eventBatchConfig.isCoalescing = !pEventCoalescingSetting->getValue().has_value() || std::get<long long>(pEventCoalescingSetting->getValue().value()) != 0;
+
+    // Get FEC parity count, no parity by default
+    long long fecGroupsLL = pFecGroupsSetting->getValue().has_value() ? std::get<long long>(pFecGroupsSetting->getValue().value()) : 0;
+    if (fecGroupsLL < 0 || fecGroupsLL > 255) {
+        COMPLOG_ERROR("Invalid FEC group count (must be in range 0-255):", fecGroupsLL);
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+
+    // Get datagram size, jumbo frames need it up to 8972
+    long long mtuLL = pMtuSetting->getValue().has_value() ? std::get<long long>(pMtuSetting->getValue().value()) : Protocol::ImagePacket::MTU_SIZE;
+    if (mtuLL < static_cast<long long>(Protocol::ImagePacket::MIN_MTU_SIZE) || mtuLL > static_cast<long long>(Protocol::ImagePacket::MAX_MTU_SIZE)) {
+        COMPLOG_ERROR("Invalid MTU size (must be in range", Protocol::ImagePacket::MIN_MTU_SIZE, "-", Protocol::ImagePacket::MAX_MTU_SIZE, "):", mtuLL);
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+
+    // Get pacing, disabled without bitrate and spread. Spread is percent of shot interval every shot is sent over
+    Protocol::PacingConfig pacing;
+    long long pacingBitrateLL = pPacingBitrateSetting->getValue().has_value() ? std::get<long long>(pPacingBitrateSetting->getValue().value()) : 0;
+    long long pacingBurstLL   = pPacingBurstSetting->getValue().has_value() ? std::get<long long>(pPacingBurstSetting->getValue().value()) : pacing.burstSize;
+    long long pacingGapLL     = pPacingGapSetting->getValue().has_value() ? std::get<long long>(pPacingGapSetting->getValue().value()) : 0;
+    long long pacingSpreadLL  = pPacingSpreadSetting->getValue().has_value() ? std::get<long long>(pPacingSpreadSetting->getValue().value()) : 0;
+    if (pacingBitrateLL < 0 || pacingBurstLL <= 0 || pacingGapLL < 0 || pacingSpreadLL < 0 || pacingSpreadLL > 100) {
+        COMPLOG_ERROR("Invalid pacing config (bitrate and gap must be >=0, burst >=1, spread 0-100)");
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+    pacing.bitrate   = pacingBitrateLL;
+    pacing.burstSize = pacingBurstLL;
+    pacing.burstGap  = std::chrono::microseconds(pacingGapLL);
+
+    // Get cameras, comma-separated devices. Each camera is streamed with own stream id
+    std::vector<std::string> cameraDevices;
+    if (pCamerasSetting->getValue().has_value()) {
+        std::stringstream camerasStream(pCamerasSetting->getValueString());
+        for (std::string device; std::getline(camerasStream, device, ',');) {
+            device.erase(0, device.find_first_not_of(' '));
+            device.erase(device.find_last_not_of(' ') + 1);
+            if (!device.empty()) {
+                cameraDevices.push_back(std::move(device));
+            }
+        }
+    }
+    if (cameraDevices.empty()) {
+        cameraDevices.push_back("/dev/video0");
+    }
+    if (cameraDevices.size() > 256) {
+        COMPLOG_ERROR("Too many cameras (must be up to 256):", cameraDevices.size());
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+
+    // Get tile coding, whole frames are sent by default
+    ImageProcessing::TileCodecConfig tileCodecConfig;
+    bool isTileCoding = pTileCodingSetting->getValue().has_value() && std::get<long long>(pTileCodingSetting->getValue().value()) != 0;
+    long long tileSizeLL         = pTileSizeSetting->getValue().has_value() ? std::get<long long>(pTileSizeSetting->getValue().value()) : tileCodecConfig.tileSize;
+    long long keyframeIntervalLL = pKeyframeIntervalSetting->getValue().has_value() ? std::get<long long>(pKeyframeIntervalSetting->getValue().value()) : tileCodecConfig.keyframeInterval;
+    if (tileSizeLL < 8 || tileSizeLL > 1024 || keyframeIntervalLL < 1 || keyframeIntervalLL > UINT32_MAX) {
+        COMPLOG_ERROR("Invalid tile coding config (tile size must be in range 8-1024, keyframe interval >=1)");
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+    tileCodecConfig.tileSize         = static_cast<int>(tileSizeLL);
+    tileCodecConfig.keyframeInterval = static_cast<uint32_t>(keyframeIntervalLL);
+
     // Start endpoint using parameters
     DetectorEndpoint endpoint;
     endpoint.setDeviceId(std::get<long long>(pDevIdSetting->getValue().value()));
+    endpoint.setEventEncoding(eventEncoding);
+    endpoint.setEventBatching(eventBatchConfig);
+    endpoint.setFecGroupCount(static_cast<uint8_t>(fecGroupsLL));
+    endpoint.setMtuSize(mtuLL);
+    endpoint.setPacing(pacing, static_cast<unsigned>(pacingSpreadLL));
+    endpoint.setCameraDevices(cameraDevices);
+    endpoint.setTileCoding(isTileCoding, tileCodecConfig);
+    if (pSharedSocketSetting->getValue().has_value()) {
+        endpoint.setSharedMemorySocket(pSharedSocketSetting->getValueString()); // Empty disables it
+    }
     endpoint.setDebugMode(vm.count("debug") != 0);
     try {
         if (!endpoint.start(serverAddress, streamingUDPPort, eventPort)) {
@@ -0,0 +1,142 @@
+#include <Components/Logger/Logger.h>
+#include <Components/Common/DirectoryManager.h>
+
+#include <boost/program_options.hpp>
+
+#include "simulator/fleetsimulator.hpp"
+
+#include <csignal>
+#include <iostream>
+
+namespace bpo = boost::program_options;
+
+#define APP_EXITCODE_OK                   0
+#define APP_EXITCODE_CONFIGURATION_ERROR  1
+#define APP_EXITCODE_FAILURE              2
+#define APP_EXITCODE_EXCEPTION            3
+
+namespace
+{
+FleetSimulator* pRunningSimulator {nullptr};
+
+void stopSimulation(int)
+{
+    if (pRunningSimulator) {
+        pRunningSimulator->stop();
+    }
+}
+}
+
+int main(int argc, char* argv[]) {
+    SimulationConfig config;
+    std::size_t durationSec {static_cast<std::size_t>(config.duration.count())};
+    std::size_t jitterMs {};
+    std::size_t fecGroups {};
+    std::string eventEncoding {"bin"};
+
+    bpo::options_description desc;
+    desc.add_options()
+            ("host",            bpo::value(&config.host),           "Address of server (127.0.0.1 by default)")
+            ("api-port",        bpo::value(&config.apiPort),        "Management API port of server, used for event subscription and streaming status (9001 by default)")
+            ("event-port",      bpo::value(&config.eventPort),      "Detector event port of server (9002 by default)")
+            ("stream-port",     bpo::value(&config.streamPort),     "UDP streaming port of server (9003 by default)")
+            ("first-id",        bpo::value(&config.firstDeviceId),  "Id of the first simulated detector, ids must be registered on server (1 by default)")
+            ("devices",         bpo::value(&config.deviceCount),    "Count of simulated detectors (10 by default)")
+            ("threads",         bpo::value(&config.threadCount),    "Threads sending frames and events (1 by default)")
+            ("duration",        bpo::value(&durationSec),           "Seconds of load (60 by default)")
+            ("fps",             bpo::value(&config.fps),            "Frames per second of every detector, 0 disables streaming (1 by default)")
+            ("width",           bpo::value(&config.frameWidth),     "Width of generated frame (640 by default)")
+            ("height",          bpo::value(&config.frameHeight),    "Height of generated frame (480 by default)")
+            ("video",                                               "Send cached frames of test video instead of generated frame")
+            ("video-frames",    bpo::value(&config.videoFrameCount), "Count of cached video frames (64 by default)")
+            ("fec-groups",      bpo::value(&fecGroups),             "FEC parity fragments of every frame (0 by default)")
+            ("mtu",             bpo::value(&config.mtuSize),        "Size of streaming datagrams")
+            ("loss",            bpo::value(&config.lossRatio),      "Probability of fragment loss, 0-1 (0 by default)")
+            ("jitter",          bpo::value(&jitterMs),              "Max random delay of frame in milliseconds (0 by default)")
+            ("event-rate",      bpo::value(&config.eventRate),      "Events per second of every detector, 0 disables events (1 by default)")
+            ("event-encoding",  bpo::value(&eventEncoding),         "Event channel encoding: bin (default) or json")
+            ;
+
+    bpo::variables_map vm;
+    try {
+        auto options = bpo::parse_command_line(argc, argv, desc, bpo::command_line_style::unix_style);
+        bpo::store(options, vm);
+        bpo::notify(vm);
+    } catch (bpo::error& er) {
+        std::cerr << er.what() << std::endl;
+        desc.print(std::cerr);
+        std::cerr << std::endl;
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+
+    // Check-up
+    if (fecGroups > UINT8_MAX) {
+        std::cerr << "Invalid FEC group count (must be in range 0-255): " << fecGroups << std::endl;
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+    if (config.mtuSize < Protocol::ImagePacket::MIN_MTU_SIZE || config.mtuSize > Protocol::ImagePacket::MAX_MTU_SIZE) {
+        std::cerr << "Invalid MTU size: " << config.mtuSize << std::endl;
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+    if (!Protocol::toEventEncoding(eventEncoding, config.eventEncoding)) {
+        std::cerr << "Invalid event encoding (must be json or bin): " << eventEncoding << std::endl;
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    }
+    config.duration         = std::chrono::seconds(durationSec);
+    config.jitter           = std::chrono::milliseconds(jitterMs);
+    config.fecGroupCount    = static_cast<uint8_t>(fecGroups);
+    config.isVideoFrames    = vm.count("video") != 0;
+
+    auto& dirManager = Common::DirectoryManager::getInstance();
+    dirManager.setRootPath(CCR_APP_TARGET_NAME);
+    COMPLOG_SET_LOGSDIR(dirManager.getDirectory(Common::DirectoryManager::Logs));
+
+    SimulationReport report;
+    try {
+        FleetSimulator simulator(config);
+        pRunningSimulator = &simulator;
+        std::signal(SIGINT, stopSimulation);
+        std::signal(SIGTERM, stopSimulation);
+
+        COMPLOG_INFO("Simulating", config.deviceCount, "detectors for", durationSec, "s, fps:", config.fps, "events/s:", config.eventRate);
+        const bool isDone = simulator.run(report);
+        pRunningSimulator = nullptr;
+        if (!isDone) {
+            COMPLOG_ERROR("Simulation failed:", simulator.getLastErrorText());
+            return APP_EXITCODE_FAILURE;
+        }
+    } catch (const std::invalid_argument& ex) {
+        std::cerr << "Invalid simulation config: " << ex.what() << std::endl;
+        return APP_EXITCODE_CONFIGURATION_ERROR;
+    } catch (const std::exception& ex) {
+        std::cerr << "CRITICAL: EXCEPTION: " << ex.what() << std::endl;
+        return APP_EXITCODE_EXCEPTION;
+    }
+
+    // Report
+    COMPLOG_INFO("Detectors connected:", report.connectedDevices, "of", report.devices,
+                 "accepted by server:", report.acceptedDevices);
+    COMPLOG_INFO("Frames sent:", report.sentFrames,
+                 "fragments:", report.sentFragments,
+                 "lost on purpose:", report.lostFragments,
+                 "retransmission requests:", report.nackRequests,
+                 "resent fragments:", report.resentFragments);
+    if (report.hasServerStreaming) {
+        COMPLOG_INFO("Frames completed by server:", report.serverCompletedFrames,
+                     "incomplete:", report.serverIncompleteFrames,
+                     "kernel drops:", report.serverKernelDrops,
+                     "completion ratio:", report.getFrameCompletionRatio());
+    } else {
+        COMPLOG_WARNING("Frame completion is unknown, server streaming status is not available");
+    }
+    COMPLOG_INFO("Events sent:", report.sentEvents,
+                 "not sent (disconnected):", report.failedEvents,
+                 "confirmed by server:", report.confirmedEvents,
+                 "unconfirmed (lost or dropped from subscription):", report.getUnconfirmedEvents(),
+                 "acceptance ratio:", report.getEventAcceptanceRatio());
+    COMPLOG_INFO("Event round trip (us) p50:", report.latencyP50Us,
+                 "p90:", report.latencyP90Us,
+                 "p99:", report.latencyP99Us,
+                 "max:", report.latencyMaxUs);
+    return APP_EXITCODE_OK;
+}
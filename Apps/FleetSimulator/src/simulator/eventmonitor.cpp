@@ -0,0 +1,172 @@
+#include "eventmonitor.hpp"
+
+#include "simulateddetector.hpp"
+
+#include <websocketpp/client.hpp>
+#include <websocketpp/config/asio_client.hpp>
+
+#include <Components/Logger/Logger.h>
+
+#include <ROD/Protocol.h>
+
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using Client = websocketpp::client<websocketpp::config::asio_client>;
+using ConnectionHdl = websocketpp::connection_hdl;
+using MessagePtr = websocketpp::config::asio_client::message_type::ptr;
+
+struct EventMonitor::Impl
+{
+    Client                              client;
+    websocketpp::lib::asio::io_service  ioService;
+    ConnectionHdl                       connection;
+    std::thread                         ioThread;
+
+    uint64_t    firstDeviceId {};
+    std::size_t deviceCount {};
+
+    mutable std::mutex      mx;
+    std::condition_variable connectionCv;
+    bool                    isConnectionDone {false};
+    bool                    isConnected {false};
+    MonitorStats            stats;
+
+    bool isSimulatedDevice(const std::string& deviceId) const {
+        uint64_t id {};
+        auto res = std::from_chars(deviceId.data(), deviceId.data() + deviceId.size(), id);
+        return (res.ec == std::errc()) && (id >= firstDeviceId) && (id - firstDeviceId < deviceCount);
+    }
+
+    void finishConnection(bool isSuccess) {
+        std::lock_guard<std::mutex> lock(mx);
+        isConnectionDone = true;
+        isConnected = isSuccess;
+        connectionCv.notify_all();
+    }
+};
+
+
+EventMonitor::EventMonitor() :
+    d {new Impl}
+{
+    d->client.clear_access_channels(websocketpp::log::alevel::all);
+    d->client.init_asio(&d->ioService);
+
+    d->client.set_open_handler([this](ConnectionHdl hdl) {
+        d->finishConnection(true);
+    });
+    d->client.set_fail_handler([this](ConnectionHdl hdl) {
+        COMPLOG_ERROR("[WS] Event subscription failed:", d->client.get_con_from_hdl(hdl)->get_ec().message());
+        d->finishConnection(false);
+    });
+    d->client.set_close_handler([this](ConnectionHdl hdl) {
+        COMPLOG_WARNING("[WS] Event subscription closed:", d->client.get_con_from_hdl(hdl)->get_remote_close_reason());
+        d->finishConnection(false);
+    });
+
+    d->client.set_message_handler([this](ConnectionHdl hdl, MessagePtr msg) {
+        const auto nowUs = getCurrentTimeUs();
+        std::vector<Protocol::Event> events;
+        if (!Protocol::readEvents(msg->get_payload(), Protocol::EventEncoding::Json, events)) {
+            COMPLOG_WARNING("[WS] Invalid events from subscription, size:", msg->get_payload().size());
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(d->mx);
+        for (auto& ev : events) {
+            switch (ev.getType()) {
+            case Protocol::EventType::DetectorConnected:
+                if (d->isSimulatedDevice(ev.getHeader(Protocol::EventHeaders::HEADER_DEVICE))) {
+                    d->stats.connectedDevices++;
+                }
+                break;
+
+            case Protocol::EventType::DetectedObject: {
+                const auto payload = ev.getPayload();
+                const auto& prefix = SimulatedDetector::EVENT_PAYLOAD_PREFIX;
+                if (payload.compare(0, prefix.size(), prefix) != 0 ||
+                    !d->isSimulatedDevice(ev.getHeader(Protocol::EventHeaders::HEADER_DEVICE))) {
+                    break; // Event of real detector
+                }
+                int64_t sentUs {};
+                std::from_chars(payload.data() + prefix.size(), payload.data() + payload.size(), sentUs);
+                d->stats.confirmedEvents++;
+                d->stats.latenciesUs.push_back(static_cast<uint32_t>(std::clamp<int64_t>(nowUs - sentUs, 0, UINT32_MAX)));
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+    });
+}
+
+EventMonitor::~EventMonitor()
+{
+    disconnect();
+}
+
+bool EventMonitor::connect(const std::string &host, uint16_t apiPort, uint64_t firstDeviceId, std::size_t deviceCount,
+                           std::chrono::milliseconds timeout)
+{
+    d->firstDeviceId = firstDeviceId;
+    d->deviceCount = deviceCount;
+
+    // Devices are filtered here, list of all ids does not fit URL. Dropped events are not replaced by summaries,
+    // which would merge events of one device and hide their latencies
+    const auto url = "ws://" + host + ":" + std::to_string(apiPort) + Protocol::API::EVENTS_SUBSCRIBE_BASE +
+                     "?types=" + Protocol::toString(Protocol::EventType::DetectorConnected) + "," +
+                     Protocol::toString(Protocol::EventType::DetectedObject) + "&policy=drop";
+    websocketpp::lib::error_code ec;
+    auto con = d->client.get_connection(url, ec);
+    if (ec) {
+        COMPLOG_ERROR("[WS] Event subscription:", ec.message());
+        return false;
+    }
+    d->connection = con->get_handle();
+    d->client.connect(con);
+    d->ioThread = std::thread([this]() {
+        d->client.run();
+    });
+
+    std::unique_lock<std::mutex> lock(d->mx);
+    d->connectionCv.wait_for(lock, timeout, [this]() {
+        return d->isConnectionDone;
+    });
+    return d->isConnected;
+}
+
+void EventMonitor::disconnect()
+{
+    bool isConnected {false};
+    {
+        std::lock_guard<std::mutex> lock(d->mx);
+        isConnected = d->isConnected;
+    }
+    if (isConnected) {
+        websocketpp::lib::error_code ec;
+        d->client.close(d->connection, websocketpp::close::status::normal, "Simulation finished", ec);
+    }
+    d->client.stop();
+    if (d->ioThread.joinable()) {
+        d->ioThread.join();
+    }
+}
+
+MonitorStats EventMonitor::getStats() const
+{
+    std::lock_guard<std::mutex> lock(d->mx);
+    auto stats = d->stats;
+    std::sort(stats.latenciesUs.begin(), stats.latenciesUs.end());
+    return stats;
+}
+
+int64_t EventMonitor::getCurrentTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+ * @brief The MonitorStats struct Events of simulated detectors seen by server
+ */
+struct MonitorStats
+{
+    uint64_t connectedDevices {};       // DetectorConnected published by server
+    uint64_t confirmedEvents {};        // Simulated events came back through subscription
+    std::vector<uint32_t> latenciesUs;  // Round trip of confirmed events, sorted
+};
+
+/**
+ * @brief The EventMonitor class Subscriber of server events, confirms events of simulated detectors
+ * @note Round trip is device -> event channel -> server processing -> subscriber push, so it includes
+ *       pacing of subscription sending
+ */
+class EventMonitor
+{
+public:
+    EventMonitor();
+    ~EventMonitor();
+
+    /**
+     * @brief connect       Subscribe to DetectorConnected and DetectedObject events of devices in range.
+     *                      Server drops the oldest events, when subscriber queue overflows (policy drop)
+     * @param timeout       Max waiting for subscription
+     * @return              false if subscription failed
+     */
+    bool connect(const std::string& host, uint16_t apiPort, uint64_t firstDeviceId, std::size_t deviceCount,
+                 std::chrono::milliseconds timeout);
+    void disconnect();
+
+    MonitorStats getStats() const;
+
+    /**
+     * @brief getCurrentTimeUs  Monotonic time used in payload of simulated events
+     */
+    static int64_t getCurrentTimeUs();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+};
@@ -0,0 +1,311 @@
+#include "fleetsimulator.hpp"
+
+#include "eventmonitor.hpp"
+#include "simulateddetector.hpp"
+
+#include <ROD/ImageProcessing/Utility.h>
+#include <ROD/ImageProcessing/VideoReader.h>
+#include <ROD/StreamingStatus.h>
+
+#include <Components/Logger/Logger.h>
+#include <Components/Common/DirectoryManager.h>
+
+#include <websocketpp/common/asio.hpp>
+
+#include <atomic>
+#include <functional>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr std::chrono::milliseconds SUBSCRIPTION_TIMEOUT {5000};
+constexpr std::chrono::milliseconds CONNECTION_TIMEOUT {10000};
+constexpr std::chrono::milliseconds DRAIN_TIME {2000};          // Waiting for last events and retransmissions
+
+// Server sends to subscriber up to 64 events per 50 ms (EventSubscriptionController), the rest is queued and dropped
+constexpr double SUBSCRIPTION_MAX_EVENT_RATE {64 * 1000.0 / 50};
+
+/**
+ * @brief The SendTask struct Next frame or event of detector
+ */
+struct SendTask
+{
+    Clock::time_point   time;
+    Clock::time_point   regularTime;    // Frame time without jitter
+    std::size_t         detectorNo {};
+    bool                isFrame {};
+
+    bool operator>(const SendTask& other) const {
+        return time > other.time;
+    }
+};
+
+uint32_t getPercentile(const std::vector<uint32_t>& sortedValues, double percentile)
+{
+    if (sortedValues.empty()) {
+        return 0;
+    }
+    const auto index = static_cast<std::size_t>(percentile * (sortedValues.size() - 1) + 0.5);
+    return sortedValues[std::min(index, sortedValues.size() - 1)];
+}
+}
+
+struct FleetSimulator::Impl
+{
+    SimulationConfig config;
+
+    std::vector<ImageProcessing::ImageData_t>       frames; // Shared by all detectors
+    std::vector<std::unique_ptr<SimulatedDetector>> detectors;
+    EventMonitor                                    monitor;
+
+    std::atomic<bool>   isRunning {false};
+    std::string         lastErrorText;
+};
+
+
+FleetSimulator::FleetSimulator(const SimulationConfig &config) :
+    d {new Impl}
+{
+    if (config.deviceCount == 0 || config.threadCount == 0) {
+        throw std::invalid_argument("Device and thread count must be positive");
+    }
+    if (config.firstDeviceId == 0 || config.firstDeviceId + config.deviceCount < config.firstDeviceId) {
+        throw std::invalid_argument("Device ids must be in range 1-UINT64_MAX");
+    }
+    if (config.fps < 0 || config.eventRate < 0 || config.lossRatio < 0 || config.lossRatio > 1 || config.jitter.count() < 0) {
+        throw std::invalid_argument("FPS, event rate and jitter must not be negative, loss ratio must be in range 0-1");
+    }
+    if (config.frameWidth <= 0 || config.frameHeight <= 0 || config.videoFrameCount == 0) {
+        throw std::invalid_argument("Frame size and count of video frames must be positive");
+    }
+    d->config = config;
+}
+
+FleetSimulator::~FleetSimulator()
+{
+    stop();
+}
+
+bool FleetSimulator::run(SimulationReport &oReport)
+{
+    if (d->config.fps > 0 && !prepareFrames()) {
+        return false;
+    }
+
+    checkSubscriptionThroughput();
+
+    // Subscription is opened first, so connections of detectors are seen
+    if (!d->monitor.connect(d->config.host, d->config.apiPort, d->config.firstDeviceId, d->config.deviceCount, SUBSCRIPTION_TIMEOUT)) {
+        d->lastErrorText = "Failed to subscribe to server events";
+        return false;
+    }
+    DataObjects::StreamingStatus streamingBefore;
+    const bool hasStreamingBefore = readServerStreaming(streamingBefore);
+
+    d->isRunning.store(true, std::memory_order_release);
+    connectDetectors();
+
+    SimulationReport report;
+    report.devices = d->config.deviceCount;
+    for (auto& pDetector : d->detectors) {
+        report.connectedDevices += pDetector->isConnected() ? 1 : 0;
+    }
+    COMPLOG_INFO("Connected detectors:", report.connectedDevices, "of", report.devices);
+
+    std::vector<std::thread> sendThreads;
+    for (std::size_t threadNo = 0; threadNo < std::min(d->config.threadCount, d->detectors.size()); ++threadNo) {
+        sendThreads.emplace_back([this, threadNo]() {
+            sendLoop(threadNo);
+        });
+    }
+    for (auto& sendThread : sendThreads) {
+        sendThread.join();
+    }
+
+    std::this_thread::sleep_for(DRAIN_TIME);
+    DataObjects::StreamingStatus streamingAfter;
+    report.hasServerStreaming = hasStreamingBefore && readServerStreaming(streamingAfter);
+    if (report.hasServerStreaming) {
+        report.serverCompletedFrames    = streamingAfter.frames.completed - streamingBefore.frames.completed;
+        report.serverIncompleteFrames   = streamingAfter.frames.incomplete - streamingBefore.frames.incomplete;
+        report.serverKernelDrops        = streamingAfter.receive.kernelDrops - streamingBefore.receive.kernelDrops;
+    }
+
+    for (auto& pDetector : d->detectors) {
+        auto stats = pDetector->getStats();
+        report.sentFrames       += stats.frames;
+        report.sentFragments    += stats.fragments;
+        report.lostFragments    += stats.lostFragments;
+        report.nackRequests     += stats.nackRequests;
+        report.resentFragments  += stats.resentFragments;
+        report.sentEvents       += stats.events;
+        report.failedEvents     += stats.failedEvents;
+        pDetector->disconnect();
+    }
+    d->monitor.disconnect();
+
+    auto monitorStats = d->monitor.getStats();
+    report.acceptedDevices  = monitorStats.connectedDevices;
+    report.confirmedEvents  = monitorStats.confirmedEvents;
+    report.latencyP50Us     = getPercentile(monitorStats.latenciesUs, 0.50);
+    report.latencyP90Us     = getPercentile(monitorStats.latenciesUs, 0.90);
+    report.latencyP99Us     = getPercentile(monitorStats.latenciesUs, 0.99);
+    report.latencyMaxUs     = monitorStats.latenciesUs.empty() ? 0 : monitorStats.latenciesUs.back();
+
+    oReport = report;
+    return true;
+}
+
+void FleetSimulator::stop()
+{
+    d->isRunning.store(false, std::memory_order_release);
+}
+
+std::string_view FleetSimulator::getLastErrorText() const
+{
+    return d->lastErrorText;
+}
+
+bool FleetSimulator::prepareFrames()
+{
+    d->frames.clear();
+    if (!d->config.isVideoFrames) {
+        d->frames.push_back(ImageProcessing::Utility::generateTestImageBytes(d->config.frameWidth, d->config.frameHeight));
+        return true;
+    }
+
+    // Video is decoded once, detectors send cached frames in cycle
+    auto& dirManager = Common::DirectoryManager::getInstance();
+    auto videoFile = dirManager.getDirectory(Common::DirectoryManager::Data) / "translation_test.mp4";
+    ImageProcessing::VideoReader videoReader;
+    if (!videoReader.setVideofile(videoFile)) {
+        d->lastErrorText = "Failed to open test video: " + videoFile.string();
+        return false;
+    }
+    for (auto frameIt = videoReader.begin(); frameIt != videoReader.end() && d->frames.size() < d->config.videoFrameCount; ++frameIt) {
+        d->frames.push_back(*frameIt);
+    }
+    if (d->frames.empty()) {
+        d->lastErrorText = "No frames in test video: " + videoFile.string();
+        return false;
+    }
+    return true;
+}
+
+void FleetSimulator::connectDetectors()
+{
+    // All detectors connect at once, as after server restart
+    d->detectors.clear();
+    for (std::size_t detectorNo = 0; detectorNo < d->config.deviceCount; ++detectorNo) {
+        auto pDetector = std::make_unique<SimulatedDetector>(d->config.firstDeviceId + detectorNo, d->config);
+        if (!pDetector->connect()) {
+            continue;
+        }
+        d->detectors.push_back(std::move(pDetector));
+    }
+
+    const auto deadline = Clock::now() + CONNECTION_TIMEOUT;
+    while (Clock::now() < deadline && d->isRunning.load(std::memory_order_acquire)) {
+        const auto connectedCount = std::count_if(d->detectors.begin(), d->detectors.end(), [](auto& pDetector) {
+            return pDetector->isConnected();
+        });
+        if (static_cast<std::size_t>(connectedCount) == d->detectors.size()) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+}
+
+void FleetSimulator::sendLoop(std::size_t threadNo)
+{
+    std::mt19937_64 random(threadNo + 1);
+    std::priority_queue<SendTask, std::vector<SendTask>, std::greater<SendTask>> tasks;
+
+    const auto startTime = Clock::now();
+    const auto deadline = startTime + d->config.duration;
+    const auto frameInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(d->config.fps > 0 ? 1.0 / d->config.fps : 0.0));
+    std::uniform_int_distribution<Clock::rep> phaseDist(0, std::max<Clock::rep>(frameInterval.count() - 1, 0));
+    std::uniform_int_distribution<Clock::rep> jitterDist(0, std::chrono::duration_cast<Clock::duration>(d->config.jitter).count());
+    std::exponential_distribution<double> eventIntervalDist(d->config.eventRate > 0 ? d->config.eventRate : 1.0);
+    auto getNextEventTime = [&](Clock::time_point time) {
+        return time + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(eventIntervalDist(random)));
+    };
+
+    // Detectors of thread are every threadCount-th ones, frames start with random phase
+    std::vector<std::size_t> frameNos(d->detectors.size());
+    for (auto detectorNo = threadNo; detectorNo < d->detectors.size(); detectorNo += d->config.threadCount) {
+        if (d->config.fps > 0) {
+            const auto regularTime = startTime + Clock::duration(phaseDist(random));
+            tasks.push({regularTime + Clock::duration(jitterDist(random)), regularTime, detectorNo, true});
+        }
+        if (d->config.eventRate > 0) {
+            const auto eventTime = getNextEventTime(startTime);
+            tasks.push({eventTime, eventTime, detectorNo, false});
+        }
+    }
+
+    while (!tasks.empty() && d->isRunning.load(std::memory_order_acquire)) {
+        auto task = tasks.top();
+        if (task.time >= deadline) {
+            break;
+        }
+        tasks.pop();
+        std::this_thread::sleep_until(task.time);
+
+        auto& detector = *d->detectors[task.detectorNo];
+        if (task.isFrame) {
+            auto& frameNo = frameNos[task.detectorNo];
+            detector.sendFrame(d->frames[frameNo]);
+            frameNo = (frameNo + 1) % d->frames.size();
+
+            const auto regularTime = task.regularTime + frameInterval;
+            tasks.push({regularTime + Clock::duration(jitterDist(random)), regularTime, task.detectorNo, true});
+        } else {
+            detector.sendEvent(EventMonitor::getCurrentTimeUs());
+            const auto eventTime = getNextEventTime(task.time);
+            tasks.push({eventTime, eventTime, task.detectorNo, false});
+        }
+    }
+}
+
+void FleetSimulator::checkSubscriptionThroughput() const
+{
+    const auto eventRate = d->config.eventRate * static_cast<double>(d->config.deviceCount);
+    if (eventRate > SUBSCRIPTION_MAX_EVENT_RATE) {
+        COMPLOG_WARNING("Event rate of fleet", eventRate, "/s exceeds subscription throughput", SUBSCRIPTION_MAX_EVENT_RATE,
+                        "/s, acceptance is limited by subscription, not by server");
+    }
+}
+
+bool FleetSimulator::readServerStreaming(DataObjects::StreamingStatus &oStatus) const
+{
+    try {
+        websocketpp::lib::asio::ip::tcp::iostream stream(d->config.host, std::to_string(d->config.apiPort));
+        if (!stream) {
+            COMPLOG_WARNING("Server streaming status is not available:", stream.error().message());
+            return false;
+        }
+        stream << "GET " << Protocol::API::SERVER_STREAMING_BASE << " HTTP/1.0\r\n"
+               << "Host: " << d->config.host << "\r\n\r\n" << std::flush;
+
+        std::string line;
+        std::getline(stream, line);
+        if (line.find(" 200 ") == std::string::npos) {
+            COMPLOG_WARNING("Server streaming status is not available:", line);
+            return false;
+        }
+        while (std::getline(stream, line) && line != "\r") {
+            // Headers
+        }
+        const std::string body((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        return oStatus.readJson(body);
+    } catch (const std::exception& ex) {
+        COMPLOG_WARNING("Server streaming status is not available:", ex.what());
+        return false;
+    }
+}
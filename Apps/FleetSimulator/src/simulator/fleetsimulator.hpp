@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <string_view>
+#include <stdint.h>
+
+#include "simulationconfig.hpp"
+
+namespace DataObjects {
+struct StreamingStatus;
+}
+
+/**
+ * @brief The SimulationReport struct Result of simulation, server side values are measured by server
+ */
+struct SimulationReport
+{
+    // Connections
+    std::size_t devices {};
+    std::size_t connectedDevices {};        // Event channel opened
+    std::size_t acceptedDevices {};         // DetectorConnected published by server
+
+    // Streaming
+    uint64_t sentFrames {};
+    uint64_t sentFragments {};
+    uint64_t lostFragments {};
+    uint64_t nackRequests {};
+    uint64_t resentFragments {};
+    bool     hasServerStreaming {false};    // Server streaming status was read before and after simulation
+    uint64_t serverCompletedFrames {};      // Completed by server during simulation (of all senders)
+    uint64_t serverIncompleteFrames {};
+    uint64_t serverKernelDrops {};
+
+    // Events
+    uint64_t sentEvents {};
+    uint64_t failedEvents {};               // Not sent, event channel was disconnected
+    uint64_t confirmedEvents {};            // Came back through server subscription
+    uint32_t latencyP50Us {};
+    uint32_t latencyP90Us {};
+    uint32_t latencyP99Us {};
+    uint32_t latencyMaxUs {};
+
+    double getFrameCompletionRatio() const {
+        return sentFrames ? std::min(1.0, static_cast<double>(serverCompletedFrames) / sentFrames) : 0.0;
+    }
+    // Lost by server or dropped from subscription queue, when event rate exceeds subscription throughput
+    uint64_t getUnconfirmedEvents() const {
+        return sentEvents - std::min(sentEvents, confirmedEvents);
+    }
+    double getEventAcceptanceRatio() const {
+        return sentEvents ? std::min(1.0, static_cast<double>(confirmedEvents) / sentEvents) : 0.0;
+    }
+};
+
+/**
+ * @brief The FleetSimulator class Emulates many detectors from one process for server load testing
+ * @note Every detector has own event channel (EventEndpoint of detector) and streaming socket.
+ *       Frames and events of all detectors are sent by a few threads, every thread sleeps until its nearest send
+ */
+class FleetSimulator
+{
+public:
+    /**
+     * @throws std::invalid_argument on invalid config
+     */
+    explicit FleetSimulator(const SimulationConfig& config);
+    ~FleetSimulator();
+
+    /**
+     * @brief run   Connect detectors, send load for duration of config and collect report. Blocks
+     * @return      false if simulation could not start (no frames, no subscription), see getLastErrorText
+     */
+    bool run(SimulationReport& oReport);
+
+    /**
+     * @brief stop  Finish running simulation early, report is still collected. Thread-safe
+     */
+    void stop();
+
+    std::string_view getLastErrorText() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+
+    bool prepareFrames();
+    void connectDetectors();
+    void sendLoop(std::size_t threadNo);
+    void checkSubscriptionThroughput() const;
+    bool readServerStreaming(DataObjects::StreamingStatus& oStatus) const;
+};
@@ -0,0 +1,178 @@
+#include "simulateddetector.hpp"
+
+#include "endpoint/eventendpoint.hpp"
+
+#include <Components/Logger/Logger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <numeric>
+#include <random>
+
+struct SimulatedDetector::Impl
+{
+    uint64_t            deviceId {};
+    SimulationConfig    config;
+
+    EventEndpoint       eventEndpoint;
+
+    // Streaming, sender is used by event thread too (retransmission)
+    std::mutex                          sendMx;
+    Protocol::ImageStreamSender         streamingSender;
+    std::deque<Protocol::SendableImage> retransmitCache; // Newest at back
+    uint64_t                            currentImageId {1};
+    std::mt19937_64                     random;
+    std::bernoulli_distribution         lossDist;
+    std::vector<uint64_t>               keptFragmentNos;
+
+    // Stats
+    std::atomic<uint64_t> frames {};
+    std::atomic<uint64_t> fragments {};
+    std::atomic<uint64_t> lostFragments {};
+    std::atomic<uint64_t> nackRequests {};
+    std::atomic<uint64_t> resentFragments {};
+    std::atomic<uint64_t> events {};
+    std::atomic<uint64_t> failedEvents {};
+
+    // Fragments surviving lossy link
+    void selectKeptFragments(const std::vector<uint64_t>& fragmentNos) {
+        keptFragmentNos.clear();
+        for (auto fragmentNo : fragmentNos) {
+            if (!lossDist(random)) {
+                keptFragmentNos.push_back(fragmentNo);
+            }
+        }
+        lostFragments.fetch_add(fragmentNos.size() - keptFragmentNos.size(), std::memory_order_relaxed);
+    }
+};
+
+
+SimulatedDetector::SimulatedDetector(uint64_t deviceId, const SimulationConfig &config) :
+    d {new Impl}
+{
+    d->deviceId = deviceId;
+    d->config = config;
+    d->random.seed(deviceId);
+    d->lossDist = std::bernoulli_distribution(std::clamp(config.lossRatio, 0.0, 1.0));
+
+    d->eventEndpoint.setDeviceId(static_cast<long long>(deviceId));
+    d->eventEndpoint.setServer(config.host, config.eventPort);
+    d->eventEndpoint.setEncoding(config.eventEncoding);
+    d->eventEndpoint.getEventProcessor().setEventProcessor(Protocol::EventType::FragmentsRequested, [this](Protocol::Event&& ev) {
+        Protocol::FragmentNack nack;
+        if (!nack.readRaw(ev.getPayload())) {
+            COMPLOG_WARNING("Invalid fragments request to device", d->deviceId, ":", ev.getPayload());
+            return;
+        }
+        resendFragments(nack);
+    });
+}
+
+SimulatedDetector::~SimulatedDetector()
+{
+    disconnect();
+}
+
+uint64_t SimulatedDetector::getDeviceId() const
+{
+    return d->deviceId;
+}
+
+bool SimulatedDetector::connect()
+{
+    {
+        std::lock_guard<std::mutex> lock(d->sendMx);
+        if (!d->streamingSender.setHost(d->config.host, d->config.streamPort)) {
+            COMPLOG_ERROR("Failed to setup streaming of device", d->deviceId, ":", d->streamingSender.getLastErrorText());
+            return false;
+        }
+    }
+    d->eventEndpoint.connect();
+    return true;
+}
+
+bool SimulatedDetector::isConnected() const
+{
+    return d->eventEndpoint.isConnected();
+}
+
+void SimulatedDetector::disconnect()
+{
+    d->eventEndpoint.disconnect();
+    std::lock_guard<std::mutex> lock(d->sendMx);
+    d->streamingSender.close();
+}
+
+void SimulatedDetector::sendFrame(const ImageProcessing::ImageData_t &frameData)
+{
+    Protocol::SendableImage img;
+    img.setSenderId(d->deviceId);
+    img.setFecGroupCount(d->config.fecGroupCount);
+    img.setMtuSize(d->config.mtuSize);
+
+    std::lock_guard<std::mutex> lock(d->sendMx);
+    img.setImage(d->currentImageId++, ImageProcessing::ImageData_t(frameData));
+
+    std::vector<uint64_t> fragmentNos(img.getFragmentCount());
+    std::iota(fragmentNos.begin(), fragmentNos.end(), 0);
+    d->selectKeptFragments(fragmentNos);
+    if (!d->streamingSender.sendFragments(img, d->keptFragmentNos)) {
+        COMPLOG_WARNING("Failed to send frame of device", d->deviceId, ":", d->streamingSender.getLastErrorText());
+    }
+    d->frames.fetch_add(1, std::memory_order_relaxed);
+    d->fragments.fetch_add(fragmentNos.size(), std::memory_order_relaxed);
+
+    if (d->retransmitCache.size() >= RETRANSMIT_CACHE_SIZE) {
+        d->retransmitCache.pop_front();
+    }
+    d->retransmitCache.push_back(std::move(img));
+}
+
+void SimulatedDetector::sendEvent(int64_t sentUs)
+{
+    Protocol::Event ev;
+    ev.setType(Protocol::EventType::DetectedObject);
+    ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, std::to_string(d->deviceId));
+    ev.setPayload(std::string(EVENT_PAYLOAD_PREFIX) + std::to_string(sentUs));
+    if (!d->eventEndpoint.sendEvent(std::move(ev))) {
+        d->failedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    d->events.fetch_add(1, std::memory_order_relaxed);
+}
+
+DetectorStats SimulatedDetector::getStats() const
+{
+    DetectorStats stats;
+    stats.frames            = d->frames.load(std::memory_order_relaxed);
+    stats.fragments         = d->fragments.load(std::memory_order_relaxed);
+    stats.lostFragments     = d->lostFragments.load(std::memory_order_relaxed);
+    stats.nackRequests      = d->nackRequests.load(std::memory_order_relaxed);
+    stats.resentFragments   = d->resentFragments.load(std::memory_order_relaxed);
+    stats.events            = d->events.load(std::memory_order_relaxed);
+    stats.failedEvents      = d->failedEvents.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void SimulatedDetector::resendFragments(const Protocol::FragmentNack &nack)
+{
+    d->nackRequests.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(d->sendMx);
+    auto cachedImg = std::find_if(d->retransmitCache.begin(), d->retransmitCache.end(), [&nack](auto& img) {
+        return (img.getId() == nack.shotId) && (img.getStreamId() == nack.streamId);
+    });
+    if (cachedImg == d->retransmitCache.end()) {
+        return;
+    }
+
+    // Retransmission goes through the same lossy link
+    d->selectKeptFragments(nack.fragmentNos);
+    if (!d->streamingSender.sendFragments(*cachedImg, d->keptFragmentNos)) {
+        COMPLOG_WARNING("Failed to resend fragments of device", d->deviceId, ":", d->streamingSender.getLastErrorText());
+        return;
+    }
+    d->resentFragments.fetch_add(d->keptFragmentNos.size(), std::memory_order_relaxed);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <stdint.h>
+
+#include <ROD/ImageProcessing/Common.h>
+
+#include "simulationconfig.hpp"
+
+/**
+ * @brief The DetectorStats struct Counters of one simulated detector
+ */
+struct DetectorStats
+{
+    uint64_t frames {};
+    uint64_t fragments {};          // Fragments of sent frames, including lost ones
+    uint64_t lostFragments {};      // Not sent on purpose
+    uint64_t nackRequests {};       // Retransmission requests from server
+    uint64_t resentFragments {};
+    uint64_t events {};
+    uint64_t failedEvents {};       // Not sent, event channel was disconnected
+};
+
+/**
+ * @brief The SimulatedDetector class Detector without camera: real event channel and UDP streaming with lossy link
+ * @note sendFrame and sendEvent are called by one simulation thread, retransmissions run in event thread
+ */
+class SimulatedDetector
+{
+public:
+    SimulatedDetector(uint64_t deviceId, const SimulationConfig& config);
+    ~SimulatedDetector();
+
+    uint64_t getDeviceId() const;
+
+    /**
+     * @brief connect   Open streaming socket and start connecting event channel (asynchronously)
+     * @return          false if streaming socket can not be opened
+     */
+    bool connect();
+    bool isConnected() const;
+    void disconnect();
+
+    /**
+     * @brief sendFrame Send frame as next image of stream 0, every fragment is lost with loss ratio of config
+     */
+    void sendFrame(const ImageProcessing::ImageData_t& frameData);
+
+    /**
+     * @brief sendEvent Send DetectedObject event carrying its send time, server echoes it to subscribers
+     * @param sentUs    Monotonic time of sending
+     */
+    void sendEvent(int64_t sentUs);
+
+    DetectorStats getStats() const;
+
+    // Count of last sent images kept for retransmission, as real detector does
+    static constexpr std::size_t RETRANSMIT_CACHE_SIZE {8};
+
+    // Payload of simulated events is prefix and send time in microseconds
+    static constexpr std::string_view EVENT_PAYLOAD_PREFIX {"fleet-simulator:"};
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+
+    void resendFragments(const Protocol::FragmentNack& nack);
+};
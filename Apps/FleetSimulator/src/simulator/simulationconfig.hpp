@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <stdint.h>
+
+#include <ROD/Protocol.h>
+
+/**
+ * @brief The SimulationConfig struct Load generated by simulated detectors
+ */
+struct SimulationConfig
+{
+    // Server
+    std::string host {"127.0.0.1"};
+    uint16_t    apiPort {9001};
+    uint16_t    eventPort {9002};
+    uint16_t    streamPort {9003};
+
+    // Fleet, ids must be registered on server
+    uint64_t    firstDeviceId {1};
+    std::size_t deviceCount {10};
+    std::size_t threadCount {1};                // Threads sending frames and events of all detectors
+    std::chrono::seconds duration {60};
+
+    // Frames
+    double      fps {1.0};
+    int         frameWidth {640};
+    int         frameHeight {480};
+    bool        isVideoFrames {false};          // Cached frames of test video instead of generated one
+    std::size_t videoFrameCount {64};
+    uint8_t     fecGroupCount {};
+    std::size_t mtuSize {Protocol::ImagePacket::MTU_SIZE};
+    double      lossRatio {};                   // Probability of fragment not to be sent (retransmissions too)
+    std::chrono::microseconds jitter {};        // Max delay of frame after its regular time
+
+    // Events
+    double      eventRate {1.0};                // Events per second of every detector (Poisson arrivals)
+    Protocol::EventEncoding eventEncoding {Protocol::EventEncoding::Binary};
+};
@@ -1,5 +1,7 @@
 #include "detector.hpp"
 
+#include <QDateTime>
+
 #include "server.hpp"
 
 namespace Web {
@@ -59,4 +61,13 @@ void Detector::commitConfigurationUpdate()
     emit visibleDataChanged();
 }
 
+void Detector::setOnline(bool isOnline)
+{
+    // Zero time means online now
+    const int64_t lastOnlineTime = isOnline ? 0 : QDateTime::currentSecsSinceEpoch();
+    d->config.source().online.lastOnlineTimeUTC = lastOnlineTime;
+    d->config->online.lastOnlineTimeUTC = lastOnlineTime;
+    emit visibleDataChanged();
+}
+
 } // namespace Web
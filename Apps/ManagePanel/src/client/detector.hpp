@@ -37,6 +37,7 @@ private:
     void replaceConfiguration(const DataObjects::DetectorConfiguration& conf);
     const DataObjects::DetectorConfiguration &getPendingConfiguration() const;
     void commitConfigurationUpdate();
+    void setOnline(bool isOnline); // From server events, not a configuration change
 };
 
 } // namespace Web
@@ -27,6 +27,19 @@ struct DetectorServer::Impl
         }
         detectorInfoInterface.requestUpdateDetectorInfo(hdl->getPendingConfiguration());
     }
+
+    DetectorHandler findDetector(const std::string& detId) {
+        for (auto& det : detectors) {
+            if (!det.isValid()) {
+                continue;
+            }
+            auto& confId = det->getConfiguration().system.id;
+            if (confId.has_value() && std::to_string(confId.value()) == detId) {
+                return det;
+            }
+        }
+        return {};
+    }
 };
 
 DetectorServer::DetectorServer(int64_t serverId, ServerRegistry *parent)
@@ -42,6 +55,21 @@ DetectorServer::DetectorServer(int64_t serverId, ServerRegistry *parent)
             }
         }
     });
+
+    // Detector state is updated by server events, not by list requests. Other events are not shown
+    setEventTypes({Protocol::EventType::DetectorConnected, Protocol::EventType::DetectorDisconnected});
+    connect(this, &Server::gotEvent,
+            this, [this](const Protocol::Event& ev) {
+        auto det = d->findDetector(ev.getHeader(Protocol::EventHeaders::HEADER_DEVICE));
+        if (!det.isValid()) {
+            return;
+        }
+        if (ev.getType() == Protocol::EventType::DetectorConnected) {
+            det->setOnline(true);
+        } else if (ev.getType() == Protocol::EventType::DetectorDisconnected) {
+            det->setOnline(false);
+        }
+    });
 }
 
 DetectorServer::~DetectorServer()
@@ -0,0 +1,115 @@
+#include "eventsubscriber.hpp"
+
+#include <QTimer>
+#include <QUrl>
+#include <QWebSocket>
+
+#include <Components/Logger/Logger.h>
+
+namespace Web::Implementation
+{
+
+static const int RECONNECT_INTERVAL_MS {3000};
+
+struct EventSubscriber::Impl
+{
+    QWebSocket  socket;
+    QTimer      reconnectTimer;
+    QString     serverAddress;
+    QStringList deviceIds;
+    QStringList eventTypes;
+    bool        isConnected {false};
+    uint64_t    droppedCount {};
+};
+
+EventSubscriber::EventSubscriber(QObject *parent)
+    : QObject{parent},
+    d {new Impl()}
+{
+    d->reconnectTimer.setSingleShot(true);
+    d->reconnectTimer.setInterval(RECONNECT_INTERVAL_MS);
+    connect(&d->reconnectTimer, &QTimer::timeout,
+            this, &EventSubscriber::openConnection);
+
+    connect(&d->socket, &QWebSocket::connected,
+            this, [this]() {
+        d->isConnected = true;
+        emit connectionChanged(true);
+    });
+    connect(&d->socket, &QWebSocket::disconnected,
+            this, [this]() {
+        if (d->isConnected) {
+            d->isConnected = false;
+            emit connectionChanged(false);
+        }
+        if (!d->serverAddress.isEmpty()) {
+            d->reconnectTimer.start();
+        }
+    });
+    connect(&d->socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error),
+            this, [this](auto) {
+        // Failed connection attempt does not emit disconnected
+        if (!d->isConnected && !d->serverAddress.isEmpty() && !d->reconnectTimer.isActive()) {
+            d->reconnectTimer.start();
+        }
+    });
+    connect(&d->socket, &QWebSocket::textMessageReceived,
+            this, &EventSubscriber::processMessage);
+}
+
+EventSubscriber::~EventSubscriber()
+{
+    d->serverAddress.clear();
+    d->socket.blockSignals(true);
+    d->socket.close();
+}
+
+void EventSubscriber::setFilter(const QStringList &deviceIds, const QStringList &eventTypes)
+{
+    d->deviceIds = deviceIds;
+    d->eventTypes = eventTypes;
+}
+
+void EventSubscriber::setServer(const QString &serverAddress)
+{
+    d->serverAddress = serverAddress;
+    d->reconnectTimer.stop();
+    if (d->socket.state() != QAbstractSocket::UnconnectedState) {
+        d->socket.abort(); // Reconnection is started by disconnected signal
+        return;
+    }
+    openConnection();
+}
+
+bool EventSubscriber::isConnected() const
+{
+    return d->isConnected;
+}
+
+void EventSubscriber::openConnection()
+{
+    if (d->serverAddress.isEmpty()) {
+        return;
+    }
+    auto target = QString::fromStdString(Protocol::API::QT::EVENTS_SUBSCRIBE).arg(
+        d->deviceIds.join(','), d->eventTypes.join(','), "summarize");
+    d->socket.open(QUrl("ws://" + d->serverAddress + target));
+}
+
+void EventSubscriber::processMessage(const QString &message)
+{
+    std::vector<Protocol::Event> events;
+    if (!Protocol::readEvents(message.toStdString(), Protocol::EventEncoding::Json, events)) {
+        COMPLOG_WARNING("Invalid event message from server:", d->serverAddress.toStdString());
+        return;
+    }
+    for (auto& ev : events) {
+        if (ev.getType() == Protocol::EventType::EventsDropped) {
+            d->droppedCount += QString::fromStdString(ev.getPayload()).toULongLong();
+            COMPLOG_WARNING("Server dropped events for slow subscription, total:", d->droppedCount);
+        }
+        emit gotEvent(ev);
+    }
+}
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+
+#include <ROD/Protocol.h>
+
+namespace Web::Implementation
+{
+
+/**
+ * @brief The EventSubscriber class Receives events pushed by server over WebSocket, reconnects while server is set
+ */
+class EventSubscriber : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EventSubscriber(QObject *parent = nullptr);
+    ~EventSubscriber();
+
+    /**
+     * @brief setFilter Events to subscribe, applied on next connection. Empty lists mean any device or type
+     */
+    void setFilter(const QStringList& deviceIds, const QStringList& eventTypes);
+
+    /**
+     * @brief setServer     Connect to server, previous connection is closed
+     * @param serverAddress Already checked, correct server address if format ip:port. Empty one disconnects
+     */
+    void setServer(const QString& serverAddress);
+
+    bool isConnected() const;
+
+signals:
+    void connectionChanged(bool isConnected);
+    void gotEvent(const Protocol::Event& ev);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+
+    void openConnection();
+    void processMessage(const QString& message);
+};
+
+}
@@ -5,6 +5,7 @@
 #include <Components/Logger/Logger.h>
 
 #include "implementation/servermanager.hpp"
+#include "implementation/eventsubscriber.hpp"
 #include "common/serverconfiguration.hpp"
 #include "serverregistry.hpp"
 
@@ -17,6 +18,7 @@ struct Server::Impl
     // Common server properties
     int64_t             serverId {};
     ServerManager       serverInterface;
+    EventSubscriber     eventSubscriber;
     CommitableObject<ServerConfiguration> configuration;
     bool                cache_isServerAvailable {false};
 };
@@ -35,6 +37,15 @@ Server::Server(int64_t serverId, ServerRegistry *parent)
             emit gotStatus({});
         }
     });
+
+    // Server availability is known from subscription, it is reconnected in background
+    connect(&d->eventSubscriber, &EventSubscriber::connectionChanged,
+            this, [this](bool isConnected) {
+        d->cache_isServerAvailable = isConnected;
+        emit visibleDataChanged();
+    });
+    connect(&d->eventSubscriber, &EventSubscriber::gotEvent,
+            this, &Server::gotEvent);
 }
 
 Server::~Server()
@@ -120,10 +131,20 @@ void Server::commitConfigurationUpdate()
     emit visibleDataChanged();
 }
 
+void Server::setEventTypes(const std::vector<Protocol::EventType> &eventTypes)
+{
+    QStringList typeNames;
+    for (auto etype : eventTypes) {
+        typeNames.append(QString::fromStdString(Protocol::toString(etype)));
+    }
+    d->eventSubscriber.setFilter({}, typeNames);
+}
+
 void Server::updateServerAddress()
 {
     auto serverAddr = d->configuration->getHost() + ":" + QString::number(d->configuration->getPort());
     d->serverInterface.setServer(serverAddr);
+    d->eventSubscriber.setServer(serverAddr);
     ping();
 }
 
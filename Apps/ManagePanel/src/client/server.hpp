@@ -3,9 +3,11 @@
 #include <QObject>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include <ROD/DetectorConfiguration.h>
 #include <ROD/DeviceStatus.h>
+#include <ROD/Protocol.h>
 
 #include "handlers.hpp"
 #include "common/commitableobject.hpp"
@@ -31,7 +33,7 @@ public:
     int64_t getId() const;
 
     void ping();
-    bool isServerAvailable() const; // Returns last ping result
+    bool isServerAvailable() const; // Returns last ping or event subscription state
 
     void requestPoweroff() const;
     void requestReboot() const;
@@ -46,6 +48,8 @@ signals:
 
     void gotStatus(const DataObjects::DeviceStatus& devStatus);
 
+    void gotEvent(const Protocol::Event& ev); // Pushed by server, no polling required
+
     void configurationChanged();
 
 private:
@@ -58,6 +62,11 @@ private:
 
 protected:
     virtual void updateServerAddress(); // Must be called last in overriden functions
+
+    /**
+     * @brief setEventTypes Events server pushes to gotEvent, applied on next connection. Empty list means any type
+     */
+    void setEventTypes(const std::vector<Protocol::EventType>& eventTypes);
 };
 
 } // namespace Web
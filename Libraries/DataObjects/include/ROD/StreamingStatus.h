@@ -0,0 +1 @@
+#include "../../src/streamingstatus.hpp"
@@ -0,0 +1,50 @@
+#include "streamingstatus.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <Components/Logger/Logger.h>
+
+namespace DataObjects {
+
+std::string StreamingStatus::toJson() const
+{
+    nlohmann::json res;
+    res["receive"]["datagrams"]     = receive.datagrams;
+    res["receive"]["kernel_drops"]  = receive.kernelDrops;
+
+    res["frames"]["completed"]      = frames.completed;
+    res["frames"]["incomplete"]     = frames.incomplete;
+    res["frames"]["corrupted"]      = frames.corrupted;
+    res["frames"]["fec_recovered_fragments"]    = frames.fecRecoveredFragments;
+    res["frames"]["nack_requests"]              = frames.nackRequests;
+    res["frames"]["nack_recovered"]             = frames.nackRecoveredFrames;
+
+    m_error.setErrorCode(ErrorCodes::NoError);
+    return res.dump();
+}
+
+bool StreamingStatus::readJson(const std::string &iString)
+{
+    try {
+        auto statusJson = nlohmann::json::parse(iString);
+
+        receive.datagrams   = statusJson["receive"]["datagrams"];
+        receive.kernelDrops = statusJson["receive"]["kernel_drops"];
+
+        frames.completed    = statusJson["frames"]["completed"];
+        frames.incomplete   = statusJson["frames"]["incomplete"];
+        frames.corrupted    = statusJson["frames"]["corrupted"];
+        frames.fecRecoveredFragments    = statusJson["frames"]["fec_recovered_fragments"];
+        frames.nackRequests             = statusJson["frames"]["nack_requests"];
+        frames.nackRecoveredFrames      = statusJson["frames"]["nack_recovered"];
+
+        m_error.setErrorCode(ErrorCodes::NoError);
+    } catch (nlohmann::json::exception& ex) {
+        COMPLOG_ERROR("Parse error:", ex.what());
+        m_error.setErrorCode(ErrorCodes::ProtocolJsonException);
+        return false;
+    }
+    return true;
+}
+
+} // namespace DataObjects
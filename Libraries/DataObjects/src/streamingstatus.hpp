@@ -0,0 +1,41 @@
+#pragma once
+
+#include <ROD/Error.h>
+#include "serializableobject.hpp"
+
+#include <string>
+#include <stdint.h>
+
+namespace DataObjects {
+
+/**
+ * @brief The StreamingStatus class Counters of image streaming on server since start
+ */
+struct StreamingStatus : public SerializableObject,
+                         public ErrorUser
+{
+    struct ReceiveInfo
+    {
+        uint64_t    datagrams       {};
+        uint64_t    kernelDrops     {};
+    };
+    ReceiveInfo receive {};
+
+    struct FrameInfo
+    {
+        uint64_t    completed       {};
+        uint64_t    incomplete      {};
+        uint64_t    corrupted       {};
+        uint64_t    fecRecoveredFragments   {};
+        uint64_t    nackRequests            {};
+        uint64_t    nackRecoveredFrames     {};
+    };
+    FrameInfo frames {};
+
+    // SerializableObject interface
+    std::string toJson() const override;
+    bool readJson(const std::string& iString) override;
+};
+
+
+} // namespace DataObjects
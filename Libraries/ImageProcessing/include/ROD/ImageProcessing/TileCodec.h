@@ -0,0 +1 @@
+#include "../../../src/tilecodec.hpp"
@@ -86,6 +86,11 @@ ImageData_t CameraAdaptor::shot()
     return Utility::serializeMat(img);
 }
 
+cv::Mat CameraAdaptor::shotFrame()
+{
+    return d->shot();
+}
+
 bool CameraAdaptor::initStreaming(const std::string &configuration)
 {
     if (!canWork()) {
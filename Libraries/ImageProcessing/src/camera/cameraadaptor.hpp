@@ -7,6 +7,9 @@
 
 #include <ROD/ImageProcessing/Common.h>
 
+namespace cv {
+class Mat;
+}
 
 namespace ImageProcessing
 {
@@ -49,6 +52,12 @@ public:
      */
     ImageData_t shot();
 
+    /**
+     * @brief shotFrame Запросить снимок с камеры без кодирования
+     * @return          Пустой cv::Mat при ошибке
+     */
+    cv::Mat shotFrame();
+
     /**
      * @brief initStreaming     Подготовить стриминг данных с камеры, используя GStreamer
      * @param configuration     Конфигурация пайплайна для GStreamer
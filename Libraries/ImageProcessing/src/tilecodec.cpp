@@ -0,0 +1,342 @@
+#include "tilecodec.hpp"
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+/*
+ * Encoded tile frame (all numbers are little-endian):
+ *
+ * 0       4       5       6       8       10      12      16
+ * +-------+-------+-------+-------+-------+-------+-------+
+ * | magic |version| flags | tile  | width |height | tile  |
+ * | RODT  |       |       | size  |       |       | count |
+ * +-------+-------+-------+-------+-------+-------+-------+
+ *
+ * Keyframe (flags & 0x01): header is followed by JPEG of whole frame, tile count is 0
+ * Delta: header is followed by tile count records:
+ *   u32 tile index (row-major) | u32 JPEG size | JPEG of tile
+ */
+
+namespace ImageProcessing
+{
+
+namespace {
+
+constexpr uint8_t       TILE_MAGIC[4] {'R', 'O', 'D', 'T'};
+constexpr uint8_t       TILE_VERSION {1};
+constexpr uint8_t       FLAG_KEYFRAME {0x01};
+constexpr std::size_t   HEADER_SIZE {16};
+constexpr std::size_t   TILE_RECORD_SIZE {8};
+constexpr int           MAX_DIMENSION {UINT16_MAX};
+
+struct TileFrameHeader
+{
+    uint8_t     flags {};
+    uint16_t    tileSize {};
+    uint16_t    width {};
+    uint16_t    height {};
+    uint32_t    tileCount {};
+};
+
+void writeU16(uint8_t* pBuf, uint16_t value)
+{
+    pBuf[0] = static_cast<uint8_t>(value);
+    pBuf[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeU32(uint8_t* pBuf, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) {
+        pBuf[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+uint16_t readU16(const uint8_t* pBuf)
+{
+    return static_cast<uint16_t>(pBuf[0] | (pBuf[1] << 8));
+}
+
+uint32_t readU32(const uint8_t* pBuf)
+{
+    uint32_t value {};
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(pBuf[i]) << (8 * i);
+    }
+    return value;
+}
+
+void appendHeader(ImageData_t& oBuf, const TileFrameHeader& header)
+{
+    oBuf.resize(HEADER_SIZE);
+    std::memcpy(oBuf.data(), TILE_MAGIC, sizeof(TILE_MAGIC));
+    oBuf[4] = TILE_VERSION;
+    oBuf[5] = header.flags;
+    writeU16(&oBuf[6], header.tileSize);
+    writeU16(&oBuf[8], header.width);
+    writeU16(&oBuf[10], header.height);
+    writeU32(&oBuf[12], header.tileCount);
+}
+
+bool readHeader(const ImageData_t& iBuf, TileFrameHeader& oHeader)
+{
+    if (iBuf.size() < HEADER_SIZE || std::memcmp(iBuf.data(), TILE_MAGIC, sizeof(TILE_MAGIC)) != 0 || iBuf[4] != TILE_VERSION) {
+        return false;
+    }
+    oHeader.flags     = iBuf[5];
+    oHeader.tileSize  = readU16(&iBuf[6]);
+    oHeader.width     = readU16(&iBuf[8]);
+    oHeader.height    = readU16(&iBuf[10]);
+    oHeader.tileCount = readU32(&iBuf[12]);
+    return (oHeader.tileSize > 0);
+}
+
+int getTileColumns(int width, int tileSize)
+{
+    return (width + tileSize - 1) / tileSize;
+}
+
+cv::Rect getTileRect(uint32_t tileNo, int width, int height, int tileSize)
+{
+    const int columns = getTileColumns(width, tileSize);
+    const int x = static_cast<int>(tileNo % columns) * tileSize;
+    const int y = static_cast<int>(tileNo / columns) * tileSize;
+    return {x, y, std::min(tileSize, width - x), std::min(tileSize, height - y)};
+}
+
+} // namespace
+
+
+struct TileEncoder::Impl
+{
+    TileCodecConfig     config;
+    TileEncoderStats    stats;
+    cv::Mat             reference;  // Frame as receiver has it (before JPEG losses)
+    uint32_t            framesSinceKeyframe {};
+    bool                isKeyframeRequested {true};
+
+    std::vector<int>    jpegParams;
+    std::vector<uint8_t> jpegBuffer;
+
+    bool needKeyframe(const cv::Mat& frame) const {
+        return isKeyframeRequested || reference.empty() || (reference.size() != frame.size()) ||
+               (reference.type() != frame.type()) || (framesSinceKeyframe >= config.keyframeInterval);
+    }
+};
+
+
+TileEncoder::TileEncoder(const TileCodecConfig &config) :
+    d {new Impl}
+{
+    setConfig(config);
+}
+
+TileEncoder::~TileEncoder() = default;
+TileEncoder::TileEncoder(TileEncoder &&other) noexcept = default;
+TileEncoder &TileEncoder::operator=(TileEncoder &&other) noexcept = default;
+
+void TileEncoder::setConfig(const TileCodecConfig &config)
+{
+    if (config.tileSize <= 0 || config.tileSize > MAX_DIMENSION || config.keyframeInterval == 0) {
+        throw std::invalid_argument("Tile size and keyframe interval must be positive");
+    }
+    d->config = config;
+    d->jpegParams = {cv::IMWRITE_JPEG_QUALITY, config.jpegQuality};
+    d->isKeyframeRequested = true;
+}
+
+const TileCodecConfig &TileEncoder::getConfig() const
+{
+    return d->config;
+}
+
+void TileEncoder::requestKeyframe()
+{
+    d->isKeyframeRequested = true;
+}
+
+ImageData_t TileEncoder::encode(const cv::Mat &frame)
+{
+    if (frame.empty() || frame.depth() != CV_8U || frame.cols > MAX_DIMENSION || frame.rows > MAX_DIMENSION) {
+        return {};
+    }
+
+    TileFrameHeader header;
+    header.tileSize = static_cast<uint16_t>(d->config.tileSize);
+    header.width    = static_cast<uint16_t>(frame.cols);
+    header.height   = static_cast<uint16_t>(frame.rows);
+
+    ImageData_t encoded;
+    if (d->needKeyframe(frame)) {
+        header.flags = FLAG_KEYFRAME;
+        appendHeader(encoded, header);
+        if (!cv::imencode(".jpg", frame, d->jpegBuffer, d->jpegParams)) {
+            return {};
+        }
+        encoded.insert(encoded.end(), d->jpegBuffer.begin(), d->jpegBuffer.end());
+
+        frame.copyTo(d->reference);
+        d->framesSinceKeyframe = 1;
+        d->isKeyframeRequested = false;
+        d->stats.keyframes++;
+        d->stats.encodedBytes += encoded.size();
+        return encoded;
+    }
+
+    appendHeader(encoded, header);
+    const int tileSize = d->config.tileSize;
+    const uint32_t tileCount = static_cast<uint32_t>(getTileColumns(frame.cols, tileSize) * getTileColumns(frame.rows, tileSize));
+    uint32_t changedTiles {};
+    for (uint32_t tileNo = 0; tileNo < tileCount; ++tileNo) {
+        const auto rect = getTileRect(tileNo, frame.cols, frame.rows, tileSize);
+        auto tile = frame(rect);
+        auto refTile = d->reference(rect);
+
+        // L1 norm is SIMD-optimized in OpenCV, compare with what receiver already has
+        const double maxSad = d->config.changeThreshold * rect.area() * frame.channels();
+        if (cv::norm(tile, refTile, cv::NORM_L1) <= maxSad) {
+            continue;
+        }
+
+        if (!cv::imencode(".jpg", tile, d->jpegBuffer, d->jpegParams)) {
+            d->isKeyframeRequested = true; // Reference already differs from receiver canvas
+            return {};
+        }
+        const auto recordPos = encoded.size();
+        encoded.resize(recordPos + TILE_RECORD_SIZE);
+        writeU32(&encoded[recordPos], tileNo);
+        writeU32(&encoded[recordPos + 4], static_cast<uint32_t>(d->jpegBuffer.size()));
+        encoded.insert(encoded.end(), d->jpegBuffer.begin(), d->jpegBuffer.end());
+
+        tile.copyTo(refTile);
+        ++changedTiles;
+    }
+    writeU32(&encoded[12], changedTiles);
+
+    d->framesSinceKeyframe++;
+    d->stats.deltaFrames++;
+    d->stats.totalTiles += tileCount;
+    d->stats.changedTiles += changedTiles;
+    d->stats.encodedBytes += encoded.size();
+    return encoded;
+}
+
+const TileEncoderStats &TileEncoder::getStats() const
+{
+    return d->stats;
+}
+
+
+struct TileDecoder::Impl
+{
+    cv::Mat                 canvas;
+    bool                    hasCanvas {false};
+    uint64_t                lastFrameNo {};
+    std::vector<TileRect>   changedTiles;
+    std::string             lastErrorText;
+
+    bool fail(const std::string& errorText) {
+        // Deltas after gap reference nothing, so state is dropped until keyframe
+        hasCanvas = false;
+        canvas.release();
+        changedTiles.clear();
+        lastErrorText = errorText;
+        return false;
+    }
+};
+
+
+TileDecoder::TileDecoder() :
+    d {new Impl}
+{
+}
+
+TileDecoder::~TileDecoder() = default;
+TileDecoder::TileDecoder(TileDecoder &&other) noexcept = default;
+TileDecoder &TileDecoder::operator=(TileDecoder &&other) noexcept = default;
+
+bool TileDecoder::isTileFrame(const ImageData_t &data)
+{
+    return (data.size() >= HEADER_SIZE) && (std::memcmp(data.data(), TILE_MAGIC, sizeof(TILE_MAGIC)) == 0);
+}
+
+bool TileDecoder::apply(uint64_t frameNo, const ImageData_t &data)
+{
+    TileFrameHeader header;
+    if (!readHeader(data, header)) {
+        return d->fail("Invalid tile frame header");
+    }
+
+    if (header.flags & FLAG_KEYFRAME) {
+        cv::Mat jpeg(1, static_cast<int>(data.size() - HEADER_SIZE), CV_8UC1, const_cast<uint8_t*>(data.data() + HEADER_SIZE));
+        d->canvas = cv::imdecode(jpeg, cv::IMREAD_COLOR);
+        if (d->canvas.empty() || d->canvas.cols != header.width || d->canvas.rows != header.height) {
+            return d->fail("Failed to decode keyframe");
+        }
+        d->hasCanvas = true;
+        d->lastFrameNo = frameNo;
+        d->changedTiles.assign(1, TileRect{0, 0, header.width, header.height});
+        return true;
+    }
+
+    if (!d->hasCanvas || frameNo != d->lastFrameNo + 1) {
+        return d->fail("No reference frame for delta " + std::to_string(frameNo));
+    }
+    if (d->canvas.cols != header.width || d->canvas.rows != header.height) {
+        return d->fail("Delta size differs from keyframe");
+    }
+
+    const uint32_t tileCount = static_cast<uint32_t>(getTileColumns(header.width, header.tileSize) * getTileColumns(header.height, header.tileSize));
+    d->changedTiles.clear();
+    std::size_t pos {HEADER_SIZE};
+    for (uint32_t i = 0; i < header.tileCount; ++i) {
+        if (data.size() - pos < TILE_RECORD_SIZE) {
+            return d->fail("Truncated tile record");
+        }
+        const uint32_t tileNo = readU32(&data[pos]);
+        const uint32_t jpegSize = readU32(&data[pos + 4]);
+        pos += TILE_RECORD_SIZE;
+        if (tileNo >= tileCount || data.size() - pos < jpegSize) {
+            return d->fail("Invalid tile record");
+        }
+
+        cv::Mat jpeg(1, static_cast<int>(jpegSize), CV_8UC1, const_cast<uint8_t*>(data.data() + pos));
+        const auto tile = cv::imdecode(jpeg, cv::IMREAD_COLOR);
+        const auto rect = getTileRect(tileNo, header.width, header.height, header.tileSize);
+        if (tile.cols != rect.width || tile.rows != rect.height) {
+            return d->fail("Failed to decode tile " + std::to_string(tileNo));
+        }
+        tile.copyTo(d->canvas(rect));
+        d->changedTiles.push_back({rect.x, rect.y, rect.width, rect.height});
+        pos += jpegSize;
+    }
+
+    d->lastFrameNo = frameNo;
+    return true;
+}
+
+bool TileDecoder::hasCanvas() const
+{
+    return d->hasCanvas;
+}
+
+const cv::Mat &TileDecoder::getCanvas() const
+{
+    return d->canvas;
+}
+
+const std::vector<TileRect> &TileDecoder::getChangedTiles() const
+{
+    return d->changedTiles;
+}
+
+std::string TileDecoder::getLastErrorText() const
+{
+    return d->lastErrorText;
+}
+
+} // namespace ImageProcessing
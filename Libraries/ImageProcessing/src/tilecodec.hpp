@@ -0,0 +1,138 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "common.hpp"
+
+namespace cv {
+class Mat;
+}
+
+namespace ImageProcessing
+{
+
+/**
+ * @brief The TileCodecConfig struct Configuration of inter-frame tile coding
+ */
+struct TileCodecConfig
+{
+    int         tileSize {64};          // Side of square tile in pixels, edge tiles are clipped
+    uint32_t    keyframeInterval {30};  // Whole frame is sent every N frames, so lost deltas are repaired
+    double      changeThreshold {4.0};  // Mean absolute difference per pixel channel to treat tile as changed
+    int         jpegQuality {90};
+};
+
+
+/**
+ * @brief The TileRect struct Area of tile in frame
+ */
+struct TileRect
+{
+    int x {};
+    int y {};
+    int width {};
+    int height {};
+};
+
+
+/**
+ * @brief The TileEncoderStats struct Statistics of encoder, tiles are counted only in delta frames
+ */
+struct TileEncoderStats
+{
+    uint64_t keyframes {};
+    uint64_t deltaFrames {};
+    uint64_t totalTiles {};
+    uint64_t changedTiles {};
+    uint64_t encodedBytes {};
+};
+
+
+/**
+ * @brief The TileEncoder class Encodes frames as keyframes or JPEG tiles changed since previous sent frame
+ * @note Encoded layout described in tilecodec.cpp. Each delta depends on all frames since keyframe
+ */
+class TileEncoder
+{
+public:
+    explicit TileEncoder(const TileCodecConfig& config = {});
+    ~TileEncoder();
+
+    TileEncoder(TileEncoder&& other) noexcept;
+    TileEncoder& operator=(TileEncoder&& other) noexcept;
+
+    /**
+     * @brief setConfig Set configuration, next frame will be keyframe
+     * @throws std::invalid_argument on non-positive tile size or keyframe interval
+     */
+    void setConfig(const TileCodecConfig& config);
+    const TileCodecConfig& getConfig() const;
+
+    /**
+     * @brief requestKeyframe Force whole frame on next encode (e.g. receiver lost reference)
+     */
+    void requestKeyframe();
+
+    /**
+     * @brief encode    Encode next frame of stream
+     * @param frame     8-bit frame, up to 65535x65535
+     * @return          Empty buffer on encoding error
+     */
+    ImageData_t encode(const cv::Mat& frame);
+
+    const TileEncoderStats& getStats() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+};
+
+
+/**
+ * @brief The TileDecoder class Composites keyframes and tile deltas of one stream into persistent canvas
+ */
+class TileDecoder
+{
+public:
+    TileDecoder();
+    ~TileDecoder();
+
+    TileDecoder(TileDecoder&& other) noexcept;
+    TileDecoder& operator=(TileDecoder&& other) noexcept;
+
+    /**
+     * @brief isTileFrame   Check if data was produced by TileEncoder, other data is plain image
+     */
+    static bool isTileFrame(const ImageData_t& data);
+
+    /**
+     * @brief apply     Apply encoded frame to canvas
+     * @param frameNo   Sequential number of frame in stream, delta must follow previous applied frame
+     * @param data      Frame produced by TileEncoder
+     * @return          false on invalid data or missing reference (gap in frame numbers). Decoder is reset then
+     *                  and accepts only keyframe, see hasCanvas
+     */
+    bool apply(uint64_t frameNo, const ImageData_t& data);
+
+    /**
+     * @brief hasCanvas Decoder has reference frame, otherwise keyframe is needed (request it from encoder)
+     */
+    bool hasCanvas() const;
+    const cv::Mat& getCanvas() const;
+
+    /**
+     * @brief getChangedTiles   Areas of canvas updated by last applied frame, whole canvas for keyframe
+     */
+    const std::vector<TileRect>& getChangedTiles() const;
+
+    std::string getLastErrorText() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+};
+
+} // namespace ImageProcessing
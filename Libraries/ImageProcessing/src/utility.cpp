@@ -101,11 +101,50 @@ std::string createReceiverPipeline(const CameraPipelineConfig &config) {
     // return oss.str();
 }
 
-std::vector<uint8_t> calculateImageHash(const ImageData_t &data) {
-    XXH64_hash_t hash = XXH3_64bits(data.data(), data.size());
-    std::vector<uint8_t> result(sizeof(XXH64_hash_t));
-    std::memcpy(result.data(), &hash, sizeof(hash));
-    return result;
+uint64_t calculateImageHash(const ImageData_t &data) {
+    return XXH3_64bits(data.data(), data.size());
+}
+
+uint64_t calculateImageHash(const uint8_t *pData, std::size_t dataSize) {
+    return XXH3_64bits(pData, dataSize);
+}
+
+
+struct ImageHashState::Impl
+{
+    XXH3_state_t* pState {XXH3_createState()};
+
+    ~Impl() {
+        XXH3_freeState(pState);
+    }
+};
+
+ImageHashState::ImageHashState() :
+    d {new Impl}
+{
+    if (d->pState == nullptr) {
+        throw std::bad_alloc();
+    }
+    reset();
+}
+
+ImageHashState::~ImageHashState() = default;
+ImageHashState::ImageHashState(ImageHashState &&other) noexcept = default;
+ImageHashState &ImageHashState::operator=(ImageHashState &&other) noexcept = default;
+
+void ImageHashState::reset()
+{
+    XXH3_64bits_reset(d->pState);
+}
+
+void ImageHashState::update(const uint8_t *pData, std::size_t dataSize)
+{
+    XXH3_64bits_update(d->pState, pData, dataSize);
+}
+
+uint64_t ImageHashState::getDigest() const
+{
+    return XXH3_64bits_digest(d->pState);
 }
 
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -37,6 +38,30 @@ struct CameraPipelineConfig {
 std::string createSenderPipeline(const CameraPipelineConfig& config);
 std::string createReceiverPipeline(const CameraPipelineConfig& config);
 
-std::vector<uint8_t> calculateImageHash(const ImageData_t& data);
+uint64_t calculateImageHash(const ImageData_t& data);
+uint64_t calculateImageHash(const uint8_t* pData, std::size_t dataSize);
+
+
+/**
+ * @brief The ImageHashState class Incremental calculateImageHash for data arriving by parts
+ * @note Digest of parts fed in order equals hash of whole data
+ */
+class ImageHashState
+{
+public:
+    ImageHashState();
+    ~ImageHashState();
+
+    ImageHashState(ImageHashState&& other) noexcept;
+    ImageHashState& operator=(ImageHashState&& other) noexcept;
+
+    void reset();
+    void update(const uint8_t* pData, std::size_t dataSize);
+    uint64_t getDigest() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> d;
+};
 
 } // namespace ImageProcessing
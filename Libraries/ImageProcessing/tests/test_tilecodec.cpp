@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "tilecodec.hpp"
+#include "utility.hpp"
+
+#include <opencv2/core.hpp>
+
+using namespace ImageProcessing;
+
+TEST(ImageProcessing_TileCodec, StaticSceneSendsNoTiles) {
+    auto frame = Utility::generateColorBarImage(320, 240);
+
+    TileCodecConfig config;
+    config.tileSize = 64;
+    config.keyframeInterval = 10;
+    TileEncoder encoder(config);
+    TileDecoder decoder;
+
+    auto keyframe = encoder.encode(frame);
+    ASSERT_TRUE(TileDecoder::isTileFrame(keyframe));
+    ASSERT_TRUE(decoder.apply(1, keyframe));
+    ASSERT_EQ(decoder.getCanvas().size(), frame.size());
+
+    auto delta = encoder.encode(frame);
+    ASSERT_LT(delta.size(), keyframe.size() / 10);
+    ASSERT_TRUE(decoder.apply(2, delta));
+    ASSERT_TRUE(decoder.getChangedTiles().empty());
+    ASSERT_EQ(encoder.getStats().changedTiles, 0u);
+    ASSERT_EQ(encoder.getStats().totalTiles, 5u * 4u);
+}
+
+TEST(ImageProcessing_TileCodec, ChangedTileComposited) {
+    auto frame = Utility::generateColorBarImage(320, 240);
+
+    TileEncoder encoder;
+    TileDecoder decoder;
+    ASSERT_TRUE(decoder.apply(7, encoder.encode(frame)));
+
+    // Change one tile in the middle of the second tile row (edge tiles are clipped)
+    cv::Mat changed = frame.clone();
+    changed(cv::Rect(70, 70, 40, 40)).setTo(cv::Scalar(10, 200, 30));
+    ASSERT_TRUE(decoder.apply(8, encoder.encode(changed)));
+
+    auto& tiles = decoder.getChangedTiles();
+    ASSERT_EQ(tiles.size(), 1u);
+    ASSERT_EQ(tiles.front().x, 64);
+    ASSERT_EQ(tiles.front().y, 64);
+    ASSERT_EQ(tiles.front().width, 64);
+
+    // Lossy JPEG, but changed area must follow the new frame
+    const auto& canvas = decoder.getCanvas();
+    ASSERT_LT(cv::norm(canvas(cv::Rect(70, 70, 40, 40)), changed(cv::Rect(70, 70, 40, 40)), cv::NORM_L1) / (40 * 40 * 3), 8.0);
+}
+
+TEST(ImageProcessing_TileCodec, LostDeltaWaitsForKeyframe) {
+    auto frame = Utility::generateColorBarImage(128, 128);
+
+    TileCodecConfig config;
+    config.keyframeInterval = 3;
+    TileEncoder encoder(config);
+    TileDecoder decoder;
+
+    ASSERT_TRUE(decoder.apply(1, encoder.encode(frame)));
+    encoder.encode(frame); // Frame 2 is lost
+    ASSERT_FALSE(decoder.apply(3, encoder.encode(frame)));
+    ASSERT_FALSE(decoder.hasCanvas());
+
+    // Frame 4 is keyframe by interval
+    ASSERT_TRUE(decoder.apply(4, encoder.encode(frame)));
+    ASSERT_TRUE(decoder.hasCanvas());
+    ASSERT_EQ(encoder.getStats().keyframes, 2u);
+
+    ASSERT_FALSE(TileDecoder::isTileFrame(Utility::serializeMat(frame)));
+}
+
+TEST(ImageProcessing_TileCodec, RequestedKeyframeAfterGap) {
+    auto frame = Utility::generateColorBarImage(128, 128);
+
+    TileCodecConfig config;
+    config.keyframeInterval = 30;
+    TileEncoder encoder(config);
+    TileDecoder decoder;
+
+    ASSERT_TRUE(decoder.apply(1, encoder.encode(frame)));
+    encoder.encode(frame); // Frame 2 is superseded on receiver
+    ASSERT_FALSE(decoder.apply(3, encoder.encode(frame)));
+    ASSERT_FALSE(decoder.hasCanvas());
+    ASSERT_TRUE(decoder.getCanvas().empty());
+
+    // Receiver asks for keyframe instead of waiting for interval
+    encoder.requestKeyframe();
+    ASSERT_TRUE(decoder.apply(4, encoder.encode(frame)));
+    ASSERT_TRUE(decoder.apply(5, encoder.encode(frame)));
+    ASSERT_EQ(encoder.getStats().keyframes, 2u);
+}
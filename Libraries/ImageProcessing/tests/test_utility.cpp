@@ -32,3 +32,17 @@ TEST(ImageProcessing_Utility, ImageSerialize) {
 
     ASSERT_TRUE(equalBitwise(img, deserializedImg));
 }
+
+TEST(ImageProcessing_Utility, StreamingHash) {
+    auto imgData = ImageProcessing::Utility::generateTestImageBytes(341, 992);
+
+    ImageProcessing::Utility::ImageHashState hashState;
+    for (std::size_t partStart = 0; partStart < imgData.size(); partStart += 1352) {
+        hashState.update(imgData.data() + partStart, std::min<std::size_t>(1352, imgData.size() - partStart));
+    }
+    ASSERT_EQ(hashState.getDigest(), ImageProcessing::Utility::calculateImageHash(imgData));
+
+    hashState.reset();
+    hashState.update(imgData.data(), imgData.size() - 1);
+    ASSERT_NE(hashState.getDigest(), ImageProcessing::Utility::calculateImageHash(imgData));
+}
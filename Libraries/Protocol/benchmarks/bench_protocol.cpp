@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+
+#include <ROD/Protocol.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace Protocol;
+
+namespace {
+
+/**
+ * @brief createImageBytes  Random bytes of JPEG-like size (~3 bits per pixel), incompressible as real shots
+ */
+ImageProcessing::ImageData_t createImageBytes(int width, int height) {
+    std::mt19937 randomGen(width * 7919 + height);
+    ImageProcessing::ImageData_t res(std::max(width * height * 3 / 8, 64));
+    std::generate(res.begin(), res.end(), [&randomGen]() { return static_cast<uint8_t>(randomGen()); });
+    return res;
+}
+
+SendableImage createImage(int width, int height, uint8_t fecGroupCount = 0) {
+    SendableImage res;
+    res.setSenderId(1);
+    res.setFecGroupCount(fecGroupCount);
+    res.setImage(1, createImageBytes(width, height));
+    return res;
+}
+
+void applyImageSizes(benchmark::internal::Benchmark* pBench) {
+    pBench->Args({10, 10})->Args({480, 560})->Args({3840, 2160});
+}
+
+} // namespace
+
+
+static void BM_HeaderEncode(benchmark::State& state) {
+    ImagePacketHeader header;
+    header.shotId = 1;
+    header.totalImageSize = 1'000'000;
+    uint8_t buf[ImagePacketHeader::WIRE_SIZE];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(header.writeTo(buf, sizeof(buf)));
+        benchmark::ClobberMemory();
+        ++header.fragmentStart;
+    }
+}
+BENCHMARK(BM_HeaderEncode);
+
+static void BM_PacketEncode(benchmark::State& state) {
+    ImagePacket packet;
+    packet.setId(1);
+    packet.setTotalImageSize(1'000'000);
+    packet.setPayload(createImageBytes(40, 90));
+    std::vector<uint8_t> buf(ImagePacket::MTU_SIZE);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(packet.writePacketPart(buf.data(), buf.size()));
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK(BM_PacketEncode);
+
+static void BM_PacketViewDecode(benchmark::State& state) {
+    auto img = createImage(480, 560);
+    auto& packets = img.convertToPackets();
+    std::size_t packetNo {};
+    ImagePacketView view;
+    for (auto _ : state) {
+        auto& packet = packets[packetNo++ % packets.size()];
+        benchmark::DoNotOptimize(view.init(packet.data(), packet.size()));
+    }
+}
+BENCHMARK(BM_PacketViewDecode);
+
+static void BM_PacketDecode(benchmark::State& state) {
+    auto img = createImage(480, 560);
+    auto& packets = img.convertToPackets();
+    std::size_t packetNo {};
+    ImagePacket packet;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(packet.initFromPacketPart(packets[packetNo++ % packets.size()]));
+    }
+}
+BENCHMARK(BM_PacketDecode);
+
+static void BM_ConvertToPackets(benchmark::State& state) {
+    auto img = createImage(state.range(0), state.range(1));
+    uint64_t senderId {1};
+    for (auto _ : state) {
+        img.setSenderId(++senderId); // Drops packets cache, image hash is kept
+        benchmark::DoNotOptimize(img.convertToPackets().data());
+    }
+    state.SetBytesProcessed(state.iterations() * img.getImage().size());
+}
+BENCHMARK(BM_ConvertToPackets)->Apply(applyImageSizes);
+
+static void BM_InitFromPackets(benchmark::State& state) {
+    auto img = createImage(state.range(0), state.range(1));
+    auto& packets = img.convertToPackets();
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto packetsCopy = packets;
+        SendableImage receivedImg;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(receivedImg.initFromPackets(std::move(packetsCopy)));
+    }
+    state.SetBytesProcessed(state.iterations() * img.getImage().size());
+}
+BENCHMARK(BM_InitFromPackets)->Apply(applyImageSizes);
+
+/**
+ * @brief BM_Reassembly Frame assembler fed with lost and locally reordered packets
+ * @note Args: width, height, loss per mille, FEC groups
+ */
+static void BM_Reassembly(benchmark::State& state) {
+    auto img = createImage(state.range(0), state.range(1), static_cast<uint8_t>(state.range(3)));
+    auto packets = img.convertToPackets();
+
+    // Reorder inside small windows, as network does, then drop
+    std::mt19937 randomGen(42);
+    constexpr std::size_t REORDER_WINDOW {8};
+    for (std::size_t windowStart = 0; windowStart < packets.size(); windowStart += REORDER_WINDOW) {
+        auto windowEnd = std::min(windowStart + REORDER_WINDOW, packets.size());
+        std::shuffle(packets.begin() + windowStart, packets.begin() + windowEnd, randomGen);
+    }
+    std::uniform_int_distribution<int> lossDist(0, 999);
+    packets.erase(std::remove_if(packets.begin(), packets.end(), [&](auto&) {
+        return lossDist(randomGen) < state.range(2);
+    }), packets.end());
+
+    std::vector<ImagePacketView> views(packets.size());
+    uint64_t completedFrames {};
+    for (auto _ : state) {
+        FrameAssembler assembler;
+        assembler.setFrameCallback([&completedFrames](SendableImage&&) { ++completedFrames; });
+        for (std::size_t i = 0; i < packets.size(); ++i) {
+            views[i].init(packets[i].data(), packets[i].size());
+        }
+        assembler.addPackets(views.data(), views.size());
+    }
+    state.SetBytesProcessed(state.iterations() * img.getImage().size());
+    state.counters["completed"] = benchmark::Counter(completedFrames, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Reassembly)
+    ->ArgNames({"w", "h", "loss_pm", "fec"})
+    ->Args({480, 560, 0, 0})
+    ->Args({480, 560, 10, 0})
+    ->Args({480, 560, 10, 4})
+    ->Args({3840, 2160, 0, 0})
+    ->Args({3840, 2160, 10, 0})
+    ->Args({3840, 2160, 10, 8});
+
+BENCHMARK_MAIN();
@@ -1,4 +1,19 @@
 #include "../../src/events.hpp"
 #include "../../src/eventprocessor.hpp"
+#include "../../src/asynceventprocessor.hpp"
+#include "../../src/eventbatcher.hpp"
+#include "../../src/eventlog.hpp"
+#include "../../src/eventsubscription.hpp"
+#include "../../src/deviceregistry.hpp"
+#include "../../src/presencetracker.hpp"
 #include "../../src/httpconstants.hpp"
 #include "../../src/sendableimage.hpp"
+#include "../../src/trafficpacer.hpp"
+#include "../../src/imagestreamsender.hpp"
+#include "../../src/imagestreamreceiver.hpp"
+#include "../../src/frameassembler.hpp"
+#include "../../src/fragmentnack.hpp"
+#include "../../src/framemailbox.hpp"
+#include "../../src/sharedframering.hpp"
+#include "../../src/sharedimagesender.hpp"
+#include "../../src/sharedimagereceiver.hpp"
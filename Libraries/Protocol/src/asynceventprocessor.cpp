@@ -0,0 +1,326 @@
+#include "asynceventprocessor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+
+namespace Protocol
+{
+
+namespace {
+
+constexpr auto WORKER_WAKEUP_TIMEOUT {std::chrono::milliseconds(100)}; // Guard against lost notification
+constexpr auto PRODUCER_WAKEUP_TIMEOUT {std::chrono::milliseconds(10)};
+constexpr auto CACHE_LINE_SIZE {64};
+
+/**
+ * @brief The EventQueue class Bounded multi-producer queue (sequence numbers per cell), single consumer
+ */
+class EventQueue
+{
+public:
+    explicit EventQueue(std::size_t capacity) :
+        m_cells {new Cell[capacity]},
+        m_mask {capacity - 1}
+    {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @return  false if queue is full, ev is not moved then
+     */
+    bool tryPush(Event&& ev)
+    {
+        auto pos = m_enqueuePos.load(std::memory_order_relaxed);
+        Cell* pCell {nullptr};
+        while (true) {
+            pCell = &m_cells[pos & m_mask];
+            const auto seq = pCell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        pCell->ev = std::move(ev);
+        pCell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Only for consumer
+    bool tryPop(Event& oEv)
+    {
+        const auto pos = m_dequeuePos.load(std::memory_order_relaxed);
+        auto& cell = m_cells[pos & m_mask];
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return false;
+        }
+        oEv = std::move(cell.ev);
+        cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+        m_dequeuePos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        const auto pos = m_dequeuePos.load(std::memory_order_acquire);
+        return m_cells[pos & m_mask].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    std::size_t getDepth() const
+    {
+        const auto dequeuePos = m_dequeuePos.load(std::memory_order_acquire);
+        const auto enqueuePos = m_enqueuePos.load(std::memory_order_acquire);
+        return (enqueuePos > dequeuePos) ? (enqueuePos - dequeuePos) : 0;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t>    sequence {};
+        Event                       ev;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    const std::size_t       m_mask;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_enqueuePos {};
+    alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_dequeuePos {};
+};
+
+std::size_t roundUpToPowerOfTwo(std::size_t value)
+{
+    std::size_t res {1};
+    while (res < value) {
+        res <<= 1;
+    }
+    return res;
+}
+
+void updateMax(std::atomic<uint64_t>& maxValue, uint64_t value)
+{
+    auto current = maxValue.load(std::memory_order_relaxed);
+    while (current < value && !maxValue.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+} // namespace
+
+
+/**
+ * @brief The AsyncEventProcessor::Shard struct Queue of one worker
+ */
+struct AsyncEventProcessor::Shard
+{
+    explicit Shard(std::size_t capacity) :
+        queue {capacity}
+    {
+    }
+
+    EventQueue              queue;
+    std::atomic<bool>       isSleeping {false};
+    std::atomic<bool>       isStopping {false};
+    std::mutex              mx;
+    std::condition_variable cv;
+
+    // Producers waiting for free space (Block policy), worker notifies after pop
+    std::atomic<uint32_t>   waitingProducers {};
+    std::mutex              spaceMx;
+    std::condition_variable spaceCv;
+
+    // Stats
+    std::atomic<uint64_t>   enqueued {};
+    std::atomic<uint64_t>   processed {};
+    std::atomic<uint64_t>   unhandled {};
+    std::atomic<uint64_t>   maxDepth {};
+    std::atomic<uint64_t>   handlerTimeTotalUs {};
+    std::atomic<uint64_t>   handlerTimeMaxUs {};
+};
+
+
+AsyncEventProcessor::AsyncEventProcessor() :
+    EventProcessor()
+{
+
+}
+
+AsyncEventProcessor::~AsyncEventProcessor()
+{
+    stop();
+}
+
+void AsyncEventProcessor::setQueue(EventOverflowPolicy policy, std::size_t queueCapacity)
+{
+    if (queueCapacity == 0) {
+        throw std::invalid_argument("Event queue capacity must be at least 1");
+    }
+    m_policy = policy;
+    m_queueCapacity = roundUpToPowerOfTwo(queueCapacity);
+}
+
+void AsyncEventProcessor::start(std::size_t workerCount)
+{
+    if (workerCount == 0) {
+        throw std::invalid_argument("Event worker count must be at least 1");
+    }
+    if (isWorking()) {
+        return;
+    }
+
+    m_shards.clear();
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        m_shards.push_back(std::make_unique<Shard>(m_queueCapacity));
+    }
+    for (auto& pShard : m_shards) {
+        m_workers.emplace_back([this, pShard = pShard.get()]() {
+            workerLoop(*pShard);
+        });
+    }
+    m_isWorking.store(true);
+}
+
+bool AsyncEventProcessor::isWorking() const
+{
+    return m_isWorking.load(std::memory_order_acquire);
+}
+
+void AsyncEventProcessor::stop()
+{
+    if (!m_isWorking.exchange(false)) {
+        return;
+    }
+
+    // New events are processed in caller thread, wait for ones being queued
+    while (m_activeProducers.load() != 0) {
+        std::this_thread::yield();
+    }
+    for (auto& pShard : m_shards) {
+        std::lock_guard<std::mutex> lock(pShard->mx);
+        pShard->isStopping.store(true);
+        pShard->cv.notify_one();
+    }
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void AsyncEventProcessor::addEvent(Event &&ev)
+{
+    m_activeProducers.fetch_add(1);
+    if (!m_isWorking.load()) {
+        m_activeProducers.fetch_sub(1);
+        processEvent(std::move(ev));
+        return;
+    }
+
+    auto& shard = getShard(ev);
+    bool isQueued = shard.queue.tryPush(std::move(ev));
+    if (!isQueued && m_policy == EventOverflowPolicy::Block) {
+        m_blockedPushes.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(shard.spaceMx);
+        shard.waitingProducers.fetch_add(1);
+        // Pairs with fence of worker after pop
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!(isQueued = shard.queue.tryPush(std::move(ev)))) {
+            shard.spaceCv.wait_for(lock, PRODUCER_WAKEUP_TIMEOUT);
+        }
+        shard.waitingProducers.fetch_sub(1);
+    }
+
+    if (isQueued) {
+        shard.enqueued.fetch_add(1, std::memory_order_relaxed);
+        updateMax(shard.maxDepth, shard.queue.getDepth());
+
+        // Pairs with fence of worker going to sleep
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (shard.isSleeping.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(shard.mx);
+            shard.cv.notify_one();
+        }
+    } else {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_activeProducers.fetch_sub(1);
+}
+
+AsyncEventStats AsyncEventProcessor::getStats() const
+{
+    AsyncEventStats stats;
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.blockedPushes = m_blockedPushes.load(std::memory_order_relaxed);
+    for (auto& pShard : m_shards) {
+        stats.enqueued += pShard->enqueued.load(std::memory_order_relaxed);
+        stats.processed += pShard->processed.load(std::memory_order_relaxed);
+        stats.unhandled += pShard->unhandled.load(std::memory_order_relaxed);
+        stats.queueDepth += pShard->queue.getDepth();
+        stats.maxQueueDepth = std::max(stats.maxQueueDepth, pShard->maxDepth.load(std::memory_order_relaxed));
+        stats.handlerTimeTotalUs += pShard->handlerTimeTotalUs.load(std::memory_order_relaxed);
+        stats.handlerTimeMaxUs = std::max(stats.handlerTimeMaxUs, pShard->handlerTimeMaxUs.load(std::memory_order_relaxed));
+    }
+    return stats;
+}
+
+void AsyncEventProcessor::workerLoop(Shard &shard)
+{
+    Event ev;
+    while (true) {
+        if (shard.queue.tryPop(ev)) {
+            notifySpaceFreed(shard);
+            processQueued(shard, std::move(ev));
+            continue;
+        }
+        if (shard.isStopping.load()) {
+            break; // Producers are finished, queue is empty
+        }
+
+        std::unique_lock<std::mutex> lock(shard.mx);
+        shard.isSleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (shard.queue.isEmpty() && !shard.isStopping.load()) {
+            shard.cv.wait_for(lock, WORKER_WAKEUP_TIMEOUT);
+        }
+        shard.isSleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+void AsyncEventProcessor::notifySpaceFreed(Shard &shard)
+{
+    // Pairs with fence of producer starting to wait
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (shard.waitingProducers.load(std::memory_order_relaxed) != 0) {
+        std::lock_guard<std::mutex> lock(shard.spaceMx);
+        shard.spaceCv.notify_one();
+    }
+}
+
+void AsyncEventProcessor::processQueued(Shard &shard, Event &&ev)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    const bool isHandled = processEvent(std::move(ev));
+    const auto handlerTimeUs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count());
+
+    shard.processed.fetch_add(1, std::memory_order_relaxed);
+    if (!isHandled) {
+        shard.unhandled.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    shard.handlerTimeTotalUs.fetch_add(handlerTimeUs, std::memory_order_relaxed);
+    updateMax(shard.handlerTimeMaxUs, handlerTimeUs);
+}
+
+AsyncEventProcessor::Shard &AsyncEventProcessor::getShard(const Event &ev)
+{
+    const auto deviceId = ev.getHeader(EventHeaders::HEADER_DEVICE);
+    return *m_shards[std::hash<std::string>()(deviceId) % m_shards.size()];
+}
+
+}
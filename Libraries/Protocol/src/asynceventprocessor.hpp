@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#include "eventprocessor.hpp"
+
+namespace Protocol
+{
+
+/**
+ * @brief The EventOverflowPolicy enum What to do with event, which queue of worker is full
+ */
+enum class EventOverflowPolicy : uint8_t
+{
+    DropNewest = 0, // Event is dropped and counted
+    Block,          // Producer sleeps until worker frees space (back-pressure to event channel)
+};
+
+/**
+ * @brief The AsyncEventStats struct Statistics of asynchronous event processing
+ */
+struct AsyncEventStats
+{
+    uint64_t enqueued {};
+    uint64_t processed {};
+    uint64_t unhandled {};      // No handler of event type
+    uint64_t dropped {};        // Queue was full (DropNewest)
+    uint64_t blockedPushes {};  // Producer waited for free space (Block)
+    uint64_t queueDepth {};     // Events waiting now, sum of all queues
+    uint64_t maxQueueDepth {};  // Max depth of single queue
+    uint64_t handlerTimeTotalUs {};
+    uint64_t handlerTimeMaxUs {};
+};
+
+/**
+ * @brief The AsyncEventProcessor class Event processor, which calls handlers in worker threads
+ * @note Every worker has own lock-free bounded multi-producer queue. Events are routed to worker
+ *       by device header, so events of one device are processed in order they were added.
+ *       Before start and after stop events are processed in caller thread
+ */
+class AsyncEventProcessor : public EventProcessor
+{
+public:
+    AsyncEventProcessor();
+    ~AsyncEventProcessor() override;
+
+    AsyncEventProcessor(const AsyncEventProcessor&) = delete;
+    AsyncEventProcessor& operator=(const AsyncEventProcessor&) = delete;
+
+    /**
+     * @brief setQueue      Set overflow policy and capacity of every worker queue, applied on start
+     * @param queueCapacity Rounded up to power of two
+     * @note With Block policy handlers must not add events to the same processor, worker could wait for itself
+     * @throws std::invalid_argument on zero capacity
+     */
+    void setQueue(EventOverflowPolicy policy, std::size_t queueCapacity);
+
+    /**
+     * @brief start         Start workers
+     * @param workerCount   Count of worker threads (and queues)
+     * @throws std::invalid_argument on zero worker count
+     */
+    void start(std::size_t workerCount);
+    bool isWorking() const;
+
+    /**
+     * @brief stop  Process queued events and stop workers
+     */
+    void stop();
+
+    // EventProcessor interface
+    void addEvent(Protocol::Event&& ev) override;
+
+    /**
+     * @brief getStats  Stats since start, must not be called concurrently with start
+     */
+    AsyncEventStats getStats() const;
+
+private:
+    struct Shard;
+
+    EventOverflowPolicy m_policy {EventOverflowPolicy::Block};
+    std::size_t         m_queueCapacity {1024};
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::vector<std::thread>            m_workers;
+    std::atomic<bool>                   m_isWorking {false};
+    std::atomic<uint32_t>               m_activeProducers {}; // Inside addEvent, stop waits for them
+
+    std::atomic<uint64_t>   m_dropped {};
+    std::atomic<uint64_t>   m_blockedPushes {};
+
+    void workerLoop(Shard& shard);
+    void notifySpaceFreed(Shard& shard);
+    void processQueued(Shard& shard, Protocol::Event&& ev);
+    Shard& getShard(const Protocol::Event& ev);
+};
+
+using AsyncEventProcessorPtr = std::shared_ptr<AsyncEventProcessor>;
+
+}
@@ -0,0 +1,187 @@
+#include "deviceregistry.hpp"
+
+#include <charconv>
+#include <mutex>
+
+namespace Protocol
+{
+
+namespace
+{
+const std::string_view TARGET_PREFIX {"/?"};
+const std::string_view PARAMETER_DEVICE {"dev"};
+const std::string_view PARAMETER_ENCODING {"enc"};
+
+constexpr std::size_t MIN_SLOT_COUNT {64};
+
+std::size_t hashId(uint64_t deviceId)
+{
+    // splitmix64 finalizer, ids are sequential
+    deviceId ^= deviceId >> 30;
+    deviceId *= 0xbf58476d1ce4e5b9ULL;
+    deviceId ^= deviceId >> 27;
+    deviceId *= 0x94d049bb133111ebULL;
+    deviceId ^= deviceId >> 31;
+    return static_cast<std::size_t>(deviceId);
+}
+}
+
+bool parseEventChannelTarget(std::string_view resource, EventChannelTarget &oTarget) noexcept
+{
+    if (resource.substr(0, TARGET_PREFIX.size()) != TARGET_PREFIX) {
+        return false;
+    }
+    resource.remove_prefix(TARGET_PREFIX.size());
+
+    EventChannelTarget target;
+    bool hasDevice {false};
+    bool hasEncoding {false};
+    while (!resource.empty()) {
+        const auto parameterEnd = resource.find('&');
+        const auto parameter = resource.substr(0, parameterEnd);
+        resource.remove_prefix(parameterEnd == std::string_view::npos ? resource.size() : parameterEnd + 1);
+        if (parameterEnd != std::string_view::npos && resource.empty()) {
+            return false; // Trailing separator
+        }
+
+        const auto separator = parameter.find('=');
+        if (separator == std::string_view::npos) {
+            return false;
+        }
+        const auto key = parameter.substr(0, separator);
+        const auto value = parameter.substr(separator + 1);
+
+        if (key == PARAMETER_DEVICE && !hasDevice) {
+            if (value.empty() || value.front() == '0') {
+                return false;
+            }
+            auto res = std::from_chars(value.data(), value.data() + value.size(), target.deviceId);
+            if (res.ec != std::errc() || res.ptr != value.data() + value.size()) {
+                return false;
+            }
+            hasDevice = true;
+        } else if (key == PARAMETER_ENCODING && !hasEncoding) {
+            if (!toEventEncoding(std::string(value), target.encoding)) {
+                return false;
+            }
+            hasEncoding = true;
+        } else {
+            return false;
+        }
+    }
+    if (!hasDevice) {
+        return false;
+    }
+    oTarget = target;
+    return true;
+}
+
+DeviceRegistry::DeviceRegistry() :
+    m_slots(MIN_SLOT_COUNT, EMPTY_SLOT)
+{
+
+}
+
+void DeviceRegistry::reset(const std::vector<uint64_t> &deviceIds)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mx);
+    std::size_t slotCount {MIN_SLOT_COUNT};
+    while (slotCount < deviceIds.size() * 2) {
+        slotCount *= 2;
+    }
+    m_slots.assign(slotCount, EMPTY_SLOT);
+    m_size = 0;
+    m_removedCount = 0;
+    for (auto deviceId : deviceIds) {
+        insert(deviceId);
+    }
+}
+
+bool DeviceRegistry::add(uint64_t deviceId)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mx);
+    return insert(deviceId);
+}
+
+bool DeviceRegistry::remove(uint64_t deviceId)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mx);
+    const auto slot = findSlot(deviceId);
+    if (slot == m_slots.size()) {
+        return false;
+    }
+    m_slots[slot] = REMOVED_SLOT; // Keeps probe chains of other ids
+    m_size--;
+    m_removedCount++;
+    return true;
+}
+
+bool DeviceRegistry::contains(uint64_t deviceId) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mx);
+    return findSlot(deviceId) != m_slots.size();
+}
+
+std::size_t DeviceRegistry::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mx);
+    return m_size;
+}
+
+std::size_t DeviceRegistry::findSlot(uint64_t deviceId) const
+{
+    if (deviceId == EMPTY_SLOT || deviceId == REMOVED_SLOT) {
+        return m_slots.size();
+    }
+    const auto mask = m_slots.size() - 1;
+    for (auto slot = hashId(deviceId) & mask; ; slot = (slot + 1) & mask) {
+        if (m_slots[slot] == deviceId) {
+            return slot;
+        }
+        if (m_slots[slot] == EMPTY_SLOT) {
+            return m_slots.size(); // Table always has empty slots
+        }
+    }
+}
+
+bool DeviceRegistry::insert(uint64_t deviceId)
+{
+    if (deviceId == EMPTY_SLOT || deviceId == REMOVED_SLOT || findSlot(deviceId) != m_slots.size()) {
+        return false;
+    }
+    // Load factor with removed slots is kept under 1/2, so probe chains are short
+    if ((m_size + m_removedCount + 1) * 2 > m_slots.size()) {
+        rehash(m_size + 1);
+    }
+
+    const auto mask = m_slots.size() - 1;
+    auto slot = hashId(deviceId) & mask;
+    while (m_slots[slot] != EMPTY_SLOT && m_slots[slot] != REMOVED_SLOT) {
+        slot = (slot + 1) & mask;
+    }
+    if (m_slots[slot] == REMOVED_SLOT) {
+        m_removedCount--;
+    }
+    m_slots[slot] = deviceId;
+    m_size++;
+    return true;
+}
+
+void DeviceRegistry::rehash(std::size_t minSize)
+{
+    std::size_t slotCount {MIN_SLOT_COUNT};
+    while (slotCount < minSize * 4) {
+        slotCount *= 2;
+    }
+    std::vector<uint64_t> slots(slotCount, EMPTY_SLOT);
+    slots.swap(m_slots);
+    m_size = 0;
+    m_removedCount = 0;
+    for (auto deviceId : slots) {
+        if (deviceId != EMPTY_SLOT && deviceId != REMOVED_SLOT) {
+            insert(deviceId);
+        }
+    }
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+#include "events.hpp"
+
+namespace Protocol
+{
+
+/**
+ * @brief The EventChannelTarget struct Parameters of device event channel connection ("/?dev=N&enc=json|bin")
+ */
+struct EventChannelTarget
+{
+    uint64_t        deviceId {};
+    EventEncoding   encoding {EventEncoding::Json};
+};
+
+/**
+ * @brief parseEventChannelTarget   Parse target of device connection: "/?dev=N" with optional "enc=json|bin" in any order.
+ *                                  Device id is positive number without leading zeroes, unknown or repeated parameters are invalid
+ * @return                          false on invalid target, oTarget is not changed then
+ */
+bool parseEventChannelTarget(std::string_view resource, EventChannelTarget& oTarget) noexcept;
+
+
+/**
+ * @brief The DeviceRegistry class Set of registered device ids, checked on every device connection
+ * @note Open addressing hash table with linear probing, so lookup is a few probes of one array.
+ *       Thread-safe: lookups run in parallel, changes are rare (loaded once, then updated by device management)
+ */
+class DeviceRegistry
+{
+public:
+    DeviceRegistry();
+
+    /**
+     * @brief reset Replace all ids, 0 and max value are not valid ids and skipped
+     */
+    void reset(const std::vector<uint64_t>& deviceIds);
+
+    /**
+     * @brief add   Register device
+     * @return      false if id is invalid or already registered
+     */
+    bool add(uint64_t deviceId);
+
+    /**
+     * @brief remove    Unregister device
+     * @return          false if device is not registered
+     */
+    bool remove(uint64_t deviceId);
+
+    bool contains(uint64_t deviceId) const;
+    std::size_t size() const;
+
+private:
+    static constexpr uint64_t EMPTY_SLOT {0};
+    static constexpr uint64_t REMOVED_SLOT {~uint64_t(0)};
+
+    std::vector<uint64_t>   m_slots;        // Count is power of 2
+    std::size_t             m_size {};
+    std::size_t             m_removedCount {};
+    mutable std::shared_mutex m_mx;
+
+    std::size_t findSlot(uint64_t deviceId) const; // Index of slot with id, slot count if not found
+    bool insert(uint64_t deviceId);
+    void rehash(std::size_t minSize);
+};
+
+}
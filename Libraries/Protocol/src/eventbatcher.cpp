@@ -0,0 +1,82 @@
+#include "eventbatcher.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace Protocol
+{
+
+EventBatcher::EventBatcher(const EventBatchConfig &config)
+{
+    setConfig(config);
+    setCoalesced(EventType::DetectorAlert, true);
+}
+
+void EventBatcher::setConfig(const EventBatchConfig &config)
+{
+    if (config.maxEvents == 0 || config.maxEvents > std::numeric_limits<uint16_t>::max()) {
+        throw std::invalid_argument("Event batch size must be in range 1-65535");
+    }
+    if (config.maxDelay.count() < 0) {
+        throw std::invalid_argument("Event batch delay must not be negative");
+    }
+    m_config = config;
+}
+
+const EventBatchConfig &EventBatcher::getConfig() const
+{
+    return m_config;
+}
+
+void EventBatcher::setCoalesced(EventType etype, bool isCoalesced)
+{
+    const auto index = static_cast<std::size_t>(etype + 1);
+    if (index >= m_coalescedTypes.size()) {
+        throw std::invalid_argument(std::string("Unknown event type: ") + std::to_string(etype));
+    }
+    m_coalescedTypes[index] = isCoalesced;
+}
+
+bool EventBatcher::add(Event &&ev)
+{
+    const auto index = static_cast<std::size_t>(ev.getType() + 1);
+    if (m_config.isCoalescing && index < m_coalescedTypes.size() && m_coalescedTypes[index]) {
+        const auto deviceId = ev.getHeader(EventHeaders::HEADER_DEVICE);
+        auto queuedIt = std::find_if(m_events.begin(), m_events.end(), [&ev, &deviceId](const Event& queued) {
+            return (queued.getType() == ev.getType()) && (queued.getHeader(EventHeaders::HEADER_DEVICE) == deviceId);
+        });
+        if (queuedIt != m_events.end()) {
+            m_events.erase(queuedIt); // Newer one goes to the end, order with other events is kept
+            m_coalescedCount++;
+        }
+    }
+
+    m_events.push_back(std::move(ev));
+    return m_events.size() >= m_config.maxEvents;
+}
+
+bool EventBatcher::isEmpty() const
+{
+    return m_events.empty();
+}
+
+std::size_t EventBatcher::size() const
+{
+    return m_events.size();
+}
+
+std::vector<Event> EventBatcher::takeBatch()
+{
+    std::vector<Event> batch;
+    batch.swap(m_events);
+    m_events.reserve(m_config.maxEvents);
+    return batch;
+}
+
+uint64_t EventBatcher::getCoalescedCount() const
+{
+    return m_coalescedCount;
+}
+
+}
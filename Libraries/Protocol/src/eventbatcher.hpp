@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <vector>
+#include <stdint.h>
+
+#include "events.hpp"
+
+namespace Protocol
+{
+
+/**
+ * @brief The EventBatchConfig struct When batch of events is sent
+ */
+struct EventBatchConfig
+{
+    std::size_t                 maxEvents {16};     // Batch is sent when it has so many events, 1 disables batching
+    std::chrono::microseconds   maxDelay {2000};    // Batch is sent so long after its first event
+    bool                        isCoalescing {true};// Newer event of coalesced type replaces queued one of the same device
+};
+
+/**
+ * @brief The EventBatcher class Collects outgoing events into batches, sent as one frame (see writeEvents)
+ * @note Not thread-safe, owner flushes it by count (add returns true) or by timer (maxDelay)
+ */
+class EventBatcher
+{
+public:
+    /**
+     * @throws std::invalid_argument on invalid config
+     */
+    explicit EventBatcher(const EventBatchConfig& config = {});
+
+    /**
+     * @brief setConfig Set config, queued events are kept
+     * @throws std::invalid_argument on zero or more than 65535 max events
+     */
+    void setConfig(const EventBatchConfig& config);
+    const EventBatchConfig& getConfig() const;
+
+    /**
+     * @brief setCoalesced  Mark type of status-like events, only the latest one of a device is worth sending.
+     *                      DetectorAlert is coalesced by default
+     */
+    void setCoalesced(EventType etype, bool isCoalesced);
+
+    /**
+     * @brief add   Queue event, it replaces queued event of same coalesced type and device
+     * @return      true if batch is full and must be sent
+     */
+    bool add(Event&& ev);
+
+    bool isEmpty() const;
+    std::size_t size() const;
+
+    /**
+     * @brief takeBatch Take queued events in order they were added, batcher is empty after it
+     */
+    std::vector<Event> takeBatch();
+
+    uint64_t getCoalescedCount() const;
+
+private:
+    EventBatchConfig                            m_config;
+    std::array<bool, Protocol::EVENT_TYPE_COUNT> m_coalescedTypes {};
+    std::vector<Event>                          m_events;
+    uint64_t                                    m_coalescedCount {};
+};
+
+}
@@ -0,0 +1,550 @@
+#include "eventlog.hpp"
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+
+#include <Components/Logger/Logger.h>
+
+namespace Protocol
+{
+
+namespace {
+
+constexpr char        SEGMENT_MAGIC[4] {'R', 'O', 'D', 'L'};
+constexpr uint32_t    SEGMENT_VERSION {1};
+constexpr std::size_t RECORD_ALIGNMENT {8};
+constexpr std::size_t MIN_SEGMENT_SIZE {4096};
+const std::string     SEGMENT_PREFIX {"segment_"};
+const std::string     SEGMENT_EXTENSION {".rodlog"};
+
+/**
+ * @brief The SegmentHeader struct Start of segment file
+ * @note Host byte order, log is not moved between hosts
+ */
+struct SegmentHeader
+{
+    char        magic[4];
+    uint32_t    version;
+    uint64_t    segmentId;
+    int64_t     createdUs;
+    uint64_t    reserved;
+};
+static_assert(sizeof(SegmentHeader) == 32, "Segment header size is part of file format");
+
+/**
+ * @brief The RecordHeader struct Fixed header of record, binary event follows it
+ */
+struct RecordHeader
+{
+    uint32_t    recordSize;     // With header and alignment, 0 marks end of records
+    uint32_t    dataSize;
+    int64_t     timestampUs;
+    uint64_t    deviceId;
+    int16_t     type;
+    uint16_t    reserved1;
+    uint32_t    reserved2;
+};
+static_assert(sizeof(RecordHeader) == 32, "Record header size is part of file format");
+
+std::size_t alignRecordSize(std::size_t size)
+{
+    return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+
+uint64_t toDeviceId(const Event& ev)
+{
+    const auto deviceHeader = ev.getHeader(EventHeaders::HEADER_DEVICE);
+    if (deviceHeader.empty() || deviceHeader.find_first_not_of("0123456789") != std::string::npos || deviceHeader.size() > 19) {
+        return 0;
+    }
+    return std::stoull(deviceHeader);
+}
+
+uint32_t toTypeMask(EventType etype)
+{
+    const auto index = static_cast<uint32_t>(etype + 1);
+    return (index < 32) ? (1u << index) : 0;
+}
+
+std::filesystem::path createSegmentPath(const std::filesystem::path& directory, uint64_t segmentId)
+{
+    auto idText = std::to_string(segmentId);
+    idText.insert(0, 20 - idText.size(), '0'); // Sorted as text
+    return directory / (SEGMENT_PREFIX + idText + SEGMENT_EXTENSION);
+}
+
+} // namespace
+
+
+/**
+ * @brief The EventLog::Segment struct Mapped segment file and its index
+ */
+struct EventLog::Segment
+{
+    struct IndexEntry
+    {
+        int64_t     timestampUs {};
+        std::size_t offset {};
+    };
+
+    std::filesystem::path   path;
+    uint64_t                id {};
+    int                     fd {-1};
+    uint8_t*                pData {nullptr};
+    std::size_t             mappedSize {};
+    std::size_t             writeOffset {sizeof(SegmentHeader)};
+    bool                    isWritable {false};
+
+    // Index
+    std::size_t             recordCount {};
+    int64_t                 minTimestampUs {std::numeric_limits<int64_t>::max()};
+    int64_t                 maxTimestampUs {std::numeric_limits<int64_t>::min()};
+    uint32_t                typeMask {};
+    std::vector<uint64_t>   devices;    // Sorted
+    std::vector<IndexEntry> index;      // Sparse, sorted by time
+    std::size_t             lastIndexOffset {};
+
+    ~Segment()
+    {
+        unmap();
+    }
+
+    void unmap()
+    {
+        if (pData != nullptr) {
+            munmap(pData, mappedSize);
+            pData = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    void addToIndex(const RecordHeader& header, std::size_t offset, std::size_t indexInterval)
+    {
+        if (index.empty() || offset - lastIndexOffset >= indexInterval) {
+            index.push_back({header.timestampUs, offset});
+            lastIndexOffset = offset;
+        }
+        recordCount++;
+        minTimestampUs = std::min(minTimestampUs, header.timestampUs);
+        maxTimestampUs = std::max(maxTimestampUs, header.timestampUs);
+        typeMask |= toTypeMask(static_cast<EventType>(header.type));
+        auto deviceIt = std::lower_bound(devices.begin(), devices.end(), header.deviceId);
+        if (deviceIt == devices.end() || *deviceIt != header.deviceId) {
+            devices.insert(deviceIt, header.deviceId);
+        }
+    }
+
+    /**
+     * @brief findStart Offset of first record, which could have timestamp not less than given one
+     */
+    std::size_t findStart(int64_t fromUs) const
+    {
+        auto entryIt = std::lower_bound(index.begin(), index.end(), fromUs, [](const IndexEntry& entry, int64_t timestampUs) {
+            return entry.timestampUs < timestampUs;
+        });
+        if (entryIt != index.begin()) {
+            --entryIt; // Records after previous entry could be in range
+        }
+        return (entryIt == index.end()) ? writeOffset : entryIt->offset;
+    }
+};
+
+
+EventLog::EventLog()
+{
+
+}
+
+EventLog::~EventLog()
+{
+    close();
+}
+
+bool EventLog::open(const std::filesystem::path &directory, const EventLogConfig &config)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mx);
+    if (config.segmentSize < MIN_SEGMENT_SIZE || config.segmentSize > std::numeric_limits<uint32_t>::max() || config.indexInterval == 0) {
+        m_lastErrorText = "Invalid event log config (segment size must be in range 4 KiB - 4 GiB, index interval >0)";
+        return false;
+    }
+    m_segments.clear();
+    m_isOpened = false;
+    m_directory = directory;
+    m_config = config;
+    m_lastTimestampUs = 0;
+    m_nextSegmentId = 1;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        m_lastErrorText = "Failed to create event log directory: " + ec.message();
+        return false;
+    }
+
+    std::vector<std::pair<uint64_t, std::filesystem::path>> segmentFiles;
+    for (auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        const auto filename = entry.path().filename().string();
+        if (!entry.is_regular_file() || filename.rfind(SEGMENT_PREFIX, 0) != 0 || entry.path().extension() != SEGMENT_EXTENSION) {
+            continue;
+        }
+        const auto idText = filename.substr(SEGMENT_PREFIX.size(), filename.size() - SEGMENT_PREFIX.size() - SEGMENT_EXTENSION.size());
+        if (idText.empty() || idText.find_first_not_of("0123456789") != std::string::npos) {
+            continue;
+        }
+        segmentFiles.emplace_back(std::stoull(idText), entry.path());
+    }
+    if (ec) {
+        m_lastErrorText = "Failed to list event log directory: " + ec.message();
+        return false;
+    }
+    std::sort(segmentFiles.begin(), segmentFiles.end());
+
+    for (auto& [segmentId, path] : segmentFiles) {
+        m_nextSegmentId = segmentId + 1;
+        if (!loadSegment(path, segmentId)) {
+            COMPLOG_WARNING("[EventLog] Skipped segment", path.string(), ":", m_lastErrorText);
+        }
+    }
+    for (auto& pSegment : m_segments) {
+        m_lastTimestampUs = std::max(m_lastTimestampUs, pSegment->maxTimestampUs);
+    }
+    m_isOpened = startSegment();
+    return m_isOpened;
+}
+
+bool EventLog::isOpen() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mx);
+    return !m_segments.empty() && m_segments.back()->isWritable;
+}
+
+void EventLog::close()
+{
+    std::unique_lock<std::shared_mutex> lock(m_mx);
+    finishActiveSegment();
+    m_segments.clear();
+    m_isOpened = false;
+}
+
+bool EventLog::append(const Event &ev)
+{
+    return append(ev, getCurrentTimestampUs());
+}
+
+bool EventLog::append(const Event &ev, int64_t timestampUs)
+{
+    const auto data = ev.toBinary();
+
+    RecordHeader header {};
+    header.recordSize = static_cast<uint32_t>(alignRecordSize(sizeof(RecordHeader) + data.size()));
+    header.dataSize = static_cast<uint32_t>(data.size());
+    header.deviceId = toDeviceId(ev);
+    header.type = static_cast<int16_t>(ev.getType());
+
+    std::unique_lock<std::shared_mutex> lock(m_mx);
+    auto pSegment = getActiveSegment();
+    if (pSegment == nullptr && m_isOpened) {
+        // Previous segment start failed (e.g. disk was full), retry
+        if (!startSegment()) {
+            return false;
+        }
+        pSegment = getActiveSegment();
+    }
+    if (pSegment == nullptr) {
+        m_lastErrorText = "Event log is not open";
+        return false;
+    }
+    if (header.recordSize > m_config.segmentSize - sizeof(SegmentHeader) - sizeof(RecordHeader)) {
+        m_lastErrorText = "Event is larger than log segment";
+        return false;
+    }
+
+    // End marker (zero size) must fit after record
+    if (pSegment->writeOffset + header.recordSize + sizeof(RecordHeader) > pSegment->mappedSize) {
+        finishActiveSegment();
+        if (!startSegment()) {
+            return false;
+        }
+        if (m_config.retention.count() > 0) {
+            const auto retentionUs = std::chrono::duration_cast<std::chrono::microseconds>(m_config.retention).count();
+            removeOlderThanLocked(timestampUs - retentionUs);
+        }
+        pSegment = getActiveSegment();
+    }
+
+    header.timestampUs = std::max(timestampUs, m_lastTimestampUs);
+    m_lastTimestampUs = header.timestampUs;
+
+    // Record becomes visible to recovery when its size is written, so header goes last
+    const auto offset = pSegment->writeOffset;
+    auto pRecord = pSegment->pData + offset;
+    std::memcpy(pRecord + sizeof(RecordHeader), data.data(), data.size());
+    const auto recordSize = header.recordSize;
+    header.recordSize = 0;
+    std::memcpy(pRecord, &header, sizeof(header));
+    std::memcpy(pRecord, &recordSize, sizeof(recordSize));
+    header.recordSize = recordSize;
+
+    pSegment->writeOffset += recordSize;
+    pSegment->addToIndex(header, offset, m_config.indexInterval);
+    return true;
+}
+
+bool EventLog::flush()
+{
+    std::shared_lock<std::shared_mutex> lock(m_mx);
+    if (m_segments.empty() || !m_segments.back()->isWritable) {
+        return false;
+    }
+    auto& segment = *m_segments.back();
+    return msync(segment.pData, segment.writeOffset, MS_SYNC) == 0;
+}
+
+std::size_t EventLog::scan(const EventLogQuery &query, const ScanCallback &callback) const
+{
+    uint32_t queryTypeMask {};
+    for (auto etype : query.types) {
+        queryTypeMask |= toTypeMask(etype);
+    }
+    if (queryTypeMask == 0) {
+        queryTypeMask = std::numeric_limits<uint32_t>::max();
+    }
+
+    // Record spans are collected under lock, records are read and passed to callback without it
+    struct SegmentSpan
+    {
+        std::shared_ptr<const Segment>  pSegment;
+        std::size_t                     startOffset {};
+        std::size_t                     endOffset {};
+    };
+    std::vector<SegmentSpan> spans;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mx);
+        for (auto& pSegment : m_segments) {
+            auto& segment = *pSegment;
+            if (segment.recordCount == 0 || segment.maxTimestampUs < query.fromUs || (segment.typeMask & queryTypeMask) == 0) {
+                continue;
+            }
+            if (segment.minTimestampUs > query.toUs) {
+                break; // Next segments are newer
+            }
+            if (query.deviceId && !std::binary_search(segment.devices.begin(), segment.devices.end(), *query.deviceId)) {
+                continue;
+            }
+            spans.push_back({pSegment, segment.findStart(query.fromUs), segment.writeOffset});
+        }
+    }
+
+    std::size_t count {};
+    for (auto& span : spans) {
+        const auto pData = span.pSegment->pData;
+        for (auto offset = span.startOffset; offset < span.endOffset;) {
+            RecordHeader header;
+            std::memcpy(&header, pData + offset, sizeof(header));
+            const auto recordOffset = offset;
+            offset += header.recordSize;
+
+            if (header.timestampUs < query.fromUs) {
+                continue;
+            }
+            if (header.timestampUs > query.toUs) {
+                return count;
+            }
+            if ((query.deviceId && header.deviceId != *query.deviceId) ||
+                (toTypeMask(static_cast<EventType>(header.type)) & queryTypeMask) == 0) {
+                continue;
+            }
+
+            EventLogRecord record;
+            record.timestampUs = header.timestampUs;
+            record.deviceId = header.deviceId;
+            const auto pEventData = reinterpret_cast<const char*>(pData + recordOffset + sizeof(RecordHeader));
+            if (!record.event.readBinary(std::string(pEventData, header.dataSize))) {
+                continue;
+            }
+            count++;
+            if (!callback(std::move(record))) {
+                return count;
+            }
+        }
+    }
+    return count;
+}
+
+std::size_t EventLog::removeOlderThan(int64_t timestampUs)
+{
+    std::unique_lock<std::shared_mutex> lock(m_mx);
+    return removeOlderThanLocked(timestampUs);
+}
+
+std::size_t EventLog::getSegmentCount() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mx);
+    return m_segments.size();
+}
+
+std::string EventLog::getLastErrorText() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mx);
+    return m_lastErrorText;
+}
+
+int64_t EventLog::getCurrentTimestampUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool EventLog::loadSegment(const std::filesystem::path &path, uint64_t segmentId)
+{
+    auto pSegment = std::make_shared<Segment>();
+    pSegment->path = path;
+    pSegment->id = segmentId;
+    pSegment->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (pSegment->fd < 0) {
+        m_lastErrorText = std::string("Failed to open: ") + std::strerror(errno);
+        return false;
+    }
+    const auto fileSize = lseek(pSegment->fd, 0, SEEK_END);
+    if (fileSize < static_cast<off_t>(sizeof(SegmentHeader))) {
+        m_lastErrorText = "File is too small";
+        return false;
+    }
+    pSegment->mappedSize = static_cast<std::size_t>(fileSize);
+    auto pMapped = mmap(nullptr, pSegment->mappedSize, PROT_READ, MAP_SHARED, pSegment->fd, 0);
+    if (pMapped == MAP_FAILED) {
+        m_lastErrorText = std::string("Failed to map: ") + std::strerror(errno);
+        return false;
+    }
+    pSegment->pData = static_cast<uint8_t*>(pMapped);
+
+    SegmentHeader segmentHeader;
+    std::memcpy(&segmentHeader, pSegment->pData, sizeof(segmentHeader));
+    if (std::memcmp(segmentHeader.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0 || segmentHeader.version != SEGMENT_VERSION) {
+        m_lastErrorText = "Not an event log segment";
+        return false;
+    }
+
+    // Records up to end marker or first damaged one (not finished write)
+    auto offset = sizeof(SegmentHeader);
+    while (offset + sizeof(RecordHeader) <= pSegment->mappedSize) {
+        RecordHeader header;
+        std::memcpy(&header, pSegment->pData + offset, sizeof(header));
+        if (header.recordSize == 0 ||
+            header.recordSize != alignRecordSize(sizeof(RecordHeader) + header.dataSize) ||
+            offset + header.recordSize > pSegment->mappedSize) {
+            break;
+        }
+        pSegment->addToIndex(header, offset, m_config.indexInterval);
+        offset += header.recordSize;
+    }
+    pSegment->writeOffset = offset;
+    m_segments.push_back(std::move(pSegment));
+    return true;
+}
+
+bool EventLog::startSegment()
+{
+    const uint64_t segmentId = m_nextSegmentId++;
+    auto pSegment = std::make_shared<Segment>();
+    pSegment->path = createSegmentPath(m_directory, segmentId);
+    pSegment->id = segmentId;
+    pSegment->fd = ::open(pSegment->path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (pSegment->fd < 0) {
+        m_lastErrorText = std::string("Failed to create segment: ") + std::strerror(errno);
+        return false;
+    }
+    // Blocks are allocated now, sparse file would raise SIGBUS on write to mapping when disk is full
+    const int allocateRes = posix_fallocate(pSegment->fd, 0, static_cast<off_t>(m_config.segmentSize));
+    if (allocateRes != 0) {
+        m_lastErrorText = std::string("Failed to allocate segment: ") + std::strerror(allocateRes);
+        COMPLOG_ERROR("[EventLog]", m_lastErrorText);
+        std::error_code ec;
+        std::filesystem::remove(pSegment->path, ec);
+        return false;
+    }
+    pSegment->mappedSize = m_config.segmentSize;
+    auto pMapped = mmap(nullptr, pSegment->mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, pSegment->fd, 0);
+    if (pMapped == MAP_FAILED) {
+        m_lastErrorText = std::string("Failed to map segment: ") + std::strerror(errno);
+        std::error_code ec;
+        std::filesystem::remove(pSegment->path, ec);
+        return false;
+    }
+    pSegment->pData = static_cast<uint8_t*>(pMapped);
+    pSegment->isWritable = true;
+
+    SegmentHeader segmentHeader {};
+    std::memcpy(segmentHeader.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    segmentHeader.version = SEGMENT_VERSION;
+    segmentHeader.segmentId = segmentId;
+    segmentHeader.createdUs = getCurrentTimestampUs();
+    std::memcpy(pSegment->pData, &segmentHeader, sizeof(segmentHeader)); // File is zeroed, so records end here
+    m_segments.push_back(std::move(pSegment));
+    return true;
+}
+
+void EventLog::finishActiveSegment()
+{
+    if (m_segments.empty() || !m_segments.back()->isWritable) {
+        return;
+    }
+
+    // Unused tail is cut, finished segment is read-only.
+    // Mapping is released with segment, running scans read only records before used size
+    auto& segment = *m_segments.back();
+    msync(segment.pData, segment.writeOffset, MS_SYNC);
+    const auto usedSize = segment.writeOffset;
+    const int fd = segment.fd;
+    segment.fd = -1;
+    segment.isWritable = false;
+    if (ftruncate(fd, static_cast<off_t>(usedSize)) != 0) {
+        COMPLOG_WARNING("[EventLog] Failed to truncate segment:", std::strerror(errno));
+    }
+    ::close(fd);
+
+    if (segment.recordCount == 0) {
+        std::error_code ec;
+        std::filesystem::remove(segment.path, ec);
+        m_segments.pop_back();
+        return;
+    }
+    const auto segmentPath = segment.path;
+    const auto segmentId = segment.id;
+    m_segments.pop_back();
+    if (!loadSegment(segmentPath, segmentId)) {
+        COMPLOG_ERROR("[EventLog] Failed to reopen segment", segmentPath.string(), ":", m_lastErrorText);
+    }
+}
+
+EventLog::Segment *EventLog::getActiveSegment()
+{
+    if (m_segments.empty() || !m_segments.back()->isWritable) {
+        return nullptr;
+    }
+    return m_segments.back().get();
+}
+
+std::size_t EventLog::removeOlderThanLocked(int64_t timestampUs)
+{
+    std::size_t removedCount {};
+    auto segmentIt = m_segments.begin();
+    while (segmentIt != m_segments.end() && !(*segmentIt)->isWritable && (*segmentIt)->maxTimestampUs < timestampUs) {
+        std::error_code ec;
+        std::filesystem::remove((*segmentIt)->path, ec);
+        ++segmentIt;
+        removedCount++;
+    }
+    m_segments.erase(m_segments.begin(), segmentIt);
+    return removedCount;
+}
+
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "events.hpp"
+
+namespace Protocol
+{
+
+/**
+ * @brief The EventLogConfig struct Segmentation and retention of event log
+ */
+struct EventLogConfig
+{
+    std::size_t             segmentSize {64 * 1024 * 1024}; // Max size of segment file, new segment is started then
+    std::size_t             indexInterval {64 * 1024};      // Bytes of records between sparse index entries
+    std::chrono::seconds    retention {0};                  // Segments older than it are deleted on segment roll, 0 keeps all
+};
+
+/**
+ * @brief The EventLogQuery struct Filter of event log scan, all conditions must match
+ */
+struct EventLogQuery
+{
+    int64_t                 fromUs {};                                      // Inclusive, microseconds since epoch
+    int64_t                 toUs {std::numeric_limits<int64_t>::max()};     // Inclusive
+    std::optional<uint64_t> deviceId;                                       // Any device if not set, 0 is server
+    std::vector<EventType>  types;                                          // Any type if empty
+};
+
+/**
+ * @brief The EventLogRecord struct Event read from log
+ */
+struct EventLogRecord
+{
+    int64_t     timestampUs {};
+    uint64_t    deviceId {};
+    Event       event;
+};
+
+/**
+ * @brief The EventLog class Append-only event store of memory-mapped segment files
+ * @note Record is fixed header (size, timestamp, device, type) and binary event (Event::toBinary).
+ *       Timestamps never decrease in log (earlier one is raised to last), so segments and records are sorted by time.
+ *       Every segment has sparse index (timestamp -> offset) and summary of its devices and event types,
+ *       both rebuilt from records on open. Existing segments are read-only, appending goes to new segment.
+ *       Thread-safe: appends are serialized, scans run in parallel. Scan callback is called without lock,
+ *       so it may use the log; segments being scanned stay mapped until scan ends
+ */
+class EventLog
+{
+public:
+    using ScanCallback = std::function<bool(EventLogRecord&& record)>; // Returns false to stop scan
+
+    EventLog();
+    ~EventLog();
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    /**
+     * @brief open      Open log directory (created if missing) and index its segments
+     * @return          false on invalid config or IO error
+     */
+    bool open(const std::filesystem::path& directory, const EventLogConfig& config = {});
+    bool isOpen() const;
+    void close();
+
+    /**
+     * @brief append    Append event with current time. Device id is taken from device header (0 if not numeric)
+     * @return          false if log is closed, record is larger than segment or IO failed (e.g. no space for new segment)
+     */
+    bool append(const Event& ev);
+    bool append(const Event& ev, int64_t timestampUs);
+
+    /**
+     * @brief flush Write active segment to disk (msync)
+     */
+    bool flush();
+
+    /**
+     * @brief scan      Call callback for every matching record in time order
+     * @note Records appended during scan are not visited
+     * @return          Count of records passed to callback
+     */
+    std::size_t scan(const EventLogQuery& query, const ScanCallback& callback) const;
+
+    /**
+     * @brief removeOlderThan   Delete finished segments, which newest record is older than timestamp
+     * @return                  Count of deleted segments
+     */
+    std::size_t removeOlderThan(int64_t timestampUs);
+
+    std::size_t getSegmentCount() const;
+    std::string getLastErrorText() const;
+
+    static int64_t getCurrentTimestampUs();
+
+private:
+    struct Segment;
+
+    std::filesystem::path   m_directory;
+    EventLogConfig          m_config;
+    int64_t                 m_lastTimestampUs {};
+    uint64_t                m_nextSegmentId {1};
+    bool                    m_isOpened {false};     // New segment is started on append, if previous start failed
+
+    std::vector<std::shared_ptr<Segment>>   m_segments; // Sorted by id, last one is active if it is writable
+    mutable std::shared_mutex               m_mx;
+
+    std::string m_lastErrorText;
+
+    bool loadSegment(const std::filesystem::path& path, uint64_t segmentId);
+    bool startSegment();
+    void finishActiveSegment();
+    Segment* getActiveSegment();
+    std::size_t removeOlderThanLocked(int64_t timestampUs);
+};
+
+}
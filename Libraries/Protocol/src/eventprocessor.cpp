@@ -2,22 +2,35 @@
 
 #include <Components/Logger/Logger.h>
 
+#include <stdexcept>
+
 namespace Protocol
 {
 
 void EventProcessor::addEvent(Protocol::Event &&ev)
 {
-    auto processor = m_processors.find(ev.getType());
-    if (processor == m_processors.end()) {
-        COMPLOG_WARNING("PROCESSOR: [", m_name, "] Ignored event:", Protocol::toString(ev.getType()));
-        return;
-    }
-    processor->second(std::move(ev));
+    processEvent(std::move(ev));
 }
 
 void EventProcessor::setEventProcessor(Protocol::EventType etype, DeviceEventProcessor &&deviceEvent)
 {
-    m_processors.emplace(etype, std::move(deviceEvent));
+    const auto index = static_cast<std::size_t>(etype + 1);
+    if (index >= m_processors.size()) {
+        throw std::invalid_argument(std::string("Unknown event type: ") + std::to_string(etype));
+    }
+    m_processors[index] = std::move(deviceEvent);
+}
+
+bool EventProcessor::processEvent(Protocol::Event &&ev)
+{
+    const auto index = static_cast<std::size_t>(ev.getType() + 1);
+    if (index >= m_processors.size() || !m_processors[index]) {
+        const auto typeName = (index < m_processors.size()) ? Protocol::toString(ev.getType()) : std::to_string(ev.getType());
+        COMPLOG_WARNING("PROCESSOR: [", m_name, "] Ignored event:", typeName);
+        return false;
+    }
+    m_processors[index](std::move(ev));
+    return true;
 }
 
 void EventProcessor::setProcessorName(const std::string &name)
@@ -1,9 +1,9 @@
 #pragma once
 
-#include <ROD/Protocol.h>
+#include "events.hpp"
 
+#include <array>
 #include <functional>
-#include <map>
 #include <memory>
 
 namespace Protocol
@@ -19,7 +19,17 @@ using EventProcessorPtr = std::shared_ptr<EventProcessor>;
 class EventProcessor
 {
 public:
+    virtual ~EventProcessor() = default;
+
+    /**
+     * @brief addEvent  Process event in caller thread
+     */
     virtual void addEvent(Protocol::Event&& ev);
+
+    /**
+     * @brief setEventProcessor Set handler of event type, must be called before events are added
+     * @throws std::invalid_argument on type not in @enum EventType
+     */
     void setEventProcessor(Protocol::EventType etype, DeviceEventProcessor&& deviceEvent);
 
     /**
@@ -29,10 +39,18 @@ public:
     void setProcessorName(const std::string& name);
     std::string getName() const;
 
+protected:
+    /**
+     * @brief processEvent  Call handler of event type
+     * @return              false if there is no handler (event is ignored)
+     */
+    bool processEvent(Protocol::Event&& ev);
+
 private:
     std::string m_name;
 
-    std::map<Protocol::EventType, DeviceEventProcessor> m_processors;
+    // Indexed by type value + 1, lookup without search
+    std::array<DeviceEventProcessor, Protocol::EVENT_TYPE_COUNT> m_processors;
 };
 
 }
@@ -4,9 +4,91 @@
 
 #include <Components/Logger/Logger.h>
 
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
 namespace Protocol
 {
 
+namespace {
+
+constexpr uint8_t BINARY_EVENT_VERSION {1};
+constexpr uint8_t BINARY_BATCH_VERSION {0x81}; // Differs from event version, so frames are told apart by first byte
+constexpr uint8_t CUSTOM_HEADER_ID {0}; // Key is written as string
+
+// Interned header keys, id is index + 1. Only append, ids are part of the wire format
+const std::array<const std::string*, 1> INTERNED_HEADERS {
+    &EventHeaders::HEADER_DEVICE,
+};
+
+uint8_t toHeaderId(const std::string& key) noexcept
+{
+    for (std::size_t i = 0; i < INTERNED_HEADERS.size(); ++i) {
+        if (*INTERNED_HEADERS[i] == key) {
+            return static_cast<uint8_t>(i + 1);
+        }
+    }
+    return CUSTOM_HEADER_ID;
+}
+
+template <typename T>
+inline void appendLE(std::string& oBuf, T val)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        oBuf.push_back(static_cast<char>(static_cast<uint8_t>(val >> (8 * i))));
+    }
+}
+
+/**
+ * @brief The BinaryReader class Bounds-checked reader of binary event
+ */
+class BinaryReader
+{
+public:
+    explicit BinaryReader(const std::string& data) :
+        m_data {data}
+    {
+    }
+
+    template <typename T>
+    bool read(T& oVal) noexcept
+    {
+        if (m_data.size() - m_pos < sizeof(T)) {
+            return false;
+        }
+        std::make_unsigned_t<T> res {};
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            res |= static_cast<std::make_unsigned_t<T>>(static_cast<uint8_t>(m_data[m_pos + i])) << (8 * i);
+        }
+        m_pos += sizeof(T);
+        oVal = static_cast<T>(res);
+        return true;
+    }
+
+    bool read(std::size_t size, std::string& oVal)
+    {
+        if (m_data.size() - m_pos < size) {
+            return false;
+        }
+        oVal.assign(m_data, m_pos, size);
+        m_pos += size;
+        return true;
+    }
+
+    bool isEnd() const noexcept
+    {
+        return m_pos == m_data.size();
+    }
+
+private:
+    const std::string&  m_data;
+    std::size_t         m_pos {};
+};
+
+} // namespace
+
 Event::Event(const std::string &initialTxt)
 {
     readRaw(initialTxt);
@@ -15,13 +97,26 @@ Event::Event(const std::string &initialTxt)
 bool Event::readRaw(const std::string &txt) noexcept
 {
     try {
-        auto eventRequest = nlohmann::json::parse(txt);
+        return readJson(nlohmann::json::parse(txt));
+    } catch (nlohmann::json::exception& parseEx) {
+        COMPLOG_ERROR("Event parse exception:", parseEx.what());
+        return false;
+    } catch (...) {
+        return false;
+    }
+}
 
-        for (auto& [key, value] : eventRequest["headers"].items()) {
-            m_headers[key] = value;
+bool Event::readJson(const nlohmann::json &eventObject) noexcept
+{
+    try {
+        const auto headers = eventObject.find("headers");
+        if (headers != eventObject.end() && !headers->is_null()) {
+            for (auto& [key, value] : headers->items()) {
+                m_headers[key] = value;
+            }
         }
-        m_type = eventRequest["event"];
-        m_payload = eventRequest["payload"];
+        m_type = eventObject.at("event");
+        m_payload = eventObject.at("payload");
 
         return true;
     } catch (nlohmann::json::exception& parseEx) {
@@ -46,6 +141,107 @@ std::string Event::toRaw() const
     return res.dump();
 }
 
+bool Event::readBinary(const std::string &data) noexcept
+{
+    try {
+        BinaryReader reader(data);
+        uint8_t version {};
+        int16_t type {};
+        uint8_t headerCount {};
+        if (!reader.read(version) || version != BINARY_EVENT_VERSION) {
+            COMPLOG_ERROR("Event parse: unsupported binary version");
+            return false;
+        }
+        if (!reader.read(type) || !reader.read(headerCount) || type < EventType::Undefined || static_cast<std::size_t>(type + 1) >= EVENT_TYPE_COUNT) {
+            COMPLOG_ERROR("Event parse: invalid binary header");
+            return false;
+        }
+
+        std::map<std::string, std::string> headers;
+        for (uint8_t i = 0; i < headerCount; ++i) {
+            uint8_t keyId {};
+            if (!reader.read(keyId) || keyId > INTERNED_HEADERS.size()) {
+                COMPLOG_ERROR("Event parse: unknown header id");
+                return false;
+            }
+            std::string key;
+            if (keyId == CUSTOM_HEADER_ID) {
+                uint8_t keySize {};
+                if (!reader.read(keySize) || !reader.read(keySize, key)) {
+                    return false;
+                }
+            } else {
+                key = *INTERNED_HEADERS[keyId - 1];
+            }
+            uint16_t valueSize {};
+            std::string value;
+            if (!reader.read(valueSize) || !reader.read(valueSize, value)) {
+                return false;
+            }
+            headers[std::move(key)] = std::move(value);
+        }
+
+        uint32_t payloadSize {};
+        std::string payload;
+        if (!reader.read(payloadSize) || !reader.read(payloadSize, payload) || !reader.isEnd()) {
+            COMPLOG_ERROR("Event parse: invalid binary payload size");
+            return false;
+        }
+
+        m_headers = std::move(headers);
+        m_type = static_cast<EventType>(type);
+        m_payload = std::move(payload);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+std::string Event::toBinary() const
+{
+    if (m_headers.size() > std::numeric_limits<uint8_t>::max()) {
+        throw std::invalid_argument("Too many event headers for binary encoding");
+    }
+
+    std::string res;
+    res.reserve(8 + m_payload.size() + m_headers.size() * 16);
+    appendLE<uint8_t>(res, BINARY_EVENT_VERSION);
+    appendLE<uint16_t>(res, static_cast<uint16_t>(m_type));
+    appendLE<uint8_t>(res, static_cast<uint8_t>(m_headers.size()));
+    for (auto& [key, value] : m_headers) {
+        if (value.size() > std::numeric_limits<uint16_t>::max()) {
+            throw std::invalid_argument("Event header is too long: " + key);
+        }
+        const auto keyId = toHeaderId(key);
+        appendLE<uint8_t>(res, keyId);
+        if (keyId == CUSTOM_HEADER_ID) {
+            if (key.size() > std::numeric_limits<uint8_t>::max()) {
+                throw std::invalid_argument("Event header name is too long: " + key);
+            }
+            appendLE<uint8_t>(res, static_cast<uint8_t>(key.size()));
+            res += key;
+        }
+        appendLE<uint16_t>(res, static_cast<uint16_t>(value.size()));
+        res += value;
+    }
+    if (m_payload.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("Event payload is too long");
+    }
+    appendLE<uint32_t>(res, static_cast<uint32_t>(m_payload.size()));
+    res += m_payload;
+    return res;
+}
+
+bool Event::read(const std::string &data, EventEncoding encoding) noexcept
+{
+    return (encoding == EventEncoding::Binary) ? readBinary(data) : readRaw(data);
+}
+
+std::string Event::encode(EventEncoding encoding) const
+{
+    return (encoding == EventEncoding::Binary) ? toBinary() : toRaw();
+}
+
 void Event::setHeader(const std::string &header, const std::string &value)
 {
     m_headers[header] = value;
@@ -125,8 +321,132 @@ std::string toString(EventType etype)
         return "DetectedObject";
     case FailedObjectDetection:
         return "FailedObjectDetection";
+
+    // Streaming
+    case FragmentsRequested:
+        return "FragmentsRequested";
+
+    // Subscription
+    case EventsDropped:
+        return "EventsDropped";
+
+    // Streaming
+    case KeyframeRequested:
+        return "KeyframeRequested";
     }
     throw std::invalid_argument(std::string("Unknown event type: ") + std::to_string(etype));
 }
 
+bool toEventEncoding(const std::string &name, EventEncoding &oEncoding) noexcept
+{
+    if (name == "json") {
+        oEncoding = EventEncoding::Json;
+        return true;
+    }
+    if (name == "bin") {
+        oEncoding = EventEncoding::Binary;
+        return true;
+    }
+    return false;
+}
+
+std::string toString(EventEncoding encoding)
+{
+    switch (encoding)
+    {
+    case EventEncoding::Json:
+        return "json";
+    case EventEncoding::Binary:
+        return "bin";
+    }
+    throw std::invalid_argument(std::string("Unknown event encoding: ") + std::to_string(static_cast<int>(encoding)));
+}
+
+std::string writeEvents(const std::vector<Event> &events, EventEncoding encoding)
+{
+    if (events.empty() || events.size() > std::numeric_limits<uint16_t>::max()) {
+        throw std::invalid_argument("Invalid count of events in batch: " + std::to_string(events.size()));
+    }
+    if (events.size() == 1) {
+        return events.front().encode(encoding);
+    }
+
+    std::string res;
+    if (encoding == EventEncoding::Json) {
+        res.push_back('[');
+        for (auto& ev : events) {
+            res += ev.toRaw();
+            res.push_back(',');
+        }
+        res.back() = ']';
+        return res;
+    }
+
+    appendLE<uint8_t>(res, BINARY_BATCH_VERSION);
+    appendLE<uint16_t>(res, static_cast<uint16_t>(events.size()));
+    for (auto& ev : events) {
+        const auto data = ev.toBinary();
+        appendLE<uint32_t>(res, static_cast<uint32_t>(data.size()));
+        res += data;
+    }
+    return res;
+}
+
+bool readEvents(const std::string &data, EventEncoding encoding, std::vector<Event> &oEvents) noexcept
+{
+    try {
+        std::vector<Event> events;
+        if (encoding == EventEncoding::Json) {
+            if (data.empty() || data.front() != '[') {
+                events.emplace_back();
+                if (!events.back().readRaw(data)) {
+                    return false;
+                }
+            } else {
+                for (auto& element : nlohmann::json::parse(data)) {
+                    events.emplace_back();
+                    if (!element.is_object() || !events.back().readJson(element)) {
+                        return false;
+                    }
+                }
+            }
+        } else if (data.empty() || static_cast<uint8_t>(data.front()) != BINARY_BATCH_VERSION) {
+            events.emplace_back();
+            if (!events.back().readBinary(data)) {
+                return false;
+            }
+        } else {
+            BinaryReader reader(data);
+            uint8_t version {};
+            uint16_t count {};
+            reader.read(version);
+            if (!reader.read(count)) {
+                return false;
+            }
+            events.resize(count);
+            for (auto& ev : events) {
+                uint32_t size {};
+                std::string eventData;
+                if (!reader.read(size) || !reader.read(size, eventData) || !ev.readBinary(eventData)) {
+                    COMPLOG_ERROR("Event parse: invalid batch");
+                    return false;
+                }
+            }
+            if (!reader.isEnd()) {
+                return false;
+            }
+        }
+
+        for (auto& ev : events) {
+            oEvents.push_back(std::move(ev));
+        }
+        return true;
+    } catch (nlohmann::json::exception& parseEx) {
+        COMPLOG_ERROR("Event parse exception:", parseEx.what());
+        return false;
+    } catch (...) {
+        return false;
+    }
+}
+
 }
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <map>
+#include <vector>
+#include <stdint.h>
+
+#include <nlohmann/json_fwd.hpp>
 
 namespace Protocol
 {
@@ -35,8 +40,20 @@ enum EventType : short
     // Detection
     DetectedObject,
     FailedObjectDetection,
+
+    // Streaming
+    FragmentsRequested, // Server lost fragments of image, payload is FragmentNack
+
+    // Subscription
+    EventsDropped, // Subscriber queue overflowed, payload is count of dropped events
+
+    // Streaming (appended, values of types are sent in binary encoding)
+    KeyframeRequested, // Server has no reference for tile deltas of stream, payload is stream id
 };
 
+// Count of event types including Undefined, index of type is its value + 1
+constexpr std::size_t EVENT_TYPE_COUNT {static_cast<std::size_t>(EventType::KeyframeRequested) + 2};
+
 
 /**
  * @brief toString  Conversion EventType into string for display, etc.
@@ -56,6 +73,23 @@ const std::string HEADER_DEVICE {"device"};
 }
 
 
+/**
+ * @brief The EventEncoding enum Wire format of events on the event channel
+ */
+enum class EventEncoding : uint8_t
+{
+    Json = 0,   // Text frames, readable for debugging
+    Binary,     // Binary frames, header keys are interned (see Event::toBinary)
+};
+
+/**
+ * @brief toEventEncoding   Parse encoding name ("json" or "bin")
+ * @return                  false on unknown name, oEncoding is not changed then
+ */
+bool toEventEncoding(const std::string& name, EventEncoding& oEncoding) noexcept;
+std::string toString(EventEncoding encoding);
+
+
 /**
  * @brief The Event class   Event of the server, detector, etc.
  */
@@ -66,9 +100,29 @@ public:
     explicit Event(const std::string& initialTxt);
     virtual ~Event() = default;
 
+    Event(const Event&) = default;
+    Event& operator=(const Event&) = default;
+    Event(Event&&) noexcept = default;
+    Event& operator=(Event&&) noexcept = default;
+
     bool readRaw(const std::string& txt) noexcept;
+    /**
+     * @brief readJson  Read event from parsed JSON object, e.g. element of batch
+     */
+    bool readJson(const nlohmann::json& eventObject) noexcept;
     std::string toRaw() const;
 
+    /**
+     * @brief readBinary    Read event in binary encoding, event is not changed on failure
+     * @note Layout (little-endian): u8 version, i16 type, u8 header count,
+     *       headers as {u8 key id, [u8 key size, key if id is 0], u16 value size, value}, u32 payload size, payload
+     */
+    bool readBinary(const std::string& data) noexcept;
+    std::string toBinary() const;
+
+    bool read(const std::string& data, EventEncoding encoding) noexcept;
+    std::string encode(EventEncoding encoding) const;
+
     void setHeader(const std::string& header, const std::string& value);
     std::string getHeader(const std::string& headerName) const;
 
@@ -85,4 +139,19 @@ private:
     std::string                         m_payload;
 };
 
+
+
+/**
+ * @brief writeEvents   Encode events into one frame. Single event is encoded as is,
+ *                      several ones as JSON array or binary batch (u8 batch version, u16 count, {u32 size, event})
+ * @throws std::invalid_argument on empty list, more than 65535 events or event, which can not be encoded
+ */
+std::string writeEvents(const std::vector<Event>& events, EventEncoding encoding);
+
+/**
+ * @brief readEvents    Decode frame of single event or batch
+ * @param oEvents       Decoded events are appended, nothing is appended on failure
+ */
+bool readEvents(const std::string& data, EventEncoding encoding, std::vector<Event>& oEvents) noexcept;
+
 }
@@ -0,0 +1,171 @@
+#include "eventsubscription.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace Protocol
+{
+
+namespace
+{
+uint64_t getDeviceId(const Event& ev)
+{
+    const auto device = ev.getHeader(EventHeaders::HEADER_DEVICE);
+    uint64_t deviceId {};
+    auto res = std::from_chars(device.data(), device.data() + device.size(), deviceId);
+    if (res.ec != std::errc() || res.ptr != device.data() + device.size()) {
+        return 0;
+    }
+    return deviceId;
+}
+
+std::vector<std::string> splitList(const std::string& list)
+{
+    std::vector<std::string> items;
+    std::istringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        items.push_back(item);
+    }
+    return items;
+}
+}
+
+bool EventFilter::matches(const Event &ev) const
+{
+    if (!types.empty() && std::find(types.begin(), types.end(), ev.getType()) == types.end()) {
+        return false;
+    }
+    if (!devices.empty() && std::find(devices.begin(), devices.end(), getDeviceId(ev)) == devices.end()) {
+        return false;
+    }
+    return true;
+}
+
+bool EventFilter::parse(const std::string &devices, const std::string &types, EventFilter &oFilter)
+{
+    EventFilter filter;
+    for (const auto& item : splitList(devices)) {
+        uint64_t deviceId {};
+        auto res = std::from_chars(item.data(), item.data() + item.size(), deviceId);
+        if (item.empty() || res.ec != std::errc() || res.ptr != item.data() + item.size()) {
+            return false;
+        }
+        filter.devices.push_back(deviceId);
+    }
+    for (const auto& item : splitList(types)) {
+        bool isFound {false};
+        for (std::size_t index = 1; index < EVENT_TYPE_COUNT; ++index) {
+            const auto etype = static_cast<EventType>(index - 1);
+            if (toString(etype) == item) {
+                filter.types.push_back(etype);
+                isFound = true;
+                break;
+            }
+        }
+        if (!isFound) {
+            return false;
+        }
+    }
+    oFilter = std::move(filter);
+    return true;
+}
+
+bool toSubscriberOverflowPolicy(const std::string &name, SubscriberOverflowPolicy &oPolicy) noexcept
+{
+    if (name == "drop") {
+        oPolicy = SubscriberOverflowPolicy::DropOldest;
+        return true;
+    }
+    if (name == "summarize") {
+        oPolicy = SubscriberOverflowPolicy::Summarize;
+        return true;
+    }
+    return false;
+}
+
+EventSubscription::EventSubscription(const EventFilter &filter, std::size_t capacity, SubscriberOverflowPolicy policy) :
+    m_filter {filter},
+    m_capacity {capacity},
+    m_policy {policy}
+{
+    if (m_capacity == 0) {
+        throw std::invalid_argument("Subscription queue capacity must be positive");
+    }
+}
+
+const EventFilter &EventSubscription::getFilter() const
+{
+    return m_filter;
+}
+
+bool EventSubscription::push(const Event &ev)
+{
+    if (!m_filter.matches(ev)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mx);
+    if (m_events.size() >= m_capacity) {
+        auto droppedIt = m_events.begin();
+        if (m_policy == SubscriberOverflowPolicy::Summarize) {
+            // Older state of the same device is least valuable
+            const auto deviceId = ev.getHeader(EventHeaders::HEADER_DEVICE);
+            auto sameIt = std::find_if(m_events.begin(), m_events.end(), [&ev, &deviceId](const Event& queued) {
+                return (queued.getType() == ev.getType()) && (queued.getHeader(EventHeaders::HEADER_DEVICE) == deviceId);
+            });
+            if (sameIt != m_events.end()) {
+                droppedIt = sameIt;
+            }
+            m_unreportedCount++;
+        }
+        m_events.erase(droppedIt);
+        m_droppedCount++;
+    }
+    m_events.push_back(ev);
+
+    if (m_isFlushPending) {
+        return false;
+    }
+    m_isFlushPending = true;
+    return true;
+}
+
+std::vector<Event> EventSubscription::take(std::size_t maxCount, bool &oIsFlushPending)
+{
+    std::vector<Event> events;
+    std::lock_guard<std::mutex> lock(m_mx);
+    const auto count = std::min(maxCount, m_events.size());
+    events.reserve(count + 1);
+
+    if (m_unreportedCount > 0 && count > 0) {
+        Event summary;
+        summary.setType(EventType::EventsDropped);
+        summary.setPayload(std::to_string(m_unreportedCount));
+        events.push_back(std::move(summary));
+        m_unreportedCount = 0;
+    }
+    std::move(m_events.begin(), m_events.begin() + count, std::back_inserter(events));
+    m_events.erase(m_events.begin(), m_events.begin() + count);
+
+    m_isFlushPending = !m_events.empty();
+    oIsFlushPending = m_isFlushPending;
+    return events;
+}
+
+std::size_t EventSubscription::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mx);
+    return m_events.size();
+}
+
+uint64_t EventSubscription::getDroppedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mx);
+    return m_droppedCount;
+}
+
+}
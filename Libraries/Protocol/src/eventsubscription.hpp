@@ -0,0 +1,91 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "events.hpp"
+
+namespace Protocol
+{
+
+/**
+ * @brief The EventFilter struct Events a subscriber wants to receive
+ */
+struct EventFilter
+{
+    std::vector<uint64_t>   devices;    // Any device if empty, 0 is server
+    std::vector<EventType>  types;      // Any type if empty
+
+    bool matches(const Event& ev) const;
+
+    /**
+     * @brief parse     Read filter from comma separated lists: device ids ("1,2,5") and type names ("DetectorConnected,DetectedObject")
+     * @return          false on invalid id or unknown type name, oFilter is not changed then
+     */
+    static bool parse(const std::string& devices, const std::string& types, EventFilter& oFilter);
+};
+
+/**
+ * @brief The SubscriberOverflowPolicy enum What happens with events when subscriber queue is full
+ */
+enum class SubscriberOverflowPolicy : uint8_t
+{
+    DropOldest = 0, // Oldest queued event is dropped
+    Summarize,      // Queued event of the same type and device (else the oldest one) is dropped, EventsDropped is sent before next events
+};
+
+/**
+ * @brief toSubscriberOverflowPolicy    Parse policy name ("drop" or "summarize")
+ * @return                              false on unknown name, oPolicy is not changed then
+ */
+bool toSubscriberOverflowPolicy(const std::string& name, SubscriberOverflowPolicy& oPolicy) noexcept;
+
+/**
+ * @brief The EventSubscription class Filtered bounded queue of events for one subscriber
+ * @note Events are pushed by any thread and taken by sender of subscriber. A slow subscriber loses its own events only.
+ *       push returns true once, when sending must be scheduled. Sender schedules itself again,
+ *       if take leaves events in queue, so only one sending is scheduled at once
+ */
+class EventSubscription
+{
+public:
+    /**
+     * @throws std::invalid_argument on zero capacity
+     */
+    explicit EventSubscription(const EventFilter& filter, std::size_t capacity = 256,
+                               SubscriberOverflowPolicy policy = SubscriberOverflowPolicy::Summarize);
+
+    const EventFilter& getFilter() const;
+
+    /**
+     * @brief push  Queue event if it matches filter
+     * @return      true if sending of queue must be scheduled
+     */
+    bool push(const Event& ev);
+
+    /**
+     * @brief take              Take up to maxCount events in order they were pushed.
+     *                          With Summarize policy EventsDropped event (payload is count) goes first after overflow
+     * @param oIsFlushPending   true if events are left in queue and sending must be scheduled again
+     */
+    std::vector<Event> take(std::size_t maxCount, bool& oIsFlushPending);
+
+    std::size_t size() const;
+    uint64_t getDroppedCount() const;
+
+private:
+    const EventFilter               m_filter;
+    const std::size_t               m_capacity;
+    const SubscriberOverflowPolicy  m_policy;
+
+    mutable std::mutex  m_mx;
+    std::deque<Event>   m_events;
+    bool                m_isFlushPending {false};
+    uint64_t            m_droppedCount {};
+    uint64_t            m_unreportedCount {}; // Dropped since last EventsDropped
+};
+
+}
@@ -0,0 +1,24 @@
+#include "fec.hpp"
+
+#include <cstring>
+
+namespace Protocol::FEC
+{
+
+void xorInto(uint8_t* __restrict dst, const uint8_t* __restrict src, std::size_t size) noexcept
+{
+    // Word-wide loop, vectorized by compiler
+    std::size_t pos {};
+    for (; pos + sizeof(uint64_t) <= size; pos += sizeof(uint64_t)) {
+        uint64_t dstWord, srcWord;
+        std::memcpy(&dstWord, dst + pos, sizeof(dstWord));
+        std::memcpy(&srcWord, src + pos, sizeof(srcWord));
+        dstWord ^= srcWord;
+        std::memcpy(dst + pos, &dstWord, sizeof(dstWord));
+    }
+    for (; pos < size; ++pos) {
+        dst[pos] ^= src[pos];
+    }
+}
+
+} // namespace Protocol::FEC
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <stdint.h>
+
+/**
+ * @file Forward error correction for image fragments
+ *
+ * Data fragment N belongs to parity group (N % groupCount), parity of a group is XOR of its data
+ * fragments, zero-padded to MTU payload size. Interleaving allows to recover one lost fragment in
+ * every group, so burst of up to groupCount sequential lost packets is recovered.
+ */
+
+namespace Protocol::FEC
+{
+
+/**
+ * @brief xorInto   XOR source bytes into destination (dst ^= src)
+ * @param dst       Destination buffer, at least size bytes
+ * @param src       Source buffer, at least size bytes, must not overlap destination
+ */
+void xorInto(uint8_t* dst, const uint8_t* src, std::size_t size) noexcept;
+
+inline std::size_t getGroupNo(std::size_t fragmentNo, std::size_t groupCount) noexcept {
+    return fragmentNo % groupCount;
+}
+
+} // namespace Protocol::FEC
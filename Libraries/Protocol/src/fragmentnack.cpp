@@ -0,0 +1,111 @@
+#include "fragmentnack.hpp"
+
+#include <charconv>
+
+namespace Protocol {
+
+namespace {
+
+// Limit for fragments in one request (protection from invalid ranges)
+constexpr uint64_t MAX_NACK_FRAGMENTS {64 * 1024};
+
+void appendNumber(std::string& oTxt, uint64_t value) {
+    char buf[24];
+    auto res = std::to_chars(std::begin(buf), std::end(buf), value);
+    oTxt.append(buf, res.ptr);
+}
+
+bool readNumber(const char*& pPos, const char* pEnd, uint64_t& oValue) {
+    auto res = std::from_chars(pPos, pEnd, oValue);
+    if (res.ec != std::errc()) {
+        return false;
+    }
+    pPos = res.ptr;
+    return true;
+}
+
+}
+
+std::string FragmentNack::toRaw() const
+{
+    std::string res;
+    res.reserve(24 + fragmentNos.size() * 4);
+    appendNumber(res, shotId);
+    if (streamId != 0) {
+        res.push_back('/');
+        appendNumber(res, streamId);
+    }
+    res.push_back(':');
+
+    for (std::size_t i = 0; i < fragmentNos.size();) {
+        auto rangeEnd = i;
+        while (rangeEnd + 1 < fragmentNos.size() && fragmentNos[rangeEnd + 1] == fragmentNos[rangeEnd] + 1) {
+            ++rangeEnd;
+        }
+
+        if (i != 0) {
+            res.push_back(',');
+        }
+        appendNumber(res, fragmentNos[i]);
+        if (rangeEnd != i) {
+            res.push_back('-');
+            appendNumber(res, fragmentNos[rangeEnd]);
+        }
+        i = rangeEnd + 1;
+    }
+    return res;
+}
+
+bool FragmentNack::readRaw(const std::string &txt) noexcept
+{
+    fragmentNos.clear();
+
+    const char* pPos = txt.data();
+    const char* pEnd = txt.data() + txt.size();
+    if (!readNumber(pPos, pEnd, shotId) || pPos == pEnd) {
+        return false;
+    }
+    streamId = 0;
+    if (*pPos == '/') {
+        uint64_t streamNo {};
+        ++pPos;
+        if (!readNumber(pPos, pEnd, streamNo) || streamNo > UINT8_MAX || pPos == pEnd) {
+            return false;
+        }
+        streamId = static_cast<uint8_t>(streamNo);
+    }
+    if (*pPos != ':') {
+        return false;
+    }
+    ++pPos;
+
+    while (pPos != pEnd) {
+        uint64_t first {}, last {};
+        if (!readNumber(pPos, pEnd, first)) {
+            return false;
+        }
+        last = first;
+        if (pPos != pEnd && *pPos == '-') {
+            ++pPos;
+            if (!readNumber(pPos, pEnd, last) || last < first) {
+                return false;
+            }
+        }
+        if (last - first >= MAX_NACK_FRAGMENTS - fragmentNos.size()) {
+            return false;
+        }
+        for (auto fragmentNo = first; fragmentNo <= last; ++fragmentNo) {
+            fragmentNos.push_back(fragmentNo);
+        }
+
+        if (pPos != pEnd) {
+            if (*pPos != ',') {
+                return false;
+            }
+            ++pPos;
+        }
+    }
+    return true;
+}
+
+} // namespace Protocol
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace Protocol {
+
+/**
+ * @brief The FragmentNack struct Request of lost fragments of image, sent by server to detector
+ * @note Payload text is "<shot id>[/<stream id>]:<first>[-<last>],..." with consecutive fragments packed into ranges
+ */
+struct FragmentNack
+{
+    uint8_t                 streamId {};    // Written only if not zero
+    uint64_t                shotId {};
+    std::vector<uint64_t>   fragmentNos;    // Sorted numbers of missing fragments
+
+    std::string toRaw() const;
+    bool readRaw(const std::string& txt) noexcept;
+};
+
+} // namespace Protocol
@@ -0,0 +1,385 @@
+#include "frameassembler.hpp"
+
+#include "fec.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Protocol {
+
+namespace {
+
+inline std::size_t getPayloadSize(std::size_t fragmentNo, std::size_t fragmentSize, std::size_t imageSize) {
+    return std::min(fragmentSize, imageSize - fragmentNo * fragmentSize);
+}
+
+inline bool isFragmentReceived(const std::vector<uint64_t>& bitmap, std::size_t fragmentNo) {
+    return bitmap[fragmentNo / 64] & (uint64_t(1) << (fragmentNo % 64));
+}
+
+inline std::size_t getGroupSize(std::size_t groupNo, std::size_t fragmentCount, std::size_t groupCount) {
+    return fragmentCount / groupCount + (groupNo < fragmentCount % groupCount ? 1 : 0);
+}
+
+}
+
+void FrameAssembler::setFrameCallback(FrameCallback &&cbk)
+{
+    m_frameCallback = std::move(cbk);
+}
+
+void FrameAssembler::setNackCallback(NackCallback &&cbk)
+{
+    m_nackCallback = std::move(cbk);
+}
+
+void FrameAssembler::setPendingFrameCount(std::size_t frameCount)
+{
+    if (frameCount == 0) {
+        throw std::invalid_argument("Pending frame count must be at least 1");
+    }
+    m_pendingFrameCount = frameCount;
+    m_streams.clear();
+    m_senderStreamCounts.clear();
+}
+
+void FrameAssembler::setSenderFilter(SenderFilter &&filter)
+{
+    m_senderFilter = std::move(filter);
+}
+
+void FrameAssembler::setStreamIdleTimeout(std::chrono::milliseconds timeout)
+{
+    m_streamIdleTimeout = timeout;
+}
+
+void FrameAssembler::addPacket(const ImagePacketView &iView)
+{
+    addPacket(iView, Clock::now());
+}
+
+void FrameAssembler::addPacket(const ImagePacketView &iView, Clock::time_point now)
+{
+    auto& header = iView.getHeader();
+    if (header.shotId == 0 ||
+        header.totalImageSize == 0 ||
+        header.totalImageSize > MAX_IMAGE_SIZE ||
+        header.fragmentSize < ImagePacket::MIN_MTU_SIZE - ImagePacketHeader::WIRE_SIZE ||
+        header.fragmentSize > ImagePacket::MAX_MTU_PAYLOAD_SIZE) {
+        ++m_stats.invalidPackets;
+        return;
+    }
+
+    StreamKey streamKey {header.senderId, header.streamId};
+    auto* pStream = findOrCreateStream(streamKey);
+    if (!pStream) {
+        ++m_stats.rejectedPackets;
+        return;
+    }
+    pStream->lastPacketTime = now;
+    auto& senderSlots = pStream->slots;
+    auto& slot = senderSlots[header.shotId % senderSlots.size()];
+    if (header.shotId != slot.shotId) {
+        if (isStale(slot, header.shotId)) {
+            ++m_stats.stalePackets;
+            return;
+        }
+        if (m_senderFilter && !m_senderFilter(header.senderId)) {
+            ++m_stats.rejectedPackets;
+            return;
+        }
+        if (!slot.isComplete) {
+            ++m_stats.droppedFrames;
+        }
+        resetSlot(slot, header);
+
+        // Newer frame started, older ones will not receive anything except retransmission
+        for (auto& pendingSlot : senderSlots) {
+            if (pendingSlot.shotId < header.shotId) {
+                requestMissing(pendingSlot, streamKey);
+            }
+        }
+    } else if (slot.isComplete) {
+        ++m_stats.stalePackets;
+        return;
+    }
+
+    if (header.totalImageSize != slot.imageSize ||
+        header.fragmentSize != slot.fragmentSize ||
+        header.fecGroupCount != slot.fecGroupCount ||
+        header.imageHash != slot.imageHash) {
+        ++m_stats.invalidPackets;
+        return;
+    }
+
+    bool isAdded = (header.flags & ImagePacketHeader::FLAG_PARITY) ?
+                addParityFragment(slot, header, iView.getPayloadData()) :
+                addDataFragment(slot, header, iView.getPayloadData());
+    if (!isAdded) {
+        return;
+    }
+    completeIfReady(slot, streamKey);
+    if (slot.nackRounds == 0 && isLastPacket(slot, header)) {
+        requestMissing(slot, streamKey);
+    }
+}
+
+void FrameAssembler::addPackets(const ImagePacketView *pViews, std::size_t viewCount)
+{
+    const auto now = Clock::now();
+    for (std::size_t i = 0; i < viewCount; ++i) {
+        addPacket(pViews[i], now);
+    }
+    if (now - m_lastEvictionTime >= m_streamIdleTimeout / 2) {
+        evictIdleStreams(now);
+    }
+}
+
+void FrameAssembler::evictIdleStreams(Clock::time_point now)
+{
+    m_lastEvictionTime = now;
+    for (auto streamIt = m_streams.begin(); streamIt != m_streams.end();) {
+        if (now - streamIt->second.lastPacketTime < m_streamIdleTimeout) {
+            ++streamIt;
+            continue;
+        }
+        auto countIt = m_senderStreamCounts.find(streamIt->first.senderId);
+        if (countIt != m_senderStreamCounts.end() && --countIt->second == 0) {
+            m_senderStreamCounts.erase(countIt);
+        }
+        streamIt = m_streams.erase(streamIt);
+        ++m_stats.evictedStreams;
+    }
+}
+
+const AssemblerStats &FrameAssembler::getStats() const
+{
+    return m_stats;
+}
+
+FrameAssembler::StreamSlots *FrameAssembler::findOrCreateStream(const StreamKey &streamKey)
+{
+    auto streamIt = m_streams.find(streamKey);
+    if (streamIt != m_streams.end()) {
+        return &streamIt->second;
+    }
+
+    // Header is not authenticated, so stream takes memory only for known sender within limit
+    if (m_senderFilter && !m_senderFilter(streamKey.senderId)) {
+        return nullptr;
+    }
+    auto& streamCount = m_senderStreamCounts[streamKey.senderId];
+    if (streamCount >= MAX_STREAMS_PER_SENDER) {
+        return nullptr;
+    }
+    ++streamCount;
+    auto& stream = m_streams[streamKey];
+    stream.slots.resize(m_pendingFrameCount);
+    return &stream;
+}
+
+bool FrameAssembler::isStale(const FrameSlot &slot, uint64_t shotId) const
+{
+    return (shotId < slot.shotId) && (slot.shotId - shotId < REORDER_WINDOW);
+}
+
+void FrameAssembler::resetSlot(FrameSlot &slot, const ImagePacketHeader &header)
+{
+    slot.shotId         = header.shotId;
+    slot.isComplete     = false;
+    slot.fragmentSize   = header.fragmentSize;
+    slot.fragmentCount  = (header.totalImageSize + slot.fragmentSize - 1) / slot.fragmentSize;
+    slot.receivedCount  = 0;
+    slot.imageSize      = header.totalImageSize;
+    slot.buffer.clear();
+    slot.buffer.reserve(std::min(slot.imageSize, slot.completedImageSize));
+    slot.receivedBitmap.assign((slot.fragmentCount + 63) / 64, 0);
+
+    slot.imageHash   = header.imageHash;
+    slot.hashedCount = 0;
+    slot.hashState.reset();
+
+    slot.fecGroupCount = header.fecGroupCount;
+    slot.parityBuffer.resize(slot.fecGroupCount * slot.fragmentSize);
+    slot.parityReceived.assign(slot.fecGroupCount, 0);
+    slot.groupReceivedCount.assign(slot.fecGroupCount, 0);
+
+    slot.nackRounds = 0;
+}
+
+bool FrameAssembler::addDataFragment(FrameSlot &slot, const ImagePacketHeader &header, const uint8_t *pPayload)
+{
+    // Fragment must be exactly where sender puts it
+    auto fragmentNo = header.fragmentStart / slot.fragmentSize;
+    if (header.fragmentStart % slot.fragmentSize != 0 ||
+        fragmentNo >= slot.fragmentCount ||
+        header.payloadSize != getPayloadSize(fragmentNo, slot.fragmentSize, slot.imageSize)) {
+        ++m_stats.invalidPackets;
+        return false;
+    }
+
+    auto& bitmapWord = slot.receivedBitmap[fragmentNo / 64];
+    auto fragmentBit = uint64_t(1) << (fragmentNo % 64);
+    if (bitmapWord & fragmentBit) {
+        ++m_stats.duplicatePackets;
+        return false;
+    }
+    bitmapWord |= fragmentBit;
+    growBuffer(slot, header.fragmentStart + header.payloadSize);
+    std::copy(pPayload, pPayload + header.payloadSize, slot.buffer.begin() + header.fragmentStart);
+    ++slot.receivedCount;
+    updateHash(slot);
+
+    if (slot.fecGroupCount) {
+        auto groupNo = FEC::getGroupNo(fragmentNo, slot.fecGroupCount);
+        ++slot.groupReceivedCount[groupNo];
+        tryRecover(slot, groupNo);
+    }
+    return true;
+}
+
+bool FrameAssembler::addParityFragment(FrameSlot &slot, const ImagePacketHeader &header, const uint8_t *pPayload)
+{
+    auto groupNo = header.fragmentStart;
+    if (groupNo >= slot.fecGroupCount ||
+        header.payloadSize != slot.fragmentSize) {
+        ++m_stats.invalidPackets;
+        return false;
+    }
+    if (slot.parityReceived[groupNo]) {
+        ++m_stats.duplicatePackets;
+        return false;
+    }
+    slot.parityReceived[groupNo] = 1;
+    std::copy(pPayload, pPayload + header.payloadSize, slot.parityBuffer.begin() + groupNo * slot.fragmentSize);
+    tryRecover(slot, groupNo);
+    return true;
+}
+
+void FrameAssembler::tryRecover(FrameSlot &slot, std::size_t groupNo)
+{
+    // Only one lost fragment of a group could be restored
+    auto groupSize = getGroupSize(groupNo, slot.fragmentCount, slot.fecGroupCount);
+    if (!slot.parityReceived[groupNo] || slot.groupReceivedCount[groupNo] + 1 != groupSize) {
+        return;
+    }
+
+    auto* pParity = slot.parityBuffer.data() + groupNo * slot.fragmentSize;
+    m_recoverBuffer.assign(pParity, pParity + slot.fragmentSize);
+
+    std::size_t lostFragmentNo {slot.fragmentCount};
+    for (auto fragmentNo = groupNo; fragmentNo < slot.fragmentCount; fragmentNo += slot.fecGroupCount) {
+        if (!isFragmentReceived(slot.receivedBitmap, fragmentNo)) {
+            lostFragmentNo = fragmentNo;
+            continue;
+        }
+        FEC::xorInto(m_recoverBuffer.data(),
+                     slot.buffer.data() + fragmentNo * slot.fragmentSize,
+                     getPayloadSize(fragmentNo, slot.fragmentSize, slot.imageSize));
+    }
+
+    auto lostFragmentStart = lostFragmentNo * slot.fragmentSize;
+    auto lostPayloadSize = getPayloadSize(lostFragmentNo, slot.fragmentSize, slot.imageSize);
+    growBuffer(slot, lostFragmentStart + lostPayloadSize);
+    std::copy_n(m_recoverBuffer.begin(), lostPayloadSize, slot.buffer.begin() + lostFragmentStart);
+    slot.receivedBitmap[lostFragmentNo / 64] |= uint64_t(1) << (lostFragmentNo % 64);
+    ++slot.receivedCount;
+    ++slot.groupReceivedCount[groupNo];
+    ++m_stats.recoveredFragments;
+    updateHash(slot);
+}
+
+void FrameAssembler::growBuffer(FrameSlot &slot, std::size_t size)
+{
+    // Fragments mostly arrive in order, so buffer grows geometrically up to declared size
+    if (size > slot.buffer.size()) {
+        if (size > slot.buffer.capacity()) {
+            slot.buffer.reserve(std::min(std::max(size, slot.buffer.capacity() * 2), slot.imageSize));
+        }
+        slot.buffer.resize(size);
+    }
+}
+
+void FrameAssembler::updateHash(FrameSlot &slot)
+{
+    // Fragments mostly arrive in order, so hashing goes along with receiving
+    auto hashEnd = slot.hashedCount;
+    while (hashEnd < slot.fragmentCount && isFragmentReceived(slot.receivedBitmap, hashEnd)) {
+        ++hashEnd;
+    }
+    if (hashEnd == slot.hashedCount) {
+        return;
+    }
+
+    auto hashStart = slot.hashedCount * slot.fragmentSize;
+    auto hashEndByte = std::min(hashEnd * slot.fragmentSize, slot.imageSize);
+    slot.hashState.update(slot.buffer.data() + hashStart, hashEndByte - hashStart);
+    slot.hashedCount = hashEnd;
+}
+
+void FrameAssembler::completeIfReady(FrameSlot &slot, const StreamKey &streamKey)
+{
+    if (slot.receivedCount != slot.fragmentCount) {
+        return;
+    }
+
+    // Frame complete, only verified buffer goes to consumer
+    slot.isComplete = true;
+    if (slot.hashState.getDigest() != slot.imageHash) {
+        ++m_stats.corruptedFrames;
+        return;
+    }
+    ++m_stats.completedFrames;
+    slot.completedImageSize = slot.imageSize;
+    if (slot.nackRounds != 0) {
+        ++m_stats.nackRecoveredFrames;
+    }
+    if (!m_frameCallback) {
+        return;
+    }
+    SendableImage img;
+    img.setSenderId(streamKey.senderId);
+    img.setStreamId(streamKey.streamId);
+    img.setImage(slot.shotId, std::move(slot.buffer));
+    slot.buffer = {};
+    m_frameCallback(std::move(img));
+}
+
+bool FrameAssembler::isLastPacket(const FrameSlot &slot, const ImagePacketHeader &header) const
+{
+    // Sender puts parity after data, so the last parity or the last data fragment is the tail of frame
+    if (header.flags & ImagePacketHeader::FLAG_PARITY) {
+        return (header.fragmentStart + 1 == std::min(slot.fecGroupCount, slot.fragmentCount));
+    }
+    return (slot.fecGroupCount == 0) && (header.fragmentStart + header.payloadSize == slot.imageSize);
+}
+
+void FrameAssembler::requestMissing(FrameSlot &slot, const StreamKey &streamKey)
+{
+    if (!m_nackCallback || slot.isComplete || slot.nackRounds >= MAX_NACK_ROUNDS) {
+        return;
+    }
+
+    m_nack.streamId = streamKey.streamId;
+    m_nack.shotId = slot.shotId;
+    m_nack.fragmentNos.clear();
+    for (std::size_t wordNo = 0; wordNo < slot.receivedBitmap.size(); ++wordNo) {
+        auto missingBits = ~slot.receivedBitmap[wordNo];
+        while (missingBits) {
+            auto fragmentNo = wordNo * 64 + __builtin_ctzll(missingBits);
+            if (fragmentNo >= slot.fragmentCount) {
+                break;
+            }
+            m_nack.fragmentNos.push_back(fragmentNo);
+            missingBits &= missingBits - 1;
+        }
+    }
+
+    if (slot.nackRounds++ == 0) {
+        ++m_stats.nackedFrames;
+    }
+    ++m_stats.nackRequests;
+    m_nackCallback(streamKey.senderId, m_nack);
+}
+
+} // namespace Protocol
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+#include "imagepacket.hpp"
+#include "sendableimage.hpp"
+#include "fragmentnack.hpp"
+
+#include <ROD/ImageProcessing/Utility.h>
+
+namespace Protocol {
+
+/**
+ * @brief The AssemblerStats struct Statistics of frame reassembly
+ */
+struct AssemblerStats
+{
+    uint64_t completedFrames {};    // Frames passed to callback
+    uint64_t droppedFrames {};      // Incomplete frames superseded by newer ones
+    uint64_t invalidPackets {};     // Packets not fitting frame layout
+    uint64_t stalePackets {};       // Packets of already completed or dropped frames
+    uint64_t duplicatePackets {};   // Fragments received twice
+    uint64_t recoveredFragments {}; // Fragments restored from FEC parity
+    uint64_t corruptedFrames {};    // Complete frames failed hash verification (not passed to callback)
+    uint64_t rejectedPackets {};    // Packets of unknown senders or over stream limit of sender
+    uint64_t evictedStreams {};     // Streams without packets for idle timeout
+
+    // Retransmission
+    uint64_t nackRequests {};       // Requests of missing fragments sent
+    uint64_t nackedFrames {};       // Frames with at least one request
+    uint64_t nackRecoveredFrames {};// Requested frames completed after retransmission
+
+    double getNackRecoveryRatio() const {
+        return nackedFrames ? static_cast<double>(nackRecoveredFrames) / nackedFrames : 0.0;
+    }
+};
+
+/**
+ * @brief The FrameAssembler class Reassembles images from packets, fixed count of slots per stream of sender
+ * @note Not thread-safe, designed to be fed from one receive thread
+ */
+class FrameAssembler
+{
+public:
+    using FrameCallback = std::function<void(SendableImage&&)>;
+    using NackCallback  = std::function<void(uint64_t senderId, const FragmentNack& nack)>;
+    using SenderFilter  = std::function<bool(uint64_t senderId)>;
+    using Clock         = std::chrono::steady_clock;
+
+    /**
+     * @brief setFrameCallback  Set callback for completed frames. Called in thread of addPackets
+     */
+    void setFrameCallback(FrameCallback&& cbk);
+
+    /**
+     * @brief setNackCallback   Set callback requesting missing fragments from sender. Called in thread of addPackets
+     * @note Called when the last packet of frame arrived with gaps and when a newer frame of sender starts
+     */
+    void setNackCallback(NackCallback&& cbk);
+
+    /**
+     * @brief setPendingFrameCount  Set count of frames per sender kept under reassembly (1 by default)
+     * @param frameCount            More than 1 lets retransmitted fragments complete frame while newer ones arrive
+     * @throws std::invalid_argument on zero frame count
+     * @note Drops all frames under reassembly
+     */
+    void setPendingFrameCount(std::size_t frameCount);
+
+    /**
+     * @brief setSenderFilter   Accept packets only of senders passing filter (all senders by default)
+     * @note Checked when stream or frame of sender starts, so packets of a frame cost one check
+     */
+    void setSenderFilter(SenderFilter&& filter);
+
+    /**
+     * @brief setStreamIdleTimeout  Stream without packets for timeout is removed with its buffers (10 s by default)
+     */
+    void setStreamIdleTimeout(std::chrono::milliseconds timeout);
+
+    void addPacket(const ImagePacketView& iView);
+    void addPackets(const ImagePacketView* pViews, std::size_t viewCount);
+
+    /**
+     * @brief evictIdleStreams  Remove streams without packets since (now - idle timeout). Called by addPackets once in a while
+     */
+    void evictIdleStreams(Clock::time_point now);
+
+    const AssemblerStats& getStats() const;
+
+    // Limit for image size (protection from invalid headers)
+    static constexpr uint64_t MAX_IMAGE_SIZE {64 * 1024 * 1024};
+
+    // Shots older than current on less than window are late packets, others mean sender restart
+    static constexpr uint64_t REORDER_WINDOW {16};
+
+    // Count of requests for missing fragments of one frame
+    static constexpr uint8_t MAX_NACK_ROUNDS {3};
+
+    // Streams of one sender under reassembly (protection from invalid headers)
+    static constexpr std::size_t MAX_STREAMS_PER_SENDER {8};
+
+private:
+    /**
+     * @brief The FrameSlot struct Image under reassembly, buffer grows with received fragments
+     */
+    struct FrameSlot
+    {
+        uint64_t                        shotId {};
+        bool                            isComplete {true};
+        ImageProcessing::ImageData_t    buffer;             // Size is end of the farthest received fragment
+        std::size_t                     imageSize {};       // Size declared by sender
+        std::size_t                     completedImageSize {}; // Size of the last completed image, reserved for next one
+        std::vector<uint64_t>           receivedBitmap;
+        std::size_t                     fragmentSize {};    // Set by sender, same for all fragments of frame
+        std::size_t                     fragmentCount {};
+        std::size_t                     receivedCount {};
+
+        // Hash of contiguous received prefix, verified on completion
+        uint64_t                                    imageHash {};
+        ImageProcessing::Utility::ImageHashState    hashState;
+        std::size_t                                 hashedCount {};
+
+        // FEC
+        std::size_t                     fecGroupCount {};
+        std::vector<uint8_t>            parityBuffer;
+        std::vector<uint8_t>            parityReceived;
+        std::vector<std::size_t>        groupReceivedCount;
+
+        // Retransmission
+        uint8_t                         nackRounds {};
+    };
+    /**
+     * @brief The StreamKey struct Shots are sequential inside of stream of sender
+     */
+    struct StreamKey
+    {
+        uint64_t    senderId {};
+        uint8_t     streamId {};
+
+        bool operator==(const StreamKey& other) const {
+            return (senderId == other.senderId) && (streamId == other.streamId);
+        }
+    };
+    struct StreamKeyHash
+    {
+        std::size_t operator()(const StreamKey& key) const {
+            return std::hash<uint64_t>()(key.senderId ^ (static_cast<uint64_t>(key.streamId) << 56));
+        }
+    };
+    struct StreamSlots
+    {
+        std::vector<FrameSlot>  slots;          // Slot of shot is (shot id % pending frame count)
+        Clock::time_point       lastPacketTime;
+    };
+    std::unordered_map<StreamKey, StreamSlots, StreamKeyHash> m_streams;
+    std::unordered_map<uint64_t, std::size_t>   m_senderStreamCounts;
+    std::size_t m_pendingFrameCount {1};
+
+    SenderFilter                m_senderFilter;
+    std::chrono::milliseconds   m_streamIdleTimeout {10000};
+    Clock::time_point           m_lastEvictionTime;
+
+    FrameCallback   m_frameCallback;
+    NackCallback    m_nackCallback;
+    AssemblerStats  m_stats;
+    std::vector<uint8_t> m_recoverBuffer;
+    FragmentNack         m_nack;
+
+    void addPacket(const ImagePacketView& iView, Clock::time_point now);
+    StreamSlots* findOrCreateStream(const StreamKey& streamKey);
+    bool isStale(const FrameSlot& slot, uint64_t shotId) const;
+    void growBuffer(FrameSlot& slot, std::size_t size);
+    void resetSlot(FrameSlot& slot, const ImagePacketHeader& header);
+
+    bool addDataFragment(FrameSlot& slot, const ImagePacketHeader& header, const uint8_t* pPayload);
+    bool addParityFragment(FrameSlot& slot, const ImagePacketHeader& header, const uint8_t* pPayload);
+    void tryRecover(FrameSlot& slot, std::size_t groupNo);
+    void updateHash(FrameSlot& slot);
+    void completeIfReady(FrameSlot& slot, const StreamKey& streamKey);
+
+    bool isLastPacket(const FrameSlot& slot, const ImagePacketHeader& header) const;
+    void requestMissing(FrameSlot& slot, const StreamKey& streamKey);
+};
+
+} // namespace Protocol
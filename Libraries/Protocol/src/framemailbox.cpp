@@ -0,0 +1,197 @@
+#include "framemailbox.hpp"
+
+#include <algorithm>
+
+namespace Protocol {
+
+FrameMailbox::FrameMailbox(MailboxPolicy policy, std::size_t streamCapacity)
+{
+    setPolicy(policy, streamCapacity);
+}
+
+void FrameMailbox::setPolicy(MailboxPolicy policy, std::size_t streamCapacity)
+{
+    std::lock_guard<std::mutex> lock(m_mx);
+    m_policy = policy;
+    m_streamCapacity = std::max<std::size_t>(streamCapacity, 1);
+}
+
+MailboxPolicy FrameMailbox::getPolicy() const
+{
+    std::lock_guard<std::mutex> lock(m_mx);
+    return m_policy;
+}
+
+void FrameMailbox::setStreamIdleTimeout(std::chrono::milliseconds timeout)
+{
+    std::lock_guard<std::mutex> lock(m_mx);
+    m_streamIdleTimeout = timeout;
+}
+
+bool FrameMailbox::push(SendableImage &&img, bool isOrdered)
+{
+    const StreamKey key {img.getSenderId(), img.getStreamId()};
+    const auto now = Clock::now();
+    std::unique_lock<std::mutex> lock(m_mx);
+    if (m_isClosed) {
+        m_stats.dropped++;
+        return false;
+    }
+    if (now - m_lastEvictionTime >= m_streamIdleTimeout / 2) {
+        evictIdleStreamsLocked(now);
+    }
+
+    auto& box = m_streams[key];
+    box.lastPushTime = now;
+    const auto capacity = getStreamCapacity(isOrdered);
+    if (box.images.size() >= capacity) {
+        switch (m_policy) {
+        case MailboxPolicy::Block:
+            m_stats.blockedPushes++;
+            box.waitingPushes++;
+            m_spaceCv.wait(lock, [this, &box, capacity]() {
+                return (box.images.size() < capacity) || m_isClosed;
+            });
+            box.waitingPushes--;
+            if (m_isClosed) {
+                m_stats.dropped++;
+                return false;
+            }
+            break;
+        case MailboxPolicy::LatestOnly:
+            if (isOrdered) {
+                box.images.pop_front();
+                m_stats.dropped++;
+                break;
+            }
+            m_stats.superseded += box.images.size();
+            box.images.clear();
+            break;
+        case MailboxPolicy::DropOldest:
+            box.images.pop_front();
+            m_stats.dropped++;
+            break;
+        }
+    }
+
+    box.images.push_back(std::move(img));
+    m_stats.pushed++;
+    markReady(key, box);
+    lock.unlock();
+    m_readyCv.notify_one();
+    return true;
+}
+
+bool FrameMailbox::pop(SendableImage &oImg)
+{
+    std::unique_lock<std::mutex> lock(m_mx);
+    m_readyCv.wait(lock, [this]() {
+        return !m_readyStreams.empty() || m_isClosed;
+    });
+    if (m_isClosed) {
+        return false;
+    }
+
+    const auto key = m_readyStreams.front();
+    m_readyStreams.pop_front();
+    auto& box = m_streams[key];
+    box.isReady = false;
+    box.isBusy = true;
+    oImg = std::move(box.images.front());
+    box.images.pop_front();
+    m_stats.delivered++;
+    const bool isBlocking = (m_policy == MailboxPolicy::Block);
+    lock.unlock();
+
+    if (isBlocking) {
+        m_spaceCv.notify_all(); // Producer waits for exact stream
+    }
+    return true;
+}
+
+void FrameMailbox::finish(uint64_t senderId, uint8_t streamId)
+{
+    const StreamKey key {senderId, streamId};
+    std::unique_lock<std::mutex> lock(m_mx);
+    auto boxIt = m_streams.find(key);
+    if (boxIt == m_streams.end()) {
+        return;
+    }
+    boxIt->second.isBusy = false;
+    if (boxIt->second.images.empty()) {
+        return;
+    }
+    markReady(key, boxIt->second);
+    lock.unlock();
+    m_readyCv.notify_one();
+}
+
+void FrameMailbox::close()
+{
+    std::unique_lock<std::mutex> lock(m_mx);
+    m_isClosed = true;
+    for (auto& [key, box] : m_streams) {
+        m_stats.dropped += box.images.size();
+        box.images.clear();
+        box.isReady = false;
+    }
+    m_readyStreams.clear();
+    lock.unlock();
+
+    m_readyCv.notify_all();
+    m_spaceCv.notify_all();
+}
+
+void FrameMailbox::open()
+{
+    std::lock_guard<std::mutex> lock(m_mx);
+    m_isClosed = false;
+}
+
+void FrameMailbox::evictIdleStreams(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_mx);
+    evictIdleStreamsLocked(now);
+}
+
+MailboxStats FrameMailbox::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mx);
+    return m_stats;
+}
+
+std::size_t FrameMailbox::getStreamCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mx);
+    return m_streams.size();
+}
+
+std::size_t FrameMailbox::getStreamCapacity(bool isOrdered) const
+{
+    return (m_policy == MailboxPolicy::LatestOnly && !isOrdered) ? 1 : m_streamCapacity;
+}
+
+void FrameMailbox::evictIdleStreamsLocked(Clock::time_point now)
+{
+    m_lastEvictionTime = now;
+    for (auto streamIt = m_streams.begin(); streamIt != m_streams.end();) {
+        const auto& box = streamIt->second;
+        if (!box.images.empty() || box.isBusy || (box.waitingPushes > 0) || (now - box.lastPushTime < m_streamIdleTimeout)) {
+            ++streamIt;
+            continue;
+        }
+        streamIt = m_streams.erase(streamIt);
+        ++m_stats.evictedStreams;
+    }
+}
+
+void FrameMailbox::markReady(const StreamKey &key, StreamBox &box)
+{
+    if (box.isBusy || box.isReady) {
+        return;
+    }
+    box.isReady = true;
+    m_readyStreams.push_back(key);
+}
+
+} // namespace Protocol
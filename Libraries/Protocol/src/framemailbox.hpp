@@ -0,0 +1,150 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <stdint.h>
+
+#include "sendableimage.hpp"
+
+namespace Protocol {
+
+/**
+ * @brief The MailboxPolicy enum What to do with frame of stream, which mailbox is full
+ */
+enum class MailboxPolicy : uint8_t
+{
+    DropOldest = 0, // Oldest queued frame of stream is dropped
+    LatestOnly,     // Only one frame per stream is queued, new frame supersedes it (capacity is used by ordered frames)
+    Block,          // Producer waits for consumer
+};
+
+/**
+ * @brief The MailboxStats struct Statistics of frame delivery
+ */
+struct MailboxStats
+{
+    uint64_t pushed {};
+    uint64_t delivered {};
+    uint64_t superseded {};     // Replaced by newer frame (LatestOnly)
+    uint64_t dropped {};        // Dropped on overflow (DropOldest) or on close
+    uint64_t blockedPushes {};  // Producer waited for free space (Block)
+    uint64_t evictedStreams {}; // Streams without frames for idle timeout
+};
+
+/**
+ * @brief The FrameMailbox class Bounded queues of completed frames per stream (sender and stream id)
+ * @note Frames of one stream are never processed by two consumers at once and are delivered in order:
+ *       popped stream is busy until finish() is called. Streams are served round-robin
+ * @note Dropping policies break tile delta chains, server requests keyframe of stream then (KeyframeRequested).
+ *       Ordered frames (tile coding) are not superseded by LatestOnly, they are queued like with DropOldest
+ */
+class FrameMailbox
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param policy            Overflow policy
+     * @param streamCapacity    Max count of queued frames of every stream, at least 1
+     */
+    explicit FrameMailbox(MailboxPolicy policy = MailboxPolicy::LatestOnly, std::size_t streamCapacity = 4);
+
+    FrameMailbox(const FrameMailbox&) = delete;
+    FrameMailbox& operator=(const FrameMailbox&) = delete;
+
+    /**
+     * @brief setPolicy Change policy, must be called before frames are pushed
+     */
+    void setPolicy(MailboxPolicy policy, std::size_t streamCapacity);
+    MailboxPolicy getPolicy() const;
+
+    /**
+     * @brief setStreamIdleTimeout  Stream without frames for timeout is forgotten (10 s by default)
+     */
+    void setStreamIdleTimeout(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief push      Queue frame by policy. With Block policy waits while stream is full
+     * @param isOrdered Frame depends on previous frames of stream (tile delta), LatestOnly queues it up to stream capacity
+     * @return          false if mailbox is closed (frame is dropped)
+     */
+    bool push(SendableImage&& img, bool isOrdered = false);
+
+    /**
+     * @brief pop   Wait for frame of any stream, which is not processed now
+     * @return      false if mailbox is closed
+     */
+    bool pop(SendableImage& oImg);
+
+    /**
+     * @brief finish    Frame of stream is processed, next frame of the stream could be popped
+     */
+    void finish(uint64_t senderId, uint8_t streamId);
+
+    /**
+     * @brief close Wake up waiting producers and consumers, queued frames are dropped
+     */
+    void close();
+
+    /**
+     * @brief open  Accept frames again after close
+     */
+    void open();
+
+    /**
+     * @brief evictIdleStreams  Forget idle streams without frames since (now - idle timeout). Called by push once in a while
+     */
+    void evictIdleStreams(Clock::time_point now);
+
+    MailboxStats getStats() const;
+    std::size_t getStreamCount() const;
+
+private:
+    struct StreamKey
+    {
+        uint64_t    senderId {};
+        uint8_t     streamId {};
+
+        bool operator==(const StreamKey& other) const {
+            return (senderId == other.senderId) && (streamId == other.streamId);
+        }
+    };
+    struct StreamKeyHash
+    {
+        std::size_t operator()(const StreamKey& key) const {
+            return std::hash<uint64_t>()(key.senderId ^ (static_cast<uint64_t>(key.streamId) << 56));
+        }
+    };
+    struct StreamBox
+    {
+        std::deque<SendableImage>   images;
+        bool                        isBusy {false};     // Popped frame is processed by consumer
+        bool                        isReady {false};    // In ready list
+        std::size_t                 waitingPushes {};   // Producers waiting for space (Block)
+        Clock::time_point           lastPushTime {};
+    };
+
+    MailboxPolicy   m_policy {};
+    std::size_t     m_streamCapacity {};
+    bool            m_isClosed {false};
+
+    std::chrono::milliseconds   m_streamIdleTimeout {10000};
+    Clock::time_point           m_lastEvictionTime {};
+
+    std::unordered_map<StreamKey, StreamBox, StreamKeyHash> m_streams;
+    std::deque<StreamKey>   m_readyStreams; // Have frames and are not busy
+
+    mutable std::mutex      m_mx;
+    std::condition_variable m_readyCv;  // Consumers wait for frames
+    std::condition_variable m_spaceCv;  // Producers wait for space (Block)
+    MailboxStats            m_stats;
+
+    std::size_t getStreamCapacity(bool isOrdered) const;
+    void evictIdleStreamsLocked(Clock::time_point now);
+    void markReady(const StreamKey& key, StreamBox& box);
+};
+
+} // namespace Protocol
@@ -25,8 +25,11 @@ const std::string   API_VERSION         {"v1"};
 const std::string   SERVER_BASE         {"/api/" + API_VERSION + "/server"};
 const auto          SERVER_STATUS_BASE  {SERVER_BASE + "/status"};
 const auto          SERVER_POWER_BASE   {SERVER_BASE + "/power"};
+const auto          SERVER_STREAMING_BASE {SERVER_BASE + "/streaming"};
 const std::string   DETECTOR_BASE       {"/api/" + API_VERSION + "/detector"};
 const auto          DETECTOR_APP_BASE   {DETECTOR_BASE + "/software"};
+const std::string   EVENTS_BASE         {"/api/" + API_VERSION + "/events"};
+const auto          EVENTS_SUBSCRIBE_BASE {EVENTS_BASE + "/subscribe"};
 
 
 // API in Qt side
@@ -34,6 +37,7 @@ namespace QT
 {
 const auto SERVER_STATUS    {SERVER_STATUS_BASE};
 const auto SERVER_POWER     {SERVER_POWER_BASE + "/%1"};
+const auto SERVER_STREAMING {SERVER_STREAMING_BASE};
 
 const auto DETECTOR_APP_VERSION_GET_ALL {DETECTOR_APP_BASE + "/versions"};
 const auto DETECTOR_APP_VERSION_GET     {DETECTOR_APP_BASE + "/%1"};
@@ -46,6 +50,9 @@ const auto DETECTOR_INFO                {DETECTOR_BASE + "/%1/info"};
 const auto DETECTOR_STATUS              {DETECTOR_BASE + "/%1/status"};
 const auto DETECTOR_POWER               {DETECTOR_BASE + "/%1/power/%2"};
 const auto DETECTOR_TOGGLE_STREAMING    {DETECTOR_BASE + "/%1/streaming?enabled=%2"};
+
+const auto EVENTS_SUBSCRIBE             {EVENTS_SUBSCRIBE_BASE + "?dev=%1&types=%2&policy=%3"}; // WebSocket, see EventFilter::parse
+const auto EVENTS_HISTORY               {EVENTS_BASE + "?from=%1&to=%2&dev=%3&types=%4"};       // Microseconds since epoch, inclusive
 }
 
 
@@ -54,6 +61,7 @@ namespace DROGON
 {
 const auto SERVER_STATUS    {SERVER_STATUS_BASE};
 const auto SERVER_POWER     {SERVER_POWER_BASE + "/{action_type}"};
+const auto SERVER_STREAMING {SERVER_STREAMING_BASE};
 
 const auto DETECTOR_APP_VERSION_GET_ALL {DETECTOR_APP_BASE + "/versions"};
 const auto DETECTOR_APP_VERSION_GET     {DETECTOR_APP_BASE + "/{dev_uuid}"};
@@ -66,6 +74,9 @@ const auto DETECTOR_INFO                {DETECTOR_BASE + "/{dev_uuid}/info"};
 const auto DETECTOR_STATUS              {DETECTOR_BASE + "/{dev_uuid}/status"};
 const auto DETECTOR_POWER               {DETECTOR_BASE + "/{dev_uuid}/power/{power_action}"};
 const auto DETECTOR_TOGGLE_STREAMING    {DETECTOR_BASE + "/{dev_uuid}/streaming?enabled={is_enabled}"};
+
+const auto EVENTS_SUBSCRIBE             {EVENTS_SUBSCRIBE_BASE};
+const auto EVENTS_HISTORY               {EVENTS_BASE};
 }
 
 }
@@ -1,34 +1,35 @@
 #include "imagepacket.hpp"
 
-#include <boost/archive/binary_iarchive.hpp>
-#include <boost/archive/binary_oarchive.hpp>
-#include <boost/archive/archive_exception.hpp>
-#include <boost/serialization/vector.hpp>
-
-#include <boost/iostreams/device/back_inserter.hpp>
-#include <boost/iostreams/stream.hpp>
+#include <algorithm>
+#include <stdexcept>
 
 #include <Components/Logger/Logger.h>
 
-#include <ROD/ImageProcessing/Utility.h>
-
 using namespace ImageProcessing;
 
 /*
 
-TOTAL SIZE: 1400 (Ethernet MTU)
-PAYLOAD: Calculates using other parts of a packet
+TOTAL SIZE: 1400 by default (Ethernet MTU), up to 8972 (jumbo frames), set by sender
+HEADER: 48 bytes, fixed layout, little-endian
+PAYLOAD: Rest of the datagram
 
 Shot ID 0 is reserved for invalid shots
 
 
-Field name          |  Size (byte)  |    Example    |   Description
+Field name          |  Offset  |  Size (byte)  |    Example    |   Description
 --------------------------------------------------------------------------------------------------------------------
-Shot ID             |       8       |  00000000001  |   Sequential, from 1 to N, increments every time shot created
-Fragment start      |       8       |  00000000000  |   Always zero (conversion issue)
-Shot hash           |      64       |  a5317f9123e  |   XXH3 hash
-Total size          |       8       |  00000000001  |   Image bytes total count
-Payload             |   Calculated  |  ...........  |   Image bytes
+Version             |     0    |       1       |  04           |   Header layout version, unknown versions are dropped
+Flags               |     1    |       1       |  00           |   Packet kind, 0x01 -- FEC parity (fragment start is group number)
+Payload size        |     2    |       2       |  00000000544  |   Count of payload bytes after the header
+FEC groups          |     4    |       1       |  00           |   Count of parity groups in shot, 0 if FEC disabled
+Stream ID           |     5    |       1       |  00           |   Camera or variant of sender, shots are counted per stream
+Fragment size       |     6    |       2       |  00000001352  |   Payload size of every data fragment except the last one, and of parity
+Sender ID           |     8    |       8       |  00000000001  |   Detector ID
+Shot ID             |    16    |       8       |  00000000001  |   Sequential, from 1 to N, increments every time shot of stream created
+Fragment start      |    24    |       8       |  00000000000  |   Offset of payload in the image
+Total size          |    32    |       8       |  00000000001  |   Image bytes total count
+Shot hash           |    40    |       8       |  a5317f9123e  |   XXH3 64-bit hash of the whole image
+Payload             |    48    |   Calculated  |  ...........  |   Image bytes
 
 
 */
@@ -37,38 +38,93 @@ namespace Protocol {
 
 static bool s_isLoggingEnabled {false};
 
-/**
- * @brief The vector_istreambuf class Extra class for reading data from std::vector
- */
-struct vector_istreambuf : std::streambuf {
-    vector_istreambuf(const std::vector<uint8_t>& v) {
-        auto* data = reinterpret_cast<char*>(const_cast<uint8_t*>(v.data()));
-        setg(data, data, data + v.size());
+namespace {
+
+template <typename T>
+inline void writeLE(uint8_t* oBuf, T val) noexcept {
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        oBuf[i] = static_cast<uint8_t>(val >> (8 * i));
     }
-};
-
-/**
- * @brief The vector_ostreambuf class Extra class for writing data to std::vector
- */
-struct vector_ostreambuf : std::streambuf {
-    explicit vector_ostreambuf(std::vector<uint8_t>& v) : vec(v) {}
-
-protected:
-    int_type overflow(int_type c) override {
-        if (c != traits_type::eof()) {
-            vec.push_back(static_cast<uint8_t>(c));
-        }
-        return c;
+}
+
+template <typename T>
+inline T readLE(const uint8_t* iBuf) noexcept {
+    T res {};
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        res |= static_cast<T>(iBuf[i]) << (8 * i);
+    }
+    return res;
+}
+
+} // namespace
+
+std::size_t ImagePacketHeader::writeTo(uint8_t *oBuf, std::size_t bufSize) const noexcept
+{
+    if (bufSize < WIRE_SIZE) {
+        return 0;
+    }
+    writeLE<uint8_t>(oBuf + 0, version);
+    writeLE<uint8_t>(oBuf + 1, flags);
+    writeLE<uint16_t>(oBuf + 2, payloadSize);
+    writeLE<uint8_t>(oBuf + 4, fecGroupCount);
+    writeLE<uint8_t>(oBuf + 5, streamId);
+    writeLE<uint16_t>(oBuf + 6, fragmentSize);
+    writeLE<uint64_t>(oBuf + 8, senderId);
+    writeLE<uint64_t>(oBuf + 16, shotId);
+    writeLE<uint64_t>(oBuf + 24, fragmentStart);
+    writeLE<uint64_t>(oBuf + 32, totalImageSize);
+    writeLE<uint64_t>(oBuf + 40, imageHash);
+    return WIRE_SIZE;
+}
+
+bool ImagePacketHeader::readFrom(const uint8_t *iBuf, std::size_t bufSize) noexcept
+{
+    if (bufSize < WIRE_SIZE || iBuf[0] != CURRENT_VERSION) {
+        return false;
+    }
+    version         = readLE<uint8_t>(iBuf + 0);
+    flags           = readLE<uint8_t>(iBuf + 1);
+    payloadSize     = readLE<uint16_t>(iBuf + 2);
+    fecGroupCount   = readLE<uint8_t>(iBuf + 4);
+    streamId        = readLE<uint8_t>(iBuf + 5);
+    fragmentSize    = readLE<uint16_t>(iBuf + 6);
+    senderId        = readLE<uint64_t>(iBuf + 8);
+    shotId          = readLE<uint64_t>(iBuf + 16);
+    fragmentStart   = readLE<uint64_t>(iBuf + 24);
+    totalImageSize  = readLE<uint64_t>(iBuf + 32);
+    imageHash       = readLE<uint64_t>(iBuf + 40);
+    return true;
+}
+
+bool ImagePacketView::init(const uint8_t *iData, std::size_t iSize) noexcept
+{
+    m_payload = nullptr;
+    if (!m_header.readFrom(iData, iSize)) {
+        return false;
     }
 
-    std::streamsize xsputn(const char* s, std::streamsize n) override {
-        vec.insert(vec.end(), s, s + n);
-        return n;
+    // Payload must take the rest of datagram (truncated datagrams are dropped)
+    if (m_header.payloadSize != iSize - ImagePacketHeader::WIRE_SIZE) {
+        return false;
     }
+    m_payload = iData + ImagePacketHeader::WIRE_SIZE;
+    return true;
+}
+
+const ImagePacketHeader &ImagePacketView::getHeader() const noexcept
+{
+    return m_header;
+}
+
+const uint8_t *ImagePacketView::getPayloadData() const noexcept
+{
+    return m_payload;
+}
 
-private:
-    std::vector<uint8_t>& vec;
-};
+std::size_t ImagePacketView::getPayloadSize() const noexcept
+{
+    return m_header.payloadSize;
+}
 
 void ImagePacket::setLoggingEnabled(bool isLoggingEnabled)
 {
@@ -100,6 +156,16 @@ uint64_t ImagePacket::getSenderId() const
     return m_senderId;
 }
 
+void ImagePacket::setStreamId(uint8_t streamId)
+{
+    m_streamId = streamId;
+}
+
+uint8_t ImagePacket::getStreamId() const
+{
+    return m_streamId;
+}
+
 void ImagePacket::setTotalImageSize(uint64_t totalSize)
 {
     if (m_fragmentStartByte > totalSize) {
@@ -126,19 +192,32 @@ uint64_t ImagePacket::getFragmentStart() const
     return m_fragmentStartByte;
 }
 
-void ImagePacket::setImageHash(const std::vector<uint8_t> &imgHash)
+void ImagePacket::setImageHash(uint64_t imgHash)
 {
     m_imageHash = imgHash;
 }
 
-const std::vector<uint8_t> &ImagePacket::getImageHash() const
+uint64_t ImagePacket::getImageHash() const
 {
     return m_imageHash;
 }
 
+void ImagePacket::setFragmentSize(std::size_t fragmentSize)
+{
+    if (fragmentSize == 0 || fragmentSize > MAX_MTU_PAYLOAD_SIZE) {
+        throw std::invalid_argument("Invalid fragment size");
+    }
+    m_fragmentSize = fragmentSize;
+}
+
+std::size_t ImagePacket::getFragmentSize() const
+{
+    return m_fragmentSize;
+}
+
 void ImagePacket::setPayload(ImageData_t &&payload)
 {
-    if (payload.size() > MTU_PAYLOAD_SIZE) {
+    if (payload.size() > MAX_MTU_PAYLOAD_SIZE) {
         throw std::invalid_argument("Payload size is more, than allowed");
     }
     m_payload = std::move(payload);
@@ -149,53 +228,76 @@ const ImageData_t &ImagePacket::getPayload() const
     return m_payload;
 }
 
-bool ImagePacket::initFromPacketPart(const std::vector<uint8_t> &iData)
+bool ImagePacket::initFromView(const ImagePacketView &iView)
 {
-    if (iData.empty()) return false;
+    auto& header = iView.getHeader();
+    if (iView.getPayloadData() == nullptr || header.payloadSize > header.fragmentSize) {
+        if (s_isLoggingEnabled) {
+            COMPLOG_WARNING("Failed to init packet: invalid packet view");
+        }
+        *this = {}; // Reset self
+        return false;
+    }
 
-    vector_istreambuf isb(iData);
-    std::istream is(&isb);
-    try {
-        boost::archive::binary_iarchive ia(is);
-        ia >> *this;
+    m_senderId          = header.senderId;
+    m_streamId          = header.streamId;
+    m_shotId            = header.shotId;
+    m_totalImageSize    = header.totalImageSize;
+    m_fragmentStartByte = header.fragmentStart;
+    m_imageHash         = header.imageHash;
+    m_fragmentSize      = header.fragmentSize;
+    m_payload.assign(iView.getPayloadData(), iView.getPayloadData() + iView.getPayloadSize());
+    return true;
+}
 
-        if (m_payload.size() > MTU_PAYLOAD_SIZE) {
-            throw std::invalid_argument("Serialized payload size is more, than allowed");
-        }
+bool ImagePacket::initFromPacketPart(const std::vector<uint8_t> &iData)
+{
+    if (iData.empty()) return false;
 
-        return true;
-    } catch (const boost::archive::archive_exception& e) {
+    ImagePacketView view;
+    if (!view.init(iData.data(), iData.size())) {
         if (s_isLoggingEnabled) {
-            COMPLOG_WARNING("(archivator error) Failed to deserialize packet:", e.what());
-        }
-    } catch (const std::exception& e) {
-        if (s_isLoggingEnabled) {
-            COMPLOG_WARNING("(Unknown error) Failed to deserialize packet:", e.what());
+            COMPLOG_WARNING("Failed to deserialize packet: invalid header, size:", iData.size());
         }
+        *this = {}; // Reset self
+        return false;
     }
-    *this = {}; // Reset self
-    return false;
+    return initFromView(view);
 }
 
-std::vector<uint8_t> ImagePacket::convertToPacketPart() const
+std::size_t ImagePacket::writePacketPart(uint8_t *oBuf, std::size_t bufSize) const
 {
-    std::vector<uint8_t> oData;
-    oData.reserve(MTU_SIZE);
-    vector_ostreambuf os(oData);
-    try {
-        boost::archive::binary_oarchive oa(os);
-        oa << *this;
-        return oData;
-    } catch (const boost::archive::archive_exception& e) {
-        if (s_isLoggingEnabled) {
-            COMPLOG_WARNING("(archivator error) Failed to deserialize packet:", e.what());
-        }
-    } catch (const std::exception& e) {
+    auto header = createHeader();
+    if (bufSize < ImagePacketHeader::WIRE_SIZE + m_payload.size()) {
         if (s_isLoggingEnabled) {
-            COMPLOG_WARNING("(Unknown error) Failed to deserialize packet:", e.what());
+            COMPLOG_WARNING("Failed to serialize packet: buffer too small:", bufSize);
         }
+        return 0;
     }
-    return {};
+    auto written = header.writeTo(oBuf, bufSize);
+    std::copy(m_payload.begin(), m_payload.end(), oBuf + written);
+    return written + m_payload.size();
+}
+
+std::vector<uint8_t> ImagePacket::convertToPacketPart() const
+{
+    std::vector<uint8_t> oData(ImagePacketHeader::WIRE_SIZE + m_payload.size());
+    writePacketPart(oData.data(), oData.size());
+    return oData;
+}
+
+ImagePacketHeader ImagePacket::createHeader() const
+{
+    ImagePacketHeader header;
+    header.payloadSize      = static_cast<uint16_t>(m_payload.size());
+    header.senderId         = m_senderId;
+    header.streamId         = m_streamId;
+    header.shotId           = m_shotId;
+    header.fragmentStart    = m_fragmentStartByte;
+    header.totalImageSize   = m_totalImageSize;
+    header.imageHash        = m_imageHash;
+    header.fragmentSize     = static_cast<uint16_t>(m_fragmentSize);
+    return header;
 }
 
 bool ImagePacket::operator <(const ImagePacket& _oPacket) const {
@@ -205,10 +307,12 @@ bool ImagePacket::operator <(const ImagePacket& _oPacket) const {
 bool ImagePacket::operator ==(const ImagePacket& _oPacket) const {
     return
         m_senderId          == _oPacket.m_senderId &&
+        m_streamId          == _oPacket.m_streamId &&
         m_shotId            == _oPacket.m_shotId &&
         m_totalImageSize    == _oPacket.m_totalImageSize &&
         m_fragmentStartByte == _oPacket.m_fragmentStartByte &&
         m_imageHash         == _oPacket.m_imageHash &&
+        m_fragmentSize      == _oPacket.m_fragmentSize &&
         m_payload           == _oPacket.m_payload;
 }
 
@@ -2,15 +2,73 @@
 
 #include <vector>
 #include <stdint.h>
+#include <cstddef>
 
 #include <ROD/ImageProcessing/Common.h>
 
-namespace boost::serialization {
-class access;
-}
-
 namespace Protocol {
 
+/**
+ * @brief The ImagePacketHeader struct Fixed-layout header of image packet
+ * @note On wire all fields are little-endian, layout described in imagepacket.cpp
+ */
+struct ImagePacketHeader
+{
+    uint8_t     version {CURRENT_VERSION};
+    uint8_t     flags {};
+    uint16_t    payloadSize {};
+    uint8_t     fecGroupCount {};
+    uint8_t     streamId {};
+    uint16_t    fragmentSize {};
+    uint64_t    senderId {};
+    uint64_t    shotId {};
+    uint64_t    fragmentStart {};
+    uint64_t    totalImageSize {};
+    uint64_t    imageHash {};
+
+    static constexpr uint8_t        CURRENT_VERSION {4};
+    static constexpr std::size_t    WIRE_SIZE {48};
+
+    // Flags
+    static constexpr uint8_t        FLAG_PARITY {0x01}; // Payload is XOR parity of FEC group, fragment start is group number
+
+    /**
+     * @brief writeTo   Write header into buffer
+     * @param oBuf      Buffer to write into, at least WIRE_SIZE bytes
+     * @param bufSize   Size of the buffer
+     * @return          Count of bytes written (WIRE_SIZE) or 0 if buffer is too small
+     */
+    std::size_t writeTo(uint8_t* oBuf, std::size_t bufSize) const noexcept;
+
+    /**
+     * @brief readFrom  Read header from buffer
+     * @param iBuf      Received datagram bytes
+     * @param bufSize   Size of the datagram
+     * @return          false on too small buffer or unsupported version
+     */
+    bool readFrom(const uint8_t* iBuf, std::size_t bufSize) noexcept;
+};
+
+
+/**
+ * @brief The ImagePacketView class Non-owning view over received image packet datagram
+ * @note Valid until the datagram buffer is alive
+ */
+class ImagePacketView
+{
+public:
+    bool init(const uint8_t* iData, std::size_t iSize) noexcept;
+
+    const ImagePacketHeader& getHeader() const noexcept;
+    const uint8_t* getPayloadData() const noexcept;
+    std::size_t getPayloadSize() const noexcept;
+
+private:
+    ImagePacketHeader   m_header {};
+    const uint8_t*      m_payload {nullptr};
+};
+
+
 /**
  * @brief The ImagePacket class Part of image data (first or next packets)
  */
@@ -27,19 +85,34 @@ public:
     void setSenderId(uint64_t sId);
     uint64_t getSenderId() const;
 
+    void setStreamId(uint8_t streamId);
+    uint8_t getStreamId() const;
+
     void setTotalImageSize(uint64_t totalSize);
     uint64_t getTotalImageSize() const;
 
     void setFragmentStart(uint64_t startByte);
     uint64_t getFragmentStart() const;
 
-    void setImageHash(const std::vector<uint8_t>& imgHash);
-    const std::vector<uint8_t>& getImageHash() const;
+    void setImageHash(uint64_t imgHash);
+    uint64_t getImageHash() const;
+
+    void setFragmentSize(std::size_t fragmentSize);
+    std::size_t getFragmentSize() const;
 
     void setPayload(ImageProcessing::ImageData_t&& payload);
     const ImageProcessing::ImageData_t& getPayload() const;
 
+    bool initFromView(const ImagePacketView& iView);
     bool initFromPacketPart(const std::vector<uint8_t>& iData);
+
+    /**
+     * @brief writePacketPart   Write packet (header and payload) into caller buffer
+     * @param oBuf              Buffer to write into, MTU_SIZE is always enough
+     * @param bufSize           Size of the buffer
+     * @return                  Count of bytes written or 0 if buffer is too small
+     */
+    std::size_t writePacketPart(uint8_t* oBuf, std::size_t bufSize) const;
     std::vector<uint8_t> convertToPacketPart() const;
 
     bool operator <(const ImagePacket& _oPacket) const;
@@ -48,36 +121,24 @@ public:
 
 private:
     uint64_t                        m_senderId {};
+    uint8_t                         m_streamId {};
     uint64_t                        m_shotId {};
     uint64_t                        m_totalImageSize {};
     uint64_t                        m_fragmentStartByte {};
-    std::vector<uint8_t>            m_imageHash {};
+    uint64_t                        m_imageHash {};
+    std::size_t                     m_fragmentSize {MTU_PAYLOAD_SIZE};
     ImageProcessing::ImageData_t    m_payload {};
 
-    template<class Archive>
-    void serialize(Archive& ar, const unsigned int version) {
-        ar & m_senderId;
-        ar & m_shotId;
-        ar & m_fragmentStartByte;
-
-        // TODO: Separate fields if good solution
-        ar & m_imageHash;
-        ar & m_totalImageSize;
-
-        ar & m_payload;
-    }
-    friend class boost::serialization::access;
+    ImagePacketHeader createHeader() const;
 
 public:
-    // UDP Minimal Transporting Unit sizes
+    // UDP Minimal Transporting Unit sizes (whole datagram), default one is used if sender did not set other
     // TODO: Move to constants?
-    static constexpr auto MTU_SIZE {1400};
-    static constexpr auto MTU_PAYLOAD_SIZE {MTU_SIZE // TODO: Add processing for first packet (no sense in extra fields)
-        - sizeof(m_shotId)
-        - sizeof(m_fragmentStartByte)
-        - sizeof(m_totalImageSize)
-        - sizeof(m_imageHash)
-    };
+    static constexpr std::size_t MTU_SIZE {1400};
+    static constexpr std::size_t MIN_MTU_SIZE {576 - 28};   // Minimal IPv4 datagram without IP and UDP headers
+    static constexpr std::size_t MAX_MTU_SIZE {9000 - 28};  // Jumbo frame without IP and UDP headers
+    static constexpr std::size_t MTU_PAYLOAD_SIZE {MTU_SIZE - ImagePacketHeader::WIRE_SIZE};
+    static constexpr std::size_t MAX_MTU_PAYLOAD_SIZE {MAX_MTU_SIZE - ImagePacketHeader::WIRE_SIZE};
 };
 
 } // namespace Protocol
@@ -0,0 +1,188 @@
+#include "imagestreamreceiver.hpp"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <Components/Logger/Logger.h>
+
+namespace Protocol {
+
+namespace {
+constexpr auto RECEIVE_TIMEOUT_US {100'000}; // For stop flag check
+constexpr auto RECEIVE_BUFFER_SIZE {8 * 1024 * 1024};
+constexpr auto CONTROL_SIZE {CMSG_SPACE(sizeof(uint32_t))};
+}
+
+ImageStreamReceiver::ImageStreamReceiver(std::size_t batchSize) :
+    m_batchSize {batchSize ? batchSize : 1}
+{
+
+}
+
+ImageStreamReceiver::~ImageStreamReceiver()
+{
+    stop();
+}
+
+void ImageStreamReceiver::setBatchProcessor(BatchProcessor &&processor)
+{
+    m_batchProcessor = std::move(processor);
+}
+
+bool ImageStreamReceiver::start(uint16_t port)
+{
+    if (isWorking()) {
+        return true;
+    }
+
+    m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_socket < 0) {
+        m_lastErrorText = std::string("Failed to open socket: ") + std::strerror(errno);
+        return false;
+    }
+
+    int enabled {1};
+    setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+    setsockopt(m_socket, SOL_SOCKET, SO_RXQ_OVFL, &enabled, sizeof(enabled));
+
+    int receiveBufferSize {RECEIVE_BUFFER_SIZE};
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+
+    timeval timeout {0, RECEIVE_TIMEOUT_US};
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        m_lastErrorText = std::string("Failed to bind socket: ") + std::strerror(errno);
+        ::close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+    socklen_t addrLen = sizeof(addr);
+    getsockname(m_socket, reinterpret_cast<sockaddr*>(&addr), &addrLen);
+    m_port = ntohs(addr.sin_port);
+
+    // Slab for whole batch, never reallocated while receiving. Every sender could choose own MTU, so max one is reserved
+    m_slab.resize(m_batchSize * ImagePacket::MAX_MTU_SIZE);
+    m_controlSlab.resize(m_batchSize * CONTROL_SIZE);
+    m_iovecs.resize(m_batchSize);
+    m_messages.resize(m_batchSize);
+    m_views.resize(m_batchSize);
+
+    m_isWorking.store(true, std::memory_order_release);
+    m_receiveThread = std::make_unique<std::thread>([this]() {
+        receiveLoop();
+    });
+    return true;
+}
+
+bool ImageStreamReceiver::isWorking() const
+{
+    return m_isWorking.load(std::memory_order_acquire);
+}
+
+void ImageStreamReceiver::stop()
+{
+    if (!isWorking()) {
+        return;
+    }
+    m_isWorking.store(false, std::memory_order_release);
+    if (m_receiveThread && m_receiveThread->joinable()) {
+        m_receiveThread->join();
+    }
+    m_receiveThread.reset();
+
+    ::close(m_socket);
+    m_socket = -1;
+}
+
+uint16_t ImageStreamReceiver::getPort() const
+{
+    return m_port;
+}
+
+ReceiveStats ImageStreamReceiver::getStats() const
+{
+    ReceiveStats res;
+    res.batches             = m_batches.load(std::memory_order_relaxed);
+    res.datagrams           = m_datagrams.load(std::memory_order_relaxed);
+    res.invalidDatagrams    = m_invalidDatagrams.load(std::memory_order_relaxed);
+    res.kernelDrops         = m_kernelDrops.load(std::memory_order_relaxed);
+    res.lastBatchSize       = m_lastBatchSize.load(std::memory_order_relaxed);
+    return res;
+}
+
+std::string_view ImageStreamReceiver::getLastErrorText() const
+{
+    return m_lastErrorText;
+}
+
+void ImageStreamReceiver::receiveLoop()
+{
+    while (isWorking()) {
+        for (std::size_t i = 0; i < m_batchSize; ++i) {
+            m_iovecs[i].iov_base = m_slab.data() + i * ImagePacket::MAX_MTU_SIZE;
+            m_iovecs[i].iov_len  = ImagePacket::MAX_MTU_SIZE;
+
+            auto& msg = m_messages[i];
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_hdr.msg_iov         = &m_iovecs[i];
+            msg.msg_hdr.msg_iovlen      = 1;
+            msg.msg_hdr.msg_control     = m_controlSlab.data() + i * CONTROL_SIZE;
+            msg.msg_hdr.msg_controllen  = CONTROL_SIZE;
+        }
+
+        // Wait for first datagram, then take everything already queued
+        auto recvRes = recvmmsg(m_socket, m_messages.data(), m_batchSize, MSG_WAITFORONE, nullptr);
+        if (recvRes < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                COMPLOG_ERROR("[UDP] Receive error:", std::strerror(errno));
+            }
+            continue;
+        }
+        processBatch(recvRes);
+    }
+}
+
+void ImageStreamReceiver::processBatch(std::size_t receivedCount)
+{
+    std::size_t validCount {};
+    for (std::size_t i = 0; i < receivedCount; ++i) {
+        auto& msg = m_messages[i];
+
+        // Kernel drop counter is cumulative for socket
+        for (auto* pCmsg = CMSG_FIRSTHDR(&msg.msg_hdr); pCmsg != nullptr; pCmsg = CMSG_NXTHDR(&msg.msg_hdr, pCmsg)) {
+            if (pCmsg->cmsg_level == SOL_SOCKET && pCmsg->cmsg_type == SO_RXQ_OVFL) {
+                uint32_t dropCounter {};
+                std::memcpy(&dropCounter, CMSG_DATA(pCmsg), sizeof(dropCounter));
+                m_kernelDrops.fetch_add(dropCounter - m_lastKernelDropCounter, std::memory_order_relaxed);
+                m_lastKernelDropCounter = dropCounter;
+            }
+        }
+
+        auto* pData = static_cast<const uint8_t*>(m_iovecs[i].iov_base);
+        if ((msg.msg_hdr.msg_flags & MSG_TRUNC) || !m_views[validCount].init(pData, msg.msg_len)) {
+            m_invalidDatagrams.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        ++validCount;
+    }
+
+    m_batches.fetch_add(1, std::memory_order_relaxed);
+    m_datagrams.fetch_add(receivedCount, std::memory_order_relaxed);
+    m_lastBatchSize.store(receivedCount, std::memory_order_relaxed);
+
+    if (m_batchProcessor && validCount) {
+        m_batchProcessor(m_views.data(), validCount);
+    }
+}
+
+} // namespace Protocol
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#include "imagepacket.hpp"
+
+struct iovec;
+struct mmsghdr;
+
+namespace Protocol {
+
+/**
+ * @brief The ReceiveStats struct Statistics of batched receiving
+ */
+struct ReceiveStats
+{
+    uint64_t batches {};            // Count of recvmmsg calls returned data
+    uint64_t datagrams {};          // Total datagrams received
+    uint64_t invalidDatagrams {};   // Datagrams with invalid header (skipped)
+    uint64_t kernelDrops {};        // Datagrams dropped by kernel (socket queue overflow)
+    uint64_t lastBatchSize {};      // Datagrams in last recvmmsg call
+
+    double getDatagramsPerCall() const {
+        return batches ? static_cast<double>(datagrams) / batches : 0.0;
+    }
+};
+
+/**
+ * @brief The ImageStreamReceiver class UDP receiver of image packets, pulls datagrams in batches with recvmmsg
+ * @note Datagrams are received into preallocated slab, views are valid only while batch processor runs
+ */
+class ImageStreamReceiver
+{
+public:
+    using BatchProcessor = std::function<void(const ImagePacketView* pViews, std::size_t viewCount)>;
+
+    /**
+     * @param batchSize Max count of datagrams, received by one call
+     */
+    explicit ImageStreamReceiver(std::size_t batchSize = 64);
+    ~ImageStreamReceiver();
+
+    ImageStreamReceiver(const ImageStreamReceiver&) = delete;
+    ImageStreamReceiver& operator=(const ImageStreamReceiver&) = delete;
+
+    /**
+     * @brief setBatchProcessor Set processor of received packets. Called in receive thread
+     */
+    void setBatchProcessor(BatchProcessor&& processor);
+
+    /**
+     * @brief start Bind socket and start receive thread
+     * @param port  UDP port to listen on all interfaces (0 for any free port)
+     * @return      false if socket can not be bound
+     */
+    bool start(uint16_t port);
+    bool isWorking() const;
+    void stop();
+
+    uint16_t getPort() const;
+
+    ReceiveStats getStats() const;
+    std::string_view getLastErrorText() const;
+
+private:
+    int m_socket {-1};
+    uint16_t m_port {};
+    std::size_t m_batchSize {};
+
+    // Slab and message descriptors, allocated once
+    std::vector<uint8_t>        m_slab;
+    std::vector<uint8_t>        m_controlSlab;
+    std::vector<iovec>          m_iovecs;
+    std::vector<mmsghdr>        m_messages;
+    std::vector<ImagePacketView> m_views;
+
+    BatchProcessor              m_batchProcessor;
+    std::unique_ptr<std::thread> m_receiveThread;
+    std::atomic<bool>           m_isWorking {false};
+
+    // Stats
+    std::atomic<uint64_t>       m_batches {};
+    std::atomic<uint64_t>       m_datagrams {};
+    std::atomic<uint64_t>       m_invalidDatagrams {};
+    std::atomic<uint64_t>       m_kernelDrops {};
+    std::atomic<uint64_t>       m_lastBatchSize {};
+    uint32_t                    m_lastKernelDropCounter {};
+
+    std::string m_lastErrorText;
+
+    void receiveLoop();
+    void processBatch(std::size_t receivedCount);
+};
+
+} // namespace Protocol
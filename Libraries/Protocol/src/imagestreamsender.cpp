@@ -0,0 +1,205 @@
+#include "imagestreamsender.hpp"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netdb.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+namespace Protocol {
+
+ImageStreamSender::ImageStreamSender()
+{
+
+}
+
+ImageStreamSender::~ImageStreamSender()
+{
+    close();
+}
+
+bool ImageStreamSender::setHost(const std::string &host, uint16_t port)
+{
+    close();
+
+    addrinfo hints {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* pAddr {nullptr};
+    auto resolveRes = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &pAddr);
+    if (resolveRes != 0) {
+        m_lastErrorText = std::string("Failed to resolve host: ") + gai_strerror(resolveRes);
+        return false;
+    }
+
+    m_socket = socket(pAddr->ai_family, pAddr->ai_socktype, pAddr->ai_protocol);
+    if (m_socket < 0 || ::connect(m_socket, pAddr->ai_addr, pAddr->ai_addrlen) != 0) {
+        m_lastErrorText = std::string("Failed to open socket: ") + std::strerror(errno);
+        freeaddrinfo(pAddr);
+        close();
+        return false;
+    }
+    freeaddrinfo(pAddr);
+    return true;
+}
+
+bool ImageStreamSender::isReady() const
+{
+    return (m_socket >= 0);
+}
+
+void ImageStreamSender::close()
+{
+    if (m_socket < 0) {
+        return;
+    }
+    ::close(m_socket);
+    m_socket = -1;
+}
+
+bool ImageStreamSender::sendImage(const SendableImage &img)
+{
+    if (!isReady()) {
+        m_lastErrorText = "Socket is not opened";
+        return false;
+    }
+
+    auto fragmentCount = img.getFragmentCount();
+    reserveMessages(fragmentCount);
+    for (std::size_t fragmentNo = 0; fragmentNo < fragmentCount; ++fragmentNo) {
+        prepareMessage(fragmentNo, img.getFragment(fragmentNo));
+    }
+    return sendMessages(fragmentCount);
+}
+
+bool ImageStreamSender::sendFragments(const SendableImage &img, const std::vector<uint64_t> &fragmentNos)
+{
+    if (!isReady()) {
+        m_lastErrorText = "Socket is not opened";
+        return false;
+    }
+
+    auto fragmentCount = img.getFragmentCount();
+    reserveMessages(fragmentNos.size());
+    std::size_t messageCount {};
+    for (auto fragmentNo : fragmentNos) {
+        if (fragmentNo >= fragmentCount) {
+            continue;
+        }
+        prepareMessage(messageCount++, img.getFragment(fragmentNo));
+    }
+    return sendMessages(messageCount);
+}
+
+void ImageStreamSender::reserveMessages(std::size_t messageCount)
+{
+    m_headerBuffer.resize(messageCount * ImagePacketHeader::WIRE_SIZE);
+    m_iovecs.resize(messageCount * 2);
+    m_messages.resize(messageCount);
+}
+
+void ImageStreamSender::prepareMessage(std::size_t messageNo, const ImageFragment &fragment)
+{
+    // Header and payload of every packet are gathered by kernel
+    auto* pHeader = m_headerBuffer.data() + messageNo * ImagePacketHeader::WIRE_SIZE;
+    fragment.header.writeTo(pHeader, ImagePacketHeader::WIRE_SIZE);
+
+    auto* pIov = &m_iovecs[messageNo * 2];
+    pIov[0].iov_base = pHeader;
+    pIov[0].iov_len  = ImagePacketHeader::WIRE_SIZE;
+    pIov[1].iov_base = const_cast<uint8_t*>(fragment.payload);
+    pIov[1].iov_len  = fragment.header.payloadSize;
+
+    auto& msg = m_messages[messageNo];
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_hdr.msg_iov     = pIov;
+    msg.msg_hdr.msg_iovlen  = 2;
+}
+
+bool ImageStreamSender::sendMessages(std::size_t messageCount)
+{
+    auto startTime = TrafficPacer::Clock::now();
+    auto isSent = m_pacer.isEnabled() ? sendPacedMessages(messageCount) : sendMessageRange(0, messageCount);
+    if (!isSent) {
+        return false;
+    }
+
+    auto endTime = TrafficPacer::Clock::now();
+    m_stats.sendingTime += endTime - startTime;
+    m_stats.lastQueueDelay = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+    m_stats.maxQueueDelay = std::max(m_stats.maxQueueDelay, m_stats.lastQueueDelay);
+    return true;
+}
+
+bool ImageStreamSender::sendPacedMessages(std::size_t messageCount)
+{
+    auto getMessageSize = [this](std::size_t messageNo) {
+        return ImagePacketHeader::WIRE_SIZE + m_iovecs[messageNo * 2 + 1].iov_len;
+    };
+
+    std::size_t frameBytes {};
+    for (std::size_t messageNo = 0; messageNo < messageCount; ++messageNo) {
+        frameBytes += getMessageSize(messageNo);
+    }
+    m_pacer.startFrame(frameBytes);
+
+    // Split into bursts, every one waits for tokens
+    std::size_t sentCount {};
+    while (sentCount < messageCount) {
+        auto burstEnd = sentCount + 1;
+        auto burstBytes = getMessageSize(sentCount);
+        while (burstEnd < messageCount && burstBytes + getMessageSize(burstEnd) <= m_pacer.getConfig().burstSize) {
+            burstBytes += getMessageSize(burstEnd);
+            ++burstEnd;
+        }
+
+        std::this_thread::sleep_until(m_pacer.schedule(burstBytes, TrafficPacer::Clock::now()));
+        if (!sendMessageRange(sentCount, burstEnd - sentCount)) {
+            return false;
+        }
+        sentCount = burstEnd;
+    }
+    return true;
+}
+
+bool ImageStreamSender::sendMessageRange(std::size_t firstMessage, std::size_t messageCount)
+{
+    std::size_t sentCount {};
+    while (sentCount < messageCount) {
+        auto sendRes = sendmmsg(m_socket, m_messages.data() + firstMessage + sentCount, messageCount - sentCount, 0);
+        if (sendRes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            m_lastErrorText = std::string("Failed to send packets: ") + std::strerror(errno);
+            return false;
+        }
+        for (int i = 0; i < sendRes; ++i) {
+            m_stats.bytes += ImagePacketHeader::WIRE_SIZE + m_iovecs[(firstMessage + sentCount + i) * 2 + 1].iov_len;
+        }
+        m_stats.packets += sendRes;
+        sentCount += sendRes;
+    }
+    return true;
+}
+
+void ImageStreamSender::setPacing(const PacingConfig &config)
+{
+    m_pacer.setConfig(config);
+}
+
+const SendStats &ImageStreamSender::getStats() const
+{
+    return m_stats;
+}
+
+std::string_view ImageStreamSender::getLastErrorText() const
+{
+    return m_lastErrorText;
+}
+
+} // namespace Protocol
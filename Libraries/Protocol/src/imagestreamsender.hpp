@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "sendableimage.hpp"
+#include "trafficpacer.hpp"
+
+struct iovec;
+struct mmsghdr;
+
+namespace Protocol {
+
+/**
+ * @brief The SendStats struct Statistics of image sending
+ */
+struct SendStats
+{
+    uint64_t                    packets {};
+    uint64_t                    bytes {};           // Including headers
+    TrafficPacer::Clock::duration sendingTime {};   // Spent in send calls including pacing waits, idle time between them is not counted
+    std::chrono::microseconds   lastQueueDelay {};  // Time from send call to the last packet of frame sent
+    std::chrono::microseconds   maxQueueDelay {};
+
+    double getAchievedBitrate() const {
+        std::chrono::duration<double> seconds = sendingTime;
+        return seconds.count() > 0 ? bytes * 8 / seconds.count() : 0.0;
+    }
+};
+
+/**
+ * @brief The ImageStreamSender class UDP sender of images, submits whole frame with sendmmsg
+ * @note Headers are built per fragment, payloads are sent directly from image bytes (no copy)
+ * @note With pacing enabled, frame is split into bursts and send calls block until the last burst is sent.
+ *       With frame interval set, rate is taken from size of every frame (or fragments of retransmission)
+ */
+class ImageStreamSender
+{
+public:
+    ImageStreamSender();
+    ~ImageStreamSender();
+
+    ImageStreamSender(const ImageStreamSender&) = delete;
+    ImageStreamSender& operator=(const ImageStreamSender&) = delete;
+
+    /**
+     * @brief setHost   Open socket and connect it to server
+     * @param host      IPv4 address or hostname of a server
+     * @param port      UDP streaming port
+     * @return          false if host can not be resolved or socket can not be opened
+     */
+    bool setHost(const std::string& host, uint16_t port);
+    bool isReady() const;
+    void close();
+
+    /**
+     * @brief sendImage Send all fragments of image
+     * @return          false on socket error (image is partially sent)
+     */
+    bool sendImage(const SendableImage& img);
+
+    /**
+     * @brief sendFragments Send only selected fragments of image (retransmission)
+     * @param fragmentNos   Numbers of fragments, invalid ones are skipped
+     * @return              false on socket error
+     */
+    bool sendFragments(const SendableImage& img, const std::vector<uint64_t>& fragmentNos);
+
+    /**
+     * @brief setPacing Set traffic shaping for next sends, pacing is disabled by default
+     * @throws std::invalid_argument on invalid config
+     */
+    void setPacing(const PacingConfig& config);
+
+    const SendStats& getStats() const;
+
+    std::string_view getLastErrorText() const;
+
+private:
+    int m_socket {-1};
+
+    TrafficPacer                m_pacer;
+    SendStats                   m_stats;
+
+    // Reusable buffers, grow up to the biggest frame sent
+    std::vector<uint8_t>    m_headerBuffer;
+    std::vector<iovec>      m_iovecs;
+    std::vector<mmsghdr>    m_messages;
+
+    std::string m_lastErrorText;
+
+    void reserveMessages(std::size_t messageCount);
+    void prepareMessage(std::size_t messageNo, const ImageFragment& fragment);
+    bool sendMessages(std::size_t messageCount);
+    bool sendPacedMessages(std::size_t messageCount);
+    bool sendMessageRange(std::size_t firstMessage, std::size_t messageCount);
+};
+
+} // namespace Protocol
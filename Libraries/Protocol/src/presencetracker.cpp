@@ -0,0 +1,178 @@
+#include "presencetracker.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Protocol
+{
+
+PresenceTracker::PresenceTracker(const PresenceConfig &config, Clock::time_point now) :
+    m_config {config},
+    m_timeoutTicks {config.tick.count() > 0 ? config.timeout / config.tick : 0},
+    m_startTime {now}
+{
+    if (m_config.tick.count() <= 0 || m_timeoutTicks < 1) {
+        throw std::invalid_argument("Presence tick must be positive and not longer than timeout");
+    }
+}
+
+void PresenceTracker::connect(uint64_t deviceId, Clock::time_point now)
+{
+    if (heartbeat(deviceId, now)) {
+        return;
+    }
+
+    uint32_t entryIndex;
+    if (!m_freeEntries.empty()) {
+        entryIndex = m_freeEntries.back();
+        m_freeEntries.pop_back();
+    } else {
+        entryIndex = static_cast<uint32_t>(m_entries.size());
+        m_entries.emplace_back();
+    }
+    auto& entry = m_entries[entryIndex];
+    entry.deviceId = deviceId;
+    entry.lastSeen = now;
+    entry.lastSeenTick = toTick(now);
+    entry.accountedUntil = now;
+    m_devices.emplace(deviceId, entryIndex);
+
+    schedule({entryIndex, entry.generation, entry.lastSeenTick + m_timeoutTicks});
+}
+
+bool PresenceTracker::heartbeat(uint64_t deviceId, Clock::time_point now)
+{
+    auto deviceIt = m_devices.find(deviceId);
+    if (deviceIt == m_devices.end()) {
+        return false;
+    }
+    auto& entry = m_entries[deviceIt->second];
+    entry.lastSeen = std::max(entry.lastSeen, now);
+    entry.lastSeenTick = toTick(entry.lastSeen);
+    return true;
+}
+
+bool PresenceTracker::disconnect(uint64_t deviceId, Clock::time_point now)
+{
+    auto deviceIt = m_devices.find(deviceId);
+    if (deviceIt == m_devices.end()) {
+        return false;
+    }
+    finish(deviceIt->second, std::max(now, m_entries[deviceIt->second].lastSeen));
+    return true;
+}
+
+std::vector<uint64_t> PresenceTracker::advance(Clock::time_point now)
+{
+    std::vector<uint64_t> timedOut;
+    const auto targetTick = toTick(now);
+    std::vector<TimerRef> timers;
+    while (m_currentTick < targetTick) {
+        m_currentTick++;
+
+        // Timers of upper levels move down when their range starts, highest level first
+        for (auto level = LEVEL_COUNT - 1; level > 0; --level) {
+            const auto levelShift = SLOT_BITS * level;
+            if ((m_currentTick & ((int64_t(1) << levelShift) - 1)) != 0) {
+                continue;
+            }
+            timers.clear();
+            timers.swap(m_wheel[level][(m_currentTick >> levelShift) & (SLOT_COUNT - 1)]);
+            for (auto& timer : timers) {
+                if (m_entries[timer.entry].generation == timer.generation) {
+                    schedule(timer);
+                }
+            }
+        }
+
+        timers.clear();
+        timers.swap(m_wheel[0][m_currentTick & (SLOT_COUNT - 1)]);
+        for (auto& timer : timers) {
+            auto& entry = m_entries[timer.entry];
+            if (entry.generation != timer.generation) {
+                continue; // Device disconnected
+            }
+            const auto deadlineTick = entry.lastSeenTick + m_timeoutTicks;
+            if (deadlineTick > m_currentTick) {
+                schedule({timer.entry, timer.generation, deadlineTick}); // Heartbeats came after timer was set
+                continue;
+            }
+            timedOut.push_back(entry.deviceId);
+            finish(timer.entry, entry.lastSeen);
+        }
+    }
+    return timedOut;
+}
+
+std::vector<OnlineTime> PresenceTracker::takeOnlineTimes(Clock::time_point now)
+{
+    std::vector<OnlineTime> times;
+    times.reserve(m_finished.size() + m_devices.size());
+    std::unordered_map<uint64_t, std::size_t> timeIndexes; // Id -> index in times
+    auto addTime = [&times, &timeIndexes](OnlineTime&& time) {
+        auto [indexIt, isAdded] = timeIndexes.emplace(time.deviceId, times.size());
+        if (isAdded) {
+            times.push_back(std::move(time));
+            return;
+        }
+        auto& merged = times[indexIt->second];
+        time.online += merged.online;
+        merged = std::move(time); // Sessions are added in order they ended, current one is the last
+    };
+
+    for (auto& time : m_finished) {
+        addTime(std::move(time));
+    }
+    m_finished.clear();
+    for (auto& [deviceId, entryIndex] : m_devices) {
+        auto& entry = m_entries[entryIndex];
+        const auto online = std::chrono::duration_cast<std::chrono::seconds>(std::max(now, entry.accountedUntil) - entry.accountedUntil);
+        entry.accountedUntil += online;
+        addTime({deviceId, online, true, entry.lastSeen});
+    }
+    return times;
+}
+
+bool PresenceTracker::isOnline(uint64_t deviceId) const
+{
+    return m_devices.count(deviceId) > 0;
+}
+
+std::size_t PresenceTracker::size() const
+{
+    return m_devices.size();
+}
+
+int64_t PresenceTracker::toTick(Clock::time_point time) const
+{
+    return std::max<int64_t>(0, (time - m_startTime) / m_config.tick);
+}
+
+void PresenceTracker::schedule(const TimerRef &timer)
+{
+    // Cascaded timer may be due in current tick, level 0 slot is processed after cascading
+    auto deadlineTick = std::max(timer.deadlineTick, m_currentTick);
+    const auto maxDelta = (int64_t(1) << (SLOT_BITS * LEVEL_COUNT)) - 1;
+    deadlineTick = std::min(deadlineTick, m_currentTick + maxDelta); // Fires earlier and is moved again
+
+    const auto delta = deadlineTick - m_currentTick;
+    std::size_t level {0};
+    while (level + 1 < LEVEL_COUNT && delta >= (int64_t(1) << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    const auto slot = (deadlineTick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1);
+    m_wheel[level][slot].push_back({timer.entry, timer.generation, deadlineTick});
+}
+
+void PresenceTracker::finish(uint32_t entryIndex, Clock::time_point endTime)
+{
+    auto& entry = m_entries[entryIndex];
+    const auto online = std::chrono::duration_cast<std::chrono::seconds>(std::max(endTime, entry.accountedUntil) - entry.accountedUntil);
+    m_finished.push_back({entry.deviceId, online, false, endTime});
+
+    m_devices.erase(entry.deviceId);
+    entry.generation++; // Timers of entry are stale now
+    m_freeEntries.push_back(entryIndex);
+}
+
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+namespace Protocol
+{
+
+/**
+ * @brief The PresenceConfig struct Heartbeat timing of connected devices
+ */
+struct PresenceConfig
+{
+    std::chrono::milliseconds tick {100};       // Timeout precision
+    std::chrono::milliseconds timeout {30000};  // Device without heartbeat so long is offline
+};
+
+/**
+ * @brief The OnlineTime struct Online time of device since previous PresenceTracker::takeOnlineTimes
+ */
+struct OnlineTime
+{
+    uint64_t                                deviceId {};
+    std::chrono::seconds                    online {};
+    bool                                    isOnline {};    // false if device disconnected or timed out
+    std::chrono::steady_clock::time_point   lastSeen;
+};
+
+/**
+ * @brief The PresenceTracker class Tracks heartbeats of connected devices and their online time
+ * @note Timeouts are kept in hierarchical timer wheel (4 levels of 64 slots), no timer per device.
+ *       Heartbeat only saves its time (hash lookup), timer of device is moved lazily when it fires.
+ *       Not thread-safe, owner calls advance every tick
+ */
+class PresenceTracker
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @throws std::invalid_argument on non-positive tick or timeout shorter than tick
+     */
+    explicit PresenceTracker(const PresenceConfig& config = {}, Clock::time_point now = Clock::now());
+
+    /**
+     * @brief connect   Start online session of device, reconnection of online device is a heartbeat
+     */
+    void connect(uint64_t deviceId, Clock::time_point now);
+
+    /**
+     * @brief heartbeat Device is alive
+     * @return          false if device is not connected
+     */
+    bool heartbeat(uint64_t deviceId, Clock::time_point now);
+
+    /**
+     * @brief disconnect    Finish online session of device
+     * @return              false if device is not connected
+     */
+    bool disconnect(uint64_t deviceId, Clock::time_point now);
+
+    /**
+     * @brief advance   Move time, devices without heartbeat for timeout are disconnected
+     * @return          Ids of timed out devices
+     */
+    std::vector<uint64_t> advance(Clock::time_point now);
+
+    /**
+     * @brief takeOnlineTimes   Online time of every connected device and of devices disconnected since previous call.
+     *                          Time is counted in whole seconds, remainder goes to next call.
+     *                          Sessions of reconnected device are merged into one entry, state is of the latest one
+     */
+    std::vector<OnlineTime> takeOnlineTimes(Clock::time_point now);
+
+    bool isOnline(uint64_t deviceId) const;
+    std::size_t size() const;
+
+private:
+    static constexpr int            SLOT_BITS {6};
+    static constexpr std::size_t    SLOT_COUNT {1 << SLOT_BITS};
+    static constexpr std::size_t    LEVEL_COUNT {4};
+
+    /**
+     * @brief The Entry struct Connected device, slot is reused after disconnection
+     */
+    struct Entry
+    {
+        uint64_t            deviceId {};
+        uint32_t            generation {};
+        int64_t             lastSeenTick {};
+        Clock::time_point   lastSeen;
+        Clock::time_point   accountedUntil;     // Online time before it is taken
+    };
+
+    /**
+     * @brief The TimerRef struct Timer in wheel, it is stale if generation of entry changed
+     */
+    struct TimerRef
+    {
+        uint32_t    entry {};
+        uint32_t    generation {};
+        int64_t     deadlineTick {};
+    };
+
+    const PresenceConfig    m_config;
+    const int64_t           m_timeoutTicks;
+    const Clock::time_point m_startTime;
+    int64_t                 m_currentTick {};
+
+    std::vector<Entry>                      m_entries;
+    std::vector<uint32_t>                   m_freeEntries;
+    std::unordered_map<uint64_t, uint32_t>  m_devices;      // Id -> entry
+    std::vector<OnlineTime>                 m_finished;     // Disconnected since previous take
+
+    std::array<std::array<std::vector<TimerRef>, SLOT_COUNT>, LEVEL_COUNT> m_wheel;
+
+    int64_t toTick(Clock::time_point time) const;
+    void schedule(const TimerRef& timer);
+    void finish(uint32_t entryIndex, Clock::time_point endTime);
+};
+
+}
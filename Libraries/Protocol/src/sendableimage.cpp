@@ -1,11 +1,12 @@
 #include "sendableimage.hpp"
 
 #include "imagepacket.hpp"
+#include "fec.hpp"
 
 #include <algorithm>
 #include <set>
+#include <stdexcept>
 
-#include <Components/ExtraClasses/DataFragmentator.h>
 #include <ROD/ImageProcessing/Utility.h>
 
 namespace Protocol {
@@ -20,6 +21,7 @@ bool SendableImage::isValid() const
 void SendableImage::setSenderId(uint64_t sId)
 {
     m_senderId = sId;
+    m_packetsChanged = true;
 }
 
 uint64_t SendableImage::getSenderId() const
@@ -27,6 +29,17 @@ uint64_t SendableImage::getSenderId() const
     return m_senderId;
 }
 
+void SendableImage::setStreamId(uint8_t streamId)
+{
+    m_streamId = streamId;
+    m_packetsChanged = true;
+}
+
+uint8_t SendableImage::getStreamId() const
+{
+    return m_streamId;
+}
+
 uint64_t SendableImage::getId() const
 {
     return m_imageId;
@@ -37,12 +50,42 @@ void SendableImage::setImage(uint64_t imageId, ImageData_t &&imgData)
     m_imageId = imageId;
     m_imageBytes = std::move(imgData);
     m_imageChanged = true;
+    m_packetsChanged = true;
+    m_parityChanged = true;
+}
+
+void SendableImage::setFecGroupCount(uint8_t groupCount)
+{
+    m_fecGroupCount = groupCount;
+    m_packetsChanged = true;
+    m_parityChanged = true;
+}
+
+uint8_t SendableImage::getFecGroupCount() const
+{
+    return m_fecGroupCount;
+}
+
+void SendableImage::setMtuSize(std::size_t mtuSize)
+{
+    if (mtuSize < ImagePacket::MIN_MTU_SIZE || mtuSize > ImagePacket::MAX_MTU_SIZE) {
+        throw std::invalid_argument("MTU size out of range: " + std::to_string(mtuSize));
+    }
+    m_fragmentSize = mtuSize - ImagePacketHeader::WIRE_SIZE;
+    m_packetsChanged = true;
+    m_parityChanged = true;
+}
+
+std::size_t SendableImage::getMtuSize() const
+{
+    return m_fragmentSize + ImagePacketHeader::WIRE_SIZE;
 }
 
 bool SendableImage::canInitFrom(const std::set<ImagePacket> &iPackets) const
 {
     uint64_t imgId {};
     uint64_t senderId {};
+    uint8_t streamId {};
     uint64_t prevPacketEndbyte {};
     for (auto& rp : iPackets) {
         if (prevPacketEndbyte != rp.getFragmentStart()) {
@@ -55,7 +98,8 @@ bool SendableImage::canInitFrom(const std::set<ImagePacket> &iPackets) const
         if (imgId == 0) {
             imgId = rp.getId();
             senderId = rp.getSenderId();
-        } else if (imgId != rp.getId() || senderId != rp.getSenderId()) { // Invalid part of image
+            streamId = rp.getStreamId();
+        } else if (imgId != rp.getId() || senderId != rp.getSenderId() || streamId != rp.getStreamId()) { // Invalid part of image
             return false;
         }
     }
@@ -66,6 +110,7 @@ bool SendableImage::initFromPackets(std::set<ImagePacket> &&iPackets)
 {
     m_imageId = {};
     m_senderId = {};
+    m_streamId = {};
     if (iPackets.empty()) {
         m_lastErrorText = "Empty input";
         return false;
@@ -74,6 +119,7 @@ bool SendableImage::initFromPackets(std::set<ImagePacket> &&iPackets)
     // Check packets
     uint64_t imgId {};
     uint64_t senderId {};
+    uint8_t streamId {};
     uint64_t prevPacketEndbyte {};
     for (auto& rp : iPackets) {
         if (prevPacketEndbyte != rp.getFragmentStart()) {
@@ -87,8 +133,9 @@ bool SendableImage::initFromPackets(std::set<ImagePacket> &&iPackets)
         if (imgId == 0) {
             imgId = rp.getId();
             senderId = rp.getSenderId();
-        } else if (imgId != rp.getId() || senderId != rp.getSenderId()) { // Invalid part of image
-            m_lastErrorText = "Invalid id of image or sender id";
+            streamId = rp.getStreamId();
+        } else if (imgId != rp.getId() || senderId != rp.getSenderId() || streamId != rp.getStreamId()) { // Invalid part of image
+            m_lastErrorText = "Invalid id of image, sender or stream";
             return false;
         }
     }
@@ -101,8 +148,11 @@ bool SendableImage::initFromPackets(std::set<ImagePacket> &&iPackets)
     }
     m_imageId = imgId;
     m_senderId = senderId;
+    m_streamId = streamId;
 
     m_imageChanged = true;
+    m_packetsChanged = true;
+    m_parityChanged = true;
     return true;
 }
 
@@ -116,6 +166,11 @@ ImageData_t &SendableImage::getImage()
     return m_imageBytes;
 }
 
+const ImageData_t &SendableImage::getImage() const
+{
+    return m_imageBytes;
+}
+
 bool SendableImage::initFromPackets(std::vector<ImageData_t > &&iPackets)
 {
     m_imageId = {};
@@ -123,6 +178,11 @@ bool SendableImage::initFromPackets(std::vector<ImageData_t > &&iPackets)
 
     std::set<ImagePacket> readPackets;
     for (auto& ip : iPackets) {
+        ImagePacketView view;
+        if (view.init(ip.data(), ip.size()) && (view.getHeader().flags & ImagePacketHeader::FLAG_PARITY)) {
+            continue; // Restoring is done only by FrameAssembler
+        }
+
         ImagePacket imgPart;
         if (!imgPart.initFromPacketPart(ip)) {
             m_lastErrorText = "Failed to init image part packet from raw bytes";
@@ -133,34 +193,100 @@ bool SendableImage::initFromPackets(std::vector<ImageData_t > &&iPackets)
     return initFromPackets(std::move(readPackets));
 }
 
-std::vector<ImageData_t > SendableImage::convertToPackets() const
+const std::vector<ImageData_t > &SendableImage::convertToPackets() const
 {
-    if (!m_imageChanged) {
+    if (!m_packetsChanged) {
         return m_cachedPackets;
     }
-    auto imgHash = ImageProcessing::Utility::calculateImageHash(m_imageBytes);
 
-    auto dataPackets = ExtraClasses::DataInfo::split(m_imageBytes, ImagePacket::MTU_PAYLOAD_SIZE);
-    m_cachedPackets.clear();
-    m_cachedPackets.reserve(dataPackets.size());
+    auto fragmentCount = getFragmentCount();
+    m_cachedPackets.resize(fragmentCount);
+    for (std::size_t fragmentNo = 0; fragmentNo < fragmentCount; ++fragmentNo) {
+        auto fragment = getFragment(fragmentNo);
+        auto& packet = m_cachedPackets[fragmentNo];
+        packet.resize(ImagePacketHeader::WIRE_SIZE + fragment.header.payloadSize);
+        fragment.header.writeTo(packet.data(), packet.size());
+        std::copy(fragment.payload, fragment.payload + fragment.header.payloadSize,
+                  packet.begin() + ImagePacketHeader::WIRE_SIZE);
+    }
 
-    ImagePacket imgP;
-    imgP.setSenderId(m_senderId);
-    imgP.setId(m_imageId);
-    imgP.setImageHash(imgHash);
-    imgP.setTotalImageSize(m_imageBytes.size());
+    m_packetsChanged = false;
+    return m_cachedPackets;
+}
 
-    uint64_t curPacketNo {};
-    for (auto& p : dataPackets) {
-        imgP.setPayload(std::move(p));
-        imgP.setFragmentStart(ImagePacket::MTU_PAYLOAD_SIZE * curPacketNo);
+std::size_t SendableImage::getFragmentCount() const
+{
+    return getDataFragmentCount() + getParityGroupCount();
+}
+
+std::size_t SendableImage::getDataFragmentCount() const
+{
+    return (m_imageBytes.size() + m_fragmentSize - 1) / m_fragmentSize;
+}
 
-        m_cachedPackets.push_back(imgP.convertToPacketPart());
-        ++curPacketNo;
+ImageFragment SendableImage::getFragment(std::size_t fragmentNo) const
+{
+    if (fragmentNo >= getFragmentCount()) {
+        throw std::out_of_range("Invalid fragment number");
     }
 
-    m_imageChanged = false;
-    return m_cachedPackets;
+    ImageFragment res;
+    res.header.senderId         = m_senderId;
+    res.header.streamId         = m_streamId;
+    res.header.shotId           = m_imageId;
+    res.header.totalImageSize   = m_imageBytes.size();
+    res.header.imageHash        = getImageHash();
+    res.header.fecGroupCount    = static_cast<uint8_t>(getParityGroupCount());
+    res.header.fragmentSize     = static_cast<uint16_t>(m_fragmentSize);
+
+    // Parity fragments are sent after data
+    auto dataFragmentCount = getDataFragmentCount();
+    if (fragmentNo >= dataFragmentCount) {
+        auto groupNo = fragmentNo - dataFragmentCount;
+        res.header.flags            = ImagePacketHeader::FLAG_PARITY;
+        res.header.fragmentStart    = groupNo;
+        res.header.payloadSize      = static_cast<uint16_t>(m_fragmentSize);
+        res.payload = getParityPayload(groupNo);
+        return res;
+    }
+
+    auto fragmentStart = fragmentNo * m_fragmentSize;
+    res.header.fragmentStart    = fragmentStart;
+    res.header.payloadSize      = static_cast<uint16_t>(std::min(m_fragmentSize, m_imageBytes.size() - fragmentStart));
+    res.payload = m_imageBytes.data() + fragmentStart;
+    return res;
+}
+
+uint64_t SendableImage::getImageHash() const
+{
+    if (m_imageChanged) {
+        m_imageHash = ImageProcessing::Utility::calculateImageHash(m_imageBytes);
+        m_imageChanged = false;
+    }
+    return m_imageHash;
+}
+
+std::size_t SendableImage::getParityGroupCount() const
+{
+    return std::min<std::size_t>(m_fecGroupCount, getDataFragmentCount());
+}
+
+const uint8_t *SendableImage::getParityPayload(std::size_t groupNo) const
+{
+    if (m_parityChanged) {
+        auto groupCount = getParityGroupCount();
+        m_parityBuffer.assign(groupCount * m_fragmentSize, 0);
+
+        auto dataFragmentCount = getDataFragmentCount();
+        for (std::size_t fragmentNo = 0; fragmentNo < dataFragmentCount; ++fragmentNo) {
+            auto fragmentStart = fragmentNo * m_fragmentSize;
+            auto* pParity = m_parityBuffer.data() + FEC::getGroupNo(fragmentNo, groupCount) * m_fragmentSize;
+            FEC::xorInto(pParity, m_imageBytes.data() + fragmentStart,
+                         std::min(m_fragmentSize, m_imageBytes.size() - fragmentStart));
+        }
+        m_parityChanged = false;
+    }
+    return m_parityBuffer.data() + groupNo * m_fragmentSize;
 }
 
 } // namespace Protocol
@@ -10,6 +10,15 @@
 
 namespace Protocol {
 
+/**
+ * @brief The ImageFragment struct Fragment of sendable image, payload points into image bytes
+ */
+struct ImageFragment
+{
+    ImagePacketHeader   header;
+    const uint8_t*      payload {nullptr};
+};
+
 /**
  * @brief The SendableImage class Class for UDP Send / receive data
  */
@@ -21,15 +30,51 @@ public:
     void setSenderId(uint64_t sId);
     uint64_t getSenderId() const;
 
+    /**
+     * @brief setStreamId   Set stream (camera or its variant) of sender, image ids are sequential per stream
+     */
+    void setStreamId(uint8_t streamId);
+    uint8_t getStreamId() const;
+
     uint64_t getId() const;
 
     void setImage(uint64_t imageId, ImageProcessing::ImageData_t&& imgData);
     ImageProcessing::ImageData_t& getImage();
+    const ImageProcessing::ImageData_t& getImage() const;
+
+    /**
+     * @brief setFecGroupCount  Enable forward error correction: one XOR parity packet per group of data packets
+     * @param groupCount        Count of parity packets per image (M), 0 to disable FEC
+     * @note One lost packet per group could be restored, so up to M sequential lost packets are restored
+     */
+    void setFecGroupCount(uint8_t groupCount);
+    uint8_t getFecGroupCount() const;
+
+    /**
+     * @brief setMtuSize    Set size of datagrams image is sent with (header and payload)
+     * @param mtuSize       From ImagePacket::MIN_MTU_SIZE to ImagePacket::MAX_MTU_SIZE, ImagePacket::MTU_SIZE by default
+     * @throws std::invalid_argument on size out of range
+     */
+    void setMtuSize(std::size_t mtuSize);
+    std::size_t getMtuSize() const;
 
     bool canInitFrom(const std::set<ImagePacket>& iPackets) const;
     bool initFromPackets(std::vector<ImageProcessing::ImageData_t >&& iPackets);
     bool initFromPackets(std::set<ImagePacket>&& iPackets);
-    std::vector<ImageProcessing::ImageData_t > convertToPackets() const;
+    const std::vector<ImageProcessing::ImageData_t >& convertToPackets() const;
+
+    /**
+     * @brief getFragmentCount  Count of packets image will be sent with (data and parity)
+     */
+    std::size_t getFragmentCount() const;
+    std::size_t getDataFragmentCount() const;
+
+    /**
+     * @brief getFragment   Get header and payload of fragment without copying image bytes
+     * @param fragmentNo    Number of fragment, less than getFragmentCount()
+     * @throws std::out_of_range on invalid fragment number
+     */
+    ImageFragment getFragment(std::size_t fragmentNo) const;
 
     std::string_view getLastErrorText() const;
 
@@ -37,13 +82,24 @@ private:
     ImageProcessing::ImageData_t    m_imageBytes;
     uint64_t                        m_imageId {};
     uint64_t                        m_senderId {};
+    uint8_t                         m_streamId {};
+    uint8_t                         m_fecGroupCount {};
+    std::size_t                     m_fragmentSize {ImagePacket::MTU_PAYLOAD_SIZE};
 
     // Error handling
     std::string m_lastErrorText;
 
     // Cache
     mutable bool m_imageChanged {true};
+    mutable bool m_packetsChanged {true};
+    mutable bool m_parityChanged {true};
+    mutable uint64_t m_imageHash {};
     mutable std::vector<ImageProcessing::ImageData_t> m_cachedPackets;
+    mutable std::vector<uint8_t> m_parityBuffer;
+
+    uint64_t getImageHash() const;
+    std::size_t getParityGroupCount() const;
+    const uint8_t* getParityPayload(std::size_t groupNo) const;
 };
 
 } // namespace Protocol
@@ -0,0 +1,295 @@
+#include "sharedframering.hpp"
+
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <vector>
+
+namespace Protocol {
+
+namespace {
+constexpr uint32_t      RING_MAGIC {0x524F4452}; // "RODR"
+constexpr uint32_t      RING_VERSION {1};
+constexpr std::size_t   CACHE_LINE_SIZE {64};
+
+constexpr std::size_t alignToCacheLine(std::size_t size)
+{
+    return (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+}
+}
+
+/*
+ * Memory layout:
+ * [RingHeader][slot 0: SlotHeader | data ... slotSize][slot 1] ...
+ * Head and tail are in separate cache lines, so producer and consumer do not share line on every frame
+ */
+struct SharedFrameRing::RingHeader
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    slotCount;
+    uint32_t    slotSize;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head; // Next slot to write, changed only by producer
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail; // Next slot to read, changed only by consumer
+};
+
+struct SharedFrameRing::SlotHeader
+{
+    uint64_t    senderId;
+    uint64_t    shotId;
+    uint64_t    dataSize;
+    uint8_t     streamId;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Ring indexes must be lock-free to be shared between processes");
+
+const std::size_t SharedFrameRing::RING_HEADER_SPACE {alignToCacheLine(sizeof(RingHeader))};
+
+SharedFrameRing::~SharedFrameRing()
+{
+    close();
+}
+
+SharedFrameRing::SharedFrameRing(SharedFrameRing &&other) noexcept
+{
+    *this = std::move(other);
+}
+
+SharedFrameRing &SharedFrameRing::operator=(SharedFrameRing &&other) noexcept
+{
+    if (this != &other) {
+        close();
+        std::swap(m_memFd, other.m_memFd);
+        std::swap(m_pMemory, other.m_pMemory);
+        std::swap(m_memorySize, other.m_memorySize);
+        std::swap(m_pHeader, other.m_pHeader);
+        std::swap(m_slotCount, other.m_slotCount);
+        std::swap(m_slotSize, other.m_slotSize);
+        m_lastErrorText = std::move(other.m_lastErrorText);
+    }
+    return *this;
+}
+
+bool SharedFrameRing::create(uint32_t slotCount, uint32_t slotSize)
+{
+    close();
+    if (slotCount < 2 || slotSize == 0) {
+        m_lastErrorText = "Ring must have at least 2 non-empty slots";
+        return false;
+    }
+
+    int memFd = memfd_create("rod-frame-ring", MFD_CLOEXEC);
+    if (memFd < 0) {
+        m_lastErrorText = std::string("Failed to create memfd: ") + std::strerror(errno);
+        return false;
+    }
+    const std::size_t memorySize = RING_HEADER_SPACE + static_cast<std::size_t>(slotCount) * alignToCacheLine(sizeof(SlotHeader) + slotSize);
+    if (ftruncate(memFd, static_cast<off_t>(memorySize)) != 0) {
+        m_lastErrorText = std::string("Failed to resize memfd: ") + std::strerror(errno);
+        ::close(memFd);
+        return false;
+    }
+    if (!map(memFd, memorySize)) {
+        return false;
+    }
+
+    // memfd is zero-filled, atomics are constructed in place
+    m_pHeader = new (m_pMemory) RingHeader {RING_MAGIC, RING_VERSION, slotCount, slotSize, {0}, {0}};
+    m_slotCount = slotCount;
+    m_slotSize = slotSize;
+    return true;
+}
+
+bool SharedFrameRing::attach(int memFd)
+{
+    close();
+    struct stat memStat {};
+    if (fstat(memFd, &memStat) != 0 || static_cast<std::size_t>(memStat.st_size) < RING_HEADER_SPACE) {
+        m_lastErrorText = "Invalid ring memfd";
+        ::close(memFd);
+        return false;
+    }
+    if (!map(memFd, static_cast<std::size_t>(memStat.st_size))) {
+        return false;
+    }
+
+    m_pHeader = reinterpret_cast<RingHeader*>(m_pMemory);
+    const std::size_t expectedSize = RING_HEADER_SPACE + static_cast<std::size_t>(m_pHeader->slotCount) * alignToCacheLine(sizeof(SlotHeader) + m_pHeader->slotSize);
+    if (m_pHeader->magic != RING_MAGIC || m_pHeader->version != RING_VERSION || m_pHeader->slotCount < 2 || expectedSize > m_memorySize) {
+        close();
+        m_lastErrorText = "Unsupported ring layout";
+        return false;
+    }
+    m_slotCount = m_pHeader->slotCount;
+    m_slotSize = m_pHeader->slotSize;
+    return true;
+}
+
+void SharedFrameRing::close()
+{
+    if (m_pMemory) {
+        munmap(m_pMemory, m_memorySize);
+    }
+    if (m_memFd >= 0) {
+        ::close(m_memFd);
+    }
+    m_memFd = -1;
+    m_pMemory = nullptr;
+    m_memorySize = 0;
+    m_pHeader = nullptr;
+    m_slotCount = 0;
+    m_slotSize = 0;
+}
+
+bool SharedFrameRing::isValid() const
+{
+    return (m_pHeader != nullptr);
+}
+
+int SharedFrameRing::getFd() const
+{
+    return m_memFd;
+}
+
+uint32_t SharedFrameRing::getSlotCount() const
+{
+    return m_slotCount;
+}
+
+uint32_t SharedFrameRing::getSlotSize() const
+{
+    return m_slotSize;
+}
+
+bool SharedFrameRing::push(uint64_t senderId, uint8_t streamId, uint64_t shotId, const uint8_t *pData, std::size_t dataSize)
+{
+    if (!m_pHeader || dataSize > m_slotSize) {
+        return false;
+    }
+    const uint64_t head = m_pHeader->head.load(std::memory_order_relaxed);
+    if (head - m_pHeader->tail.load(std::memory_order_acquire) >= m_slotCount) {
+        return false; // Full, consumer is late
+    }
+
+    auto pSlot = getSlot(head);
+    auto pSlotHeader = reinterpret_cast<SlotHeader*>(pSlot);
+    pSlotHeader->senderId = senderId;
+    pSlotHeader->shotId   = shotId;
+    pSlotHeader->dataSize = dataSize;
+    pSlotHeader->streamId = streamId;
+    if (dataSize) {
+        std::memcpy(pSlot + sizeof(SlotHeader), pData, dataSize);
+    }
+
+    m_pHeader->head.store(head + 1, std::memory_order_release); // Publish slot
+    return true;
+}
+
+bool SharedFrameRing::peek(SharedFrameSlot &oSlot) const
+{
+    if (!m_pHeader) {
+        return false;
+    }
+    const uint64_t tail = m_pHeader->tail.load(std::memory_order_relaxed);
+    if (tail == m_pHeader->head.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    const auto pSlot = getSlot(tail);
+    const auto pSlotHeader = reinterpret_cast<const SlotHeader*>(pSlot);
+    oSlot.senderId = pSlotHeader->senderId;
+    oSlot.shotId   = pSlotHeader->shotId;
+    oSlot.streamId = pSlotHeader->streamId;
+    oSlot.pData    = pSlot + sizeof(SlotHeader);
+    oSlot.dataSize = std::min<std::size_t>(pSlotHeader->dataSize, m_slotSize); // Shared memory is not trusted
+    return true;
+}
+
+void SharedFrameRing::release()
+{
+    if (!m_pHeader) {
+        return;
+    }
+    m_pHeader->tail.store(m_pHeader->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+std::string_view SharedFrameRing::getLastErrorText() const
+{
+    return m_lastErrorText;
+}
+
+uint8_t *SharedFrameRing::getSlot(uint64_t slotNo) const
+{
+    const std::size_t slotSpace = alignToCacheLine(sizeof(SlotHeader) + m_slotSize);
+    return m_pMemory + RING_HEADER_SPACE + (slotNo % m_slotCount) * slotSpace;
+}
+
+bool SharedFrameRing::map(int memFd, std::size_t memorySize)
+{
+    void* pMemory = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+    if (pMemory == MAP_FAILED) {
+        m_lastErrorText = std::string("Failed to map ring: ") + std::strerror(errno);
+        ::close(memFd);
+        return false;
+    }
+    m_memFd = memFd;
+    m_pMemory = static_cast<uint8_t*>(pMemory);
+    m_memorySize = memorySize;
+    return true;
+}
+
+
+bool sendFileDescriptors(int unixSocket, const int *pFds, std::size_t fdCount)
+{
+    char dataByte {'F'}; // At least one byte of data must be sent with control message
+    iovec dataVec {&dataByte, sizeof(dataByte)};
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * fdCount));
+    msghdr message {};
+    message.msg_iov = &dataVec;
+    message.msg_iovlen = 1;
+    message.msg_control = control.data();
+    message.msg_controllen = control.size();
+
+    auto pControl = CMSG_FIRSTHDR(&message);
+    pControl->cmsg_level = SOL_SOCKET;
+    pControl->cmsg_type = SCM_RIGHTS;
+    pControl->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+    std::memcpy(CMSG_DATA(pControl), pFds, sizeof(int) * fdCount);
+
+    return (sendmsg(unixSocket, &message, MSG_NOSIGNAL) == sizeof(dataByte));
+}
+
+std::size_t receiveFileDescriptors(int unixSocket, int *pFds, std::size_t maxFdCount)
+{
+    char dataByte {};
+    iovec dataVec {&dataByte, sizeof(dataByte)};
+
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * maxFdCount));
+    msghdr message {};
+    message.msg_iov = &dataVec;
+    message.msg_iovlen = 1;
+    message.msg_control = control.data();
+    message.msg_controllen = control.size();
+
+    if (recvmsg(unixSocket, &message, MSG_CMSG_CLOEXEC) <= 0) {
+        return 0;
+    }
+    auto pControl = CMSG_FIRSTHDR(&message);
+    if (!pControl || pControl->cmsg_level != SOL_SOCKET || pControl->cmsg_type != SCM_RIGHTS) {
+        return 0;
+    }
+    const std::size_t fdCount = std::min((pControl->cmsg_len - CMSG_LEN(0)) / sizeof(int), maxFdCount);
+    std::memcpy(pFds, CMSG_DATA(pControl), sizeof(int) * fdCount);
+    return fdCount;
+}
+
+} // namespace Protocol
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <stdint.h>
+
+namespace Protocol {
+
+/**
+ * @brief The SharedFrameSlot struct Frame stored in ring slot
+ * @note pData points into shared memory and is valid until the slot is released
+ */
+struct SharedFrameSlot
+{
+    uint64_t        senderId {};
+    uint64_t        shotId {};
+    uint8_t         streamId {};
+    const uint8_t*  pData {nullptr};
+    std::size_t     dataSize {};
+};
+
+
+/**
+ * @brief The SharedFrameRing class Lock-free single producer / single consumer ring of frame slots in memfd
+ * @note Ring is created by consumer, memfd is passed to producer process, which attaches it.
+ *       Head and tail are process-shared atomics, one process must only push, other must only pop
+ */
+class SharedFrameRing
+{
+public:
+    SharedFrameRing() = default;
+    ~SharedFrameRing();
+
+    SharedFrameRing(const SharedFrameRing&) = delete;
+    SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+    SharedFrameRing(SharedFrameRing&& other) noexcept;
+    SharedFrameRing& operator=(SharedFrameRing&& other) noexcept;
+
+    /**
+     * @brief create    Create memfd, map and initialize empty ring
+     * @param slotCount Count of frames in ring, at least 2
+     * @param slotSize  Max size of frame data in bytes
+     * @return          false on system error
+     */
+    bool create(uint32_t slotCount, uint32_t slotSize);
+
+    /**
+     * @brief attach    Map ring created by other process
+     * @param memFd     memfd of ring, ring owns it after call
+     * @return          false if memfd is not a valid ring
+     */
+    bool attach(int memFd);
+    void close();
+
+    bool isValid() const;
+    int getFd() const;
+    uint32_t getSlotCount() const;
+    uint32_t getSlotSize() const;
+
+    // Producer
+
+    /**
+     * @brief push  Copy frame into next free slot
+     * @return      false if ring is full or frame is larger than slot
+     */
+    bool push(uint64_t senderId, uint8_t streamId, uint64_t shotId, const uint8_t* pData, std::size_t dataSize);
+
+    // Consumer
+
+    /**
+     * @brief peek  Get the oldest frame without releasing it
+     * @return      false if ring is empty
+     */
+    bool peek(SharedFrameSlot& oSlot) const;
+    void release();
+
+    std::string_view getLastErrorText() const;
+
+private:
+    struct RingHeader;
+    struct SlotHeader;
+    static const std::size_t RING_HEADER_SPACE;
+
+    int             m_memFd {-1};
+    uint8_t*        m_pMemory {nullptr};
+    std::size_t     m_memorySize {};
+    RingHeader*     m_pHeader {nullptr};
+    uint32_t        m_slotCount {}; // Local copies, header in shared memory could be changed by other process
+    uint32_t        m_slotSize {};
+    std::string     m_lastErrorText;
+
+    uint8_t* getSlot(uint64_t slotNo) const;
+    bool map(int memFd, std::size_t memorySize);
+};
+
+
+/**
+ * @brief sendFileDescriptors   Pass descriptors to other process over Unix domain socket (SCM_RIGHTS)
+ * @return                      false on socket error
+ */
+bool sendFileDescriptors(int unixSocket, const int* pFds, std::size_t fdCount);
+
+/**
+ * @brief receiveFileDescriptors    Receive descriptors passed with sendFileDescriptors, blocks until message
+ * @return                          Count of descriptors written into pFds, 0 on error or closed socket
+ */
+std::size_t receiveFileDescriptors(int unixSocket, int* pFds, std::size_t maxFdCount);
+
+} // namespace Protocol
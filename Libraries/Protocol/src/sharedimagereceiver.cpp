@@ -0,0 +1,255 @@
+#include "sharedimagereceiver.hpp"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <Components/Logger/Logger.h>
+
+namespace Protocol {
+
+namespace {
+constexpr auto RECEIVE_TIMEOUT_MS {100}; // For stop flag check
+constexpr auto MAX_EPOLL_EVENTS {16};
+constexpr auto MAX_PENDING_CONNECTIONS {8};
+}
+
+SharedImageReceiver::Connection::~Connection()
+{
+    if (eventFd >= 0) {
+        ::close(eventFd);
+    }
+    if (socket >= 0) {
+        ::close(socket);
+    }
+}
+
+SharedImageReceiver::SharedImageReceiver(uint32_t slotCount, uint32_t slotSize) :
+    m_slotCount {std::max<uint32_t>(slotCount, 2)},
+    m_slotSize {slotSize}
+{
+
+}
+
+SharedImageReceiver::~SharedImageReceiver()
+{
+    stop();
+}
+
+void SharedImageReceiver::setImageCallback(ImageCallback &&callback)
+{
+    m_imageCallback = std::move(callback);
+}
+
+void SharedImageReceiver::setSenderFilter(SenderFilter &&filter)
+{
+    m_senderFilter = std::move(filter);
+}
+
+bool SharedImageReceiver::start(const std::string &socketPath)
+{
+    if (isWorking()) {
+        return true;
+    }
+
+    sockaddr_un addr {};
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)) {
+        m_lastErrorText = "Invalid socket path: " + socketPath;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socketPath.data(), socketPath.size());
+
+    m_listenSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listenSocket < 0) {
+        m_lastErrorText = std::string("Failed to open socket: ") + std::strerror(errno);
+        return false;
+    }
+    unlink(socketPath.c_str()); // Left by previous run
+    if (bind(m_listenSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(m_listenSocket, MAX_PENDING_CONNECTIONS) != 0) {
+        m_lastErrorText = std::string("Failed to bind socket: ") + std::strerror(errno);
+        ::close(m_listenSocket);
+        m_listenSocket = -1;
+        return false;
+    }
+    m_socketPath = socketPath;
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event listenEvent {};
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.fd = m_listenSocket;
+    if (m_epollFd < 0 || epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenSocket, &listenEvent) != 0) {
+        m_lastErrorText = std::string("Failed to setup epoll: ") + std::strerror(errno);
+        stop();
+        return false;
+    }
+
+    m_isWorking.store(true, std::memory_order_release);
+    m_receiveThread = std::make_unique<std::thread>([this]() {
+        receiveLoop();
+    });
+    return true;
+}
+
+bool SharedImageReceiver::isWorking() const
+{
+    return m_isWorking.load(std::memory_order_acquire);
+}
+
+void SharedImageReceiver::stop()
+{
+    m_isWorking.store(false, std::memory_order_release);
+    if (m_receiveThread && m_receiveThread->joinable()) {
+        m_receiveThread->join();
+    }
+    m_receiveThread.reset();
+    m_connections.clear();
+
+    if (m_epollFd >= 0) {
+        ::close(m_epollFd);
+        m_epollFd = -1;
+    }
+    if (m_listenSocket >= 0) {
+        ::close(m_listenSocket);
+        m_listenSocket = -1;
+        unlink(m_socketPath.c_str());
+    }
+}
+
+SharedReceiveStats SharedImageReceiver::getStats() const
+{
+    SharedReceiveStats stats;
+    stats.connections = m_connectionCount.load(std::memory_order_relaxed);
+    stats.rejectedConnections = m_rejectedConnections.load(std::memory_order_relaxed);
+    stats.frames = m_frames.load(std::memory_order_relaxed);
+    stats.bytes = m_bytes.load(std::memory_order_relaxed);
+    stats.rejectedFrames = m_rejectedFrames.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::string_view SharedImageReceiver::getLastErrorText() const
+{
+    return m_lastErrorText;
+}
+
+void SharedImageReceiver::receiveLoop()
+{
+    epoll_event events[MAX_EPOLL_EVENTS];
+    while (m_isWorking.load(std::memory_order_acquire)) {
+        const int eventCount = epoll_wait(m_epollFd, events, MAX_EPOLL_EVENTS, RECEIVE_TIMEOUT_MS);
+        for (int i = 0; i < eventCount; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == m_listenSocket) {
+                acceptConnection();
+                continue;
+            }
+
+            auto connectionIt = std::find_if(m_connections.begin(), m_connections.end(), [fd](auto& connection) {
+                return (connection->eventFd == fd) || (connection->socket == fd);
+            });
+            if (connectionIt == m_connections.end()) {
+                continue; // Closed by previous event of batch
+            }
+            if ((*connectionIt)->socket == fd) {
+                closeConnection(fd); // Sender never writes into socket, so it is closed
+                continue;
+            }
+
+            uint64_t notifications {};
+            if (read(fd, &notifications, sizeof(notifications)) < 0 && errno != EAGAIN) {
+                closeConnection((*connectionIt)->socket);
+                continue;
+            }
+            drainRing(**connectionIt);
+        }
+    }
+}
+
+void SharedImageReceiver::acceptConnection()
+{
+    auto connection = std::make_unique<Connection>();
+    connection->socket = accept4(m_listenSocket, nullptr, nullptr, SOCK_CLOEXEC);
+    if (connection->socket < 0) {
+        return;
+    }
+    if (m_connections.size() >= MAX_CONNECTIONS) {
+        // Closed before ring is created, sender falls back to UDP
+        m_rejectedConnections.fetch_add(1, std::memory_order_relaxed);
+        COMPLOG_WARNING("[SHM] Sender rejected, connection limit reached:", MAX_CONNECTIONS);
+        return;
+    }
+
+    connection->eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (connection->eventFd < 0 || !connection->ring.create(m_slotCount, m_slotSize)) {
+        COMPLOG_WARNING("[SHM] Failed to create ring:", connection->ring.getLastErrorText());
+        return;
+    }
+
+    const int fds[2] {connection->ring.getFd(), connection->eventFd};
+    if (!sendFileDescriptors(connection->socket, fds, 2)) {
+        COMPLOG_WARNING("[SHM] Failed to pass ring to sender:", std::strerror(errno));
+        return;
+    }
+
+    epoll_event socketEvent {};
+    socketEvent.events = EPOLLIN | EPOLLRDHUP;
+    socketEvent.data.fd = connection->socket;
+    epoll_event notifyEvent {};
+    notifyEvent.events = EPOLLIN;
+    notifyEvent.data.fd = connection->eventFd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, connection->socket, &socketEvent) != 0 ||
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, connection->eventFd, &notifyEvent) != 0) {
+        return;
+    }
+
+    m_connectionCount.fetch_add(1, std::memory_order_relaxed);
+    COMPLOG_INFO("[SHM] Sender connected, slots:", m_slotCount, "slot size:", m_slotSize);
+    m_connections.push_back(std::move(connection));
+}
+
+void SharedImageReceiver::closeConnection(int fd)
+{
+    auto connectionIt = std::find_if(m_connections.begin(), m_connections.end(), [fd](auto& connection) {
+        return (connection->socket == fd);
+    });
+    if (connectionIt == m_connections.end()) {
+        return;
+    }
+
+    drainRing(**connectionIt); // Frames sent before exit
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, (*connectionIt)->socket, nullptr);
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, (*connectionIt)->eventFd, nullptr);
+    m_connections.erase(connectionIt);
+    COMPLOG_INFO("[SHM] Sender disconnected");
+}
+
+void SharedImageReceiver::drainRing(Connection &connection)
+{
+    SharedFrameSlot slot;
+    while (connection.ring.peek(slot)) {
+        if (m_senderFilter && !m_senderFilter(slot.senderId)) {
+            connection.ring.release();
+            m_rejectedFrames.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        SendableImage img;
+        img.setSenderId(slot.senderId);
+        img.setStreamId(slot.streamId);
+        img.setImage(slot.shotId, ImageProcessing::ImageData_t(slot.pData, slot.pData + slot.dataSize));
+        connection.ring.release(); // Slot is free for sender while image is processed
+
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(slot.dataSize, std::memory_order_relaxed);
+        if (m_imageCallback) {
+            m_imageCallback(std::move(img));
+        }
+    }
+}
+
+} // namespace Protocol
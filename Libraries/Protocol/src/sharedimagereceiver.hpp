@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+#include "sendableimage.hpp"
+#include "sharedframering.hpp"
+
+namespace Protocol {
+
+/**
+ * @brief The SharedReceiveStats struct Statistics of shared memory receiving
+ */
+struct SharedReceiveStats
+{
+    uint64_t connections {};            // Senders connected since start
+    uint64_t rejectedConnections {};    // Over connection limit
+    uint64_t frames {};
+    uint64_t bytes {};
+    uint64_t rejectedFrames {};         // Of senders not passing filter
+};
+
+/**
+ * @brief The SharedImageReceiver class Receiver of images from senders on the same host
+ * @note Every connected sender gets own ring (single producer, single consumer) and eventfd,
+ *       passed over Unix domain socket. All rings are drained by one receive thread
+ */
+class SharedImageReceiver
+{
+public:
+    using ImageCallback = std::function<void(SendableImage&&)>;
+    using SenderFilter  = std::function<bool(uint64_t senderId)>;
+
+    // Max count of connected senders, every one takes a ring of slotCount * slotSize bytes
+    static constexpr std::size_t MAX_CONNECTIONS {8};
+
+    /**
+     * @param slotCount Count of frames in ring of every sender
+     * @param slotSize  Max size of frame, larger ones are sent by UDP
+     */
+    explicit SharedImageReceiver(uint32_t slotCount = 16, uint32_t slotSize = 8 * 1024 * 1024);
+    ~SharedImageReceiver();
+
+    SharedImageReceiver(const SharedImageReceiver&) = delete;
+    SharedImageReceiver& operator=(const SharedImageReceiver&) = delete;
+
+    /**
+     * @brief setImageCallback  Set processor of received images. Called in receive thread
+     */
+    void setImageCallback(ImageCallback&& callback);
+
+    /**
+     * @brief setSenderFilter   Deliver images only of senders passing filter (all senders by default). Call before start
+     * @note Sender id is written by sender into ring, it is not authenticated by connection
+     */
+    void setSenderFilter(SenderFilter&& filter);
+
+    /**
+     * @brief start         Listen on Unix domain socket and start receive thread
+     * @param socketPath    Path of socket, existing file is replaced
+     * @return              false if socket can not be bound
+     */
+    bool start(const std::string& socketPath);
+    bool isWorking() const;
+    void stop();
+
+    SharedReceiveStats getStats() const;
+    std::string_view getLastErrorText() const;
+
+private:
+    /**
+     * @brief The Connection struct Ring of one sender
+     */
+    struct Connection
+    {
+        int             socket {-1};
+        int             eventFd {-1};
+        SharedFrameRing ring;
+
+        ~Connection();
+    };
+
+    uint32_t    m_slotCount {};
+    uint32_t    m_slotSize {};
+    std::string m_socketPath;
+    int         m_listenSocket {-1};
+    int         m_epollFd {-1};
+
+    std::vector<std::unique_ptr<Connection>> m_connections; // Used only in receive thread
+
+    ImageCallback                   m_imageCallback;
+    SenderFilter                    m_senderFilter;
+    std::unique_ptr<std::thread>    m_receiveThread;
+    std::atomic<bool>               m_isWorking {false};
+
+    // Stats
+    std::atomic<uint64_t>   m_connectionCount {};
+    std::atomic<uint64_t>   m_rejectedConnections {};
+    std::atomic<uint64_t>   m_frames {};
+    std::atomic<uint64_t>   m_bytes {};
+    std::atomic<uint64_t>   m_rejectedFrames {};
+
+    std::string m_lastErrorText;
+
+    void receiveLoop();
+    void acceptConnection();
+    void closeConnection(int fd);
+    void drainRing(Connection& connection);
+};
+
+} // namespace Protocol
@@ -0,0 +1,137 @@
+#include "sharedimagesender.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace Protocol {
+
+namespace {
+constexpr auto HANDSHAKE_TIMEOUT_S {1};
+}
+
+SharedImageSender::~SharedImageSender()
+{
+    close();
+}
+
+bool SharedImageSender::connect(const std::string &socketPath)
+{
+    close();
+
+    sockaddr_un addr {};
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path)) {
+        m_lastErrorText = "Invalid socket path: " + socketPath;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socketPath.data(), socketPath.size());
+
+    m_socket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_socket < 0) {
+        m_lastErrorText = std::string("Failed to open socket: ") + std::strerror(errno);
+        return false;
+    }
+    if (::connect(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        m_lastErrorText = std::string("Failed to connect: ") + std::strerror(errno);
+        close();
+        return false;
+    }
+
+    // Receiver sends ring memfd and eventfd right after accept
+    timeval timeout {HANDSHAKE_TIMEOUT_S, 0};
+    setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    int fds[2] {-1, -1};
+    if (receiveFileDescriptors(m_socket, fds, 2) != 2) {
+        m_lastErrorText = "Receiver did not pass ring descriptors";
+        for (int fd : fds) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+        close();
+        return false;
+    }
+    m_eventFd = fds[1];
+    if (!m_ring.attach(fds[0])) {
+        m_lastErrorText = std::string(m_ring.getLastErrorText());
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool SharedImageSender::isConnected() const
+{
+    return m_ring.isValid();
+}
+
+void SharedImageSender::close()
+{
+    m_ring.close();
+    if (m_eventFd >= 0) {
+        ::close(m_eventFd);
+        m_eventFd = -1;
+    }
+    if (m_socket >= 0) {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+}
+
+bool SharedImageSender::canSend(const SendableImage &img) const
+{
+    return isConnected() && (img.getImage().size() <= m_ring.getSlotSize());
+}
+
+bool SharedImageSender::sendImage(const SendableImage &img)
+{
+    if (!isConnected()) {
+        m_lastErrorText = "Not connected";
+        return false;
+    }
+
+    auto& imgData = img.getImage();
+    if (!m_ring.push(img.getSenderId(), img.getStreamId(), img.getId(), imgData.data(), imgData.size())) {
+        if (!isReceiverAlive()) {
+            m_lastErrorText = "Receiver disconnected";
+            close();
+            return false;
+        }
+        m_lastErrorText = (imgData.size() > m_ring.getSlotSize()) ? "Image is larger than ring slot" : "Ring is full";
+        m_stats.ringFullDrops++;
+        return false;
+    }
+
+    const uint64_t notification {1};
+    if (write(m_eventFd, &notification, sizeof(notification)) != sizeof(notification) && errno != EAGAIN) {
+        m_lastErrorText = std::string("Failed to notify receiver: ") + std::strerror(errno);
+        return false;
+    }
+    m_stats.frames++;
+    m_stats.bytes += imgData.size();
+    return true;
+}
+
+const SharedSendStats &SharedImageSender::getStats() const
+{
+    return m_stats;
+}
+
+std::string_view SharedImageSender::getLastErrorText() const
+{
+    return m_lastErrorText;
+}
+
+bool SharedImageSender::isReceiverAlive() const
+{
+    // Receiver never writes after handshake, readable socket means it is closed
+    char dataByte {};
+    const auto peeked = recv(m_socket, &dataByte, sizeof(dataByte), MSG_PEEK | MSG_DONTWAIT);
+    return (peeked < 0) && (errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+} // namespace Protocol
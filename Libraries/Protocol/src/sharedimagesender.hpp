@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <stdint.h>
+
+#include "sendableimage.hpp"
+#include "sharedframering.hpp"
+
+namespace Protocol {
+
+/**
+ * @brief The SharedSendStats struct Statistics of shared memory sending
+ */
+struct SharedSendStats
+{
+    uint64_t frames {};
+    uint64_t bytes {};
+    uint64_t ringFullDrops {}; // Frames not sent, because receiver did not release slots
+};
+
+/**
+ * @brief The SharedImageSender class Sender of images to receiver on the same host through shared memory ring
+ * @note Image is copied into ring slot once, without fragmentation. Receiver is woken up with eventfd
+ */
+class SharedImageSender
+{
+public:
+    SharedImageSender() = default;
+    ~SharedImageSender();
+
+    SharedImageSender(const SharedImageSender&) = delete;
+    SharedImageSender& operator=(const SharedImageSender&) = delete;
+
+    /**
+     * @brief connect       Connect to SharedImageReceiver and attach its ring
+     * @param socketPath    Path of Unix domain socket receiver listens on
+     * @return              false if receiver is not available
+     */
+    bool connect(const std::string& socketPath);
+    bool isConnected() const;
+    void close();
+
+    /**
+     * @brief canSend   Check if image fits into ring slot
+     */
+    bool canSend(const SendableImage& img) const;
+
+    /**
+     * @brief sendImage Put image into ring and notify receiver
+     * @return          false if ring is full or receiver disconnected (connection is closed then)
+     */
+    bool sendImage(const SendableImage& img);
+
+    const SharedSendStats& getStats() const;
+    std::string_view getLastErrorText() const;
+
+private:
+    int             m_socket {-1};  // Kept open to detect receiver exit
+    int             m_eventFd {-1};
+    SharedFrameRing m_ring;
+
+    SharedSendStats m_stats;
+    std::string     m_lastErrorText;
+
+    bool isReceiverAlive() const;
+};
+
+} // namespace Protocol
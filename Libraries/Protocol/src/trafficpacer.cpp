@@ -0,0 +1,66 @@
+#include "trafficpacer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Protocol {
+
+void TrafficPacer::setConfig(const PacingConfig &config)
+{
+    if (config.frameInterval.count() < 0) {
+        throw std::invalid_argument("Frame interval must not be negative");
+    }
+    if ((config.bitrate != 0 || config.frameInterval.count() > 0) && config.burstSize == 0) {
+        throw std::invalid_argument("Burst size must be at least 1 byte");
+    }
+    m_config = config;
+    m_bytesPerSecond = config.bitrate / 8.0;
+    m_tokens = static_cast<double>(config.burstSize);
+    m_lastBurstTime = {};
+}
+
+const PacingConfig &TrafficPacer::getConfig() const
+{
+    return m_config;
+}
+
+bool TrafficPacer::isEnabled() const
+{
+    return (m_config.bitrate != 0 || m_config.frameInterval.count() > 0);
+}
+
+void TrafficPacer::startFrame(std::size_t frameBytes)
+{
+    if (m_config.frameInterval.count() <= 0) {
+        return;
+    }
+    std::chrono::duration<double> frameInterval = m_config.frameInterval;
+    m_bytesPerSecond = std::max(m_config.bitrate / 8.0, frameBytes / frameInterval.count());
+}
+
+TrafficPacer::Clock::time_point TrafficPacer::schedule(std::size_t byteCount, Clock::time_point now)
+{
+    if (!isEnabled() || m_bytesPerSecond <= 0) {
+        return now; // No frame started yet
+    }
+
+    auto sendTime = now;
+    if (m_lastBurstTime != Clock::time_point{}) {
+        sendTime = std::max(sendTime, m_lastBurstTime + m_config.burstGap);
+
+        // Refill up to burst size for the time passed since last burst
+        std::chrono::duration<double> idleTime = sendTime - m_lastBurstTime;
+        m_tokens = std::min<double>(m_config.burstSize, m_tokens + idleTime.count() * m_bytesPerSecond);
+    }
+
+    if (m_tokens < byteCount) {
+        std::chrono::duration<double> waitTime {(byteCount - m_tokens) / m_bytesPerSecond};
+        sendTime += std::chrono::duration_cast<Clock::duration>(waitTime);
+        m_tokens = static_cast<double>(byteCount);
+    }
+    m_tokens -= byteCount;
+    m_lastBurstTime = sendTime;
+    return sendTime;
+}
+
+} // namespace Protocol
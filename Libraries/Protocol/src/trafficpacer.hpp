@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <stdint.h>
+
+namespace Protocol {
+
+/**
+ * @brief The PacingConfig struct Shaping of outgoing traffic
+ */
+struct PacingConfig
+{
+    uint64_t                    bitrate {};             // Target rate in bits per second, 0 disables pacing without frame interval
+    std::size_t                 burstSize {16 * 1024};  // Max bytes sent back-to-back
+    std::chrono::microseconds   burstGap {};            // Min pause between bursts
+    std::chrono::microseconds   frameInterval {};       // Every frame is spread over it (rate follows frame size, bitrate is min rate then)
+};
+
+/**
+ * @brief The TrafficPacer class Token bucket deciding when next burst could be sent
+ * @note Not thread-safe
+ */
+class TrafficPacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief setConfig Apply pacing configuration, bucket becomes full
+     * @throws std::invalid_argument on zero burst size with pacing enabled or negative frame interval
+     */
+    void setConfig(const PacingConfig& config);
+    const PacingConfig& getConfig() const;
+    bool isEnabled() const;
+
+    /**
+     * @brief startFrame    Set rate for next frame, so it is sent in frame interval. Does nothing without frame interval
+     * @param frameBytes    Size of frame with headers
+     */
+    void startFrame(std::size_t frameBytes);
+
+    /**
+     * @brief schedule  Take tokens for burst
+     * @param byteCount Size of burst, could be more than burst size (waits for the whole amount)
+     * @param now       Current time
+     * @return          Time point burst could be sent at, now if tokens are available
+     */
+    Clock::time_point schedule(std::size_t byteCount, Clock::time_point now);
+
+private:
+    PacingConfig        m_config;
+    double              m_bytesPerSecond {};
+    double              m_tokens {};
+    Clock::time_point   m_lastBurstTime {};
+};
+
+} // namespace Protocol
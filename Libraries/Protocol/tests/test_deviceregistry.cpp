@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <ROD/Protocol.h>
+
+TEST(ProtocolDeviceRegistry, ParseTarget) {
+    Protocol::EventChannelTarget target;
+    ASSERT_TRUE(Protocol::parseEventChannelTarget("/?dev=42", target));
+    ASSERT_EQ(target.deviceId, 42u);
+    ASSERT_EQ(target.encoding, Protocol::EventEncoding::Json);
+
+    ASSERT_TRUE(Protocol::parseEventChannelTarget("/?enc=bin&dev=7", target));
+    ASSERT_EQ(target.deviceId, 7u);
+    ASSERT_EQ(target.encoding, Protocol::EventEncoding::Binary);
+
+    for (auto invalid : {"", "/", "/?", "/?dev=", "/?dev=0", "/?dev=01", "/?dev=1x", "/?dev=1&dev=2", "/?dev=1&enc=xml",
+                         "/?dev=1&", "/?dev=1&token=2", "/?enc=bin", "?dev=1", "/?dev=99999999999999999999"}) {
+        ASSERT_FALSE(Protocol::parseEventChannelTarget(invalid, target)) << invalid;
+    }
+    ASSERT_EQ(target.deviceId, 7u); // Not changed
+}
+
+TEST(ProtocolDeviceRegistry, AddRemove) {
+    Protocol::DeviceRegistry registry;
+    registry.reset({1, 2, 3, 3, 0});
+    ASSERT_EQ(registry.size(), 3u);
+    ASSERT_TRUE(registry.contains(2));
+    ASSERT_FALSE(registry.contains(0));
+    ASSERT_FALSE(registry.add(2));
+
+    // Growth and removal keep lookups correct
+    for (uint64_t id = 4; id <= 5000; ++id) {
+        ASSERT_TRUE(registry.add(id));
+    }
+    for (uint64_t id = 1; id <= 5000; id += 2) {
+        ASSERT_TRUE(registry.remove(id));
+    }
+    ASSERT_FALSE(registry.remove(1));
+    ASSERT_EQ(registry.size(), 2500u);
+    for (uint64_t id = 1; id <= 5000; ++id) {
+        ASSERT_EQ(registry.contains(id), id % 2 == 0) << id;
+    }
+
+    // Removed slots are reused
+    for (int round = 0; round < 100; ++round) {
+        ASSERT_TRUE(registry.add(10001));
+        ASSERT_TRUE(registry.remove(10001));
+    }
+    ASSERT_EQ(registry.size(), 2500u);
+}
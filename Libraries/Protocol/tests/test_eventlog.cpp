@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <ROD/Protocol.h>
+
+#include <filesystem>
+#include <unistd.h>
+
+namespace {
+class ProtocolEventLog : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_directory = std::filesystem::temp_directory_path() / ("rod_eventlog_" + std::to_string(getpid()));
+        std::filesystem::remove_all(m_directory);
+        m_config.segmentSize = 4096;
+        m_config.indexInterval = 256;
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(m_directory);
+    }
+
+    static Protocol::Event createEvent(Protocol::EventType etype, int device, int payload)
+    {
+        Protocol::Event ev;
+        ev.setType(etype);
+        ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, std::to_string(device));
+        ev.setPayload(std::to_string(payload));
+        return ev;
+    }
+
+    // Appends 300 events (several segments): timestamp i * 10, device i % 3, every 10th is DetectorConnected
+    void fillLog(Protocol::EventLog& log)
+    {
+        for (int i = 0; i < 300; ++i) {
+            auto etype = (i % 10 == 0) ? Protocol::EventType::DetectorConnected : Protocol::EventType::DetectedObject;
+            ASSERT_TRUE(log.append(createEvent(etype, i % 3, i), i * 10));
+        }
+    }
+
+    static std::vector<int> scanPayloads(const Protocol::EventLog& log, const Protocol::EventLogQuery& query)
+    {
+        std::vector<int> payloads;
+        log.scan(query, [&payloads](Protocol::EventLogRecord&& record) {
+            payloads.push_back(std::stoi(record.event.getPayload()));
+            return true;
+        });
+        return payloads;
+    }
+
+    std::filesystem::path       m_directory;
+    Protocol::EventLogConfig    m_config;
+};
+}
+
+TEST_F(ProtocolEventLog, RangeScan) {
+    Protocol::EventLog log;
+    ASSERT_TRUE(log.open(m_directory, m_config)) << log.getLastErrorText();
+    fillLog(log);
+    ASSERT_GT(log.getSegmentCount(), 3u);
+
+    Protocol::EventLogQuery query;
+    query.fromUs = 1000;
+    query.toUs = 1990;
+    auto payloads = scanPayloads(log, query);
+    ASSERT_EQ(payloads.size(), 100u);
+    for (std::size_t i = 0; i < payloads.size(); ++i) {
+        ASSERT_EQ(payloads[i], static_cast<int>(100 + i));
+    }
+
+    query.deviceId = 2;
+    query.types = {Protocol::EventType::DetectorConnected};
+    ASSERT_EQ(scanPayloads(log, query), (std::vector<int>{110, 140, 170}));
+
+    // Stop by callback, earlier timestamp is raised to keep log sorted
+    std::size_t count = log.scan({}, [](auto&&) { return false; });
+    ASSERT_EQ(count, 1u);
+    ASSERT_TRUE(log.append(createEvent(Protocol::EventType::DetectorAlert, 7, 1000), 5));
+    query = {};
+    query.deviceId = 7;
+    log.scan(query, [](Protocol::EventLogRecord&& record) {
+        EXPECT_EQ(record.timestampUs, 2990);
+        EXPECT_EQ(record.event.getType(), Protocol::EventType::DetectorAlert);
+        return true;
+    });
+}
+
+TEST_F(ProtocolEventLog, ReopenAndRetention) {
+    std::size_t segmentCount {};
+    {
+        Protocol::EventLog log;
+        ASSERT_TRUE(log.open(m_directory, m_config));
+        fillLog(log);
+        segmentCount = log.getSegmentCount();
+    }
+
+    Protocol::EventLog log;
+    ASSERT_TRUE(log.open(m_directory, m_config));
+    ASSERT_EQ(log.getSegmentCount(), segmentCount + 1); // Existing ones are read-only, new one is active
+    ASSERT_EQ(scanPayloads(log, {}).size(), 300u);
+    ASSERT_TRUE(log.append(createEvent(Protocol::EventType::DetectedObject, 1, 300), 3000));
+
+    // Only whole segments are removed, active one is kept
+    ASSERT_GT(log.removeOlderThan(1500), 0u);
+    auto payloads = scanPayloads(log, {});
+    ASSERT_LE(payloads.front(), 150);
+    ASSERT_GT(payloads.front(), 0);
+    ASSERT_EQ(payloads.back(), 300);
+    const auto remainingCount = log.getSegmentCount();
+    ASSERT_EQ(log.removeOlderThan(std::numeric_limits<int64_t>::max()), remainingCount - 1);
+    ASSERT_EQ(scanPayloads(log, {}), std::vector<int> {300});
+}
+
+TEST_F(ProtocolEventLog, AppendDuringScan) {
+    Protocol::EventLog log;
+    ASSERT_TRUE(log.open(m_directory, m_config));
+    fillLog(log);
+
+    // Callback runs without lock: appends roll segments, records appended during scan are not visited
+    std::vector<int> payloads;
+    log.scan({}, [&](Protocol::EventLogRecord&& record) {
+        payloads.push_back(std::stoi(record.event.getPayload()));
+        EXPECT_TRUE(log.append(createEvent(Protocol::EventType::DetectedObject, 1, 1000), 5000));
+        return true;
+    });
+    ASSERT_EQ(payloads.size(), 300u);
+    ASSERT_EQ(payloads.back(), 299);
+    ASSERT_EQ(scanPayloads(log, {}).size(), 600u);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <ROD/Protocol.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+Protocol::Event createEvent(Protocol::EventType etype, const std::string& device, const std::string& payload)
+{
+    Protocol::Event ev;
+    ev.setType(etype);
+    ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, device);
+    ev.setPayload(payload);
+    return ev;
+}
+}
+
+TEST(ProtocolEventProcessor, Dispatch) {
+    Protocol::EventProcessor processor;
+    int connectedCount {};
+    processor.setEventProcessor(Protocol::EventType::DetectorConnected, [&connectedCount](auto&&) {
+        connectedCount++;
+    });
+    ASSERT_THROW(processor.setEventProcessor(static_cast<Protocol::EventType>(100), [](auto&&) {}), std::invalid_argument);
+
+    processor.addEvent(createEvent(Protocol::EventType::DetectorConnected, "1", {}));
+    processor.addEvent(createEvent(Protocol::EventType::DetectorDisconnected, "1", {})); // No handler
+    processor.addEvent(createEvent(static_cast<Protocol::EventType>(100), "1", {}));
+    ASSERT_EQ(connectedCount, 1);
+}
+
+TEST(ProtocolEventProcessor, AsyncDeviceOrder) {
+    constexpr int DEVICE_COUNT {8};
+    constexpr int EVENT_COUNT {2000};
+
+    Protocol::AsyncEventProcessor processor;
+    std::mutex resultMx;
+    std::map<std::string, std::vector<int>> results;
+    processor.setEventProcessor(Protocol::EventType::DetectedObject, [&](Protocol::Event&& ev) {
+        std::lock_guard<std::mutex> lock(resultMx);
+        results[ev.getHeader(Protocol::EventHeaders::HEADER_DEVICE)].push_back(std::stoi(ev.getPayload()));
+    });
+    processor.setQueue(Protocol::EventOverflowPolicy::Block, 16); // Producers wait often
+    processor.start(3);
+
+    std::vector<std::thread> producers;
+    for (int device = 0; device < DEVICE_COUNT; ++device) {
+        producers.emplace_back([&processor, device]() {
+            for (int i = 0; i < EVENT_COUNT; ++i) {
+                processor.addEvent(createEvent(Protocol::EventType::DetectedObject, std::to_string(device), std::to_string(i)));
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    processor.stop(); // Queued events are processed
+
+    ASSERT_EQ(results.size(), static_cast<std::size_t>(DEVICE_COUNT));
+    for (auto& [device, values] : results) {
+        ASSERT_EQ(values.size(), static_cast<std::size_t>(EVENT_COUNT)) << device;
+        for (int i = 0; i < EVENT_COUNT; ++i) {
+            ASSERT_EQ(values[i], i) << device;
+        }
+    }
+    auto stats = processor.getStats();
+    ASSERT_EQ(stats.enqueued, static_cast<uint64_t>(DEVICE_COUNT * EVENT_COUNT));
+    ASSERT_EQ(stats.processed, stats.enqueued);
+    ASSERT_EQ(stats.dropped, 0u);
+    ASSERT_EQ(stats.queueDepth, 0u);
+    ASSERT_LE(stats.maxQueueDepth, 16u);
+}
+
+TEST(ProtocolEventProcessor, AsyncDropNewest) {
+    Protocol::AsyncEventProcessor processor;
+    std::atomic<bool> isReleased {false};
+    std::atomic<int> processedCount {};
+    processor.setEventProcessor(Protocol::EventType::DetectedObject, [&](auto&&) {
+        while (!isReleased.load()) {
+            std::this_thread::yield();
+        }
+        processedCount++;
+    });
+    processor.setQueue(Protocol::EventOverflowPolicy::DropNewest, 4);
+    processor.start(1);
+
+    // First event is taken by worker, which is stuck, next ones fill queue
+    for (int i = 0; i < 20; ++i) {
+        processor.addEvent(createEvent(Protocol::EventType::DetectedObject, "1", {}));
+    }
+    processor.addEvent(createEvent(Protocol::EventType::ServerAlert, "1", {})); // No handler
+    isReleased.store(true);
+    processor.stop();
+
+    auto stats = processor.getStats();
+    ASSERT_EQ(stats.enqueued + stats.dropped, 21u);
+    ASSERT_GE(stats.dropped, 15u);
+    ASSERT_EQ(stats.processed, stats.enqueued);
+    ASSERT_EQ(static_cast<uint64_t>(processedCount.load()), stats.processed - stats.unhandled);
+
+    // Stopped processor calls handlers in caller thread
+    processor.addEvent(createEvent(Protocol::EventType::DetectedObject, "1", {}));
+    ASSERT_EQ(static_cast<uint64_t>(processedCount.load()), stats.processed - stats.unhandled + 1);
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <ROD/Protocol.h>
+
+namespace {
+Protocol::Event createEvent()
+{
+    Protocol::Event ev;
+    ev.setType(Protocol::EventType::DetectedObject);
+    ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, "42");
+    ev.setHeader("camera", "1");
+    ev.setPayload(std::string("{\"object\":\"person\"}\0tail", 24));
+    return ev;
+}
+}
+
+TEST(ProtocolEvents, BinaryRoundTrip) {
+    const auto ev = createEvent();
+    const auto data = ev.toBinary();
+    ASSERT_LT(data.size(), ev.toRaw().size());
+
+    Protocol::Event received;
+    ASSERT_TRUE(received.readBinary(data));
+    ASSERT_EQ(received.getType(), Protocol::EventType::DetectedObject);
+    ASSERT_EQ(received.getHeader(Protocol::EventHeaders::HEADER_DEVICE), "42");
+    ASSERT_EQ(received.getHeader("camera"), "1");
+    ASSERT_EQ(received.getPayload(), ev.getPayload());
+
+    // Same event in both encodings
+    Protocol::Event fromJson;
+    ASSERT_TRUE(fromJson.read(ev.encode(Protocol::EventEncoding::Json), Protocol::EventEncoding::Json));
+    ASSERT_EQ(fromJson.encode(Protocol::EventEncoding::Binary), data);
+}
+
+TEST(ProtocolEvents, BinaryInvalid) {
+    const auto data = createEvent().toBinary();
+
+    Protocol::Event received;
+    received.setType(Protocol::EventType::ServerAlert);
+    for (std::size_t size = 0; size < data.size(); ++size) {
+        ASSERT_FALSE(received.readBinary(data.substr(0, size))) << size;
+    }
+    ASSERT_FALSE(received.readBinary(data + "x"));
+
+    auto badVersion = data;
+    badVersion[0] = 2;
+    ASSERT_FALSE(received.readBinary(badVersion));
+
+    auto badType = data;
+    badType[1] = 100;
+    ASSERT_FALSE(received.readBinary(badType));
+    ASSERT_EQ(received.getType(), Protocol::EventType::ServerAlert); // Not changed on failure
+
+    // Bound follows count of types
+    auto lastType = data;
+    lastType[1] = static_cast<char>(Protocol::EVENT_TYPE_COUNT - 2);
+    ASSERT_TRUE(received.readBinary(lastType));
+    ASSERT_EQ(received.getType(), Protocol::EventType::KeyframeRequested);
+    auto nextType = data;
+    nextType[1] = static_cast<char>(Protocol::EVENT_TYPE_COUNT - 1);
+    ASSERT_FALSE(received.readBinary(nextType));
+
+    Protocol::EventEncoding encoding {Protocol::EventEncoding::Json};
+    ASSERT_TRUE(Protocol::toEventEncoding("bin", encoding));
+    ASSERT_EQ(encoding, Protocol::EventEncoding::Binary);
+    ASSERT_FALSE(Protocol::toEventEncoding("cbor", encoding));
+}
+
+TEST(ProtocolEvents, Batch) {
+    std::vector<Protocol::Event> events;
+    for (int i = 0; i < 3; ++i) {
+        auto ev = createEvent();
+        ev.setPayload(std::to_string(i));
+        events.push_back(std::move(ev));
+    }
+
+    for (auto encoding : {Protocol::EventEncoding::Json, Protocol::EventEncoding::Binary}) {
+        std::vector<Protocol::Event> received;
+        ASSERT_TRUE(Protocol::readEvents(Protocol::writeEvents(events, encoding), encoding, received));
+        ASSERT_EQ(received.size(), events.size());
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            ASSERT_EQ(received[i].getPayload(), events[i].getPayload());
+            ASSERT_EQ(received[i].getHeader("camera"), "1");
+        }
+
+        // Single event is sent as is, old receivers read it
+        ASSERT_EQ(Protocol::writeEvents({events[0]}, encoding), events[0].encode(encoding));
+        ASSERT_TRUE(Protocol::readEvents(events[0].encode(encoding), encoding, received));
+        ASSERT_EQ(received.size(), events.size() + 1);
+    }
+
+    std::vector<Protocol::Event> received;
+    auto truncated = Protocol::writeEvents(events, Protocol::EventEncoding::Binary);
+    truncated.pop_back();
+    ASSERT_FALSE(Protocol::readEvents(truncated, Protocol::EventEncoding::Binary, received));
+    ASSERT_FALSE(Protocol::readEvents("[42]", Protocol::EventEncoding::Json, received));
+    ASSERT_TRUE(received.empty());
+}
+
+TEST(ProtocolEvents, BatcherCoalescing) {
+    Protocol::EventBatchConfig config;
+    config.maxEvents = 4;
+    Protocol::EventBatcher batcher(config);
+
+    auto createAlert = [](const std::string& device, const std::string& payload) {
+        Protocol::Event ev;
+        ev.setType(Protocol::EventType::DetectorAlert);
+        ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, device);
+        ev.setPayload(payload);
+        return ev;
+    };
+    ASSERT_FALSE(batcher.add(createAlert("1", "hot")));
+    ASSERT_FALSE(batcher.add(createEvent()));
+    ASSERT_FALSE(batcher.add(createAlert("2", "hot")));
+    ASSERT_FALSE(batcher.add(createAlert("1", "cold"))); // Replaces first one
+    ASSERT_EQ(batcher.getCoalescedCount(), 1u);
+    ASSERT_TRUE(batcher.add(createEvent()));
+
+    auto batch = batcher.takeBatch();
+    ASSERT_TRUE(batcher.isEmpty());
+    ASSERT_EQ(batch.size(), 4u);
+    ASSERT_EQ(batch[0].getType(), Protocol::EventType::DetectedObject);
+    ASSERT_EQ(batch[1].getHeader(Protocol::EventHeaders::HEADER_DEVICE), "2");
+    ASSERT_EQ(batch[2].getPayload(), "cold");
+    ASSERT_EQ(batch[3].getType(), Protocol::EventType::DetectedObject);
+
+    config.isCoalescing = false;
+    batcher.setConfig(config);
+    batcher.add(createAlert("1", "hot"));
+    batcher.add(createAlert("1", "cold"));
+    ASSERT_EQ(batcher.size(), 2u);
+    config.maxEvents = 0;
+    ASSERT_THROW(batcher.setConfig(config), std::invalid_argument);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <ROD/Protocol.h>
+
+namespace {
+Protocol::Event createEvent(Protocol::EventType etype, const std::string& device, const std::string& payload)
+{
+    Protocol::Event ev;
+    ev.setType(etype);
+    ev.setHeader(Protocol::EventHeaders::HEADER_DEVICE, device);
+    ev.setPayload(payload);
+    return ev;
+}
+}
+
+TEST(ProtocolEventSubscription, Filter) {
+    Protocol::EventFilter filter;
+    ASSERT_TRUE(Protocol::EventFilter::parse("1,3", "DetectorConnected,DetectedObject", filter));
+    ASSERT_EQ(filter.devices, (std::vector<uint64_t>{1, 3}));
+    ASSERT_EQ(filter.types.size(), 2u);
+
+    ASSERT_TRUE(filter.matches(createEvent(Protocol::EventType::DetectedObject, "3", {})));
+    ASSERT_FALSE(filter.matches(createEvent(Protocol::EventType::DetectedObject, "2", {})));
+    ASSERT_FALSE(filter.matches(createEvent(Protocol::EventType::DetectorAlert, "1", {})));
+
+    ASSERT_FALSE(Protocol::EventFilter::parse("1,x", "", filter));
+    ASSERT_FALSE(Protocol::EventFilter::parse("", "NoSuchEvent", filter));
+    ASSERT_EQ(filter.devices.size(), 2u); // Not changed
+
+    ASSERT_TRUE(Protocol::EventFilter::parse("", "", filter));
+    ASSERT_TRUE(filter.matches(createEvent(Protocol::EventType::ServerStarted, {}, {})));
+}
+
+TEST(ProtocolEventSubscription, DropOldest) {
+    Protocol::EventSubscription subscription({}, 3, Protocol::SubscriberOverflowPolicy::DropOldest);
+    ASSERT_TRUE(subscription.push(createEvent(Protocol::EventType::DetectedObject, "1", "0")));
+    for (int i = 1; i < 5; ++i) {
+        ASSERT_FALSE(subscription.push(createEvent(Protocol::EventType::DetectedObject, "1", std::to_string(i)))); // Already scheduled
+    }
+    ASSERT_EQ(subscription.getDroppedCount(), 2u);
+
+    bool isFlushPending {};
+    auto events = subscription.take(2, isFlushPending);
+    ASSERT_EQ(events.size(), 2u);
+    ASSERT_EQ(events[0].getPayload(), "2");
+    ASSERT_TRUE(isFlushPending);
+
+    events = subscription.take(2, isFlushPending);
+    ASSERT_EQ(events.size(), 1u);
+    ASSERT_EQ(events[0].getPayload(), "4");
+    ASSERT_FALSE(isFlushPending);
+    ASSERT_TRUE(subscription.push(createEvent(Protocol::EventType::DetectedObject, "1", "5")));
+}
+
+TEST(ProtocolEventSubscription, Summarize) {
+    Protocol::EventSubscription subscription({}, 3, Protocol::SubscriberOverflowPolicy::Summarize);
+    subscription.push(createEvent(Protocol::EventType::DetectorConnected, "1", {}));
+    subscription.push(createEvent(Protocol::EventType::DetectorAlert, "1", "old"));
+    subscription.push(createEvent(Protocol::EventType::DetectorConnected, "2", {}));
+    subscription.push(createEvent(Protocol::EventType::DetectorAlert, "1", "new"));   // Replaces older alert
+    subscription.push(createEvent(Protocol::EventType::DetectedObject, "2", {}));     // Drops the oldest
+
+    bool isFlushPending {};
+    auto events = subscription.take(10, isFlushPending);
+    ASSERT_FALSE(isFlushPending);
+    ASSERT_EQ(events.size(), 4u);
+    ASSERT_EQ(events[0].getType(), Protocol::EventType::EventsDropped);
+    ASSERT_EQ(events[0].getPayload(), "2");
+    ASSERT_EQ(events[1].getType(), Protocol::EventType::DetectorConnected);
+    ASSERT_EQ(events[1].getHeader(Protocol::EventHeaders::HEADER_DEVICE), "2");
+    ASSERT_EQ(events[2].getPayload(), "new");
+    ASSERT_EQ(events[3].getType(), Protocol::EventType::DetectedObject);
+    ASSERT_EQ(subscription.getDroppedCount(), 2u);
+}
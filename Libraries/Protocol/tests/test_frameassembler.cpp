@@ -0,0 +1,342 @@
+#include <gtest/gtest.h>
+
+#include <ROD/Protocol.h>
+#include <ROD/ImageProcessing/Utility.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace Protocol;
+
+namespace {
+
+SendableImage createTestImage(uint64_t senderId, uint64_t imageId, int w, int h) {
+    SendableImage res;
+    res.setSenderId(senderId);
+    res.setImage(imageId, ImageProcessing::Utility::generateTestImageBytes(w, h));
+    return res;
+}
+
+void feedPackets(FrameAssembler& assembler, const std::vector<ImageProcessing::ImageData_t>& packets) {
+    for (auto& p : packets) {
+        ImagePacketView view;
+        ASSERT_TRUE(view.init(p.data(), p.size()));
+        assembler.addPacket(view);
+    }
+}
+
+}
+
+TEST(ProtocolFrameAssembler, InOrder) {
+    auto img = createTestImage(5, 1, 480, 560);
+    std::vector<SendableImage> received;
+    FrameAssembler assembler;
+    assembler.setFrameCallback([&received](auto&& frame) { received.push_back(std::move(frame)); });
+
+    feedPackets(assembler, img.convertToPackets());
+    ASSERT_EQ(received.size(), 1);
+    ASSERT_EQ(received[0].getSenderId(), 5);
+    ASSERT_EQ(received[0].getId(), 1);
+    ASSERT_EQ(received[0].getImage(), img.getImage());
+
+    // Late duplicates of completed frame are ignored
+    feedPackets(assembler, img.convertToPackets());
+    ASSERT_EQ(received.size(), 1);
+    ASSERT_EQ(assembler.getStats().stalePackets, img.getFragmentCount());
+}
+
+TEST(ProtocolFrameAssembler, Reordered) {
+    auto img = createTestImage(5, 1, 480, 560);
+    auto packets = img.convertToPackets();
+    std::mt19937 randomGen;
+    std::shuffle(packets.begin(), packets.end(), randomGen);
+    packets.push_back(packets.front()); // Duplicate
+
+    std::vector<SendableImage> received;
+    FrameAssembler assembler;
+    assembler.setFrameCallback([&received](auto&& frame) { received.push_back(std::move(frame)); });
+
+    feedPackets(assembler, packets);
+    ASSERT_EQ(received.size(), 1);
+    ASSERT_EQ(received[0].getImage(), img.getImage());
+}
+
+TEST(ProtocolFrameAssembler, DropSuperseded) {
+    auto img1 = createTestImage(5, 1, 480, 560);
+    auto img2 = createTestImage(5, 2, 480, 560);
+    auto packets1 = img1.convertToPackets();
+    packets1.erase(packets1.begin() + packets1.size() / 2);
+
+    std::vector<SendableImage> received;
+    FrameAssembler assembler;
+    assembler.setFrameCallback([&received](auto&& frame) { received.push_back(std::move(frame)); });
+
+    feedPackets(assembler, packets1);
+    ASSERT_TRUE(received.empty());
+
+    feedPackets(assembler, img2.convertToPackets());
+    ASSERT_EQ(received.size(), 1);
+    ASSERT_EQ(received[0].getId(), 2);
+    ASSERT_EQ(assembler.getStats().droppedFrames, 1);
+}
+
+TEST(ProtocolFrameAssembler, InterleavedSenders) {
+    auto img1 = createTestImage(5, 10, 480, 560);
+    auto img2 = createTestImage(6, 3, 500, 500);
+    auto& packets1 = img1.convertToPackets();
+    auto& packets2 = img2.convertToPackets();
+
+    std::vector<ImageProcessing::ImageData_t> packets;
+    for (std::size_t i = 0; i < std::max(packets1.size(), packets2.size()); ++i) {
+        if (i < packets1.size()) packets.push_back(packets1[i]);
+        if (i < packets2.size()) packets.push_back(packets2[i]);
+    }
+
+    std::vector<SendableImage> received;
+    FrameAssembler assembler;
+    assembler.setFrameCallback([&received](auto&& frame) { received.push_back(std::move(frame)); });
+
+    feedPackets(assembler, packets);
+    ASSERT_EQ(received.size(), 2);
+    for (auto& frame : received) {
+        ASSERT_EQ(frame.getImage(), (frame.getSenderId() == 5 ? img1 : img2).getImage());
+    }
+}
+
+TEST(ProtocolFrameAssembler, ForwardErrorCorrection) {
+    const uint8_t groupCount {4};
+    auto img = createTestImage(5, 1, 480, 560);
+    img.setFecGroupCount(groupCount);
+    auto packets = img.convertToPackets();
+    ASSERT_EQ(packets.size(), img.getDataFragmentCount() + groupCount);
+
+    std::vector<SendableImage> received;
+    FrameAssembler assembler;
+    assembler.setFrameCallback([&received](auto&& frame) { received.push_back(std::move(frame)); });
+
+    // Single loss in the middle
+    auto lostMiddle = packets;
+    lostMiddle.erase(lostMiddle.begin() + img.getDataFragmentCount() / 2);
+    feedPackets(assembler, lostMiddle);
+    ASSERT_EQ(received.size(), 1);
+    ASSERT_EQ(received[0].getImage(), img.getImage());
+    ASSERT_EQ(assembler.getStats().recoveredFragments, 1);
+
+    // Burst loss covering every group once, including the short last fragment
+    img.setImage(2, ImageProcessing::ImageData_t(img.getImage()));
+    packets = img.convertToPackets();
+    auto lostBurst = packets;
+    auto burstEnd = lostBurst.begin() + img.getDataFragmentCount();
+    lostBurst.erase(burstEnd - groupCount, burstEnd);
+    feedPackets(assembler, lostBurst);
+    ASSERT_EQ(received.size(), 2);
+    ASSERT_EQ(received[1].getImage(), img.getImage());
+    ASSERT_EQ(assembler.getStats().recoveredFragments, 1 + groupCount);
+
+    // Two losses in one group can not be restored
+    img.setImage(3, ImageProcessing::ImageData_t(img.getImage()));
+    packets = img.convertToPackets();
+    auto lostGroup = packets;
+    lostGroup.erase(lostGroup.begin() + groupCount);
+    lostGroup.erase(lostGroup.begin());
+    feedPackets(assembler, lostGroup);
+    ASSERT_EQ(received.size(), 2);
+}
+
+TEST(ProtocolFrameAssembler, FragmentNackEncoding) {
+    FragmentNack nack;
+    nack.shotId = 42;
+    nack.fragmentNos = {0, 1, 2, 7, 9, 10};
+    ASSERT_EQ(nack.toRaw(), "42:0-2,7,9-10");
+
+    FragmentNack received;
+    ASSERT_TRUE(received.readRaw(nack.toRaw()));
+    ASSERT_EQ(received.shotId, nack.shotId);
+    ASSERT_EQ(received.fragmentNos, nack.fragmentNos);
+
+    nack.streamId = 3;
+    ASSERT_EQ(nack.toRaw(), "42/3:0-2,7,9-10");
+    ASSERT_TRUE(received.readRaw(nack.toRaw()));
+    ASSERT_EQ(received.streamId, 3);
+    ASSERT_EQ(received.fragmentNos, nack.fragmentNos);
+
+    ASSERT_FALSE(received.readRaw("42"));
+    ASSERT_FALSE(received.readRaw("42/256:1"));
+    ASSERT_FALSE(received.readRaw("42:5-3"));
+    ASSERT_FALSE(received.readRaw("42:0-99999999999"));
+}
+
+TEST(ProtocolFrameAssembler, NackRetransmission) {
+    auto img1 = createTestImage(5, 1, 480, 560);
+    auto img2 = createTestImage(5, 2, 480, 560);
+    auto packets1 = img1.convertToPackets();
+    std::vector<uint64_t> lostFragments {3, 4, packets1.size() / 2};
+
+    auto lostPackets1 = packets1;
+    for (auto it = lostFragments.rbegin(); it != lostFragments.rend(); ++it) {
+        lostPackets1.erase(lostPackets1.begin() + *it);
+    }
+
+    std::vector<SendableImage> received;
+    std::vector<FragmentNack> nacks;
+    FrameAssembler assembler;
+    assembler.setPendingFrameCount(4);
+    assembler.setFrameCallback([&received](auto&& frame) { received.push_back(std::move(frame)); });
+    assembler.setNackCallback([&nacks](uint64_t senderId, const FragmentNack& nack) {
+        ASSERT_EQ(senderId, 5);
+        nacks.push_back(nack);
+    });
+
+    // Tail of frame arrived, gaps are requested at once
+    feedPackets(assembler, lostPackets1);
+    ASSERT_TRUE(received.empty());
+    ASSERT_EQ(nacks.size(), 1);
+    ASSERT_EQ(nacks[0].shotId, 1);
+    ASSERT_EQ(nacks[0].fragmentNos, lostFragments);
+
+    // Newer frame does not drop pending one, but repeats request
+    feedPackets(assembler, img2.convertToPackets());
+    ASSERT_EQ(received.size(), 1);
+    ASSERT_EQ(received[0].getId(), 2);
+    ASSERT_EQ(nacks.size(), 2);
+
+    std::vector<ImageProcessing::ImageData_t> retransmitted;
+    for (auto fragmentNo : nacks[0].fragmentNos) {
+        retransmitted.push_back(packets1[fragmentNo]);
+    }
+    feedPackets(assembler, retransmitted);
+    ASSERT_EQ(received.size(), 2);
+    ASSERT_EQ(received[1].getId(), 1);
+    ASSERT_EQ(received[1].getImage(), img1.getImage());
+
+    auto& stats = assembler.getStats();
+    ASSERT_EQ(stats.droppedFrames, 0);
+    ASSERT_EQ(stats.nackedFrames, 1);
+    ASSERT_EQ(stats.nackRecoveredFrames, 1);
+    ASSERT_DOUBLE_EQ(stats.getNackRecoveryRatio(), 1.0);
+}
+
+TEST(ProtocolFrameAssembler, HashVerification) {
+    auto img = createTestImage(5, 1, 480, 560);
+    auto packets = img.convertToPackets();
+
+    // Payload damaged in a way passing packet layout checks
+    auto& corruptedPacket = packets[packets.size() / 2];
+    corruptedPacket.back() ^= 0xFF;
+
+    std::vector<SendableImage> received;
+    FrameAssembler assembler;
+    assembler.setFrameCallback([&received](auto&& frame) { received.push_back(std::move(frame)); });
+
+    feedPackets(assembler, packets);
+    ASSERT_TRUE(received.empty());
+    ASSERT_EQ(assembler.getStats().corruptedFrames, 1);
+    ASSERT_EQ(assembler.getStats().completedFrames, 0);
+
+    // Fragment of other image with the same shot id is not mixed in
+    auto otherImg = createTestImage(5, 2, 480, 560);
+    otherImg.setImage(2, ImageProcessing::ImageData_t(otherImg.getImage().rbegin(), otherImg.getImage().rend()));
+    auto otherPackets = otherImg.convertToPackets();
+    auto img2 = createTestImage(5, 2, 480, 560);
+    auto packets2 = img2.convertToPackets();
+    packets2.insert(packets2.begin() + 1, otherPackets[1]);
+
+    feedPackets(assembler, packets2);
+    ASSERT_EQ(received.size(), 1);
+    ASSERT_EQ(received[0].getImage(), img2.getImage());
+    ASSERT_EQ(assembler.getStats().invalidPackets, 1);
+}
+
+TEST(ProtocolFrameAssembler, RuntimeMtu) {
+    auto img = createTestImage(5, 1, 480, 560);
+    auto defaultFragmentCount = img.getDataFragmentCount();
+    ASSERT_THROW(img.setMtuSize(ImagePacket::MAX_MTU_SIZE + 1), std::invalid_argument);
+    ASSERT_THROW(img.setMtuSize(ImagePacket::MIN_MTU_SIZE - 1), std::invalid_argument);
+
+    img.setMtuSize(ImagePacket::MAX_MTU_SIZE);
+    img.setFecGroupCount(2);
+    ASSERT_LT(img.getDataFragmentCount() * 6, defaultFragmentCount);
+
+    auto packets = img.convertToPackets();
+    for (auto& p : packets) {
+        ASSERT_LE(p.size(), ImagePacket::MAX_MTU_SIZE);
+    }
+    packets.erase(packets.begin());
+
+    // Senders with different MTU are reassembled at once
+    auto smallImg = createTestImage(6, 1, 480, 560);
+    smallImg.setMtuSize(ImagePacket::MIN_MTU_SIZE);
+
+    std::vector<SendableImage> received;
+    FrameAssembler assembler;
+    assembler.setFrameCallback([&received](auto&& frame) { received.push_back(std::move(frame)); });
+    feedPackets(assembler, packets);
+    feedPackets(assembler, smallImg.convertToPackets());
+    ASSERT_EQ(received.size(), 2);
+    ASSERT_EQ(received[0].getImage(), img.getImage());
+    ASSERT_EQ(received[1].getImage(), smallImg.getImage());
+    ASSERT_EQ(assembler.getStats().recoveredFragments, 1);
+}
+
+TEST(ProtocolFrameAssembler, MultipleStreams) {
+    // Two cameras of one sender with the same shot ids
+    auto fullImg = createTestImage(5, 1, 480, 560);
+    auto lowImg = createTestImage(5, 1, 120, 140);
+    lowImg.setStreamId(1);
+    auto& fullPackets = fullImg.convertToPackets();
+    auto& lowPackets = lowImg.convertToPackets();
+
+    std::vector<ImageProcessing::ImageData_t> packets;
+    for (std::size_t i = 0; i < std::max(fullPackets.size(), lowPackets.size()); ++i) {
+        if (i < fullPackets.size()) {
+            packets.push_back(fullPackets[i]);
+        }
+        if (i < lowPackets.size()) {
+            packets.push_back(lowPackets[i]);
+        }
+    }
+
+    std::vector<SendableImage> received;
+    FrameAssembler assembler;
+    assembler.setFrameCallback([&received](auto&& frame) { received.push_back(std::move(frame)); });
+    feedPackets(assembler, packets);
+
+    ASSERT_EQ(received.size(), 2);
+    ASSERT_EQ(assembler.getStats().droppedFrames, 0);
+    std::sort(received.begin(), received.end(), [](auto& a, auto& b) { return a.getStreamId() < b.getStreamId(); });
+    ASSERT_EQ(received[0].getStreamId(), 0);
+    ASSERT_EQ(received[0].getImage(), fullImg.getImage());
+    ASSERT_EQ(received[1].getStreamId(), 1);
+    ASSERT_EQ(received[1].getSenderId(), 5);
+    ASSERT_EQ(received[1].getImage(), lowImg.getImage());
+}
+
+TEST(ProtocolFrameAssembler, UntrustedSenders) {
+    std::vector<SendableImage> received;
+    FrameAssembler assembler;
+    assembler.setFrameCallback([&received](auto&& frame) { received.push_back(std::move(frame)); });
+    assembler.setSenderFilter([](uint64_t senderId) { return senderId == 5; });
+
+    // Unknown sender takes no stream
+    auto unknownImg = createTestImage(6, 1, 120, 140);
+    feedPackets(assembler, unknownImg.convertToPackets());
+    ASSERT_TRUE(received.empty());
+    ASSERT_EQ(assembler.getStats().rejectedPackets, unknownImg.getFragmentCount());
+
+    // Streams of known sender are limited
+    for (std::size_t streamId = 0; streamId <= FrameAssembler::MAX_STREAMS_PER_SENDER; ++streamId) {
+        auto img = createTestImage(5, 1, 120, 140);
+        img.setStreamId(static_cast<uint8_t>(streamId));
+        feedPackets(assembler, img.convertToPackets());
+    }
+    ASSERT_EQ(received.size(), FrameAssembler::MAX_STREAMS_PER_SENDER);
+
+    // Idle streams are removed, so new ones could start
+    assembler.evictIdleStreams(FrameAssembler::Clock::now() + std::chrono::hours(1));
+    ASSERT_EQ(assembler.getStats().evictedStreams, FrameAssembler::MAX_STREAMS_PER_SENDER);
+    auto img = createTestImage(5, 1, 120, 140);
+    img.setStreamId(FrameAssembler::MAX_STREAMS_PER_SENDER);
+    feedPackets(assembler, img.convertToPackets());
+    ASSERT_EQ(received.size(), FrameAssembler::MAX_STREAMS_PER_SENDER + 1);
+    ASSERT_EQ(received.back().getImage(), img.getImage());
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <ROD/Protocol.h>
+
+#include <atomic>
+#include <thread>
+
+namespace {
+Protocol::SendableImage createFrame(uint64_t senderId, uint8_t streamId, uint64_t shotId)
+{
+    Protocol::SendableImage img;
+    img.setSenderId(senderId);
+    img.setStreamId(streamId);
+    img.setImage(shotId, ImageProcessing::ImageData_t(16, static_cast<uint8_t>(shotId)));
+    return img;
+}
+}
+
+TEST(ProtocolFrameMailbox, LatestOnly) {
+    Protocol::FrameMailbox mailbox(Protocol::MailboxPolicy::LatestOnly);
+    for (uint64_t shotId = 1; shotId <= 5; ++shotId) {
+        ASSERT_TRUE(mailbox.push(createFrame(1, 0, shotId)));
+    }
+    ASSERT_TRUE(mailbox.push(createFrame(2, 0, 10)));
+
+    // Streams are served in order they got frames, only the freshest frame of stream is left
+    Protocol::SendableImage img;
+    ASSERT_TRUE(mailbox.pop(img));
+    ASSERT_EQ(img.getSenderId(), 1u);
+    ASSERT_EQ(img.getId(), 5u);
+    ASSERT_TRUE(mailbox.pop(img));
+    ASSERT_EQ(img.getSenderId(), 2u);
+
+    auto stats = mailbox.getStats();
+    ASSERT_EQ(stats.pushed, 6u);
+    ASSERT_EQ(stats.superseded, 4u);
+    ASSERT_EQ(stats.delivered, 2u);
+}
+
+TEST(ProtocolFrameMailbox, DropOldestKeepsStreamOrder) {
+    Protocol::FrameMailbox mailbox(Protocol::MailboxPolicy::DropOldest, 2);
+    for (uint64_t shotId = 1; shotId <= 4; ++shotId) {
+        ASSERT_TRUE(mailbox.push(createFrame(1, 3, shotId)));
+    }
+
+    Protocol::SendableImage img;
+    ASSERT_TRUE(mailbox.pop(img));
+    ASSERT_EQ(img.getId(), 3u);
+
+    // Stream is busy until finished, other consumer must not get its next frame
+    std::atomic<bool> isPopped {false};
+    std::thread consumer([&]() {
+        Protocol::SendableImage nextImg;
+        if (mailbox.pop(nextImg)) {
+            isPopped.store(nextImg.getId() == 4);
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_FALSE(isPopped.load());
+    mailbox.finish(1, 3);
+    consumer.join();
+    ASSERT_TRUE(isPopped.load());
+    ASSERT_EQ(mailbox.getStats().dropped, 2u);
+}
+
+TEST(ProtocolFrameMailbox, BlockWaitsForConsumer) {
+    Protocol::FrameMailbox mailbox(Protocol::MailboxPolicy::Block, 1);
+    ASSERT_TRUE(mailbox.push(createFrame(1, 0, 1)));
+
+    std::atomic<bool> isPushed {false};
+    std::thread producer([&]() {
+        isPushed.store(mailbox.push(createFrame(1, 0, 2)));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_FALSE(isPushed.load());
+
+    Protocol::SendableImage img;
+    ASSERT_TRUE(mailbox.pop(img));
+    producer.join();
+    ASSERT_TRUE(isPushed.load());
+    ASSERT_EQ(mailbox.getStats().blockedPushes, 1u);
+
+    // Closing wakes everybody up
+    mailbox.close();
+    ASSERT_FALSE(mailbox.pop(img));
+    ASSERT_FALSE(mailbox.push(createFrame(1, 0, 3)));
+}
+
+TEST(ProtocolFrameMailbox, OrderedFramesAreQueuedWithLatestOnly) {
+    Protocol::FrameMailbox mailbox(Protocol::MailboxPolicy::LatestOnly, 2);
+    for (uint64_t shotId = 1; shotId <= 3; ++shotId) {
+        ASSERT_TRUE(mailbox.push(createFrame(1, 0, shotId), true));
+    }
+
+    // Tile deltas are not superseded, the oldest one is dropped on overflow
+    Protocol::SendableImage img;
+    ASSERT_TRUE(mailbox.pop(img));
+    ASSERT_EQ(img.getId(), 2u);
+    mailbox.finish(1, 0);
+    ASSERT_TRUE(mailbox.pop(img));
+    ASSERT_EQ(img.getId(), 3u);
+    mailbox.finish(1, 0);
+
+    auto stats = mailbox.getStats();
+    ASSERT_EQ(stats.dropped, 1u);
+    ASSERT_EQ(stats.superseded, 0u);
+}
+
+TEST(ProtocolFrameMailbox, EvictsIdleStreams) {
+    Protocol::FrameMailbox mailbox;
+    mailbox.setStreamIdleTimeout(std::chrono::milliseconds(100));
+    ASSERT_TRUE(mailbox.push(createFrame(1, 0, 1)));
+    ASSERT_TRUE(mailbox.push(createFrame(2, 0, 1)));
+
+    Protocol::SendableImage img;
+    ASSERT_TRUE(mailbox.pop(img));
+    ASSERT_EQ(img.getSenderId(), 1u);
+    ASSERT_EQ(mailbox.getStreamCount(), 2u);
+
+    // Busy stream and stream with queued frame are kept
+    const auto later = Protocol::FrameMailbox::Clock::now() + std::chrono::seconds(1);
+    mailbox.evictIdleStreams(later);
+    ASSERT_EQ(mailbox.getStreamCount(), 2u);
+
+    mailbox.finish(1, 0);
+    mailbox.evictIdleStreams(later);
+    ASSERT_EQ(mailbox.getStreamCount(), 1u);
+    ASSERT_EQ(mailbox.getStats().evictedStreams, 1u);
+
+    // Evicted stream starts again with its next frame
+    ASSERT_TRUE(mailbox.pop(img));
+    ASSERT_EQ(img.getSenderId(), 2u);
+    ASSERT_TRUE(mailbox.push(createFrame(1, 0, 2)));
+    ASSERT_EQ(mailbox.getStreamCount(), 2u);
+}
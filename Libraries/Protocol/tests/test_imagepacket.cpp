@@ -108,3 +108,29 @@ TEST(ProtocolImagePacket, Deserialization) {
     ASSERT_NE(deconvP2, tpack1);
     ASSERT_EQ(deconvP2, tpack2);
 }
+
+TEST(ProtocolImagePacket, HeaderLayout) {
+    auto tpack = createTestPacket1();
+    auto serialPack = tpack.convertToPacketPart();
+    ASSERT_EQ(serialPack.size(), ImagePacketHeader::WIRE_SIZE + tpack.getPayload().size());
+
+    // Fixed little-endian layout
+    ASSERT_EQ(serialPack[0], ImagePacketHeader::CURRENT_VERSION);
+    ASSERT_EQ(serialPack[16], 123);     // Shot ID, low byte
+    ASSERT_EQ(serialPack[24], 432 & 0xFF); // Fragment start, low byte
+    ASSERT_EQ(serialPack[25], 432 >> 8);
+
+    // View does not copy payload
+    ImagePacketView view;
+    ASSERT_TRUE(view.init(serialPack.data(), serialPack.size()));
+    ASSERT_EQ(view.getPayloadData(), serialPack.data() + ImagePacketHeader::WIRE_SIZE);
+    ASSERT_EQ(view.getPayloadSize(), tpack.getPayload().size());
+    ASSERT_EQ(view.getHeader().imageHash, tpack.getImageHash());
+    ASSERT_EQ(view.getHeader().fragmentStart, tpack.getFragmentStart());
+
+    // Truncated and unknown versions are rejected
+    ASSERT_FALSE(view.init(serialPack.data(), serialPack.size() - 1));
+    ASSERT_FALSE(view.init(serialPack.data(), ImagePacketHeader::WIRE_SIZE - 1));
+    serialPack[0] = ImagePacketHeader::CURRENT_VERSION + 1;
+    ASSERT_FALSE(view.init(serialPack.data(), serialPack.size()));
+}
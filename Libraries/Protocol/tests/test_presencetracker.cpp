@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <ROD/Protocol.h>
+
+#include <algorithm>
+
+using namespace std::chrono_literals;
+
+TEST(ProtocolPresenceTracker, Timeout) {
+    const auto start = Protocol::PresenceTracker::Clock::now();
+    Protocol::PresenceTracker tracker({100ms, 1000ms}, start);
+    tracker.connect(1, start);
+    tracker.connect(2, start);
+
+    // Device 1 sends heartbeats, device 2 is silent
+    std::vector<uint64_t> timedOut;
+    for (auto time = 100ms; time <= 3000ms; time += 100ms) {
+        tracker.heartbeat(1, start + time);
+        auto expired = tracker.advance(start + time);
+        timedOut.insert(timedOut.end(), expired.begin(), expired.end());
+        if (time == 1000ms) {
+            ASSERT_EQ(timedOut, std::vector<uint64_t>{2});
+        }
+    }
+    ASSERT_EQ(timedOut, std::vector<uint64_t>{2});
+    ASSERT_TRUE(tracker.isOnline(1));
+    ASSERT_FALSE(tracker.isOnline(2));
+    ASSERT_FALSE(tracker.heartbeat(2, start + 3000ms));
+
+    // Silent device 1 expires timeout after last heartbeat
+    ASSERT_TRUE(tracker.advance(start + 3900ms).empty());
+    ASSERT_EQ(tracker.advance(start + 4000ms), std::vector<uint64_t>{1});
+    ASSERT_EQ(tracker.size(), 0u);
+}
+
+TEST(ProtocolPresenceTracker, LongTimeoutAndReuse) {
+    const auto start = Protocol::PresenceTracker::Clock::now();
+    Protocol::PresenceTracker tracker({10ms, 600s}, start); // Timers go through upper levels
+    for (uint64_t id = 1; id <= 1000; ++id) {
+        tracker.connect(id, start + std::chrono::milliseconds(id));
+    }
+    for (uint64_t id = 1; id <= 1000; id += 2) {
+        ASSERT_TRUE(tracker.disconnect(id, start + 1s));
+    }
+    tracker.connect(1, start + 2s); // Reuses entry of disconnected device
+
+    ASSERT_TRUE(tracker.advance(start + 599s).empty());
+    auto timedOut = tracker.advance(start + 601s);
+    ASSERT_EQ(timedOut.size(), 500u);
+    ASSERT_TRUE(std::all_of(timedOut.begin(), timedOut.end(), [](uint64_t id) { return id % 2 == 0; }));
+    ASSERT_TRUE(tracker.isOnline(1));
+    ASSERT_EQ(tracker.advance(start + 602s), std::vector<uint64_t>{1});
+}
+
+TEST(ProtocolPresenceTracker, OnlineTime) {
+    const auto start = Protocol::PresenceTracker::Clock::now();
+    Protocol::PresenceTracker tracker({100ms, 10s}, start);
+    tracker.connect(1, start);
+    tracker.connect(2, start);
+
+    auto times = tracker.takeOnlineTimes(start + 2500ms);
+    ASSERT_EQ(times.size(), 2u);
+    for (auto& time : times) {
+        ASSERT_TRUE(time.isOnline);
+        ASSERT_EQ(time.online, 2s);
+    }
+
+    tracker.disconnect(2, start + 4000ms);
+    times = tracker.takeOnlineTimes(start + 5000ms);
+    ASSERT_EQ(times.size(), 2u);
+    std::sort(times.begin(), times.end(), [](auto& a, auto& b) { return a.deviceId < b.deviceId; });
+    ASSERT_EQ(times[0].online, 3s); // Remainder of previous take is kept
+    ASSERT_TRUE(times[0].isOnline);
+    ASSERT_EQ(times[1].online, 2s);
+    ASSERT_FALSE(times[1].isOnline);
+
+    ASSERT_EQ(tracker.takeOnlineTimes(start + 5000ms).size(), 1u);
+}
+
+TEST(ProtocolPresenceTracker, ReconnectionIsMerged) {
+    const auto start = Protocol::PresenceTracker::Clock::now();
+    Protocol::PresenceTracker tracker({100ms, 10s}, start);
+    tracker.connect(1, start);
+    tracker.disconnect(1, start + 2000ms);
+    tracker.connect(1, start + 3000ms);
+    tracker.disconnect(1, start + 4000ms);
+    tracker.connect(1, start + 5000ms);
+
+    // One record per device: online time of all sessions, state of the current one
+    auto times = tracker.takeOnlineTimes(start + 8000ms);
+    ASSERT_EQ(times.size(), 1u);
+    ASSERT_EQ(times[0].deviceId, 1u);
+    ASSERT_EQ(times[0].online, 6s);
+    ASSERT_TRUE(times[0].isOnline);
+    ASSERT_EQ(times[0].lastSeen, start + 5000ms);
+
+    tracker.disconnect(1, start + 9000ms);
+    times = tracker.takeOnlineTimes(start + 10000ms);
+    ASSERT_EQ(times.size(), 1u);
+    ASSERT_EQ(times[0].online, 1s);
+    ASSERT_FALSE(times[0].isOnline);
+}
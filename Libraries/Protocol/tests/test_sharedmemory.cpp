@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <ROD/Protocol.h>
+#include <ROD/ImageProcessing/Utility.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+TEST(ProtocolSharedMemory, RingOrderAndOverflow) {
+    Protocol::SharedFrameRing consumer;
+    ASSERT_TRUE(consumer.create(2, 64));
+
+    // Producer maps the same memfd, as other process would do
+    Protocol::SharedFrameRing producer;
+    ASSERT_TRUE(producer.attach(dup(consumer.getFd())));
+
+    const uint8_t frame1[] {1, 2, 3};
+    const uint8_t frame2[] {4, 5};
+    const uint8_t bigFrame[65] {};
+    ASSERT_FALSE(producer.push(7, 0, 1, bigFrame, sizeof(bigFrame)));
+    ASSERT_TRUE(producer.push(7, 0, 1, frame1, sizeof(frame1)));
+    ASSERT_TRUE(producer.push(7, 1, 2, frame2, sizeof(frame2)));
+    ASSERT_FALSE(producer.push(7, 0, 3, frame1, sizeof(frame1))); // Full
+
+    Protocol::SharedFrameSlot slot;
+    ASSERT_TRUE(consumer.peek(slot));
+    ASSERT_EQ(slot.shotId, 1u);
+    ASSERT_EQ(std::vector<uint8_t>(slot.pData, slot.pData + slot.dataSize), std::vector<uint8_t>(frame1, frame1 + sizeof(frame1)));
+    consumer.release();
+
+    ASSERT_TRUE(producer.push(7, 0, 3, frame1, sizeof(frame1)));
+    ASSERT_TRUE(consumer.peek(slot));
+    ASSERT_EQ(slot.shotId, 2u);
+    ASSERT_EQ(slot.streamId, 1u);
+    consumer.release();
+    ASSERT_TRUE(consumer.peek(slot));
+    ASSERT_EQ(slot.shotId, 3u);
+    consumer.release();
+    ASSERT_FALSE(consumer.peek(slot));
+}
+
+TEST(ProtocolSharedMemory, SendReceive) {
+    const std::string socketPath = "/tmp/rod_test_shm_" + std::to_string(getpid()) + ".sock";
+
+    std::mutex receivedMx;
+    std::condition_variable receivedCv;
+    std::vector<Protocol::SendableImage> receivedImages;
+    Protocol::SharedImageReceiver receiver(4, 1024 * 1024);
+    receiver.setImageCallback([&](Protocol::SendableImage&& img) {
+        std::lock_guard<std::mutex> lock(receivedMx);
+        receivedImages.push_back(std::move(img));
+        receivedCv.notify_one();
+    });
+    ASSERT_TRUE(receiver.start(socketPath)) << receiver.getLastErrorText();
+
+    Protocol::SharedImageSender sender;
+    ASSERT_TRUE(sender.connect(socketPath)) << sender.getLastErrorText();
+
+    auto imgData = ImageProcessing::Utility::generateTestImageBytes(480, 560);
+    for (uint64_t shotId = 1; shotId <= 3; ++shotId) {
+        Protocol::SendableImage img;
+        img.setSenderId(42);
+        img.setStreamId(2);
+        img.setImage(shotId, ImageProcessing::ImageData_t(imgData));
+        ASSERT_TRUE(sender.sendImage(img)) << sender.getLastErrorText();
+    }
+
+    std::unique_lock<std::mutex> lock(receivedMx);
+    ASSERT_TRUE(receivedCv.wait_for(lock, std::chrono::seconds(2), [&]() { return receivedImages.size() == 3; }));
+    for (uint64_t i = 0; i < 3; ++i) {
+        ASSERT_EQ(receivedImages[i].getId(), i + 1);
+        ASSERT_EQ(receivedImages[i].getSenderId(), 42u);
+        ASSERT_EQ(receivedImages[i].getStreamId(), 2);
+        ASSERT_EQ(receivedImages[i].getImage(), imgData);
+    }
+    lock.unlock();
+
+    // Sender notices receiver exit
+    receiver.stop();
+    Protocol::SendableImage img;
+    img.setImage(4, ImageProcessing::ImageData_t(imgData));
+    for (int i = 0; i < 10 && sender.isConnected(); ++i) {
+        sender.sendImage(img);
+    }
+    ASSERT_FALSE(sender.isConnected());
+    ASSERT_EQ(receiver.getStats().frames, 3u);
+}
+
+TEST(ProtocolSharedMemory, ConnectionLimitAndSenderFilter) {
+    const std::string socketPath = "/tmp/rod_test_shm_limit_" + std::to_string(getpid()) + ".sock";
+
+    std::atomic<std::size_t> receivedCount {};
+    Protocol::SharedImageReceiver receiver(2, 64 * 1024);
+    receiver.setImageCallback([&](Protocol::SendableImage&&) {
+        receivedCount++;
+    });
+    receiver.setSenderFilter([](uint64_t senderId) {
+        return senderId == 42;
+    });
+    ASSERT_TRUE(receiver.start(socketPath)) << receiver.getLastErrorText();
+
+    std::vector<std::unique_ptr<Protocol::SharedImageSender>> senders;
+    for (std::size_t i = 0; i < Protocol::SharedImageReceiver::MAX_CONNECTIONS; ++i) {
+        senders.push_back(std::make_unique<Protocol::SharedImageSender>());
+        ASSERT_TRUE(senders.back()->connect(socketPath)) << senders.back()->getLastErrorText();
+    }
+    Protocol::SharedImageSender rejectedSender;
+    ASSERT_FALSE(rejectedSender.connect(socketPath));
+
+    // Sender id of slot is checked before delivery
+    for (uint64_t senderId : {7, 42}) {
+        Protocol::SendableImage img;
+        img.setSenderId(senderId);
+        img.setImage(1, ImageProcessing::ImageData_t(1024, 1));
+        ASSERT_TRUE(senders.front()->sendImage(img)) << senders.front()->getLastErrorText();
+    }
+    for (int i = 0; i < 200 && receiver.getStats().frames + receiver.getStats().rejectedFrames < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    receiver.stop();
+
+    auto stats = receiver.getStats();
+    ASSERT_EQ(stats.connections, Protocol::SharedImageReceiver::MAX_CONNECTIONS);
+    ASSERT_EQ(stats.rejectedConnections, 1u);
+    ASSERT_EQ(stats.frames, 1u);
+    ASSERT_EQ(stats.rejectedFrames, 1u);
+    ASSERT_EQ(receivedCount.load(), 1u);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <ROD/Protocol.h>
+
+using namespace Protocol;
+using namespace std::chrono_literals;
+
+TEST(ProtocolTrafficPacer, Disabled) {
+    TrafficPacer pacer;
+    auto now = TrafficPacer::Clock::now();
+    ASSERT_FALSE(pacer.isEnabled());
+    ASSERT_EQ(pacer.schedule(1'000'000, now), now);
+}
+
+TEST(ProtocolTrafficPacer, TokenBucket) {
+    PacingConfig config;
+    config.bitrate = 8'000'000; // 1 MB per second
+    config.burstSize = 10'000;
+
+    TrafficPacer pacer;
+    pacer.setConfig(config);
+    auto startTime = TrafficPacer::Clock::now();
+
+    // Full bucket goes at once, then rate limits
+    ASSERT_EQ(pacer.schedule(10'000, startTime), startTime);
+    ASSERT_EQ(pacer.schedule(10'000, startTime), startTime + 10ms);
+    ASSERT_EQ(pacer.schedule(5'000, startTime), startTime + 15ms);
+
+    // Idle time refills bucket not more than burst size
+    auto idleTime = startTime + 1s;
+    ASSERT_EQ(pacer.schedule(10'000, idleTime), idleTime);
+    ASSERT_EQ(pacer.schedule(1'000, idleTime), idleTime + 1ms);
+
+    ASSERT_THROW(pacer.setConfig({8'000'000, 0, {}}), std::invalid_argument);
+}
+
+TEST(ProtocolTrafficPacer, BurstGap) {
+    PacingConfig config;
+    config.bitrate = 8'000'000;
+    config.burstSize = 10'000;
+    config.burstGap = 2ms;
+
+    TrafficPacer pacer;
+    pacer.setConfig(config);
+    auto startTime = TrafficPacer::Clock::now();
+    ASSERT_EQ(pacer.schedule(100, startTime), startTime);
+    ASSERT_EQ(pacer.schedule(100, startTime), startTime + 2ms);
+    ASSERT_EQ(pacer.schedule(100, startTime + 10ms), startTime + 10ms);
+}
+
+TEST(ProtocolTrafficPacer, FrameInterval) {
+    PacingConfig config;
+    config.burstSize = 10'000;
+    config.frameInterval = 10ms;
+
+    // Rate follows frame size: 10 kB in 10 ms is 1 MB per second
+    TrafficPacer pacer;
+    pacer.setConfig(config);
+    ASSERT_TRUE(pacer.isEnabled());
+    auto startTime = TrafficPacer::Clock::now();
+    pacer.startFrame(10'000);
+    ASSERT_EQ(pacer.schedule(10'000, startTime), startTime);
+    ASSERT_EQ(pacer.schedule(5'000, startTime), startTime + 5ms);
+
+    // Twice bigger frame goes twice faster, bitrate is min rate
+    pacer.startFrame(20'000);
+    ASSERT_EQ(pacer.schedule(2'000, startTime + 5ms), startTime + 6ms);
+    config.bitrate = 8 * 4'000'000;
+    pacer.setConfig(config);
+    pacer.startFrame(10'000);
+    ASSERT_EQ(pacer.schedule(10'000, startTime), startTime);
+    ASSERT_EQ(pacer.schedule(4'000, startTime), startTime + 1ms);
+
+    config.frameInterval = -1ms;
+    ASSERT_THROW(pacer.setConfig(config), std::invalid_argument);
+}
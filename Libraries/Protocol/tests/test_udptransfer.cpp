@@ -5,6 +5,14 @@
 #include <ROD/Protocol.h>
 #include <ROD/ImageProcessing/Utility.h>
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <thread>
+
 
 using checkpair_t = std::pair<Protocol::SendableImage, ImageProcessing::ImageData_t >;
 checkpair_t genPacket(int w, int h) {
@@ -75,3 +83,121 @@ TEST(ProtocolUDP, DropLast) {
     transferTester.testRegular(p.first);
     transferTester.testDropLast(p.first);
 }
+
+TEST(ProtocolUDP, ScatterGatherSend) {
+    auto p = genPacket(480, 560);
+
+    // Local receiver
+    int recvSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(recvSocket, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(recvSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    socklen_t addrLen = sizeof(addr);
+    ASSERT_EQ(getsockname(recvSocket, reinterpret_cast<sockaddr*>(&addr), &addrLen), 0);
+    int recvBufSize = 16 * 1024 * 1024;
+    setsockopt(recvSocket, SOL_SOCKET, SO_RCVBUF, &recvBufSize, sizeof(recvBufSize));
+    timeval tv {1, 0};
+    setsockopt(recvSocket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    Protocol::ImageStreamSender sender;
+    ASSERT_TRUE(sender.setHost("127.0.0.1", ntohs(addr.sin_port)));
+    ASSERT_TRUE(sender.sendImage(p.first));
+
+    std::vector<ImageProcessing::ImageData_t> receivedPackets;
+    for (std::size_t i = 0; i < p.first.getFragmentCount(); ++i) {
+        ImageProcessing::ImageData_t buf(Protocol::ImagePacket::MTU_SIZE);
+        auto recvRes = recv(recvSocket, buf.data(), buf.size(), 0);
+        ASSERT_GT(recvRes, 0);
+        buf.resize(recvRes);
+        receivedPackets.push_back(std::move(buf));
+    }
+    close(recvSocket);
+
+    // Same bytes, as serialized packets
+    ASSERT_EQ(receivedPackets, p.first.convertToPackets());
+
+    Protocol::SendableImage sImage;
+    ASSERT_TRUE(sImage.initFromPackets(std::move(receivedPackets)));
+    ASSERT_EQ(sImage.getImage(), p.second);
+}
+
+TEST(ProtocolUDP, PacedSend) {
+    auto p = genPacket(480, 560);
+
+    int recvSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(recvSocket, 0);
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(bind(recvSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    socklen_t addrLen = sizeof(addr);
+    ASSERT_EQ(getsockname(recvSocket, reinterpret_cast<sockaddr*>(&addr), &addrLen), 0);
+    int recvBufSize = 16 * 1024 * 1024;
+    setsockopt(recvSocket, SOL_SOCKET, SO_RCVBUF, &recvBufSize, sizeof(recvBufSize));
+
+    // Every frame is spread over 50 ms, first burst goes at once
+    const std::size_t frameBytes = p.first.getFragmentCount() * Protocol::ImagePacketHeader::WIRE_SIZE + p.second.size();
+    Protocol::PacingConfig pacing;
+    pacing.burstSize = 4 * Protocol::ImagePacket::MTU_SIZE;
+    pacing.frameInterval = std::chrono::milliseconds(50);
+
+    Protocol::ImageStreamSender sender;
+    sender.setPacing(pacing);
+    ASSERT_TRUE(sender.setHost("127.0.0.1", ntohs(addr.sin_port)));
+    ASSERT_TRUE(sender.sendImage(p.first));
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ASSERT_TRUE(sender.sendImage(p.first));
+    close(recvSocket);
+
+    // Sleeps never end early, so only lower bounds of time are exact. Scheduler delays only lower the rate
+    auto& stats = sender.getStats();
+    const auto minFrameTime = std::chrono::duration<double>(pacing.frameInterval) * (frameBytes - pacing.burstSize) / frameBytes;
+    ASSERT_EQ(stats.packets, 2 * p.first.getFragmentCount());
+    ASSERT_EQ(stats.bytes, 2 * frameBytes);
+    ASSERT_GE(stats.lastQueueDelay, minFrameTime * 0.9);
+    ASSERT_LE(stats.getAchievedBitrate(), frameBytes * 8 / (minFrameTime.count() * 0.9));
+
+    // Pause between frames is not sending time
+    ASSERT_LT(stats.sendingTime, std::chrono::milliseconds(300));
+}
+
+TEST(ProtocolUDP, BatchedReceive) {
+    auto p = genPacket(480, 560);
+
+    std::mutex receivedMx;
+    std::vector<ImageProcessing::ImageData_t> receivedPackets;
+    Protocol::ImageStreamReceiver receiver(16);
+    receiver.setBatchProcessor([&](const Protocol::ImagePacketView* pViews, std::size_t viewCount) {
+        std::lock_guard<std::mutex> lock(receivedMx);
+        for (std::size_t i = 0; i < viewCount; ++i) {
+            Protocol::ImagePacket packet;
+            ASSERT_TRUE(packet.initFromView(pViews[i]));
+            receivedPackets.push_back(packet.convertToPacketPart());
+        }
+    });
+    ASSERT_TRUE(receiver.start(0));
+
+    Protocol::ImageStreamSender sender;
+    ASSERT_TRUE(sender.setHost("127.0.0.1", receiver.getPort()));
+    ASSERT_TRUE(sender.sendImage(p.first));
+
+    for (int waitMs = 0; waitMs < 1000; waitMs += 10) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        std::lock_guard<std::mutex> lock(receivedMx);
+        if (receivedPackets.size() == p.first.getFragmentCount()) {
+            break;
+        }
+    }
+    receiver.stop();
+
+    auto stats = receiver.getStats();
+    ASSERT_EQ(stats.datagrams, p.first.getFragmentCount());
+    ASSERT_EQ(stats.invalidDatagrams, 0);
+    ASSERT_GE(stats.getDatagramsPerCall(), 1.0);
+
+    Protocol::SendableImage sImage;
+    ASSERT_TRUE(sImage.initFromPackets(std::move(receivedPackets)));
+    ASSERT_EQ(sImage.getImage(), p.second);
+}
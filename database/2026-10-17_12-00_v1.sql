@@ -0,0 +1,12 @@
+-- Text of detector info is stored as is, server binds it as statement parameter
+ALTER TABLE detector.info ALTER COLUMN display_name SET DEFAULT('Unnamed detector');
+ALTER TABLE detector.info ALTER COLUMN location SET DEFAULT('Main location');
+
+-- Decode values stored in HEX by previous versions of server. Text, which only starts like HEX, is kept
+UPDATE detector.info SET display_name = convert_from(decode(substr(display_name, 5), 'hex'), 'UTF8') WHERE display_name ~ '^HEX-([0-9a-fA-F]{2})+$';
+UPDATE detector.info SET description  = convert_from(decode(substr(description, 5), 'hex'), 'UTF8')  WHERE description ~ '^HEX-([0-9a-fA-F]{2})+$';
+UPDATE detector.info SET location     = convert_from(decode(substr(location, 5), 'hex'), 'UTF8')     WHERE location ~ '^HEX-([0-9a-fA-F]{2})+$';
+
+-- Old defaults had no prefix and ended with new line
+UPDATE detector.info SET display_name = 'Unnamed detector' WHERE display_name IN ('556e6e616d6564206465746563746f720a', E'Unnamed detector\n');
+UPDATE detector.info SET location = 'Main location' WHERE location IN ('4d61696e206c6f636174696f6e0a', E'Main location\n');